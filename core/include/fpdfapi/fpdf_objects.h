@@ -8,6 +8,7 @@
 #define CORE_INCLUDE_FPDFAPI_FPDF_OBJECTS_H_
 
 #include <map>
+#include <memory>
 #include <set>
 
 #include "core/include/fxcrt/fx_coordinates.h"
@@ -28,6 +29,7 @@ class CPDF_Stream;
 class CPDF_StreamAcc;
 class CPDF_StreamFilter;
 class CPDF_String;
+class ICodec_StreamDecoder;
 class IFX_FileRead;
 
 class CPDF_Object {
@@ -375,6 +377,8 @@ class CPDF_Dictionary : public CPDF_Object {
 
   // Set* functions invalidate iterators for the element with the key |key|.
   void SetAt(const CFX_ByteStringC& key, CPDF_Object* pObj);
+  // As SetAt(), but keeps |key|'s buffer instead of copying it.
+  void SetAtSharedKey(const CFX_ByteString& key, CPDF_Object* pObj);
   void SetAtName(const CFX_ByteStringC& key, const CFX_ByteString& name);
   void SetAtString(const CFX_ByteStringC& key, const CFX_ByteString& string);
   void SetAtInteger(const CFX_ByteStringC& key, int i);
@@ -506,6 +510,39 @@ class CPDF_StreamAcc {
   uint8_t* m_pSrcData;
 };
 
+// Pull-based alternative to CPDF_StreamAcc for streams that can be decoded
+// incrementally: unfiltered streams and single FlateDecode streams with valid
+// parameters and no predictor. Neither the raw nor the decoded data is held
+// in full; file based streams are read in blocks of kRawBlockSize bytes.
+class CPDF_StreamReader {
+ public:
+  static const FX_DWORD kRawBlockSize = 64 * 1024;
+
+  CPDF_StreamReader();
+  ~CPDF_StreamReader();
+
+  // Returns FALSE if |pStream| can not be decoded incrementally, in which
+  // case CPDF_StreamAcc should be used instead.
+  FX_BOOL Load(const CPDF_Stream* pStream);
+
+  // Returns the number of decoded bytes written to |pBuf|, which is less than
+  // |size| only once the end of the stream has been reached.
+  FX_DWORD ReadBlock(uint8_t* pBuf, FX_DWORD size);
+
+  FX_BOOL IsEOF() const { return m_bEOF; }
+  const CPDF_Stream* GetStream() const { return m_pStream; }
+
+ protected:
+  FX_DWORD ReadRawBlock(uint8_t* pBuf, FX_DWORD size);
+  FX_BOOL FeedDecoder();
+
+  const CPDF_Stream* m_pStream;
+  std::unique_ptr<ICodec_StreamDecoder> m_pDecoder;
+  uint8_t* m_pRawBuf;
+  FX_DWORD m_RawPos;
+  FX_BOOL m_bEOF;
+};
+
 class CPDF_Null : public CPDF_Object {
  public:
   CPDF_Null() {}
@@ -598,10 +635,14 @@ class CPDF_IndirectObjectHolder {
   iterator end() { return m_IndirectObjs.end(); }
   const_iterator end() const { return m_IndirectObjs.end(); }
 
+  // Shares the buffers of names and dictionary keys parsed into the holder.
+  CFX_ByteStringPool* GetStringPool() { return &m_StringPool; }
+
  protected:
   CPDF_Parser* m_pParser;
   FX_DWORD m_LastObjNum;
   std::map<FX_DWORD, CPDF_Object*> m_IndirectObjs;
+  CFX_ByteStringPool m_StringPool;
 };
 
 #endif  // CORE_INCLUDE_FPDFAPI_FPDF_OBJECTS_H_
@@ -7,7 +7,9 @@
 #ifndef CORE_INCLUDE_FPDFAPI_FPDF_PAGE_H_
 #define CORE_INCLUDE_FPDFAPI_FPDF_PAGE_H_
 
+#include <map>
 #include <memory>
+#include <vector>
 
 #include "core/include/fpdfapi/fpdf_parser.h"
 #include "core/include/fpdfapi/fpdf_resource.h"
@@ -22,6 +24,7 @@ class CPDF_StreamFilter;
 class CPDF_AllStates;
 class CPDF_ContentParser;
 class CPDF_StreamContentParser;
+class CPDF_StreamParser;
 #define PDFTRANS_GROUP 0x0100
 #define PDFTRANS_ISOLATED 0x0200
 #define PDFTRANS_KNOCKOUT 0x0400
@@ -55,9 +58,15 @@ class CPDF_PageObjectList {
     return (CPDF_PageObject*)m_ObjectList.GetAt(pos);
   }
 
-  void AddTail(CPDF_PageObject* obj) { m_ObjectList.AddTail(obj); }
+  void AddTail(CPDF_PageObject* obj);
   FX_DWORD CountObjects() const { return m_ObjectList.GetCount(); }
 
+  // Changes whenever objects are added or the list is transformed, and is
+  // never shared by two lists, so a cache keyed on the list and its version
+  // can tell a modified or recreated list from the one it saw. Changes to
+  // individual objects do not count.
+  FX_DWORD GetVersion() const { return m_dwVersion; }
+
   int GetObjectIndex(CPDF_PageObject* pObj) const;
 
   CPDF_PageObject* GetObjectByIndex(int index) const;
@@ -88,12 +97,14 @@ class CPDF_PageObjectList {
   enum ParseState { CONTENT_NOT_PARSED, CONTENT_PARSING, CONTENT_PARSED };
 
   void LoadTransInfo();
+  void UpdateVersion();
 
   FX_BOOL m_bBackgroundAlphaNeeded;
   FX_BOOL m_bHasImageMask;
   ParseState m_ParseState;
   std::unique_ptr<CPDF_ContentParser> m_pParser;
   CFX_PtrList m_ObjectList;
+  FX_DWORD m_dwVersion;
 };
 
 class CPDF_Page : public CPDF_PageObjectList, public CFX_PrivateData {
@@ -165,6 +176,103 @@ class CPDF_Form : public CPDF_PageObjectList {
 
   CPDF_Form* Clone() const;
 };
+
+// A character shown by a text operator. Positions are in page user space,
+// like the positions CPDF_TextPage reports.
+struct CPDF_TextStreamChar {
+  FX_DWORD m_CharCode;
+  // The character code itself when the font has no Unicode mapping.
+  FX_WCHAR m_Unicode;
+  FX_BOOL m_bUnicodeMapped;
+  FX_FLOAT m_FontSize;
+  FX_FLOAT m_OriginX;
+  FX_FLOAT m_OriginY;
+  int m_TextMode;
+};
+
+class IPDF_TextStreamHandler {
+ public:
+  virtual ~IPDF_TextStreamHandler() {}
+
+  // Called in content stream order, once for every Unicode character; a
+  // glyph mapped to several characters, like a ligature, reports each of
+  // them at the glyph's origin.
+  virtual void OnChar(const CPDF_TextStreamChar& ch) = 0;
+};
+
+// Walks page content for its text alone. Only the CTM and text state are
+// tracked and shown strings are decoded straight to characters, so no page
+// objects, paths, images or colour spaces are created. Form XObjects are
+// followed; image XObjects are never loaded.
+class CPDF_TextStreamParser {
+ public:
+  CPDF_TextStreamParser(CPDF_Document* pDoc, IPDF_TextStreamHandler* pHandler);
+  ~CPDF_TextStreamParser();
+
+  // |pPage| only needs CPDF_Page::Load(); its content is not parsed.
+  void ParsePage(const CPDF_Page* pPage);
+
+ private:
+  class Operands;
+  struct State {
+    State();
+
+    CFX_Matrix m_CTM;
+    CFX_Matrix m_TextMatrix;
+    FX_FLOAT m_TextX;
+    FX_FLOAT m_TextY;
+    FX_FLOAT m_TextLineX;
+    FX_FLOAT m_TextLineY;
+    FX_FLOAT m_TextLeading;
+    FX_FLOAT m_TextRise;
+    FX_FLOAT m_TextHorzScale;
+    CPDF_Font* m_pFont;
+    FX_FLOAT m_FontSize;
+    FX_FLOAT m_CharSpace;
+    FX_FLOAT m_WordSpace;
+    int m_TextMode;
+  };
+
+  void ParseContent(const uint8_t* pData,
+                    FX_DWORD dwSize,
+                    CPDF_Dictionary* pResources,
+                    int level);
+  void OnOperator(const uint8_t* op,
+                  FX_DWORD len,
+                  Operands& operands,
+                  CPDF_StreamParser* pSyntax,
+                  CPDF_Dictionary* pResources,
+                  int level);
+  void MoveTextPoint(FX_FLOAT x, FX_FLOAT y);
+  void MoveToNextLine();
+  void ShowText(const CFX_ByteString& str, int level);
+  void ShowTextArray(CPDF_Array* pArray, int level);
+  void AddText(const CFX_ByteString* pStrs,
+               FX_FLOAT fInitKerning,
+               const FX_FLOAT* pKerning,
+               int nsegs,
+               int level);
+  void ApplyKerning(CPDF_Font* pFont, FX_FLOAT kerning);
+  void EmitChar(CPDF_Font* pFont, CPDF_TextStreamChar& ch);
+  void ExecuteXObject(const CFX_ByteString& name,
+                      CPDF_Dictionary* pResources,
+                      int level);
+  void SkipInlineImage(CPDF_StreamParser* pSyntax,
+                       CPDF_Dictionary* pResources);
+  CPDF_Object* FindResourceObj(CPDF_Dictionary* pResources,
+                               const CFX_ByteStringC& type,
+                               const CFX_ByteString& name) const;
+  CPDF_Font* FindFont(CPDF_Dictionary* pResources, const CFX_ByteString& name);
+
+  CPDF_Document* const m_pDocument;
+  IPDF_TextStreamHandler* const m_pHandler;
+  CPDF_Dictionary* m_pPageResources;
+  State m_State;
+  std::vector<State> m_StateStack;
+  // Fonts loaded so far, released together when parsing ends.
+  std::map<CPDF_Dictionary*, CPDF_Font*> m_Fonts;
+};
+
 class CPDF_PageContentGenerator {
  public:
   CPDF_PageContentGenerator(CPDF_Page* pPage);
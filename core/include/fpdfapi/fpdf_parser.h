@@ -728,6 +728,12 @@ void FlateEncode(const uint8_t* src_buf,
                  FX_DWORD src_size,
                  uint8_t*& dest_buf,
                  FX_DWORD& dest_size);
+// |level| is one of the FXCODEC_FLATE_LEVEL_* values or a zlib level.
+void FlateEncode(const uint8_t* src_buf,
+                 FX_DWORD src_size,
+                 int level,
+                 uint8_t*& dest_buf,
+                 FX_DWORD& dest_size);
 void FlateEncode(const uint8_t* src_buf,
                  FX_DWORD src_size,
                  int predictor,
@@ -877,6 +883,9 @@ FX_DWORD FPDFAPI_FlateOrLZWDecode(FX_BOOL bLZW,
                                   FX_DWORD estimated_size,
                                   uint8_t*& dest_buf,
                                   FX_DWORD& dest_size);
+// Whether FPDFAPI_FlateOrLZWDecode() accepts the decode parameters |pParams|,
+// which may be NULL. PDF_DataDecode() fails on streams with others.
+FX_BOOL FPDFAPI_CheckFlateDecodeParams(const CPDF_Dictionary* pParams);
 FX_BOOL PDF_DataDecode(const uint8_t* src_buf,
                        FX_DWORD src_size,
                        const CPDF_Dictionary* pDict,
@@ -9,6 +9,8 @@
 
 #include <map>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "core/include/fpdfapi/fpdf_page.h"
 #include "core/include/fxge/fx_ge.h"
@@ -16,11 +18,13 @@
 class CFX_GraphStateData;
 class CFX_PathData;
 class CFX_RenderDevice;
+class CPDF_DisplayList;
 class CPDF_FormObject;
 class CPDF_ImageCacheEntry;
 class CPDF_ImageObject;
 class CPDF_PathObject;
 class CPDF_RenderStatus;
+class CPDF_ScratchBitmapPool;
 class CPDF_ShadingObject;
 class CPDF_TextObject;
 class IFX_Pause;
@@ -68,6 +72,10 @@ class CPDF_RenderOptions {
   IPDF_OCContext* m_pOCContext;
   FX_DWORD m_dwLimitCacheSize;
   int m_HalftoneLimit;
+  // Non-zero lets object lists be culled through display lists kept in the
+  // page render cache. Lists built under another stamp are rebuilt, so the
+  // caller changes it whenever page objects may have moved.
+  FX_DWORD m_dwDisplayListStamp;
 };
 
 class CPDF_RenderContext {
@@ -105,6 +113,12 @@ class CPDF_RenderContext {
   CPDF_Document* GetDocument() const { return m_pDocument; }
   CPDF_Dictionary* GetPageResources() const { return m_pPageResources; }
   CPDF_PageRenderCache* GetPageCache() const { return m_pPageCache; }
+  CPDF_ScratchBitmapPool* GetScratchBitmapPool() const {
+    return m_pScratchBitmaps.get();
+  }
+  // NULL unless |pOptions| allow display lists and there is a page cache.
+  const CPDF_DisplayList* GetDisplayList(const CPDF_PageObjectList* pObjs,
+                                         const CPDF_RenderOptions* pOptions);
 
  protected:
   CPDF_Document* const m_pDocument;
@@ -112,6 +126,7 @@ class CPDF_RenderContext {
   CPDF_PageRenderCache* m_pPageCache;
   FX_BOOL m_bFirstLayer;
   CFX_ArrayTemplate<Layer> m_Layers;
+  std::unique_ptr<CPDF_ScratchBitmapPool> m_pScratchBitmaps;
 };
 
 class CPDF_ProgressiveRenderer {
@@ -140,6 +155,9 @@ class CPDF_ProgressiveRenderer {
 
  private:
   void RenderStep();
+  // Moves on to the next of |m_VisibleObjects|, or returns NULL after the
+  // last.
+  FX_POSITION NextVisibleObject();
 
   Status m_Status;
   CPDF_RenderContext* const m_pContext;
@@ -151,6 +169,10 @@ class CPDF_ProgressiveRenderer {
   FX_DWORD m_ObjectIndex;
   FX_POSITION m_ObjectPos;
   FX_POSITION m_PrevLastPos;
+  // Objects of the current layer that meet the clip, when it has a display
+  // list, with their indices in the layer.
+  std::vector<std::pair<FX_DWORD, FX_POSITION>> m_VisibleObjects;
+  size_t m_VisibleIndex;
 };
 
 class CPDF_TextRenderer {
@@ -210,11 +232,42 @@ class CPDF_TextRenderer {
 };
 class CPDF_PageRenderCache {
  public:
+  // What a rendered soft mask depends on: its SMask dictionary, the
+  // resources its group falls back to, the device matrix and the clip box.
+  struct SMaskKey {
+    bool operator<(const SMaskKey& other) const;
+
+    const CPDF_Dictionary* m_pDict;
+    const CPDF_Dictionary* m_pPageResources;
+    CFX_Matrix m_Matrix;
+    FX_RECT m_Rect;
+  };
+
+  // What a rendered tiling pattern cell depends on: the pattern and the
+  // matrix its content was parsed with, the pattern to bitmap matrix, the
+  // bitmap size and the render options.
+  struct PatternKey {
+    bool operator<(const PatternKey& other) const;
+
+    const CPDF_Object* m_pPattern;
+    CFX_Matrix m_ParentMatrix;
+    CFX_Matrix m_Matrix;
+    int m_Width;
+    int m_Height;
+    FX_DWORD m_Flags;
+    int m_ColorMode;
+    FX_COLORREF m_ForeColor;
+    FX_COLORREF m_BackColor;
+  };
+
   explicit CPDF_PageRenderCache(CPDF_Page* pPage)
       : m_pPage(pPage),
         m_pCurImageCacheEntry(nullptr),
+        m_dwDisplayListStamp(0),
         m_nTimeCount(0),
         m_nCacheSize(0),
+        m_nSMaskSize(0),
+        m_nPatternSize(0),
         m_bCurFindCache(FALSE) {}
   ~CPDF_PageRenderCache();
   void ClearImageData();
@@ -252,13 +305,45 @@ class CPDF_PageRenderCache {
 
   FX_BOOL Continue(IFX_Pause* pPause);
 
+  // Soft masks rendered earlier for this page, shared by every object and
+  // every render that uses the same mask in the same place. They count
+  // towards the cache size like images.
+  CFX_DIBitmapRef GetCachedSMask(const SMaskKey& key);
+  void CacheSMask(const SMaskKey& key, const CFX_DIBitmapRef& mask);
+  void ClearSMaskCacheEntry(const SMaskKey& key);
+  size_t CountCachedSMasks() const { return m_SMaskCache.size(); }
+
+  // Tiling pattern cells, shared the same way by every object filled with
+  // the pattern at the same scale.
+  CFX_DIBitmapRef GetCachedPatternCell(const PatternKey& key);
+  void CachePatternCell(const PatternKey& key, const CFX_DIBitmapRef& cell);
+  void ClearPatternCacheEntry(const PatternKey& key);
+  size_t CountCachedPatternCells() const { return m_PatternCache.size(); }
+
+  // A display list of |pObjectList|, kept while the list's version and
+  // |dwStamp| stay the same. Returns NULL for lists still being parsed.
+  const CPDF_DisplayList* GetDisplayList(const CPDF_PageObjectList* pObjectList,
+                                         FX_DWORD dwStamp);
+
  protected:
   friend class CPDF_Page;
+
+  struct BitmapEntry {
+    CFX_DIBitmapRef m_Bitmap;
+    FX_DWORD m_dwTimeCount;
+  };
+
   CPDF_Page* const m_pPage;
   CPDF_ImageCacheEntry* m_pCurImageCacheEntry;
   std::map<CPDF_Stream*, CPDF_ImageCacheEntry*> m_ImageCache;
+  std::map<SMaskKey, BitmapEntry> m_SMaskCache;
+  std::map<PatternKey, BitmapEntry> m_PatternCache;
+  std::map<const CPDF_PageObjectList*, CPDF_DisplayList*> m_DisplayLists;
+  FX_DWORD m_dwDisplayListStamp;
   FX_DWORD m_nTimeCount;
   FX_DWORD m_nCacheSize;
+  FX_DWORD m_nSMaskSize;
+  FX_DWORD m_nPatternSize;
   FX_BOOL m_bCurFindCache;
 };
 class CPDF_RenderConfig {
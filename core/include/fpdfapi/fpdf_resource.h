@@ -461,6 +461,8 @@ class CPDF_CIDFont : public CPDF_Font {
   void LoadMetricsArray(CPDF_Array* pArray,
                         CFX_DWordArray& result,
                         int nElements);
+  void LoadWidthTable();
+  int GetCIDWidth(FX_WORD CID) const;
   void LoadSubstFont();
 
   CPDF_CMap* m_pCMap;
@@ -474,6 +476,12 @@ class CPDF_CIDFont : public CPDF_Font {
   FX_WORD* m_pAnsiWidths;
   FX_SMALL_RECT m_CharBBox[256];
   CFX_DWordArray m_WidthList;
+  // The widths of |m_WidthList| indexed by CID - |m_WidthTableStart|, with
+  // |m_DefaultWidth| for the CIDs it leaves out. NULL when it has no entries
+  // or a width beyond the range of FX_WORD.
+  FX_WORD* m_pWidthTable;
+  FX_DWORD m_WidthTableStart;
+  FX_DWORD m_WidthTableSize;
   short m_DefaultVY;
   short m_DefaultW1;
   CFX_DWordArray m_VertMetrics;
@@ -7,9 +7,14 @@
 #ifndef CORE_INCLUDE_FPDFAPI_FPDF_SERIAL_H_
 #define CORE_INCLUDE_FPDFAPI_FPDF_SERIAL_H_
 
+#include <map>
+#include <memory>
+
 #include "core/include/fpdfapi/fpdf_page.h"
 #include "core/include/fpdfapi/fpdf_pageobj.h"
 
+class CPDF_FlateEncodeQueue;
+class CPDF_ObjectDeduplicator;
 class CPDF_ObjectStream;
 class CPDF_XRefStream;
 
@@ -19,6 +24,13 @@ CFX_ByteTextBuf& operator<<(CFX_ByteTextBuf& buf, const CPDF_Object* pObj);
 #define FPDFCREATE_NO_ORIGINAL 2
 #define FPDFCREATE_PROGRESSIVE 4
 #define FPDFCREATE_OBJECTSTREAM 8
+// Deflate streams on worker threads ahead of the writer. The output is
+// byte-identical to a serial save.
+#define FPDFCREATE_PARALLEL_COMPRESS 16
+// Write one copy of indirect objects with equal values and point the written
+// references at it; the document itself is left as it was. Ignored for
+// incremental saves.
+#define FPDFCREATE_DEDUPLICATE 32
 
 class CPDF_Creator {
  public:
@@ -29,6 +41,13 @@ class CPDF_Creator {
   FX_BOOL Create(IFX_StreamWrite* pFile, FX_DWORD flags = 0);
   int32_t Continue(IFX_Pause* pPause = NULL);
   FX_BOOL SetFileVersion(int32_t fileVersion = 17);
+  // Deflate level for the streams written by this creator, one of the
+  // FXCODEC_FLATE_LEVEL_* values or a zlib level.
+  void SetCompressionLevel(int level);
+
+  // Results of FPDFCREATE_DEDUPLICATE for the last Create() call.
+  FX_DWORD GetDuplicateCount() const { return m_dwDuplicateCount; }
+  FX_FILESIZE GetDuplicateSize() const { return m_DuplicateSize; }
 
  protected:
   CPDF_Document* m_pDocument;
@@ -74,6 +93,9 @@ class CPDF_Creator {
   int32_t WriteOldIndirectObject(FX_DWORD objnum);
   int32_t WriteOldObjs(IFX_Pause* pPause);
   int32_t WriteNewObjs(FX_BOOL bIncremental, IFX_Pause* pPause);
+  FX_BOOL IsFlateCandidate(const CPDF_Object* pObj) const;
+  void PostOldObjs(FX_DWORD objnum, FX_DWORD nLastObjNum);
+  void PostNewObjs(int32_t index);
   int32_t WriteIndirectObj(const CPDF_Object* pObj);
   int32_t WriteDirectObj(FX_DWORD objnum,
                          const CPDF_Object* pObj,
@@ -97,6 +119,14 @@ class CPDF_Creator {
   CFX_DWordArray m_NewObjNumArray;
   CPDF_Array* m_pIDArray;
   int32_t m_FileVersion;
+  std::unique_ptr<CPDF_FlateEncodeQueue> m_pFlateQueue;
+  FX_DWORD m_PostPos;
+  std::unique_ptr<CPDF_ObjectDeduplicator> m_pDeduplicator;
+  // Number to write in place of each reference to a dropped duplicate.
+  std::map<FX_DWORD, FX_DWORD> m_ObjNumMap;
+  FX_DWORD m_dwDuplicateCount;
+  FX_FILESIZE m_DuplicateSize;
+  int m_CompressionLevel;
 
   friend class CPDF_ObjectStream;
   friend class CPDF_XRefStream;
@@ -87,6 +87,12 @@ class IPDF_TextPage {
 
   virtual void GetCharInfo(int index, FPDF_CHAR_INFO* info) const = 0;
 
+  // Fills |infos| for up to |count| characters from |start| and returns how
+  // many were written; cheaper than calling GetCharInfo() for each one.
+  virtual int GetCharInfos(int start,
+                           int count,
+                           FPDF_CHAR_INFO* infos) const = 0;
+
   virtual void GetRectArray(int start,
                             int nCount,
                             CFX_RectArray& rectArray) const = 0;
@@ -154,6 +160,33 @@ class IPDF_TextPageFind {
 
   virtual int GetMatchedCount() const = 0;
 };
+
+// Document-wide search over an index built page by page, so queries do not
+// load or parse pages again.
+class IPDF_DocProgressiveSearch {
+ public:
+  // |flags| are passed to IPDF_TextPage::CreateTextPage() for every page, so
+  // results use the same character indices as text pages created with them.
+  static IPDF_DocProgressiveSearch* Create(CPDF_Document* pDoc, int flags = 0);
+
+  virtual ~IPDF_DocProgressiveSearch() {}
+
+  // Parses and indexes the remaining pages in text-only mode, checking
+  // |pPause| between pages. Returns TRUE once every page is indexed.
+  virtual FX_BOOL Continue(IFX_Pause* pPause) = 0;
+
+  virtual int CountIndexedPages() const = 0;
+
+  // Searches the pages indexed so far. Takes FPDFTEXT_MATCHCASE and
+  // FPDFTEXT_MATCHWHOLEWORD; returns the number of matches.
+  virtual int Find(const CFX_WideString& findwhat, int flags) = 0;
+
+  virtual FX_BOOL GetResult(int index,
+                            int& pageIndex,
+                            int& start,
+                            int& count) const = 0;
+};
+
 class IPDF_LinkExtract {
  public:
   virtual ~IPDF_LinkExtract() {}
@@ -30,6 +30,7 @@ class ICodec_Jbig2Module;
 class ICodec_JpegModule;
 class ICodec_JpxModule;
 class ICodec_ScanlineDecoder;
+class ICodec_StreamDecoder;
 
 #ifdef PDF_ENABLE_XFA
 class ICodec_BmpModule;
@@ -60,6 +61,12 @@ class CFX_DIBAttribute {
 };
 #endif  // PDF_ENABLE_XFA
 
+// Deflate levels for ICodec_FlateModule::Encode(). Any zlib level from 1 to 9
+// is accepted as well.
+#define FXCODEC_FLATE_LEVEL_DEFAULT -1
+#define FXCODEC_FLATE_LEVEL_FAST 1
+#define FXCODEC_FLATE_LEVEL_MAX 9
+
 class CCodec_ModuleMgr {
  public:
   CCodec_ModuleMgr();
@@ -71,6 +78,12 @@ class CCodec_ModuleMgr {
   ICodec_Jbig2Module* GetJbig2Module() const { return m_pJbig2Module.get(); }
   ICodec_IccModule* GetIccModule() const { return m_pIccModule.get(); }
   ICodec_FlateModule* GetFlateModule() const { return m_pFlateModule.get(); }
+  // Replaces the bundled zlib codec, e.g. with one built on a faster deflate
+  // library. Takes ownership of |pModule|, which must be safe to call from
+  // several threads at once.
+  void SetFlateModule(ICodec_FlateModule* pModule) {
+    m_pFlateModule.reset(pModule);
+  }
 
 #ifdef PDF_ENABLE_XFA
   ICodec_ProgressiveDecoder* CreateProgressiveDecoder();
@@ -139,6 +152,25 @@ class ICodec_ScanlineDecoder {
   virtual void ClearImageData() = 0;
 };
 
+// Incremental decoder for general (non-image) data. Callers push encoded
+// input with Input() whenever NeedsInput() says so, and pull decoded bytes
+// with ReadBlock() until IsEOF().
+class ICodec_StreamDecoder {
+ public:
+  virtual ~ICodec_StreamDecoder() {}
+
+  // |src_buf| must stay valid until NeedsInput() returns TRUE again.
+  virtual void Input(const uint8_t* src_buf, FX_DWORD src_size) = 0;
+
+  virtual FX_BOOL NeedsInput() = 0;
+
+  // Returns the number of bytes written to |dest_buf|, which is less than
+  // |dest_size| only when more input is needed or the end has been reached.
+  virtual FX_DWORD ReadBlock(uint8_t* dest_buf, FX_DWORD dest_size) = 0;
+
+  virtual FX_BOOL IsEOF() = 0;
+};
+
 class ICodec_FlateModule {
  public:
   virtual ~ICodec_FlateModule() {}
@@ -152,6 +184,7 @@ class ICodec_FlateModule {
                                                 int Colors,
                                                 int BitsPerComponent,
                                                 int Columns) = 0;
+  virtual ICodec_StreamDecoder* CreateStreamDecoder() = 0;
   virtual FX_DWORD FlateOrLZWDecode(FX_BOOL bLZW,
                                     const uint8_t* src_buf,
                                     FX_DWORD src_size,
@@ -175,6 +208,11 @@ class ICodec_FlateModule {
                          FX_DWORD src_size,
                          uint8_t*& dest_buf,
                          FX_DWORD& dest_size) = 0;
+  virtual FX_BOOL Encode(const uint8_t* src_buf,
+                         FX_DWORD src_size,
+                         int level,
+                         uint8_t*& dest_buf,
+                         FX_DWORD& dest_size) = 0;
 };
 class ICodec_FaxModule {
  public:
@@ -132,7 +132,6 @@ class CFX_WideTextBuf : public CFX_BinaryBuf {
 
   CFX_WideStringC GetWideString() const;
 };
-#ifdef PDF_ENABLE_XFA
 class CFX_ArchiveSaver {
  public:
   CFX_ArchiveSaver() : m_pStream(NULL) {}
@@ -195,7 +194,6 @@ class CFX_ArchiveLoader {
 
   FX_DWORD m_LoadingSize;
 };
-#endif  // PDF_ENABLE_XFA
 
 class IFX_BufferArchive {
  public:
@@ -20,21 +20,77 @@ void FXMEM_DefaultFree(void* pointer, int flags);
 }  // extern "C"
 
 #include <stdlib.h>
+#include <string.h>
 #include <limits>
 #include <new>
 
+// Debug builds fill memory from the Uninit allocators with this byte, so a
+// read before the first write shows up as a stable wrong value rather than
+// as whatever the heap had. Under MemorySanitizer the memory is left alone
+// for it to flag such reads itself.
+#if defined(_DEBUG) && !defined(MEMORY_SANITIZER)
+#define FX_UNINIT_FILL_BYTE 0xcd
+#endif
+
 NEVER_INLINE void FX_OutOfMemoryTerminate();
 
-inline void* FX_SafeRealloc(void* ptr, size_t num_members, size_t member_size) {
+// A heap to use in place of the C runtime's, for FX_Alloc() and friends as
+// well as the FXMEM_Default functions. Alloc must return memory aligned as
+// malloc() would; Realloc and Free are never passed NULL.
+struct FXMEM_Allocator {
+  void* (*Alloc)(void* user, size_t size);
+  void* (*Realloc)(void* user, void* ptr, size_t new_size);
+  void (*Free)(void* user, void* ptr);
+  void* user;
+};
+
+// Installs |pAllocator|, or the C runtime heap when NULL. With |bAccounting|
+// every block carries a small header so that it can be charged to the
+// CFX_MemoryBudget current on the allocating thread. Only valid while no
+// memory from the FX heap is live, i.e. around library init and teardown.
+void FXMEM_SetAllocator(const FXMEM_Allocator* pAllocator, bool bAccounting);
+bool FXMEM_IsAccounting();
+
+// Flags for FX_HeapAlloc() and FX_HeapRealloc().
+#define FX_HEAP_ZEROED 1
+// The caller copes with NULL, so a budget over its limit refuses the
+// request rather than let it through.
+#define FX_HEAP_MAY_FAIL 2
+
+// The FX heap itself; sizes are in bytes and already overflow checked.
+void* FX_HeapAlloc(size_t size, int flags);
+void* FX_HeapRealloc(void* ptr, size_t new_size, int flags);
+void FX_HeapFree(void* ptr);
+
+inline void* FX_SafeAlloc(size_t num_members, size_t member_size, int flags) {
+  if (num_members >= std::numeric_limits<size_t>::max() / member_size)
+    return nullptr;
+  return FX_HeapAlloc(num_members * member_size, flags);
+}
+
+inline void* FX_SafeRealloc(void* ptr,
+                            size_t num_members,
+                            size_t member_size,
+                            int flags = FX_HEAP_MAY_FAIL) {
   if (num_members < std::numeric_limits<size_t>::max() / member_size) {
-    return realloc(ptr, num_members * member_size);
+    return FX_HeapRealloc(ptr, num_members * member_size, flags);
   }
   return nullptr;
 }
 
+inline void* FX_SafeAllocUninit(size_t num_members,
+                                size_t member_size,
+                                int flags = FX_HEAP_MAY_FAIL) {
+  void* result = FX_SafeAlloc(num_members, member_size, flags);
+#ifdef FX_UNINIT_FILL_BYTE
+  if (result)
+    memset(result, FX_UNINIT_FILL_BYTE, num_members * member_size);
+#endif
+  return result;
+}
+
 inline void* FX_AllocOrDie(size_t num_members, size_t member_size) {
-  // TODO(tsepez): See if we can avoid the implicit memset(0).
-  if (void* result = calloc(num_members, member_size)) {
+  if (void* result = FX_SafeAlloc(num_members, member_size, FX_HEAP_ZEROED)) {
     return result;
   }
   FX_OutOfMemoryTerminate();  // Never returns.
@@ -49,10 +105,26 @@ inline void* FX_AllocOrDie2D(size_t w, size_t h, size_t member_size) {
   return nullptr;             // Suppress compiler warning.
 }
 
+inline void* FX_AllocUninitOrDie(size_t num_members, size_t member_size) {
+  if (void* result = FX_SafeAllocUninit(num_members, member_size, 0)) {
+    return result;
+  }
+  FX_OutOfMemoryTerminate();  // Never returns.
+  return nullptr;             // Suppress compiler warning.
+}
+
+inline void* FX_AllocUninitOrDie2D(size_t w, size_t h, size_t member_size) {
+  if (w < std::numeric_limits<size_t>::max() / h) {
+    return FX_AllocUninitOrDie(w * h, member_size);
+  }
+  FX_OutOfMemoryTerminate();  // Never returns.
+  return nullptr;             // Suppress compiler warning.
+}
+
 inline void* FX_ReallocOrDie(void* ptr,
                              size_t num_members,
                              size_t member_size) {
-  if (void* result = FX_SafeRealloc(ptr, num_members, member_size)) {
+  if (void* result = FX_SafeRealloc(ptr, num_members, member_size, 0)) {
     return result;
   }
   FX_OutOfMemoryTerminate();  // Never returns.
@@ -66,11 +138,21 @@ inline void* FX_ReallocOrDie(void* ptr,
   (type*) FX_ReallocOrDie(ptr, size, sizeof(type))
 
 // May return NULL.
-#define FX_TryAlloc(type, size) (type*) calloc(size, sizeof(type))
+#define FX_TryAlloc(type, size) \
+  (type*) FX_SafeAlloc(size, sizeof(type), FX_HEAP_ZEROED | FX_HEAP_MAY_FAIL)
 #define FX_TryRealloc(type, ptr, size) \
   (type*) FX_SafeRealloc(ptr, size, sizeof(type))
 
-#define FX_Free(ptr) free(ptr)
+// Like the above, but the memory is not zeroed. Only for buffers that are
+// written in full before they are read, such as decoder output.
+#define FX_AllocUninit(type, size) \
+  (type*) FX_AllocUninitOrDie(size, sizeof(type))
+#define FX_AllocUninit2D(type, w, h) \
+  (type*) FX_AllocUninitOrDie2D(w, h, sizeof(type))
+#define FX_TryAllocUninit(type, size) \
+  (type*) FX_SafeAllocUninit(size, sizeof(type))
+
+#define FX_Free(ptr) FX_HeapFree(ptr)
 
 class CFX_DestructObject {
  public:
@@ -0,0 +1,77 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_INCLUDE_FXCRT_FX_MEMORYBUDGET_H_
+#define CORE_INCLUDE_FXCRT_FX_MEMORYBUDGET_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+// Bytes of the FX heap charged to one owner, normally a document. Blocks
+// are charged to the budget current on the allocating thread, see Scope,
+// and credited back whenever and wherever they are freed. Only counts while
+// FXMEM_IsAccounting(); memory from operator new is never counted.
+//
+// Once usage passes the limit, requests that may fail are refused and the
+// rest still succeed, so callers find out through IsExceeded() and
+// Scope::HasFailed() and abandon the operation instead of dying.
+class CFX_MemoryBudget {
+ public:
+  // Makes the thread's allocations charged to |pBudget|, or to nobody when
+  // NULL, for the scope's lifetime.
+  class Scope {
+   public:
+    explicit Scope(CFX_MemoryBudget* pBudget);
+    ~Scope();
+
+    // TRUE when a request was refused since the scope began, or the budget
+    // is now over its limit.
+    bool HasFailed() const;
+
+   private:
+    CFX_MemoryBudget* const m_pBudget;
+    CFX_MemoryBudget* const m_pPrevious;
+    const size_t m_nRefusedAtStart;
+  };
+
+  static CFX_MemoryBudget* GetCurrent();
+
+  // A limit of 0 means none. The creator holds the only reference.
+  explicit CFX_MemoryBudget(size_t nLimit);
+
+  // Drops the creator's reference. The budget outlives it until the last
+  // block charged to it is freed.
+  void Release();
+
+  size_t GetUsage() const { return m_nUsage; }
+  size_t GetPeakUsage() const { return m_nPeakUsage; }
+  size_t GetLimit() const { return m_nLimit; }
+  void SetLimit(size_t nLimit) { m_nLimit = nLimit; }
+  bool IsExceeded() const {
+    size_t nLimit = m_nLimit;
+    return nLimit && m_nUsage > nLimit;
+  }
+
+  // For the FX heap. Charge() takes a reference for each block unless it
+  // refuses, which only happens with |bMayFail|.
+  bool Charge(size_t size, bool bMayFail);
+  void Credit(size_t size);
+  // Realloc in place of a block already charged here.
+  bool Resize(size_t old_size, size_t new_size, bool bMayFail);
+
+ private:
+  ~CFX_MemoryBudget() {}
+
+  void Unref();
+
+  std::atomic<size_t> m_nUsage;
+  std::atomic<size_t> m_nPeakUsage;
+  std::atomic<size_t> m_nLimit;
+  std::atomic<size_t> m_nRefused;
+  std::atomic<intptr_t> m_nRefs;
+};
+
+#endif  // CORE_INCLUDE_FXCRT_FX_MEMORYBUDGET_H_
@@ -19,6 +19,12 @@ FX_BOOL FX_GetNextFile(void* handle,
                        FX_BOOL& bFolder);
 void FX_CloseFolder(void* handle);
 FX_WCHAR FX_GetFolderSeparator();
+// Gets the last modification time, in seconds since the epoch, and the size
+// of the file or folder at |path|. Returns FALSE if it cannot be examined.
+FX_BOOL FX_GetFileStatus(const FX_CHAR* path, int64_t& mtime, int64_t& size);
+// Moves the file at |src| to |dest|, replacing any file there in one step.
+FX_BOOL FX_ReplaceFile(const FX_CHAR* src, const FX_CHAR* dest);
+FX_DWORD FX_GetCurrentProcessId();
 #if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
 #define FX_FILESIZE int32_t
 #else
@@ -116,6 +122,21 @@ class IFX_FileStream : public IFX_FileRead, public IFX_FileWrite {
 IFX_FileStream* FX_CreateFileStream(const FX_CHAR* filename, FX_DWORD dwModes);
 IFX_FileStream* FX_CreateFileStream(const FX_WCHAR* filename, FX_DWORD dwModes);
 
+// A read-only view of a whole file. The system shares its pages with every
+// other process mapping the same file instead of each keeping a copy.
+class IFX_MemoryMappedFile {
+ public:
+  virtual void Release() = 0;
+  virtual const uint8_t* GetData() const = 0;
+  virtual size_t GetSize() const = 0;
+
+ protected:
+  virtual ~IFX_MemoryMappedFile() {}
+};
+
+// Returns NULL if |filename| cannot be mapped, which includes empty files.
+IFX_MemoryMappedFile* FX_CreateMemoryMappedFile(const FX_CHAR* filename);
+
 #ifdef PDF_ENABLE_XFA
 class IFX_FileAccess {
  public:
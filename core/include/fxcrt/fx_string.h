@@ -9,6 +9,11 @@
 
 #include <stdint.h>  // For intptr_t.
 #include <algorithm>
+#include <vector>
+
+#ifdef PDF_ATOMIC_STRING_REFS
+#include <atomic>
+#endif
 
 #include "fx_memory.h"
 #include "fx_system.h"
@@ -16,6 +21,15 @@
 class CFX_BinaryBuf;
 class CFX_ByteString;
 class CFX_WideString;
+
+// With pdf_atomic_string_refs, copies of one string may be taken and
+// dropped on several threads at once, e.g. by render threads sharing a
+// parsed document. Writing to a string still needs it to be unshared.
+#ifdef PDF_ATOMIC_STRING_REFS
+typedef std::atomic<intptr_t> FX_STRINGREFS;
+#else
+typedef intptr_t FX_STRINGREFS;
+#endif
 struct CFX_CharMap;
 
 // An immutable string with caller-provided storage which must outlive the
@@ -316,7 +330,7 @@ class CFX_ByteString {
         FX_Free(this);
     }
 
-    intptr_t m_nRefs;  // Would prefer ssize_t, but no windows support.
+    FX_STRINGREFS m_nRefs;  // Would prefer ssize_t, but no windows support.
     FX_STRSIZE m_nDataLength;
     FX_STRSIZE m_nAllocLength;
     FX_CHAR m_String[1];
@@ -414,6 +428,29 @@ inline CFX_ByteString operator+(const CFX_ByteStringC& str1,
                                 const CFX_ByteString& str2) {
   return CFX_ByteString(str1, str2);
 }
+
+// Hands out one shared buffer per distinct short string, so that the names
+// and dictionary keys a parser meets again and again are allocated once.
+// Not thread safe; the strings it returns are ordinary copy-on-write ones.
+class CFX_ByteStringPool {
+ public:
+  // Longer strings are rarely repeated and are never pooled.
+  static const FX_STRSIZE kMaxLength = 32;
+
+  CFX_ByteStringPool();
+  ~CFX_ByteStringPool();
+
+  CFX_ByteString Intern(const CFX_ByteStringC& str);
+  size_t GetCount() const { return m_nCount; }
+
+ private:
+  void Grow();
+
+  // Open addressing with linear probing; empty strings are free slots.
+  std::vector<CFX_ByteString> m_Slots;
+  size_t m_nCount;
+};
+
 class CFX_WideStringC {
  public:
   typedef FX_WCHAR value_type;
@@ -697,7 +734,7 @@ class CFX_WideString {
         FX_Free(this);
     }
 
-    intptr_t m_nRefs;  // Would prefer ssize_t, but no windows support.
+    FX_STRINGREFS m_nRefs;  // Would prefer ssize_t, but no windows support.
     FX_STRSIZE m_nDataLength;
     FX_STRSIZE m_nAllocLength;
     FX_WCHAR m_String[1];
@@ -0,0 +1,44 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_INCLUDE_FXCRT_FX_THREADPOOL_H_
+#define CORE_INCLUDE_FXCRT_FX_THREADPOOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "core/include/fxcrt/fx_system.h"
+
+// A fixed set of worker threads running posted tasks in FIFO order. Tasks
+// must not touch document or parser state; callers prepare the inputs on
+// their own thread and only hand self-contained work to the pool.
+class CFX_ThreadPool {
+ public:
+  // Number of workers to use for CPU bound work; always at least 1.
+  static int GetDefaultThreadCount();
+
+  explicit CFX_ThreadPool(int nThreads);
+  // Runs any tasks still queued before joining the workers.
+  ~CFX_ThreadPool();
+
+  // The returned future becomes ready once |task| has run.
+  std::future<void> PostTask(std::function<void()> task);
+  int CountThreads() const { return (int)m_Threads.size(); }
+
+ private:
+  void WorkerMain();
+
+  std::mutex m_Mutex;
+  std::condition_variable m_Cond;
+  std::deque<std::packaged_task<void()>> m_Tasks;
+  std::vector<std::thread> m_Threads;
+  FX_BOOL m_bQuit;
+};
+
+#endif  // CORE_INCLUDE_FXCRT_FX_THREADPOOL_H_
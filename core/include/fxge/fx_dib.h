@@ -296,6 +296,10 @@ class CFX_DIBitmap : public CFX_DIBSource {
                  uint8_t* pBuffer = NULL,
                  int pitch = 0);
 
+  // Like Create(), but the pixels are not zeroed. For callers that Clear()
+  // the bitmap or otherwise write every row before reading any.
+  FX_BOOL CreateUninit(int width, int height, FXDIB_Format format);
+
   FX_BOOL Copy(const CFX_DIBSource* pSrc);
 
   // CFX_DIBSource
@@ -340,6 +344,11 @@ class CFX_DIBitmap : public CFX_DIBSource {
                          int src_top,
                          void* pIccTransform = NULL);
 
+  // Fills the bitmap with copies of |pTile| laid edge to edge, one of them
+  // with its top left corner at (|origin_x|, |origin_y|). The formats must
+  // match and have whole bytes per pixel.
+  FX_BOOL TileBitmap(const CFX_DIBitmap* pTile, int origin_x, int origin_y);
+
   FX_BOOL CompositeBitmap(int dest_left,
                           int dest_top,
                           int width,
@@ -397,6 +406,14 @@ class CFX_DIBitmap : public CFX_DIBSource {
   FX_BOOL m_bExtBuf;
 
   FX_BOOL GetGrayData(void* pIccTransform = NULL);
+
+ private:
+  FX_BOOL CreateBuffer(int width,
+                       int height,
+                       FXDIB_Format format,
+                       uint8_t* pBuffer,
+                       int pitch,
+                       FX_BOOL bZeroed);
 };
 class CFX_DIBExtractor {
  public:
@@ -16,7 +16,9 @@
 typedef struct FT_FaceRec_* FXFT_Face;
 typedef void* FXFT_Library;
 
+class CFX_EmbeddedFontDesc;
 class CFX_FaceCache;
+class CFX_FontCatalog;
 class CFX_FontFaceInfo;
 class CFX_FontMapper;
 class CFX_PathData;
@@ -24,6 +26,7 @@ class CFX_SizeGlyphCache;
 class CFX_SubstFont;
 class CTTFontDesc;
 class IFX_FontEncoding;
+class IFX_MemoryMappedFile;
 class IFX_SystemFontInfo;
 
 #define FXFONT_FIXED_PITCH 0x01
@@ -119,7 +122,6 @@ class CFX_Font {
 
   FXFT_Face m_Face;
   CFX_SubstFont* m_pSubstFont;
-  uint8_t* m_pFontDataAllocation;
   uint8_t* m_pFontData;
   uint8_t* m_pGsubData;
   FX_DWORD m_dwSize;
@@ -242,12 +244,15 @@ class CFX_FontMgr {
                           int weight,
                           FX_BOOL bItalic,
                           uint8_t*& pFontData);
+  // Takes |pData|, which |pFontFile| holds when not null and which is from
+  // FX_Alloc() otherwise. AddCachedTTCFace() does the same.
   FXFT_Face AddCachedFace(const CFX_ByteString& face_name,
                           int weight,
                           FX_BOOL bItalic,
                           uint8_t* pData,
                           FX_DWORD size,
-                          int face_index);
+                          int face_index,
+                          IFX_MemoryMappedFile* pFontFile);
   FXFT_Face GetCachedTTCFace(int ttc_size,
                              FX_DWORD checksum,
                              int font_offset,
@@ -256,10 +261,23 @@ class CFX_FontMgr {
                              FX_DWORD checksum,
                              uint8_t* pData,
                              FX_DWORD size,
-                             int font_offset);
+                             int font_offset,
+                             IFX_MemoryMappedFile* pFontFile);
   FXFT_Face GetFileFace(const FX_CHAR* filename, int face_index);
   FXFT_Face GetFixedFace(const uint8_t* pData, FX_DWORD size, int face_index);
   void ReleaseFace(FXFT_Face face);
+  // A face on the embedded font program in |pData|, shared with the fonts of
+  // other documents that embed the same bytes. |pFontData| receives the copy
+  // of the program the face reads, which stays valid until the face is given
+  // back with ReleaseEmbeddedFace().
+  FXFT_Face GetEmbeddedFace(const uint8_t* pData,
+                            FX_DWORD size,
+                            uint8_t*& pFontData);
+  void ReleaseEmbeddedFace(FXFT_Face face);
+  // Programs without faces in use are kept while their sizes add up to no
+  // more than |limit| bytes.
+  void SetEmbeddedFontCacheLimit(size_t limit);
+  size_t GetIdleEmbeddedFontSize() const { return m_IdleEmbeddedFontSize; }
   void SetSystemFontInfo(IFX_SystemFontInfo* pFontInfo);
   FXFT_Face FindSubstFont(const CFX_ByteString& face_name,
                           FX_BOOL bTrueType,
@@ -273,8 +291,18 @@ class CFX_FontMgr {
   FXFT_Library GetFTLibrary() const { return m_FTLibrary; }
 
  private:
+  void TrimEmbeddedFonts();
+  void DeleteEmbeddedFont(CFX_EmbeddedFontDesc* pDesc);
+
   std::unique_ptr<CFX_FontMapper> m_pBuiltinMapper;
   std::map<CFX_ByteString, CTTFontDesc*> m_FaceMap;
+  // Embedded font programs by the hash code of their bytes.
+  std::multimap<FX_DWORD, CFX_EmbeddedFontDesc*> m_EmbeddedFonts;
+  // The programs of the embedded faces lent to fonts.
+  std::map<FXFT_Face, CFX_EmbeddedFontDesc*> m_EmbeddedFaces;
+  size_t m_IdleEmbeddedFontSize;
+  size_t m_EmbeddedFontCacheLimit;
+  FX_DWORD m_EmbeddedFontUseCount;
   FXFT_Library m_FTLibrary;
 };
 
@@ -353,7 +381,10 @@ class CFX_FontMapper {
 
 class IFX_SystemFontInfo {
  public:
-  static IFX_SystemFontInfo* CreateDefault(const char** pUserPaths);
+  // |pCatalogPath|, if not null, names the file in which platforms that scan
+  // font folders keep what they found; see CFX_FolderFontInfo.
+  static IFX_SystemFontInfo* CreateDefault(const char** pUserPaths,
+                                           const char* pCatalogPath);
   virtual void Release() = 0;
 
   virtual FX_BOOL EnumFontList(CFX_FontMapper* pMapper) = 0;
@@ -381,6 +412,9 @@ class IFX_SystemFontInfo {
   virtual int GetFaceIndex(void* hFont) { return 0; }
   virtual void DeleteFont(void* hFont) = 0;
   virtual void* RetainFont(void* hFont) { return NULL; }
+  // Maps the file holding |hFont|, whose whole contents GetFontData() gives
+  // for table 0 or 'ttcf', or returns NULL to have them read instead.
+  virtual IFX_MemoryMappedFile* MapFontFile(void* hFont) { return NULL; }
 
  protected:
   virtual ~IFX_SystemFontInfo() {}
@@ -391,6 +425,9 @@ class CFX_FolderFontInfo : public IFX_SystemFontInfo {
   CFX_FolderFontInfo();
   ~CFX_FolderFontInfo() override;
   void AddPath(const CFX_ByteStringC& path);
+  // Keeps what EnumFontList() finds in the file at |path|, so that later
+  // scans only reopen the font folders and files that have changed.
+  void SetCatalogPath(const CFX_ByteStringC& path);
 
   // IFX_SytemFontInfo:
   void Release() override;
@@ -415,17 +452,18 @@ class CFX_FolderFontInfo : public IFX_SystemFontInfo {
   void DeleteFont(void* hFont) override;
   FX_BOOL GetFaceName(void* hFont, CFX_ByteString& name) override;
   FX_BOOL GetFontCharset(void* hFont, int& charset) override;
+  IFX_MemoryMappedFile* MapFontFile(void* hFont) override;
 
  protected:
   std::map<CFX_ByteString, CFX_FontFaceInfo*> m_FontList;
   CFX_ByteStringArray m_PathList;
+  CFX_ByteString m_CatalogPath;
   CFX_FontMapper* m_pMapper;
+  // Only set during EnumFontList().
+  CFX_FontCatalog* m_pCatalog;
   void ScanPath(CFX_ByteString& path);
   void ScanFile(CFX_ByteString& path);
-  void ReportFace(CFX_ByteString& path,
-                  FXSYS_FILE* pFile,
-                  FX_DWORD filesize,
-                  FX_DWORD offset);
+  void ReportFace(const CFX_FontFaceInfo& face);
   void* GetSubstFont(const CFX_ByteString& face);
   void* FindFont(int weight,
                  FX_BOOL bItalic,
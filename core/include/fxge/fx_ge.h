@@ -7,6 +7,8 @@
 #ifndef CORE_INCLUDE_FXGE_FX_GE_H_
 #define CORE_INCLUDE_FXGE_FX_GE_H_
 
+#include <vector>
+
 #include "fx_dib.h"
 #include "fx_font.h"
 
@@ -16,10 +18,12 @@ class CFX_FontCache;
 class CFX_FaceCache;
 class IFX_RenderDeviceDriver;
 class CCodec_ModuleMgr;
+class CFX_ThreadPool;
 
 class CFX_GEModule {
  public:
-  static void Create(const char** pUserFontPaths);
+  static void Create(const char** pUserFontPaths,
+                     const char* pFontCatalogPath);
 
   static void Use(CFX_GEModule* pMgr);
 
@@ -37,11 +41,18 @@ class CFX_GEModule {
     m_pCodecModule = pCodecModule;
   }
   CCodec_ModuleMgr* GetCodecModule() { return m_pCodecModule; }
+  // Shared by devices that rasterize large paths in parallel; created on
+  // first use.
+  CFX_ThreadPool* GetRasterThreadPool();
   FXFT_Library m_FTLibrary;
   void* GetPlatformData() { return m_pPlatformData; }
+  // The font catalog file given to Create(), or NULL.
+  const char* GetFontCatalogPath() const {
+    return m_FontCatalogPath.IsEmpty() ? nullptr : m_FontCatalogPath.c_str();
+  }
 
  protected:
-  explicit CFX_GEModule(const char** pUserFontPaths);
+  CFX_GEModule(const char** pUserFontPaths, const char* pFontCatalogPath);
 
   ~CFX_GEModule();
   void InitPlatform();
@@ -52,8 +63,10 @@ class CFX_GEModule {
   CFX_FontCache* m_pFontCache;
   CFX_FontMgr* m_pFontMgr;
   CCodec_ModuleMgr* m_pCodecModule;
+  CFX_ThreadPool* m_pRasterThreadPool;
   void* m_pPlatformData;
   const char** m_pUserFontPaths;
+  CFX_ByteString m_FontCatalogPath;
 };
 typedef struct {
   FX_FLOAT m_PointX;
@@ -71,6 +84,20 @@ typedef struct {
 #define FXFILL_WINDING 2
 class CFX_ClipRgn {
  public:
+  // A clip whose pixels are each either fully inside or fully outside,
+  // stored as runs so it can be combined and copied without a mask. Row y
+  // of a region with box |box| has the runs from m_RowStart[y - box.top] up
+  // to m_RowStart[y - box.top + 1] in m_Runs. Each run is a left and an
+  // exclusive right column; a row's runs are ascending and disjoint.
+  struct Spans {
+    std::vector<int> m_RowStart;
+    std::vector<int> m_Runs;
+    // The runs drawn into a mask, made on first use by GetMask() and shared
+    // by every region holding these spans.
+    mutable CFX_DIBitmapRef m_Mask;
+  };
+  typedef CFX_CountRef<Spans> SpansRef;
+
   CFX_ClipRgn(int device_width, int device_height);
 
   CFX_ClipRgn(const FX_RECT& rect);
@@ -79,6 +106,7 @@ class CFX_ClipRgn {
 
   ~CFX_ClipRgn();
 
+  // Regions holding spans report MaskF; GetMask() draws their mask on demand.
   typedef enum { RectI, MaskF } ClipType;
 
   void Reset(const FX_RECT& rect);
@@ -87,12 +115,17 @@ class CFX_ClipRgn {
 
   const FX_RECT& GetBox() const { return m_Box; }
 
-  CFX_DIBitmapRef GetMask() const { return m_Mask; }
+  CFX_DIBitmapRef GetMask() const;
+
+  FX_BOOL HasSpans() const { return m_Spans.NotNull(); }
 
   void IntersectRect(const FX_RECT& rect);
 
   void IntersectMaskF(int left, int top, CFX_DIBitmapRef Mask);
 
+  // |spans| holds one row for every row of |box|.
+  void IntersectSpans(const FX_RECT& box, SpansRef spans);
+
  protected:
   ClipType m_Type;
 
@@ -100,7 +133,13 @@ class CFX_ClipRgn {
 
   CFX_DIBitmapRef m_Mask;
 
+  SpansRef m_Spans;
+
   void IntersectMaskRect(FX_RECT rect, FX_RECT mask_box, CFX_DIBitmapRef Mask);
+  void CombineSpans(const FX_RECT& box, const Spans* pSpans);
+  void SetSpans(const FX_RECT& box,
+                const std::vector<int>& row_start,
+                const std::vector<int>& runs);
 };
 #define FX_GAMMA(value) (value)
 #define FX_GAMMA_INVERSE(value) (value)
@@ -274,6 +313,8 @@ class CFX_RenderDevice {
   CFX_DIBitmap* GetBitmap() const { return m_pBitmap; }
   void SetBitmap(CFX_DIBitmap* pBitmap) { m_pBitmap = pBitmap; }
 
+  // The format of bitmaps that GetDIBits() can fill from this device.
+  FXDIB_Format GetCompatibleFormat() const;
   FX_BOOL CreateCompatibleBitmap(CFX_DIBitmap* pDIB,
                                  int width,
                                  int height) const;
@@ -444,6 +485,10 @@ class CFX_FxgeDevice : public CFX_RenderDevice {
                  int dither_bits = 0,
                  CFX_DIBitmap* pOriDevice = NULL);
 
+  // Splits the scan conversion of large paths into row bands rendered on
+  // CFX_GEModule's raster thread pool. The output is unchanged.
+  void SetParallelRaster(FX_BOOL bParallel);
+
  protected:
   FX_BOOL m_bOwnedBitmap;
 };
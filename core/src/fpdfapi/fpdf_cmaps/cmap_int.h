@@ -29,4 +29,10 @@ void FPDFAPI_FindEmbeddedCMap(const char* name,
 FX_WORD FPDFAPI_CIDFromCharCode(const FXCMAP_CMap* pMap, FX_DWORD charcode);
 FX_DWORD FPDFAPI_CharCodeFromCID(const FXCMAP_CMap* pMap, FX_WORD cid);
 
+// Expands the one and two byte codes of |pMap| and the maps it uses into 256
+// pages of 256 CIDs, indexed by the high and the low byte of the code. Pages
+// without any mapped code stay NULL. Free with FPDFAPI_FreeCIDPages().
+FX_WORD** FPDFAPI_LoadCIDPages(const FXCMAP_CMap* pMap);
+void FPDFAPI_FreeCIDPages(FX_WORD** pPages);
+
 #endif  // CORE_SRC_FPDFAPI_FPDF_CMAPS_CMAP_INT_H_
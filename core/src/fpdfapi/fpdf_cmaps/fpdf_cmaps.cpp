@@ -128,6 +128,56 @@ FX_WORD FPDFAPI_CIDFromCharCode(const FXCMAP_CMap* pMap, FX_DWORD charcode) {
   }
   return 0;
 }
+static void SetCIDPageEntry(FX_WORD** pPages, FX_WORD code, FX_WORD cid) {
+  FX_WORD*& pPage = pPages[code >> 8];
+  if (!pPage) {
+    if (!cid) {
+      return;
+    }
+    pPage = FX_Alloc(FX_WORD, 256);
+  }
+  pPage[code & 0xff] = cid;
+}
+// Fills the maps this one uses first, so that entries of earlier maps in the
+// chain replace theirs, the same way FPDFAPI_CIDFromCharCode() finds them.
+static void FillCIDPages(const FXCMAP_CMap* pMap, FX_WORD** pPages) {
+  if (!pMap->m_pWordMap) {
+    return;
+  }
+  if (pMap->m_UseOffset) {
+    FillCIDPages(pMap + pMap->m_UseOffset, pPages);
+  }
+  if (pMap->m_WordMapType == FXCMAP_CMap::Single) {
+    const FX_WORD* pCur = pMap->m_pWordMap;
+    const FX_WORD* pEnd = pMap->m_pWordMap + pMap->m_WordCount * 2;
+    for (; pCur < pEnd; pCur += 2) {
+      SetCIDPageEntry(pPages, pCur[0], pCur[1]);
+    }
+  } else if (pMap->m_WordMapType == FXCMAP_CMap::Range) {
+    const FX_WORD* pCur = pMap->m_pWordMap;
+    const FX_WORD* pEnd = pMap->m_pWordMap + pMap->m_WordCount * 3;
+    for (; pCur < pEnd; pCur += 3) {
+      for (FX_DWORD code = pCur[0]; code <= pCur[1]; code++) {
+        SetCIDPageEntry(pPages, (FX_WORD)code,
+                        (FX_WORD)(pCur[2] + code - pCur[0]));
+      }
+    }
+  }
+}
+FX_WORD** FPDFAPI_LoadCIDPages(const FXCMAP_CMap* pMap) {
+  FX_WORD** pPages = FX_Alloc(FX_WORD*, 256);
+  FillCIDPages(pMap, pPages);
+  return pPages;
+}
+void FPDFAPI_FreeCIDPages(FX_WORD** pPages) {
+  if (!pPages) {
+    return;
+  }
+  for (int i = 0; i < 256; i++) {
+    FX_Free(pPages[i]);
+  }
+  FX_Free(pPages);
+}
 FX_DWORD FPDFAPI_CharCodeFromCID(const FXCMAP_CMap* pMap, FX_WORD cid) {
   while (1) {
     if (pMap->m_WordMapType == FXCMAP_CMap::Single) {
@@ -7,14 +7,20 @@
 #ifndef CORE_SRC_FPDFAPI_FPDF_EDIT_EDITINT_H_
 #define CORE_SRC_FPDFAPI_FPDF_EDIT_EDITINT_H_
 
+#include <map>
+#include <memory>
+#include <set>
 #include <vector>
 
 #include "core/include/fxcrt/fx_basic.h"
 #include "core/include/fxcrt/fx_stream.h"
 #include "core/include/fxcrt/fx_system.h"
+#include "core/include/fxcrt/fx_threadpool.h"
 
 class CPDF_Creator;
+class CPDF_Document;
 class CPDF_Object;
+class CPDF_Stream;
 
 class CPDF_ObjectStream {
  public:
@@ -22,7 +28,12 @@ class CPDF_ObjectStream {
 
   FX_BOOL Start();
 
-  int32_t CompressIndirectObject(FX_DWORD dwObjNum, const CPDF_Object* pObj);
+  // References are written through |objnum_map|; see
+  // CPDF_Creator::m_ObjNumMap.
+  int32_t CompressIndirectObject(
+      FX_DWORD dwObjNum,
+      const CPDF_Object* pObj,
+      const std::map<FX_DWORD, FX_DWORD>& objnum_map);
   int32_t CompressIndirectObject(FX_DWORD dwObjNum,
                                  const uint8_t* pBuffer,
                                  FX_DWORD dwSize);
@@ -71,4 +82,64 @@ class CPDF_XRefStream {
   CFX_ByteTextBuf m_Buffer;
 };
 
+
+// Deflates stream data on worker threads ahead of the sequential writer.
+// Stream data is loaded on the posting thread; workers only run FlateEncode.
+class CPDF_FlateEncodeQueue {
+ public:
+  CPDF_FlateEncodeQueue(int nThreads, int level);
+  ~CPDF_FlateEncodeQueue();
+
+  void Post(const CPDF_Stream* pStream);
+  FX_BOOL IsPosted(const CPDF_Stream* pStream) const;
+  FX_BOOL IsFull() const;
+
+  // Waits for the job of |pStream| and hands over its encoded data, which the
+  // caller must FX_Free(). Returns FALSE if |pStream| was never posted.
+  FX_BOOL Take(const CPDF_Stream* pStream, uint8_t*& pData, FX_DWORD& dwSize);
+
+ protected:
+  struct Job;
+
+  CFX_ThreadPool m_Pool;
+  const int m_Level;
+  std::map<const CPDF_Stream*, std::unique_ptr<Job>> m_Jobs;
+  FX_DWORD m_dwPendingSize;
+};
+
+// Finds indirect objects with equal structural values, picks one copy of each
+// to keep and reports the others as duplicates. Stream data is compared by
+// its SHA-256 digest. The document's objects are not modified; the writer
+// renumbers references to duplicates through GetObjNumMap().
+class CPDF_ObjectDeduplicator {
+ public:
+  explicit CPDF_ObjectDeduplicator(CPDF_Document* pDoc);
+  ~CPDF_ObjectDeduplicator();
+
+  // |pObj| is never dropped in favour of an equal object.
+  void Pin(const CPDF_Object* pObj);
+  // Loads all objects of the document and returns the number of duplicates.
+  FX_DWORD Run();
+
+  FX_BOOL IsDuplicate(FX_DWORD objnum) const;
+  FX_DWORD CountDuplicates() const { return (FX_DWORD)m_Canonical.size(); }
+  // Maps each duplicate to the object number of the copy that is kept.
+  void GetObjNumMap(std::map<FX_DWORD, FX_DWORD>* pMap) const;
+  // Approximate size of the dropped object bodies.
+  FX_FILESIZE GetDuplicateSize() const { return m_DuplicateSize; }
+
+ protected:
+  FX_DWORD GetCanonical(FX_DWORD objnum) const;
+  void PinInlineObjects(const CPDF_Object* pObj);
+  void AppendKey(const CPDF_Object* pObj, CFX_ByteTextBuf& key) const;
+  void AppendValueKey(const CPDF_Object* pObj, CFX_ByteTextBuf& key) const;
+  FX_FILESIZE GetSerializedSize(const CPDF_Object* pObj) const;
+
+  CPDF_Document* const m_pDocument;
+  std::set<FX_DWORD> m_Pinned;
+  std::map<FX_DWORD, FX_DWORD> m_Canonical;
+  std::map<FX_DWORD, CFX_ByteString> m_StreamDigests;
+  FX_FILESIZE m_DuplicateSize;
+};
+
 #endif  // CORE_SRC_FPDFAPI_FPDF_EDIT_EDITINT_H_
@@ -6,8 +6,11 @@
 
 #include "core/src/fpdfapi/fpdf_edit/editint.h"
 
+#include <algorithm>
+#include <map>
 #include <vector>
 
+#include "core/include/fxcodec/fx_codec.h"
 #include "core/include/fxcrt/fx_ext.h"
 #include "core/include/fpdfapi/fpdf_serial.h"
 #include "core/include/fpdfapi/fpdf_parser.h"
@@ -15,14 +18,28 @@
 
 #define PDF_OBJECTSTREAM_MAXLENGTH (256 * 1024)
 #define PDF_XREFSTREAM_MAXSIZE 10000
+#define PDF_FLATEQUEUE_JOBS_PER_THREAD 4
+#define PDF_FLATEQUEUE_MAXPENDINGSIZE (32 * 1024 * 1024)
 
 // TODO(ochang): Make helper for appending "objnum 0 R ".
 
 namespace {
 
-int32_t PDF_CreatorAppendObject(const CPDF_Object* pObj,
-                                CFX_FileBufferArchive* pFile,
-                                FX_FILESIZE& offset) {
+FX_DWORD MapObjNum(const std::map<FX_DWORD, FX_DWORD>* pObjNumMap,
+                   FX_DWORD objnum) {
+  if (pObjNumMap) {
+    auto it = pObjNumMap->find(objnum);
+    if (it != pObjNumMap->end())
+      return it->second;
+  }
+  return objnum;
+}
+
+int32_t PDF_CreatorAppendObject(
+    const CPDF_Object* pObj,
+    CFX_FileBufferArchive* pFile,
+    FX_FILESIZE& offset,
+    const std::map<FX_DWORD, FX_DWORD>* pObjNumMap = nullptr) {
   int32_t len = 0;
   if (!pObj) {
     if (pFile->AppendString(" null") < 0) {
@@ -71,8 +88,10 @@ int32_t PDF_CreatorAppendObject(const CPDF_Object* pObj,
     case CPDF_Object::REFERENCE: {
       if (pFile->AppendString(" ") < 0)
         return -1;
-      if ((len = pFile->AppendDWord(pObj->AsReference()->GetRefObjNum())) < 0)
+      if ((len = pFile->AppendDWord(MapObjNum(
+               pObjNumMap, pObj->AsReference()->GetRefObjNum()))) < 0) {
         return -1;
+      }
       if (pFile->AppendString(" 0 R ") < 0)
         return -1;
       offset += len + 6;
@@ -98,7 +117,8 @@ int32_t PDF_CreatorAppendObject(const CPDF_Object* pObj,
           }
           offset += len + 5;
         } else {
-          if (PDF_CreatorAppendObject(pElement, pFile, offset) < 0) {
+          if (PDF_CreatorAppendObject(pElement, pFile, offset, pObjNumMap) <
+              0) {
             return -1;
           }
         }
@@ -137,9 +157,8 @@ int32_t PDF_CreatorAppendObject(const CPDF_Object* pObj,
           }
           offset += len + 5;
         } else {
-          if (PDF_CreatorAppendObject(pValue, pFile, offset) < 0) {
+          if (PDF_CreatorAppendObject(pValue, pFile, offset, pObjNumMap) < 0)
             return -1;
-          }
         }
       }
       if (pFile->AppendString(">>") < 0) {
@@ -150,7 +169,8 @@ int32_t PDF_CreatorAppendObject(const CPDF_Object* pObj,
     }
     case CPDF_Object::STREAM: {
       const CPDF_Stream* p = pObj->AsStream();
-      if (PDF_CreatorAppendObject(p->GetDict(), pFile, offset) < 0) {
+      if (PDF_CreatorAppendObject(p->GetDict(), pFile, offset, pObjNumMap) <
+          0) {
         return -1;
       }
       if (pFile->AppendString("stream\r\n") < 0) {
@@ -176,6 +196,54 @@ int32_t PDF_CreatorAppendObject(const CPDF_Object* pObj,
   return 1;
 }
 
+// Appends |pObj| as operator<< does, with references renumbered through
+// |objnum_map|.
+void PDF_CreatorAppendObjectToBuf(
+    CFX_ByteTextBuf& buf,
+    const CPDF_Object* pObj,
+    const std::map<FX_DWORD, FX_DWORD>& objnum_map) {
+  if (!pObj) {
+    buf << pObj;
+    return;
+  }
+  switch (pObj->GetType()) {
+    case CPDF_Object::REFERENCE:
+      buf << " "
+          << MapObjNum(&objnum_map, pObj->AsReference()->GetRefObjNum())
+          << " 0 R ";
+      break;
+    case CPDF_Object::ARRAY: {
+      const CPDF_Array* p = pObj->AsArray();
+      buf << "[";
+      for (FX_DWORD i = 0; i < p->GetCount(); i++) {
+        CPDF_Object* pElement = p->GetElement(i);
+        if (pElement->GetObjNum())
+          buf << " " << pElement->GetObjNum() << " 0 R";
+        else
+          PDF_CreatorAppendObjectToBuf(buf, pElement, objnum_map);
+      }
+      buf << "]";
+      break;
+    }
+    case CPDF_Object::DICTIONARY: {
+      buf << "<<";
+      for (const auto& it : *pObj->AsDictionary()) {
+        CPDF_Object* pValue = it.second;
+        buf << "/" << PDF_NameEncode(it.first);
+        if (pValue && pValue->GetObjNum())
+          buf << " " << pValue->GetObjNum() << " 0 R ";
+        else
+          PDF_CreatorAppendObjectToBuf(buf, pValue, objnum_map);
+      }
+      buf << ">>";
+      break;
+    }
+    default:
+      buf << pObj;
+      break;
+  }
+}
+
 int32_t PDF_CreatorWriteTrailer(CPDF_Document* pDocument,
                                 CFX_FileBufferArchive* pFile,
                                 CPDF_Array* pIDArray,
@@ -376,9 +444,13 @@ int32_t OutputIndex(CFX_FileBufferArchive* pFile, FX_FILESIZE offset) {
 
 class CPDF_FlateEncoder {
  public:
-  CPDF_FlateEncoder();
+  explicit CPDF_FlateEncoder(int level = FXCODEC_FLATE_LEVEL_DEFAULT);
   ~CPDF_FlateEncoder();
   FX_BOOL Initialize(CPDF_Stream* pStream, FX_BOOL bFlateEncode);
+  // Takes ownership of |pEncoded|, the already deflated data of |pStream|.
+  FX_BOOL Initialize(CPDF_Stream* pStream,
+                     uint8_t* pEncoded,
+                     FX_DWORD dwEncodedSize);
   FX_BOOL Initialize(const uint8_t* pBuffer,
                      FX_DWORD size,
                      FX_BOOL bFlateEncode,
@@ -389,9 +461,10 @@ class CPDF_FlateEncoder {
   CPDF_Dictionary* m_pDict;
   FX_BOOL m_bCloned;
   FX_BOOL m_bNewData;
+  int m_Level;
   CPDF_StreamAcc m_Acc;
 };
-CPDF_FlateEncoder::CPDF_FlateEncoder() {
+CPDF_FlateEncoder::CPDF_FlateEncoder(int level) : m_Level(level) {
   m_pData = NULL;
   m_dwSize = 0;
   m_pDict = NULL;
@@ -427,11 +500,19 @@ FX_BOOL CPDF_FlateEncoder::Initialize(CPDF_Stream* pStream,
     }
     return TRUE;
   }
-  m_pData = NULL;
-  m_dwSize = 0;
+  uint8_t* pEncoded = NULL;
+  FX_DWORD dwEncodedSize = 0;
+  ::FlateEncode(m_Acc.GetData(), m_Acc.GetSize(), m_Level, pEncoded,
+                dwEncodedSize);
+  return Initialize(pStream, pEncoded, dwEncodedSize);
+}
+FX_BOOL CPDF_FlateEncoder::Initialize(CPDF_Stream* pStream,
+                                      uint8_t* pEncoded,
+                                      FX_DWORD dwEncodedSize) {
+  m_pData = pEncoded;
+  m_dwSize = dwEncodedSize;
   m_bNewData = TRUE;
   m_bCloned = TRUE;
-  ::FlateEncode(m_Acc.GetData(), m_Acc.GetSize(), m_pData, m_dwSize);
   m_pDict = ToDictionary(pStream->GetDict()->Clone());
   m_pDict->SetAtInteger("Length", m_dwSize);
   m_pDict->SetAtName("Filter", "FlateDecode");
@@ -451,7 +532,7 @@ FX_BOOL CPDF_FlateEncoder::Initialize(const uint8_t* pBuffer,
   if (bXRefStream) {
     ::FlateEncode(pBuffer, size, 12, 1, 8, 7, m_pData, m_dwSize);
   } else {
-    ::FlateEncode(pBuffer, size, m_pData, m_dwSize);
+    ::FlateEncode(pBuffer, size, m_Level, m_pData, m_dwSize);
   }
   return TRUE;
 }
@@ -507,6 +588,59 @@ CPDF_Encryptor::~CPDF_Encryptor() {
 
 }  // namespace
 
+struct CPDF_FlateEncodeQueue::Job {
+  CPDF_StreamAcc m_Acc;
+  uint8_t* m_pData;
+  FX_DWORD m_dwSize;
+  std::future<void> m_Done;
+};
+CPDF_FlateEncodeQueue::CPDF_FlateEncodeQueue(int nThreads, int level)
+    : m_Pool(nThreads), m_Level(level), m_dwPendingSize(0) {}
+CPDF_FlateEncodeQueue::~CPDF_FlateEncodeQueue() {
+  for (const auto& it : m_Jobs) {
+    it.second->m_Done.wait();
+    FX_Free(it.second->m_pData);
+  }
+}
+void CPDF_FlateEncodeQueue::Post(const CPDF_Stream* pStream) {
+  if (IsPosted(pStream))
+    return;
+  std::unique_ptr<Job> pJob(new Job);
+  pJob->m_Acc.LoadAllData(pStream, TRUE);
+  pJob->m_pData = NULL;
+  pJob->m_dwSize = 0;
+  Job* pRawJob = pJob.get();
+  int level = m_Level;
+  pJob->m_Done = m_Pool.PostTask([pRawJob, level]() {
+    ::FlateEncode(pRawJob->m_Acc.GetData(), pRawJob->m_Acc.GetSize(), level,
+                  pRawJob->m_pData, pRawJob->m_dwSize);
+  });
+  m_dwPendingSize += pJob->m_Acc.GetSize();
+  m_Jobs[pStream] = std::move(pJob);
+}
+FX_BOOL CPDF_FlateEncodeQueue::IsPosted(const CPDF_Stream* pStream) const {
+  return pdfium::ContainsKey(m_Jobs, pStream);
+}
+FX_BOOL CPDF_FlateEncodeQueue::IsFull() const {
+  return m_Jobs.size() >= (size_t)m_Pool.CountThreads() *
+                              PDF_FLATEQUEUE_JOBS_PER_THREAD ||
+         m_dwPendingSize >= PDF_FLATEQUEUE_MAXPENDINGSIZE;
+}
+FX_BOOL CPDF_FlateEncodeQueue::Take(const CPDF_Stream* pStream,
+                                    uint8_t*& pData,
+                                    FX_DWORD& dwSize) {
+  auto it = m_Jobs.find(pStream);
+  if (it == m_Jobs.end())
+    return FALSE;
+  Job* pJob = it->second.get();
+  pJob->m_Done.wait();
+  pData = pJob->m_pData;
+  dwSize = pJob->m_dwSize;
+  m_dwPendingSize -= pJob->m_Acc.GetSize();
+  m_Jobs.erase(it);
+  return TRUE;
+}
+
 CPDF_ObjectStream::CPDF_ObjectStream() : m_dwObjNum(0), m_index(0) {}
 FX_BOOL CPDF_ObjectStream::Start() {
   m_ObjNumArray.RemoveAll();
@@ -516,11 +650,13 @@ FX_BOOL CPDF_ObjectStream::Start() {
   m_index = 0;
   return TRUE;
 }
-int32_t CPDF_ObjectStream::CompressIndirectObject(FX_DWORD dwObjNum,
-                                                  const CPDF_Object* pObj) {
+int32_t CPDF_ObjectStream::CompressIndirectObject(
+    FX_DWORD dwObjNum,
+    const CPDF_Object* pObj,
+    const std::map<FX_DWORD, FX_DWORD>& objnum_map) {
   m_ObjNumArray.Add(dwObjNum);
   m_OffsetArray.Add(m_Buffer.GetLength());
-  m_Buffer << pObj;
+  PDF_CreatorAppendObjectToBuf(m_Buffer, pObj, objnum_map);
   return 1;
 }
 int32_t CPDF_ObjectStream::CompressIndirectObject(FX_DWORD dwObjNum,
@@ -591,7 +727,7 @@ FX_FILESIZE CPDF_ObjectStream::End(CPDF_Creator* pCreator) {
     offset += len + tempBuffer.GetLength() + m_Buffer.GetLength();
   } else {
     tempBuffer << m_Buffer;
-    CPDF_FlateEncoder encoder;
+    CPDF_FlateEncoder encoder(pCreator->m_CompressionLevel);
     encoder.Initialize(tempBuffer.GetBuffer(), tempBuffer.GetLength(),
                        pCreator->m_bCompress);
     CPDF_Encryptor encryptor;
@@ -635,7 +771,7 @@ int32_t CPDF_XRefStream::CompressIndirectObject(FX_DWORD dwObjNum,
   if (!pCreator) {
     return 0;
   }
-  m_ObjStream.CompressIndirectObject(dwObjNum, pObj);
+  m_ObjStream.CompressIndirectObject(dwObjNum, pObj, pCreator->m_ObjNumMap);
   if (m_ObjStream.m_ObjNumArray.GetSize() < pCreator->m_ObjectStreamSize &&
       m_ObjStream.m_Buffer.GetLength() < PDF_OBJECTSTREAM_MAXLENGTH) {
     return 1;
@@ -924,6 +1060,10 @@ CPDF_Creator::CPDF_Creator(CPDF_Document* pDoc) {
   m_FileVersion = 0;
   m_dwEnryptObjNum = 0;
   m_bNewCrypto = FALSE;
+  m_PostPos = 0;
+  m_dwDuplicateCount = 0;
+  m_DuplicateSize = 0;
+  m_CompressionLevel = FXCODEC_FLATE_LEVEL_DEFAULT;
 }
 CPDF_Creator::~CPDF_Creator() {
   ResetStandardSecurity();
@@ -1014,9 +1154,17 @@ int32_t CPDF_Creator::AppendObjectNumberToXRef(FX_DWORD objnum) {
 int32_t CPDF_Creator::WriteStream(const CPDF_Object* pStream,
                                   FX_DWORD objnum,
                                   CPDF_CryptoHandler* pCrypto) {
-  CPDF_FlateEncoder encoder;
-  encoder.Initialize(const_cast<CPDF_Stream*>(pStream->AsStream()),
-                     pStream == m_pMetadata ? FALSE : m_bCompress);
+  CPDF_Stream* pStreamObj = const_cast<CPDF_Stream*>(pStream->AsStream());
+  CPDF_FlateEncoder encoder(m_CompressionLevel);
+  uint8_t* pEncoded = NULL;
+  FX_DWORD dwEncodedSize = 0;
+  if (m_pFlateQueue &&
+      m_pFlateQueue->Take(pStreamObj, pEncoded, dwEncodedSize)) {
+    encoder.Initialize(pStreamObj, pEncoded, dwEncodedSize);
+  } else {
+    encoder.Initialize(pStreamObj,
+                       pStream == m_pMetadata ? FALSE : m_bCompress);
+  }
   CPDF_Encryptor encryptor;
   if (!encryptor.Initialize(pCrypto, objnum, encoder.m_pData,
                             encoder.m_dwSize)) {
@@ -1132,7 +1280,7 @@ int32_t CPDF_Creator::WriteDirectObj(FX_DWORD objnum,
       break;
     }
     case CPDF_Object::STREAM: {
-      CPDF_FlateEncoder encoder;
+      CPDF_FlateEncoder encoder(m_CompressionLevel);
       encoder.Initialize(const_cast<CPDF_Stream*>(pObj->AsStream()),
                          m_bCompress);
       CPDF_Encryptor encryptor;
@@ -1174,8 +1322,10 @@ int32_t CPDF_Creator::WriteDirectObj(FX_DWORD objnum,
     case CPDF_Object::REFERENCE: {
       if (m_File.AppendString(" ") < 0)
         return -1;
-      if ((len = m_File.AppendDWord(pObj->AsReference()->GetRefObjNum())) < 0)
+      if ((len = m_File.AppendDWord(MapObjNum(
+               &m_ObjNumMap, pObj->AsReference()->GetRefObjNum()))) < 0) {
         return -1;
+      }
       if (m_File.AppendString(" 0 R") < 0)
         return -1;
       m_Offset += len + 5;
@@ -1214,7 +1364,7 @@ int32_t CPDF_Creator::WriteDirectObj(FX_DWORD objnum,
     }
     case CPDF_Object::DICTIONARY: {
       if (!m_pCryptoHandler || pObj == m_pEncryptDict) {
-        return PDF_CreatorAppendObject(pObj, &m_File, m_Offset);
+        return PDF_CreatorAppendObject(pObj, &m_File, m_Offset, &m_ObjNumMap);
       }
       if (m_File.AppendString("<<") < 0) {
         return -1;
@@ -1265,14 +1415,17 @@ int32_t CPDF_Creator::WriteDirectObj(FX_DWORD objnum,
 int32_t CPDF_Creator::WriteOldIndirectObject(FX_DWORD objnum) {
   if (m_pParser->IsObjectFreeOrNull(objnum))
     return 0;
+  if (m_pDeduplicator && m_pDeduplicator->IsDuplicate(objnum))
+    return 0;
 
   m_ObjectOffset[objnum] = m_Offset;
   FX_BOOL bExistInMap =
       pdfium::ContainsKey(m_pDocument->m_IndirectObjs, objnum);
   const uint8_t object_type = m_pParser->GetObjectType(objnum);
   FX_BOOL bObjStm = (object_type == 2) && m_pEncryptDict && !m_pXRefStream;
+  // The original bytes may refer to duplicates, which must be renumbered.
   if (m_pParser->IsVersionUpdated() || m_bSecurityChanged || bExistInMap ||
-      bObjStm) {
+      bObjStm || !m_ObjNumMap.empty()) {
     CPDF_Object* pObj = m_pDocument->GetIndirectObject(objnum);
     if (!pObj) {
       m_ObjectOffset[objnum] = 0;
@@ -1335,6 +1488,8 @@ int32_t CPDF_Creator::WriteOldObjs(IFX_Pause* pPause) {
 
   FX_DWORD objnum = (FX_DWORD)(uintptr_t)m_Pos;
   for (; objnum <= nLastObjNum; ++objnum) {
+    if (m_pFlateQueue)
+      PostOldObjs(objnum, nLastObjNum);
     int32_t iRet = WriteOldIndirectObject(objnum);
     if (iRet < 0)
       return iRet;
@@ -1353,9 +1508,12 @@ int32_t CPDF_Creator::WriteNewObjs(FX_BOOL bIncremental, IFX_Pause* pPause) {
   int32_t iCount = m_NewObjNumArray.GetSize();
   int32_t index = (int32_t)(uintptr_t)m_Pos;
   while (index < iCount) {
+    if (m_pFlateQueue)
+      PostNewObjs(index);
     FX_DWORD objnum = m_NewObjNumArray.ElementAt(index);
     auto it = m_pDocument->m_IndirectObjs.find(objnum);
-    if (it == m_pDocument->m_IndirectObjs.end()) {
+    if (it == m_pDocument->m_IndirectObjs.end() ||
+        (m_pDeduplicator && m_pDeduplicator->IsDuplicate(objnum))) {
       ++index;
       continue;
     }
@@ -1371,6 +1529,44 @@ int32_t CPDF_Creator::WriteNewObjs(FX_BOOL bIncremental, IFX_Pause* pPause) {
   }
   return 0;
 }
+FX_BOOL CPDF_Creator::IsFlateCandidate(const CPDF_Object* pObj) const {
+  const CPDF_Stream* pStream = pObj ? pObj->AsStream() : nullptr;
+  if (!pStream || !m_bCompress || pObj == m_pMetadata)
+    return FALSE;
+  if (m_pDeduplicator && m_pDeduplicator->IsDuplicate(pObj->GetObjNum()))
+    return FALSE;
+  CPDF_Dictionary* pDict = pStream->GetDict();
+  if (!pDict || pDict->KeyExist("Filter"))
+    return FALSE;
+  return !m_pXRefStream || pDict->GetStringBy("Type") != "XRef";
+}
+void CPDF_Creator::PostOldObjs(FX_DWORD objnum, FX_DWORD nLastObjNum) {
+  // Only objects that are already loaded are looked at. Loading others here
+  // would change how WriteOldIndirectObject() copies them.
+  const auto& objs = m_pDocument->m_IndirectObjs;
+  auto it = objs.lower_bound(std::max(objnum, m_PostPos));
+  for (; it != objs.end() && it->first <= nLastObjNum; ++it) {
+    if (m_pFlateQueue->IsFull())
+      break;
+    if (!m_pParser->IsObjectFreeOrNull(it->first) &&
+        IsFlateCandidate(it->second)) {
+      m_pFlateQueue->Post(it->second->AsStream());
+    }
+    m_PostPos = it->first + 1;
+  }
+}
+void CPDF_Creator::PostNewObjs(int32_t index) {
+  int32_t iCount = m_NewObjNumArray.GetSize();
+  int32_t i = std::max(index, (int32_t)m_PostPos);
+  for (; i < iCount && !m_pFlateQueue->IsFull(); ++i) {
+    auto it = m_pDocument->m_IndirectObjs.find(m_NewObjNumArray.ElementAt(i));
+    if (it != m_pDocument->m_IndirectObjs.end() &&
+        IsFlateCandidate(it->second)) {
+      m_pFlateQueue->Post(it->second->AsStream());
+    }
+  }
+  m_PostPos = i;
+}
 void CPDF_Creator::InitOldObjNumOffsets() {
   if (!m_pParser) {
     return;
@@ -1483,6 +1679,21 @@ int32_t CPDF_Creator::WriteDoc_Stage1(IFX_Pause* pPause) {
     }
     CPDF_Dictionary* pDict = m_pDocument->GetRoot();
     m_pMetadata = pDict ? pDict->GetElementValue("Metadata") : NULL;
+    if ((m_dwFlags & FPDFCREATE_DEDUPLICATE) &&
+        (m_dwFlags & FPDFCREATE_INCREMENTAL) == 0) {
+      m_pDeduplicator.reset(new CPDF_ObjectDeduplicator(m_pDocument));
+      m_pDeduplicator->Pin(m_pEncryptDict);
+      m_pDeduplicator->Pin(m_pMetadata);
+      m_pDeduplicator->Run();
+      m_pDeduplicator->GetObjNumMap(&m_ObjNumMap);
+      m_dwDuplicateCount = m_pDeduplicator->CountDuplicates();
+      m_DuplicateSize = m_pDeduplicator->GetDuplicateSize();
+    }
+    if (m_dwFlags & FPDFCREATE_PARALLEL_COMPRESS) {
+      m_pFlateQueue.reset(
+          new CPDF_FlateEncodeQueue(CFX_ThreadPool::GetDefaultThreadCount(),
+                                    m_CompressionLevel));
+    }
     if (m_dwFlags & FPDFCREATE_OBJECTSTREAM) {
       m_pXRefStream = new CPDF_XRefStream;
       m_pXRefStream->Start();
@@ -1572,6 +1783,7 @@ int32_t CPDF_Creator::WriteDoc_Stage2(IFX_Pause* pPause) {
   if (m_iStage == 20) {
     if ((m_dwFlags & FPDFCREATE_INCREMENTAL) == 0 && m_pParser) {
       m_Pos = (void*)(uintptr_t)0;
+      m_PostPos = 0;
       m_iStage = 21;
     } else {
       m_iStage = 25;
@@ -1586,6 +1798,7 @@ int32_t CPDF_Creator::WriteDoc_Stage2(IFX_Pause* pPause) {
   }
   if (m_iStage == 25) {
     m_Pos = (void*)(uintptr_t)0;
+    m_PostPos = 0;
     m_iStage = 26;
   }
   if (m_iStage == 26) {
@@ -1670,7 +1883,12 @@ int32_t CPDF_Creator::WriteDoc_Stage3(IFX_Pause* pPause) {
         return -1;
       }
       while (i < j) {
-        str.Format("%010d 00000 n\r\n", m_ObjectOffset[i++]);
+        // Objects that were not written, e.g. removed duplicates, are free.
+        FX_FILESIZE offset = m_ObjectOffset[i++];
+        if (offset)
+          str.Format("%010d 00000 n\r\n", offset);
+        else
+          str = "0000000000 65535 f\r\n";
         if (m_File.AppendBlock(str.c_str(), str.GetLength()) < 0) {
           return -1;
         }
@@ -1937,6 +2155,9 @@ int32_t CPDF_Creator::WriteDoc_Stage4(IFX_Pause* pPause) {
 void CPDF_Creator::Clear() {
   delete m_pXRefStream;
   m_pXRefStream = NULL;
+  m_pFlateQueue.reset();
+  m_pDeduplicator.reset();
+  m_ObjNumMap.clear();
   m_File.Clear();
   m_NewObjNumArray.RemoveAll();
   if (m_pIDArray) {
@@ -1956,6 +2177,8 @@ FX_BOOL CPDF_Creator::Create(IFX_StreamWrite* pFile, FX_DWORD flags) {
 FX_BOOL CPDF_Creator::Create(FX_DWORD flags) {
   m_dwFlags = flags;
   m_iStage = 0;
+  m_dwDuplicateCount = 0;
+  m_DuplicateSize = 0;
   m_Offset = 0;
   m_dwLastObjNum = m_pDocument->GetLastObjNum();
   m_ObjectOffset.Clear();
@@ -2040,6 +2263,9 @@ int32_t CPDF_Creator::Continue(IFX_Pause* pPause) {
   }
   return m_iStage;
 }
+void CPDF_Creator::SetCompressionLevel(int level) {
+  m_CompressionLevel = level;
+}
 FX_BOOL CPDF_Creator::SetFileVersion(int32_t fileVersion) {
   if (fileVersion < 10 || fileVersion > 17) {
     return FALSE;
@@ -0,0 +1,227 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/src/fpdfapi/fpdf_edit/editint.h"
+
+#include <map>
+
+#include "core/include/fdrm/fx_crypt.h"
+#include "core/include/fpdfapi/fpdf_objects.h"
+#include "core/include/fpdfapi/fpdf_parser.h"
+#include "core/include/fpdfapi/fpdf_serial.h"
+#include "third_party/base/stl_util.h"
+
+namespace {
+
+// Objects whose identity matters to readers, so equal copies must stay.
+FX_BOOL IsDeduplicable(const CPDF_Object* pObj) {
+  const CPDF_Dictionary* pDict = pObj->GetDict();
+  if (!pDict)
+    return TRUE;
+  CFX_ByteString type = pDict->GetStringBy("Type");
+  if (type == "Page" || type == "Pages" || type == "Catalog" ||
+      type == "Sig" || type == "XRef" || type == "ObjStm") {
+    return FALSE;
+  }
+  return !pDict->KeyExist("ByteRange");
+}
+
+}  // namespace
+
+CPDF_ObjectDeduplicator::CPDF_ObjectDeduplicator(CPDF_Document* pDoc)
+    : m_pDocument(pDoc), m_DuplicateSize(0) {}
+
+CPDF_ObjectDeduplicator::~CPDF_ObjectDeduplicator() {}
+
+void CPDF_ObjectDeduplicator::Pin(const CPDF_Object* pObj) {
+  if (pObj && pObj->GetObjNum())
+    m_Pinned.insert(pObj->GetObjNum());
+}
+
+FX_DWORD CPDF_ObjectDeduplicator::Run() {
+  Pin(m_pDocument->GetRoot());
+  Pin(m_pDocument->GetInfo());
+
+  // Every referrer of a duplicate must be serialized again with the kept
+  // copy's number, so all objects are loaded, not just the ones in memory.
+  CPDF_Parser* pParser = m_pDocument->GetParser();
+  if (pParser) {
+    FX_DWORD nLastObjNum = pParser->GetLastObjNum();
+    for (FX_DWORD objnum = 1; objnum <= nLastObjNum; ++objnum) {
+      if (!pParser->IsObjectFreeOrNull(objnum))
+        m_pDocument->GetIndirectObject(objnum);
+    }
+  }
+  std::vector<const CPDF_Object*> candidates;
+  for (const auto& it : *m_pDocument) {
+    const CPDF_Object* pObj = it.second;
+    if (!pObj || pObj->GetObjNum() != it.first)
+      continue;
+    PinInlineObjects(pObj);
+    if (pObj->IsStream()) {
+      CPDF_StreamAcc acc;
+      acc.LoadAllData(pObj->AsStream(), TRUE);
+      uint8_t digest[32];
+      CRYPT_SHA256Generate(acc.GetData(), acc.GetSize(), digest);
+      m_StreamDigests[it.first] = CFX_ByteString(digest, 32);
+    }
+    candidates.push_back(pObj);
+  }
+
+  // Merging copies can make their referrers equal in turn, e.g. two font
+  // dictionaries once their font files are merged, so repeat until stable.
+  FX_BOOL bChanged = TRUE;
+  while (bChanged) {
+    bChanged = FALSE;
+    std::map<CFX_ByteString, FX_DWORD> seen;
+    for (const CPDF_Object* pObj : candidates) {
+      FX_DWORD objnum = pObj->GetObjNum();
+      if (IsDuplicate(objnum) || !IsDeduplicable(pObj))
+        continue;
+      CFX_ByteTextBuf key;
+      AppendKey(pObj, key);
+      uint8_t digest[32];
+      CRYPT_SHA256Generate(key.GetBuffer(), key.GetSize(), digest);
+      auto result =
+          seen.insert(std::make_pair(CFX_ByteString(digest, 32), objnum));
+      if (result.second)
+        continue;
+      if (pdfium::ContainsKey(m_Pinned, objnum)) {
+        // Keep the pinned copy and drop the earlier one instead.
+        if (pdfium::ContainsKey(m_Pinned, result.first->second))
+          continue;
+        m_Canonical[result.first->second] = objnum;
+        result.first->second = objnum;
+      } else {
+        m_Canonical[objnum] = result.first->second;
+      }
+      bChanged = TRUE;
+    }
+  }
+
+  for (const CPDF_Object* pObj : candidates) {
+    if (IsDuplicate(pObj->GetObjNum()))
+      m_DuplicateSize += GetSerializedSize(pObj);
+  }
+  return CountDuplicates();
+}
+
+FX_BOOL CPDF_ObjectDeduplicator::IsDuplicate(FX_DWORD objnum) const {
+  return pdfium::ContainsKey(m_Canonical, objnum);
+}
+
+FX_DWORD CPDF_ObjectDeduplicator::GetCanonical(FX_DWORD objnum) const {
+  auto it = m_Canonical.find(objnum);
+  while (it != m_Canonical.end()) {
+    objnum = it->second;
+    it = m_Canonical.find(objnum);
+  }
+  return objnum;
+}
+
+void CPDF_ObjectDeduplicator::GetObjNumMap(
+    std::map<FX_DWORD, FX_DWORD>* pMap) const {
+  for (const auto& it : m_Canonical)
+    (*pMap)[it.first] = GetCanonical(it.first);
+}
+
+void CPDF_ObjectDeduplicator::PinInlineObjects(const CPDF_Object* pObj) {
+  // The writer emits indirect objects stored directly in a container as
+  // references that cannot be repointed, so their targets must be kept.
+  if (const CPDF_Array* pArray = pObj->AsArray()) {
+    for (FX_DWORD i = 0; i < pArray->GetCount(); ++i) {
+      const CPDF_Object* pElement = pArray->GetElement(i);
+      if (pElement->GetObjNum())
+        Pin(pElement);
+      else
+        PinInlineObjects(pElement);
+    }
+    return;
+  }
+  const CPDF_Dictionary* pDict =
+      pObj->IsStream() ? pObj->AsStream()->GetDict() : pObj->AsDictionary();
+  if (!pDict)
+    return;
+  for (const auto& it : *pDict) {
+    if (it.second->GetObjNum())
+      Pin(it.second);
+    else
+      PinInlineObjects(it.second);
+  }
+}
+
+void CPDF_ObjectDeduplicator::AppendKey(const CPDF_Object* pObj,
+                                        CFX_ByteTextBuf& key) const {
+  key.AppendByte((uint8_t)pObj->GetType());
+  switch (pObj->GetType()) {
+    case CPDF_Object::BOOLEAN:
+    case CPDF_Object::NUMBER:
+    case CPDF_Object::STRING:
+    case CPDF_Object::NAME: {
+      CFX_ByteString str = pObj->GetString();
+      key << str.GetLength() << ":" << str;
+      break;
+    }
+    case CPDF_Object::ARRAY: {
+      const CPDF_Array* pArray = pObj->AsArray();
+      key << pArray->GetCount() << ":";
+      for (FX_DWORD i = 0; i < pArray->GetCount(); ++i)
+        AppendValueKey(pArray->GetElement(i), key);
+      break;
+    }
+    case CPDF_Object::DICTIONARY: {
+      const CPDF_Dictionary* pDict = pObj->AsDictionary();
+      key << (FX_DWORD)pDict->GetCount() << ":";
+      for (const auto& it : *pDict) {
+        key << it.first.GetLength() << ":" << it.first;
+        AppendValueKey(it.second, key);
+      }
+      break;
+    }
+    case CPDF_Object::STREAM: {
+      const CPDF_Stream* pStream = pObj->AsStream();
+      key << pStream->GetRawSize() << ":";
+      auto it = m_StreamDigests.find(pObj->GetObjNum());
+      if (it != m_StreamDigests.end())
+        key << it->second;
+      // /Length may be an indirect number; the data size already covers it.
+      const CPDF_Dictionary* pDict = pStream->GetDict();
+      if (pDict) {
+        for (const auto& item : *pDict) {
+          if (item.first == "Length")
+            continue;
+          key << item.first.GetLength() << ":" << item.first;
+          AppendValueKey(item.second, key);
+        }
+      }
+      break;
+    }
+    case CPDF_Object::REFERENCE:
+      key << GetCanonical(pObj->AsReference()->GetRefObjNum()) << "R";
+      break;
+    case CPDF_Object::NULLOBJ:
+      break;
+  }
+}
+
+void CPDF_ObjectDeduplicator::AppendValueKey(const CPDF_Object* pObj,
+                                             CFX_ByteTextBuf& key) const {
+  if (pObj->GetObjNum()) {
+    key.AppendByte((uint8_t)CPDF_Object::REFERENCE);
+    key << GetCanonical(pObj->GetObjNum()) << "R";
+    return;
+  }
+  AppendKey(pObj, key);
+}
+
+FX_FILESIZE CPDF_ObjectDeduplicator::GetSerializedSize(
+    const CPDF_Object* pObj) const {
+  CFX_ByteTextBuf buf;
+  if (const CPDF_Stream* pStream = pObj->AsStream()) {
+    buf << pStream->GetDict();
+    return buf.GetSize() + pStream->GetRawSize();
+  }
+  buf << pObj;
+  return buf.GetSize();
+}
@@ -159,6 +159,9 @@ class CPDF_CMap {
   uint8_t* m_pAddMapping;
   FX_BOOL m_bLoaded;
   const FXCMAP_CMap* m_pEmbedMap;
+  // The one and two byte codes of |m_pEmbedMap|, indexed directly by code in
+  // 256 pages of 256 CIDs. Pages without any mapped code are not allocated.
+  FX_WORD** m_pEmbedPages;
   CPDF_CMap* m_pUseMap;
 };
 
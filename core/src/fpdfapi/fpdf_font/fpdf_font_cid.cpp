@@ -6,6 +6,8 @@
 
 #include "font_int.h"
 
+#include <algorithm>
+
 #include "core/include/fpdfapi/fpdf_module.h"
 #include "core/include/fpdfapi/fpdf_page.h"
 #include "core/include/fpdfapi/fpdf_resource.h"
@@ -310,13 +312,13 @@ FX_DWORD EmbeddedCharcodeFromUnicode(const FXCMAP_CMap* pEmbedMap,
 }
 #endif  // _FXM_PLATFORM_ != _FXM_PLATFORM_WINDOWS_
 
-FX_WCHAR EmbeddedUnicodeFromCharcode(const FXCMAP_CMap* pEmbedMap,
+FX_WCHAR EmbeddedUnicodeFromCharcode(const CPDF_CMap* pCMap,
                                      CIDSet charset,
                                      FX_DWORD charcode) {
   if (!IsValidEmbeddedCharcodeFromUnicodeCharset(charset))
     return 0;
 
-  FX_WORD cid = FPDFAPI_CIDFromCharCode(pEmbedMap, charcode);
+  FX_WORD cid = pCMap->CIDFromCharCode(charcode);
   if (cid == 0)
     return 0;
 
@@ -759,6 +761,7 @@ CPDF_CMap::CPDF_CMap() {
   m_pLeadingBytes = NULL;
   m_pAddMapping = NULL;
   m_pEmbedMap = NULL;
+  m_pEmbedPages = NULL;
   m_pUseMap = NULL;
   m_nCodeRanges = 0;
 }
@@ -766,6 +769,7 @@ CPDF_CMap::~CPDF_CMap() {
   FX_Free(m_pMapping);
   FX_Free(m_pAddMapping);
   FX_Free(m_pLeadingBytes);
+  FPDFAPI_FreeCIDPages(m_pEmbedPages);
   delete m_pUseMap;
 }
 void CPDF_CMap::Release() {
@@ -813,6 +817,7 @@ FX_BOOL CPDF_CMap::LoadPredefined(CPDF_CMapManager* pMgr,
   }
   FPDFAPI_FindEmbeddedCMap(pName, m_Charset, m_Coding, m_pEmbedMap);
   if (m_pEmbedMap) {
+    m_pEmbedPages = FPDFAPI_LoadCIDPages(m_pEmbedMap);
     m_bLoaded = TRUE;
     return TRUE;
   }
@@ -846,7 +851,11 @@ FX_WORD CPDF_CMap::CIDFromCharCode(FX_DWORD charcode) const {
     return (FX_WORD)charcode;
   }
   if (m_pEmbedMap) {
-    return FPDFAPI_CIDFromCharCode(m_pEmbedMap, charcode);
+    if (charcode >> 16) {
+      return FPDFAPI_CIDFromCharCode(m_pEmbedMap, charcode);
+    }
+    const FX_WORD* pPage = m_pEmbedPages[charcode >> 8];
+    return pPage ? pPage[charcode & 0xff] : 0;
   }
   if (!m_pMapping) {
     return (FX_WORD)charcode;
@@ -1043,6 +1052,9 @@ CPDF_CIDFont::CPDF_CIDFont() : CPDF_Font(PDFFONT_CIDFONT) {
   m_pAllocatedCMap = NULL;
   m_pCID2UnicodeMap = NULL;
   m_pAnsiWidths = NULL;
+  m_pWidthTable = NULL;
+  m_WidthTableStart = 0;
+  m_WidthTableSize = 0;
   m_pCIDToGIDMap = NULL;
   m_bCIDIsGID = FALSE;
   m_bAdobeCourierStd = FALSE;
@@ -1053,6 +1065,7 @@ CPDF_CIDFont::~CPDF_CIDFont() {
   if (m_pAnsiWidths) {
     FX_Free(m_pAnsiWidths);
   }
+  FX_Free(m_pWidthTable);
   delete m_pAllocatedCMap;
   delete m_pCIDToGIDMap;
   delete m_pTTGSUBTable;
@@ -1096,8 +1109,8 @@ FX_WCHAR CPDF_CIDFont::_UnicodeFromCharCode(FX_DWORD charcode) const {
     return unicode;
 #endif
     if (m_pCMap->m_pEmbedMap) {
-      return EmbeddedUnicodeFromCharcode(m_pCMap->m_pEmbedMap,
-                                         m_pCMap->m_Charset, charcode);
+      return EmbeddedUnicodeFromCharcode(m_pCMap, m_pCMap->m_Charset,
+                                         charcode);
     }
     return 0;
   }
@@ -1231,6 +1244,7 @@ FX_BOOL CPDF_CIDFont::_Load() {
   CPDF_Array* pWidthArray = pCIDFontDict->GetArrayBy("W");
   if (pWidthArray) {
     LoadMetricsArray(pWidthArray, m_WidthList, 1);
+    LoadWidthTable();
   }
   if (!IsEmbedded()) {
     LoadSubstFont();
@@ -1359,11 +1373,17 @@ int CPDF_CIDFont::GetCharWidthF(FX_DWORD charcode, int level) {
   if (m_pAnsiWidths && charcode < 0x80) {
     return m_pAnsiWidths[charcode];
   }
-  FX_WORD cid = CIDFromCharCode(charcode);
+  return GetCIDWidth(CIDFromCharCode(charcode));
+}
+int CPDF_CIDFont::GetCIDWidth(FX_WORD CID) const {
+  if (m_pWidthTable) {
+    FX_DWORD index = CID - m_WidthTableStart;
+    return index < m_WidthTableSize ? m_pWidthTable[index] : m_DefaultWidth;
+  }
   int size = m_WidthList.GetSize();
-  FX_DWORD* list = m_WidthList.GetData();
+  const FX_DWORD* list = m_WidthList.GetData();
   for (int i = 0; i < size; i += 3) {
-    if (cid >= list[i] && cid <= list[i + 1]) {
+    if (CID >= list[i] && CID <= list[i + 1]) {
       return (int)list[i + 2];
     }
   }
@@ -1392,15 +1412,7 @@ void CPDF_CIDFont::GetVertOrigin(FX_WORD CID, short& vx, short& vy) const {
         return;
       }
   }
-  FX_DWORD dwWidth = m_DefaultWidth;
-  int size = m_WidthList.GetSize();
-  const FX_DWORD* list = m_WidthList.GetData();
-  for (int i = 0; i < size; i += 3) {
-    if (CID >= list[i] && CID <= list[i + 1]) {
-      dwWidth = (FX_WORD)list[i + 2];
-      break;
-    }
-  }
+  FX_DWORD dwWidth = (FX_WORD)GetCIDWidth(CID);
   vx = (short)dwWidth / 2;
   vy = (short)m_DefaultVY;
 }
@@ -1629,6 +1641,44 @@ void CPDF_CIDFont::LoadSubstFont() {
   m_Font.LoadSubst(m_BaseFont, !m_bType1, m_Flags, m_StemV * 5, m_ItalicAngle,
                    g_CharsetCPs[m_Charset], IsVertWriting());
 }
+void CPDF_CIDFont::LoadWidthTable() {
+  int count = m_WidthList.GetSize() / 3;
+  const FX_DWORD* list = m_WidthList.GetData();
+  FX_DWORD start = 0xffff;
+  FX_DWORD end = 0;
+  for (int i = 0; i < count; i++) {
+    const FX_DWORD* entry = list + i * 3;
+    if (entry[0] > entry[1] || entry[0] > 0xffff) {
+      continue;
+    }
+    if (entry[2] > 0xffff) {
+      return;
+    }
+    start = std::min(start, entry[0]);
+    end = std::max(end, std::min(entry[1], (FX_DWORD)0xffff));
+  }
+  if (start > end) {
+    return;
+  }
+  m_WidthTableStart = start;
+  m_WidthTableSize = end - start + 1;
+  m_pWidthTable = FX_Alloc(FX_WORD, m_WidthTableSize);
+  for (FX_DWORD i = 0; i < m_WidthTableSize; i++) {
+    m_pWidthTable[i] = m_DefaultWidth;
+  }
+  // Entries are filled last to first, so the first one listed for a CID
+  // wins, as in a search of the list.
+  for (int i = count - 1; i >= 0; i--) {
+    const FX_DWORD* entry = list + i * 3;
+    if (entry[0] > entry[1] || entry[0] > 0xffff) {
+      continue;
+    }
+    FX_DWORD last = std::min(entry[1], (FX_DWORD)0xffff);
+    for (FX_DWORD cid = entry[0]; cid <= last; cid++) {
+      m_pWidthTable[cid - start] = (FX_WORD)entry[2];
+    }
+  }
+}
 void CPDF_CIDFont::LoadMetricsArray(CPDF_Array* pArray,
                                     CFX_DWordArray& result,
                                     int nElements) {
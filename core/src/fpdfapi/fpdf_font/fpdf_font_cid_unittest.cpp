@@ -6,6 +6,9 @@
 
 #include "font_int.h"
 
+#include "core/include/fpdfapi/fpdf_module.h"
+#include "core/src/fpdfapi/fpdf_cmaps/cmap_int.h"
+
 namespace {
 
 bool uint_ranges_equal(uint8_t* a, uint8_t* b, size_t count) {
@@ -64,3 +67,36 @@ TEST(fpdf_font_cid, CMap_GetCodeRange) {
   EXPECT_EQ(161, range.m_Lower[0]);
   EXPECT_EQ(0, range.m_Upper[0]);
 }
+
+TEST(fpdf_font_cid, LoadCIDPages) {
+  CPDF_ModuleMgr::Create();
+  CPDF_ModuleMgr* pModuleMgr = CPDF_ModuleMgr::Get();
+  pModuleMgr->InitPageModule();
+  pModuleMgr->LoadEmbeddedGB1CMaps();
+  pModuleMgr->LoadEmbeddedCNS1CMaps();
+  pModuleMgr->LoadEmbeddedJapan1CMaps();
+  pModuleMgr->LoadEmbeddedKorea1CMaps();
+  CPDF_FontGlobals* pFontGlobals =
+      pModuleMgr->GetPageModule()->GetFontGlobals();
+
+  // The pages of every predefined CMap agree with searching its tables.
+  int nMaps = 0;
+  for (int charset = CIDSET_GB1; charset <= CIDSET_KOREA1; ++charset) {
+    const FXCMAP_CMap* pMaps =
+        pFontGlobals->m_EmbeddedCharsets[charset].m_pMapList;
+    for (int i = 0; i < pFontGlobals->m_EmbeddedCharsets[charset].m_Count;
+         ++i) {
+      FX_WORD** pPages = FPDFAPI_LoadCIDPages(&pMaps[i]);
+      for (FX_DWORD code = 0; code < 65536; ++code) {
+        const FX_WORD* pPage = pPages[code >> 8];
+        FX_WORD cid = pPage ? pPage[code & 0xff] : 0;
+        ASSERT_EQ(FPDFAPI_CIDFromCharCode(&pMaps[i], code), cid)
+            << pMaps[i].m_Name << " " << code;
+      }
+      FPDFAPI_FreeCIDPages(pPages);
+      ++nMaps;
+    }
+  }
+  EXPECT_LT(0, nMaps);
+  CPDF_ModuleMgr::Destroy();
+}
@@ -6,9 +6,19 @@
 
 #include "pageint.h"
 
+#include <atomic>
+
 #include "core/include/fpdfapi/fpdf_module.h"
 #include "core/include/fpdfapi/fpdf_page.h"
 
+namespace {
+
+// Source of CPDF_PageObjectList versions, shared so that no two lists ever
+// hold the same one.
+std::atomic<FX_DWORD> g_LastObjectListVersion(0);
+
+}  // namespace
+
 CPDF_PageObject* CPDF_PageObject::Create(int type) {
   switch (type) {
     case TEXT:
@@ -680,7 +690,9 @@ CPDF_PageObjectList::CPDF_PageObjectList()
       m_bBackgroundAlphaNeeded(FALSE),
       m_bHasImageMask(FALSE),
       m_ParseState(CONTENT_NOT_PARSED),
-      m_ObjectList(128) {}
+      m_ObjectList(128) {
+  UpdateVersion();
+}
 CPDF_PageObjectList::~CPDF_PageObjectList() {
   FX_POSITION pos = m_ObjectList.GetHeadPosition();
   while (pos) {
@@ -697,8 +709,13 @@ void CPDF_PageObjectList::ContinueParse(IFX_Pause* pPause) {
     m_pParser.reset();
   }
 }
+void CPDF_PageObjectList::AddTail(CPDF_PageObject* obj) {
+  m_ObjectList.AddTail(obj);
+  UpdateVersion();
+}
 FX_POSITION CPDF_PageObjectList::InsertObject(FX_POSITION posInsertAfter,
                                               CPDF_PageObject* pNewObject) {
+  UpdateVersion();
   if (!posInsertAfter) {
     return m_ObjectList.AddHead(pNewObject);
   }
@@ -721,12 +738,16 @@ CPDF_PageObject* CPDF_PageObjectList::GetObjectByIndex(int index) const {
   return pos ? static_cast<CPDF_PageObject*>(m_ObjectList.GetAt(pos)) : nullptr;
 }
 void CPDF_PageObjectList::Transform(const CFX_Matrix& matrix) {
+  UpdateVersion();
   FX_POSITION pos = m_ObjectList.GetHeadPosition();
   while (pos) {
     CPDF_PageObject* pObj = (CPDF_PageObject*)m_ObjectList.GetNext(pos);
     pObj->Transform(matrix);
   }
 }
+void CPDF_PageObjectList::UpdateVersion() {
+  m_dwVersion = ++g_LastObjectListVersion;
+}
 CFX_FloatRect CPDF_PageObjectList::CalcBoundingBox() const {
   if (m_ObjectList.GetCount() == 0) {
     return CFX_FloatRect(0, 0, 0, 0);
@@ -929,7 +950,7 @@ CPDF_Form* CPDF_Form::Clone() const {
   FX_POSITION pos = m_ObjectList.GetHeadPosition();
   while (pos) {
     CPDF_PageObject* pObj = (CPDF_PageObject*)m_ObjectList.GetNext(pos);
-    pClone->m_ObjectList.AddTail(pObj->Clone());
+    pClone->AddTail(pObj->Clone());
   }
   return pClone;
 }
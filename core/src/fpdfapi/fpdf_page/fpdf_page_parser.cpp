@@ -128,6 +128,8 @@ CPDF_StreamContentParser::CPDF_StreamContentParser(
       m_Level(level),
       m_ParamStartPos(0),
       m_ParamCount(0),
+      m_SoftEndPos(0),
+      m_bNeedMoreData(FALSE),
       m_pCurStates(new CPDF_AllStates),
       m_pLastTextObject(nullptr),
       m_DefFontSize(0),
@@ -579,6 +581,16 @@ void CPDF_StreamContentParser::Handle_BeginImage() {
   while (1) {
     CPDF_StreamParser::SyntaxType type = m_pSyntax->ParseNextElement();
     if (type == CPDF_StreamParser::EndOfData) {
+      if (m_SoftEndPos) {
+        // The image data continues past the current window.
+        m_bNeedMoreData = TRUE;
+        if (pStream) {
+          pStream->Release();
+        } else {
+          pDict->Release();
+        }
+        return;
+      }
       break;
     }
     if (type != CPDF_StreamParser::Keyword) {
@@ -978,7 +990,7 @@ void CPDF_StreamContentParser::Handle_MoveTo() {
     return;
 
   if (m_Options.m_bTextOnly) {
-    m_pSyntax->SkipPathObject();
+    m_pSyntax->SkipPathObject(m_SoftEndPos);
     return;
   }
   AddPathPoint(GetNumber(1), GetNumber(0), FXPT_MOVETO);
@@ -1637,7 +1649,8 @@ void CPDF_StreamContentParser::AddPathObject(int FillType, FX_BOOL bStroke) {
 
 FX_DWORD CPDF_StreamContentParser::Parse(const uint8_t* pData,
                                          FX_DWORD dwSize,
-                                         FX_DWORD max_cost) {
+                                         FX_DWORD max_cost,
+                                         FX_DWORD soft_end) {
   if (m_Level > _FPDF_MAX_FORM_LEVEL_) {
     return dwSize;
   }
@@ -1645,17 +1658,32 @@ FX_DWORD CPDF_StreamContentParser::Parse(const uint8_t* pData,
   CPDF_StreamParser syntax(pData, dwSize);
   CPDF_StreamParserAutoClearer auto_clearer(&m_pSyntax, &syntax);
   m_CompatCount = 0;
+  m_SoftEndPos = soft_end;
+  m_bNeedMoreData = FALSE;
+  FX_DWORD op_start = 0;
   while (1) {
     FX_DWORD cost = m_pObjectList->CountObjects() - InitObjCount;
     if (max_cost && cost >= max_cost) {
       break;
     }
-    switch (syntax.ParseNextElement()) {
+    CPDF_StreamParser::SyntaxType type = syntax.ParseNextElement();
+    if (soft_end && syntax.IsEndOfData())
+      m_bNeedMoreData = TRUE;
+    if (m_bNeedMoreData) {
+      ClearAllParams();
+      return op_start;
+    }
+    switch (type) {
       case CPDF_StreamParser::EndOfData:
         return m_pSyntax->GetPos();
       case CPDF_StreamParser::Keyword:
         OnOperator((char*)syntax.GetWordBuf());
         ClearAllParams();
+        if (m_bNeedMoreData)
+          return op_start;
+        op_start = syntax.GetPos();
+        if (soft_end && op_start >= soft_end)
+          return op_start;
         break;
       case CPDF_StreamParser::Number:
         AddNumberParam((char*)syntax.GetWordBuf(), syntax.GetWordSize());
@@ -1677,6 +1705,11 @@ void CPDF_StreamContentParser::ParsePathObject() {
   int last_pos = m_pSyntax->GetPos();
   while (1) {
     CPDF_StreamParser::SyntaxType type = m_pSyntax->ParseNextElement();
+    if (m_SoftEndPos && m_pSyntax->IsEndOfData()) {
+      // Leave the cut off operator to Parse(), which waits for more data.
+      m_pSyntax->SetPos(last_pos);
+      return;
+    }
     FX_BOOL bProcessed = TRUE;
     switch (type) {
       case CPDF_StreamParser::EndOfData:
@@ -1732,6 +1765,8 @@ void CPDF_StreamContentParser::ParsePathObject() {
         }
         if (bProcessed) {
           last_pos = m_pSyntax->GetPos();
+          if (m_SoftEndPos && last_pos >= m_SoftEndPos)
+            return;
         }
         break;
       }
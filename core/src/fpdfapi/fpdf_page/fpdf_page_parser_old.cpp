@@ -14,6 +14,23 @@
 #include "core/include/fxcrt/fx_ext.h"
 #include "core/include/fxcrt/fx_safe_types.h"
 
+namespace {
+
+// Content streams with more raw data than this are decoded and parsed one
+// window at a time instead of being decoded in full up front.
+const FX_DWORD kStreamingThreshold = 1024 * 1024;
+
+// Number of decoded bytes always kept ahead of the parse position while more
+// data is pending, so that the parser seldom has to back off from an
+// operation cut off by the end of the window.
+const FX_DWORD kStreamingReserve = 1024 * 1024;
+
+// Initial size of the window holding decoded content. It doubles whenever a
+// single operation, such as a large inline image, does not fit.
+const FX_DWORD kStreamingBufferSize = 2 * kStreamingReserve;
+
+}  // namespace
+
 CPDF_StreamParser::CPDF_StreamParser(const uint8_t* pData, FX_DWORD dwSize) {
   m_pBuf = pData;
   m_Size = dwSize;
@@ -315,7 +332,7 @@ CPDF_StreamParser::SyntaxType CPDF_StreamParser::ParseNextElement() {
   return Keyword;
 }
 
-void CPDF_StreamParser::SkipPathObject() {
+void CPDF_StreamParser::SkipPathObject(FX_DWORD soft_end) {
   FX_DWORD command_startpos = m_Pos;
   if (!PositionIsInBounds())
     return;
@@ -323,8 +340,11 @@ void CPDF_StreamParser::SkipPathObject() {
   int ch = m_pBuf[m_Pos++];
   while (1) {
     while (PDFCharIsWhitespace(ch)) {
-      if (!PositionIsInBounds())
+      if (!PositionIsInBounds()) {
+        if (soft_end)
+          m_Pos = command_startpos;
         return;
+      }
       ch = m_pBuf[m_Pos++];
     }
 
@@ -335,14 +355,20 @@ void CPDF_StreamParser::SkipPathObject() {
 
     while (1) {
       while (!PDFCharIsWhitespace(ch)) {
-        if (!PositionIsInBounds())
+        if (!PositionIsInBounds()) {
+          if (soft_end)
+            m_Pos = command_startpos;
           return;
+        }
         ch = m_pBuf[m_Pos++];
       }
 
       while (PDFCharIsWhitespace(ch)) {
-        if (!PositionIsInBounds())
+        if (!PositionIsInBounds()) {
+          if (soft_end)
+            m_Pos = command_startpos;
           return;
+        }
         ch = m_pBuf[m_Pos++];
       }
 
@@ -351,13 +377,21 @@ void CPDF_StreamParser::SkipPathObject() {
 
       FX_DWORD op_startpos = m_Pos - 1;
       while (!PDFCharIsWhitespace(ch) && !PDFCharIsDelimiter(ch)) {
-        if (!PositionIsInBounds())
+        if (!PositionIsInBounds()) {
+          if (soft_end)
+            m_Pos = command_startpos;
           return;
+        }
         ch = m_pBuf[m_Pos++];
       }
 
       if (IsPathOperator(&m_pBuf[op_startpos], m_Pos - 1 - op_startpos)) {
         command_startpos = m_Pos;
+        if (soft_end && m_Pos >= soft_end) {
+          // Leave the character following the operator to the caller.
+          m_Pos--;
+          return;
+        }
         break;
       }
       m_Pos = command_startpos;
@@ -669,6 +703,7 @@ CPDF_ContentParser::CPDF_ContentParser()
       m_pObjects(nullptr),
       m_bForm(false),
       m_pType3Char(nullptr),
+      m_StreamBufferSize(0),
       m_pData(nullptr),
       m_Size(0),
       m_CurrentOffset(0) {}
@@ -700,8 +735,10 @@ void CPDF_ContentParser::Start(CPDF_Page* pPage, CPDF_ParseOptions* pOptions) {
   }
   if (CPDF_Stream* pStream = pContent->AsStream()) {
     m_nStreams = 0;
-    m_pSingleStream.reset(new CPDF_StreamAcc);
-    m_pSingleStream->LoadAllData(pStream, FALSE);
+    if (!StartStreaming(pStream)) {
+      m_pSingleStream.reset(new CPDF_StreamAcc);
+      m_pSingleStream->LoadAllData(pStream, FALSE);
+    }
   } else if (CPDF_Array* pArray = pContent->AsArray()) {
     m_nStreams = pArray->GetCount();
     if (m_nStreams)
@@ -763,15 +800,54 @@ void CPDF_ContentParser::Start(CPDF_Form* pForm,
     pData->m_pSoftMask = NULL;
   }
   m_nStreams = 0;
-  m_pSingleStream.reset(new CPDF_StreamAcc);
-  m_pSingleStream->LoadAllData(pForm->m_pFormStream, FALSE);
-  m_pData = (uint8_t*)m_pSingleStream->GetData();
-  m_Size = m_pSingleStream->GetSize();
+  if (!StartStreaming(pForm->m_pFormStream)) {
+    m_pSingleStream.reset(new CPDF_StreamAcc);
+    m_pSingleStream->LoadAllData(pForm->m_pFormStream, FALSE);
+    m_pData = (uint8_t*)m_pSingleStream->GetData();
+    m_Size = m_pSingleStream->GetSize();
+  }
   m_Status = ToBeContinued;
   m_InternalStage = STAGE_PARSE;
   m_CurrentOffset = 0;
 }
 
+FX_BOOL CPDF_ContentParser::StartStreaming(const CPDF_Stream* pStream) {
+  if (!pStream || pStream->GetRawSize() <= kStreamingThreshold)
+    return FALSE;
+
+  m_pStreamReader.reset(new CPDF_StreamReader);
+  if (!m_pStreamReader->Load(pStream)) {
+    m_pStreamReader.reset();
+    return FALSE;
+  }
+  m_StreamBufferSize = kStreamingBufferSize;
+  m_pData = FX_Alloc(uint8_t, m_StreamBufferSize);
+  m_Size = 0;
+  return TRUE;
+}
+
+void CPDF_ContentParser::FillStreamBuffer(FX_BOOL bNeedMore) {
+  FX_DWORD dwLeft = m_Size - m_CurrentOffset;
+  if (m_pStreamReader->IsEOF() || (!bNeedMore && dwLeft > kStreamingReserve))
+    return;
+
+  if (bNeedMore && dwLeft == m_StreamBufferSize) {
+    FX_SAFE_DWORD safeSize = m_StreamBufferSize;
+    safeSize *= 2;
+    if (!safeSize.IsValid()) {
+      // Parse what there is, as if the stream ended here.
+      m_pStreamReader.reset();
+      return;
+    }
+    m_StreamBufferSize = safeSize.ValueOrDie();
+    m_pData = FX_Realloc(uint8_t, m_pData, m_StreamBufferSize);
+  }
+  FXSYS_memmove(m_pData, m_pData + m_CurrentOffset, dwLeft);
+  m_CurrentOffset = 0;
+  m_Size = dwLeft + m_pStreamReader->ReadBlock(m_pData + dwLeft,
+                                               m_StreamBufferSize - dwLeft);
+}
+
 void CPDF_ContentParser::Continue(IFX_Pause* pPause) {
   int steps = 0;
   while (m_Status == ToBeContinued) {
@@ -796,7 +872,7 @@ void CPDF_ContentParser::Continue(IFX_Pause* pPause) {
             m_pData[pos++] = ' ';
           }
           m_StreamArray.clear();
-        } else {
+        } else if (m_pSingleStream) {
           m_pData = (uint8_t*)m_pSingleStream->GetData();
           m_Size = m_pSingleStream->GetSize();
         }
@@ -819,12 +895,18 @@ void CPDF_ContentParser::Continue(IFX_Pause* pPause) {
             &m_Options, nullptr, 0));
         m_pParser->GetCurStates()->m_ColorState.GetModify()->Default();
       }
+      if (m_pStreamReader)
+        FillStreamBuffer(m_pParser->NeedMoreData());
       if (m_CurrentOffset >= m_Size) {
         m_InternalStage = STAGE_CHECKCLIP;
       } else {
+        FX_DWORD soft_end = 0;
+        if (m_pStreamReader && !m_pStreamReader->IsEOF())
+          soft_end = m_Size - m_CurrentOffset - kStreamingReserve;
         m_CurrentOffset +=
             m_pParser->Parse(m_pData + m_CurrentOffset,
-                             m_Size - m_CurrentOffset, PARSE_STEP_LIMIT);
+                             m_Size - m_CurrentOffset, PARSE_STEP_LIMIT,
+                             soft_end);
       }
     }
     if (m_InternalStage == STAGE_CHECKCLIP) {
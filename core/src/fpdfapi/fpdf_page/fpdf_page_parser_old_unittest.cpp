@@ -46,3 +46,32 @@ TEST(fpdf_page_parser_old, ReadHexString) {
     EXPECT_EQ(1, parser.GetPos());
   }
 }
+
+TEST(fpdf_page_parser_old, SkipPathObject) {
+  {
+    // Skips all path operators.
+    uint8_t data[] = "0 0 m 10 10 l 20 20 l f";
+    CPDF_StreamParser parser(data, sizeof(data) - 1);
+    parser.SetPos(6);
+    parser.SkipPathObject(0);
+    EXPECT_EQ(22, parser.GetPos());
+  }
+
+  {
+    // Stops at the first operator ending past the soft end.
+    uint8_t data[] = "0 0 m 10 10 l 20 20 l f";
+    CPDF_StreamParser parser(data, sizeof(data) - 1);
+    parser.SetPos(6);
+    parser.SkipPathObject(8);
+    EXPECT_EQ(13, parser.GetPos());
+  }
+
+  {
+    // With a soft end, does not skip an operator cut off by the end.
+    uint8_t data[] = "0 0 m 10 10 l 20 2";
+    CPDF_StreamParser parser(data, sizeof(data) - 1);
+    parser.SetPos(6);
+    parser.SkipPathObject(100);
+    EXPECT_EQ(14, parser.GetPos());
+  }
+}
@@ -0,0 +1,555 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/src/fpdfapi/fpdf_page/pageint.h"
+
+#include <memory>
+#include <vector>
+
+#include "core/include/fpdfapi/fpdf_module.h"
+#include "core/include/fpdfapi/fpdf_page.h"
+
+// Operands of the operator being read, most recent last. Like
+// CPDF_StreamContentParser, keeps only the last PARAM_BUF_SIZE of them.
+class CPDF_TextStreamParser::Operands {
+ public:
+  Operands() {}
+  ~Operands() { Clear(); }
+
+  void AddNumber(const uint8_t* str, FX_DWORD len) {
+    Operand& operand = Add();
+    FX_BOOL bInteger;
+    int value;
+    FX_atonum(CFX_ByteStringC(str, len), bInteger, &value);
+    operand.m_Number = bInteger ? (FX_FLOAT)value : *(FX_FLOAT*)&value;
+  }
+  void AddName(const uint8_t* name, FX_DWORD len) {
+    Add().m_Name = PDF_NameDecode(CFX_ByteStringC(name, len));
+  }
+  void AddObject(CPDF_Object* pObj) { Add().m_pObject = pObj; }
+  void Clear() {
+    for (const Operand& operand : m_Operands) {
+      if (operand.m_pObject)
+        operand.m_pObject->Release();
+    }
+    m_Operands.clear();
+  }
+
+  FX_DWORD GetCount() const { return m_Operands.size(); }
+  // |index| counts back from the last operand.
+  FX_FLOAT GetNumber(FX_DWORD index) const {
+    const Operand* pOperand = Get(index);
+    if (!pOperand)
+      return 0;
+    return pOperand->m_pObject ? pOperand->m_pObject->GetNumber()
+                               : pOperand->m_Number;
+  }
+  CFX_ByteString GetString(FX_DWORD index) const {
+    const Operand* pOperand = Get(index);
+    if (!pOperand)
+      return CFX_ByteString();
+    return pOperand->m_pObject ? pOperand->m_pObject->GetString()
+                               : pOperand->m_Name;
+  }
+  CPDF_Object* GetObject(FX_DWORD index) const {
+    const Operand* pOperand = Get(index);
+    return pOperand ? pOperand->m_pObject : nullptr;
+  }
+
+ private:
+  struct Operand {
+    Operand() : m_Number(0), m_pObject(nullptr) {}
+
+    FX_FLOAT m_Number;
+    CFX_ByteString m_Name;
+    CPDF_Object* m_pObject;
+  };
+
+  Operand& Add() {
+    if (m_Operands.size() == PARAM_BUF_SIZE) {
+      if (m_Operands.front().m_pObject)
+        m_Operands.front().m_pObject->Release();
+      m_Operands.erase(m_Operands.begin());
+    }
+    m_Operands.push_back(Operand());
+    return m_Operands.back();
+  }
+  const Operand* Get(FX_DWORD index) const {
+    if (index >= m_Operands.size())
+      return nullptr;
+    return &m_Operands[m_Operands.size() - index - 1];
+  }
+
+  std::vector<Operand> m_Operands;
+};
+
+CPDF_TextStreamParser::State::State()
+    : m_TextX(0),
+      m_TextY(0),
+      m_TextLineX(0),
+      m_TextLineY(0),
+      m_TextLeading(0),
+      m_TextRise(0),
+      m_TextHorzScale(1.0f),
+      m_pFont(nullptr),
+      m_FontSize(1.0f),
+      m_CharSpace(0),
+      m_WordSpace(0),
+      m_TextMode(0) {}
+
+CPDF_TextStreamParser::CPDF_TextStreamParser(CPDF_Document* pDoc,
+                                             IPDF_TextStreamHandler* pHandler)
+    : m_pDocument(pDoc), m_pHandler(pHandler), m_pPageResources(nullptr) {}
+
+CPDF_TextStreamParser::~CPDF_TextStreamParser() {
+  CPDF_DocPageData* pPageData = m_pDocument->GetPageData();
+  for (const auto& it : m_Fonts) {
+    if (it.second)
+      pPageData->ReleaseFont(it.first);
+  }
+}
+
+void CPDF_TextStreamParser::ParsePage(const CPDF_Page* pPage) {
+  if (!pPage || !pPage->m_pFormDict)
+    return;
+  CPDF_Object* pContent = pPage->m_pFormDict->GetElementValue("Contents");
+  if (!pContent)
+    return;
+
+  m_pPageResources = pPage->m_pPageResources;
+  m_State = State();
+  m_StateStack.clear();
+  if (CPDF_Stream* pStream = pContent->AsStream()) {
+    CPDF_StreamAcc stream;
+    stream.LoadAllData(pStream, FALSE);
+    ParseContent(stream.GetData(), stream.GetSize(), pPage->m_pResources, 0);
+    return;
+  }
+  CPDF_Array* pArray = pContent->AsArray();
+  if (!pArray)
+    return;
+  // Operators may span streams, so they are parsed joined, as
+  // CPDF_ContentParser does.
+  CFX_BinaryBuf buf;
+  for (FX_DWORD i = 0; i < pArray->GetCount(); ++i) {
+    CPDF_StreamAcc stream;
+    stream.LoadAllData(ToStream(pArray->GetElementValue(i)), FALSE);
+    buf.AppendBlock(stream.GetData(), stream.GetSize());
+    buf.AppendByte(' ');
+  }
+  ParseContent(buf.GetBuffer(), buf.GetSize(), pPage->m_pResources, 0);
+}
+
+void CPDF_TextStreamParser::ParseContent(const uint8_t* pData,
+                                         FX_DWORD dwSize,
+                                         CPDF_Dictionary* pResources,
+                                         int level) {
+  if (level > _FPDF_MAX_FORM_LEVEL_ || !pData || !dwSize)
+    return;
+  if (!pResources)
+    pResources = m_pPageResources;
+
+  CPDF_StreamParser syntax(pData, dwSize);
+  Operands operands;
+  while (1) {
+    switch (syntax.ParseNextElement()) {
+      case CPDF_StreamParser::EndOfData:
+        return;
+      case CPDF_StreamParser::Keyword:
+        OnOperator(syntax.GetWordBuf(), syntax.GetWordSize(), operands,
+                   &syntax, pResources, level);
+        operands.Clear();
+        break;
+      case CPDF_StreamParser::Number:
+        operands.AddNumber(syntax.GetWordBuf(), syntax.GetWordSize());
+        break;
+      case CPDF_StreamParser::Name:
+        operands.AddName(syntax.GetWordBuf() + 1, syntax.GetWordSize() - 1);
+        break;
+      default:
+        operands.AddObject(syntax.GetObject());
+    }
+  }
+}
+
+void CPDF_TextStreamParser::OnOperator(const uint8_t* op,
+                                       FX_DWORD len,
+                                       Operands& operands,
+                                       CPDF_StreamParser* pSyntax,
+                                       CPDF_Dictionary* pResources,
+                                       int level) {
+  if (len > 4)
+    return;
+  FX_DWORD opid = 0;
+  for (FX_DWORD i = 0; i < 4; ++i)
+    opid = (opid << 8) + (i < len ? op[i] : 0);
+
+  switch (opid) {
+    case FXBSTR_ID('q', 0, 0, 0):
+      m_StateStack.push_back(m_State);
+      break;
+    case FXBSTR_ID('Q', 0, 0, 0):
+      if (!m_StateStack.empty()) {
+        m_State = m_StateStack.back();
+        m_StateStack.pop_back();
+      }
+      break;
+    case FXBSTR_ID('c', 'm', 0, 0): {
+      CFX_Matrix matrix(operands.GetNumber(5), operands.GetNumber(4),
+                        operands.GetNumber(3), operands.GetNumber(2),
+                        operands.GetNumber(1), operands.GetNumber(0));
+      matrix.Concat(m_State.m_CTM);
+      m_State.m_CTM = matrix;
+      break;
+    }
+    case FXBSTR_ID('B', 'T', 0, 0):
+      m_State.m_TextMatrix.SetIdentity();
+      m_State.m_TextX = 0;
+      m_State.m_TextY = 0;
+      m_State.m_TextLineX = 0;
+      m_State.m_TextLineY = 0;
+      break;
+    case FXBSTR_ID('B', 'I', 0, 0):
+      SkipInlineImage(pSyntax, pResources);
+      break;
+    case FXBSTR_ID('T', 'c', 0, 0):
+      m_State.m_CharSpace = operands.GetNumber(0);
+      break;
+    case FXBSTR_ID('T', 'w', 0, 0):
+      m_State.m_WordSpace = operands.GetNumber(0);
+      break;
+    case FXBSTR_ID('T', 'z', 0, 0):
+      if (operands.GetCount() == 1)
+        m_State.m_TextHorzScale = operands.GetNumber(0) / 100;
+      break;
+    case FXBSTR_ID('T', 'L', 0, 0):
+      m_State.m_TextLeading = operands.GetNumber(0);
+      break;
+    case FXBSTR_ID('T', 'f', 0, 0): {
+      m_State.m_FontSize = operands.GetNumber(0);
+      CPDF_Font* pFont = FindFont(pResources, operands.GetString(1));
+      if (pFont)
+        m_State.m_pFont = pFont;
+      break;
+    }
+    case FXBSTR_ID('T', 'r', 0, 0): {
+      int mode = (int)operands.GetNumber(0);
+      if (mode >= 0 && mode <= 7)
+        m_State.m_TextMode = mode;
+      break;
+    }
+    case FXBSTR_ID('T', 's', 0, 0):
+      m_State.m_TextRise = operands.GetNumber(0);
+      break;
+    case FXBSTR_ID('T', 'D', 0, 0):
+      MoveTextPoint(operands.GetNumber(1), operands.GetNumber(0));
+      m_State.m_TextLeading = -operands.GetNumber(0);
+      break;
+    case FXBSTR_ID('T', 'd', 0, 0):
+      MoveTextPoint(operands.GetNumber(1), operands.GetNumber(0));
+      break;
+    case FXBSTR_ID('T', 'm', 0, 0):
+      m_State.m_TextMatrix.Set(operands.GetNumber(5), operands.GetNumber(4),
+                               operands.GetNumber(3), operands.GetNumber(2),
+                               operands.GetNumber(1), operands.GetNumber(0));
+      m_State.m_TextX = 0;
+      m_State.m_TextY = 0;
+      m_State.m_TextLineX = 0;
+      m_State.m_TextLineY = 0;
+      break;
+    case FXBSTR_ID('T', '*', 0, 0):
+      MoveToNextLine();
+      break;
+    case FXBSTR_ID('T', 'j', 0, 0):
+      ShowText(operands.GetString(0), level);
+      break;
+    case FXBSTR_ID('\'', 0, 0, 0):
+      MoveToNextLine();
+      ShowText(operands.GetString(0), level);
+      break;
+    case FXBSTR_ID('"', 0, 0, 0):
+      m_State.m_WordSpace = operands.GetNumber(2);
+      m_State.m_CharSpace = operands.GetNumber(1);
+      MoveToNextLine();
+      ShowText(operands.GetString(0), level);
+      break;
+    case FXBSTR_ID('T', 'J', 0, 0): {
+      CPDF_Object* pObj = operands.GetObject(0);
+      if (pObj && pObj->IsArray())
+        ShowTextArray(pObj->AsArray(), level);
+      break;
+    }
+    case FXBSTR_ID('D', 'o', 0, 0):
+      ExecuteXObject(operands.GetString(0), pResources, level);
+      break;
+    default:
+      break;
+  }
+}
+
+void CPDF_TextStreamParser::MoveTextPoint(FX_FLOAT x, FX_FLOAT y) {
+  m_State.m_TextLineX += x;
+  m_State.m_TextLineY += y;
+  m_State.m_TextX = m_State.m_TextLineX;
+  m_State.m_TextY = m_State.m_TextLineY;
+}
+
+void CPDF_TextStreamParser::MoveToNextLine() {
+  m_State.m_TextLineY -= m_State.m_TextLeading;
+  m_State.m_TextX = m_State.m_TextLineX;
+  m_State.m_TextY = m_State.m_TextLineY;
+}
+
+void CPDF_TextStreamParser::ShowText(const CFX_ByteString& str, int level) {
+  if (!str.IsEmpty())
+    AddText(&str, 0, nullptr, 1, level);
+}
+
+void CPDF_TextStreamParser::ShowTextArray(CPDF_Array* pArray, int level) {
+  // Same grouping as CPDF_StreamContentParser::Handle_ShowText_Positioning()
+  // so positions match the ones of parsed text objects.
+  std::vector<CFX_ByteString> strs;
+  std::vector<FX_FLOAT> kernings;
+  FX_FLOAT fInitKerning = 0;
+  for (FX_DWORD i = 0; i < pArray->GetCount(); ++i) {
+    CPDF_Object* pObj = pArray->GetElementValue(i);
+    if (!pObj)
+      continue;
+    if (pObj->IsString()) {
+      CFX_ByteString str = pObj->GetString();
+      if (str.IsEmpty())
+        continue;
+      strs.push_back(str);
+      kernings.push_back(0);
+    } else if (strs.empty()) {
+      fInitKerning += pObj->GetNumber();
+    } else {
+      kernings.back() += pObj->GetNumber();
+    }
+  }
+  if (strs.empty()) {
+    m_State.m_TextX -= FXSYS_Mul(fInitKerning, m_State.m_FontSize) / 1000;
+    return;
+  }
+  AddText(strs.data(), fInitKerning, kernings.data(), strs.size(), level);
+}
+
+void CPDF_TextStreamParser::AddText(const CFX_ByteString* pStrs,
+                                    FX_FLOAT fInitKerning,
+                                    const FX_FLOAT* pKerning,
+                                    int nsegs,
+                                    int level) {
+  CPDF_Font* pFont = m_State.m_pFont;
+  if (!pFont)
+    return;
+  ApplyKerning(pFont, fInitKerning);
+
+  CPDF_CIDFont* pCIDFont = pFont->GetCIDFont();
+  FX_BOOL bVertWriting = pCIDFont && pCIDFont->IsVertWriting();
+  FX_FLOAT fontsize = m_State.m_FontSize;
+  // Maps glyph positions along the string to user space, like the matrix of
+  // a CPDF_TextObject placed at the current text position.
+  CFX_Matrix text_matrix = m_State.m_TextMatrix;
+  text_matrix.Concat(m_State.m_CTM);
+  CFX_Matrix char_matrix(m_State.m_TextHorzScale, 0, 0, 1.0f, 0, 0);
+  char_matrix.Concat(text_matrix);
+  text_matrix.Transform(m_State.m_TextX, m_State.m_TextY + m_State.m_TextRise,
+                        char_matrix.e, char_matrix.f);
+
+  CPDF_TextStreamChar ch;
+  ch.m_FontSize = fontsize;
+  ch.m_TextMode =
+      pFont->GetFontType() == PDFFONT_TYPE3 ? 0 : m_State.m_TextMode;
+  FX_FLOAT curpos = 0;
+  for (int i = 0; i < nsegs; ++i) {
+    if (i > 0)
+      curpos -= FXSYS_Mul(pKerning[i - 1], fontsize) / 1000;
+    const FX_CHAR* segment = pStrs[i].c_str();
+    int offset = 0;
+    int len = pStrs[i].GetLength();
+    while (offset < len) {
+      FX_DWORD charcode = pFont->GetNextChar(segment, len, offset);
+      FX_FLOAT x = curpos;
+      FX_FLOAT y = 0;
+      FX_FLOAT charwidth;
+      if (bVertWriting) {
+        FX_WORD CID = pCIDFont->CIDFromCharCode(charcode);
+        short vx;
+        short vy;
+        pCIDFont->GetVertOrigin(CID, vx, vy);
+        x = -fontsize * vx / 1000;
+        y = curpos - fontsize * vy / 1000;
+        charwidth = pCIDFont->GetVertWidth(CID) * fontsize / 1000;
+      } else {
+        charwidth = pFont->GetCharWidthF(charcode, level) * fontsize / 1000;
+      }
+      ch.m_CharCode = charcode;
+      char_matrix.Transform(x, y, ch.m_OriginX, ch.m_OriginY);
+      EmitChar(pFont, ch);
+
+      curpos += charwidth;
+      if (charcode == ' ' && (!pCIDFont || pCIDFont->GetCharSize(32) == 1))
+        curpos += m_State.m_WordSpace;
+      curpos += m_State.m_CharSpace;
+    }
+  }
+  if (bVertWriting)
+    m_State.m_TextY += curpos;
+  else
+    m_State.m_TextX += FXSYS_Mul(curpos, m_State.m_TextHorzScale);
+  if (pKerning)
+    ApplyKerning(pFont, pKerning[nsegs - 1]);
+}
+
+void CPDF_TextStreamParser::ApplyKerning(CPDF_Font* pFont, FX_FLOAT kerning) {
+  if (kerning == 0)
+    return;
+  FX_FLOAT offset = FXSYS_Mul(kerning, m_State.m_FontSize) / 1000;
+  if (pFont->IsVertWriting())
+    m_State.m_TextY -= offset;
+  else
+    m_State.m_TextX -= offset;
+}
+
+void CPDF_TextStreamParser::EmitChar(CPDF_Font* pFont,
+                                     CPDF_TextStreamChar& ch) {
+  // Same fallback as CPDF_TextPage for characters without a mapping.
+  CFX_WideString unicode = pFont->UnicodeFromCharCode(ch.m_CharCode);
+  if (unicode.IsEmpty() || unicode.GetAt(0) == 0) {
+    if (!ch.m_CharCode)
+      return;
+    ch.m_Unicode = (FX_WCHAR)ch.m_CharCode;
+    ch.m_bUnicodeMapped = FALSE;
+    m_pHandler->OnChar(ch);
+    return;
+  }
+  ch.m_bUnicodeMapped = TRUE;
+  for (int i = 0; i < unicode.GetLength(); ++i) {
+    ch.m_Unicode = unicode.GetAt(i);
+    if (ch.m_Unicode)
+      m_pHandler->OnChar(ch);
+  }
+}
+
+void CPDF_TextStreamParser::ExecuteXObject(const CFX_ByteString& name,
+                                           CPDF_Dictionary* pResources,
+                                           int level) {
+  if (!pResources)
+    return;
+  CPDF_Dictionary* pList = pResources->GetDictBy("XObject");
+  if (!pList && m_pPageResources && pResources != m_pPageResources)
+    pList = m_pPageResources->GetDictBy("XObject");
+  if (!pList)
+    return;
+  // Tells images apart without loading them when the parser knows the type.
+  if (CPDF_Reference* pRef = ToReference(pList->GetElement(name))) {
+    FX_BOOL bForm;
+    if (m_pDocument->IsFormStream(pRef->GetRefObjNum(), bForm) && !bForm)
+      return;
+  }
+  CPDF_Stream* pStream = ToStream(pList->GetElementValue(name));
+  CPDF_Dictionary* pDict = pStream ? pStream->GetDict() : nullptr;
+  if (!pDict || pDict->GetConstStringBy("Subtype") != "Form")
+    return;
+
+  // The form runs on a copy of the current state, as a nested
+  // CPDF_StreamContentParser does.
+  State saved = m_State;
+  size_t nSavedDepth = m_StateStack.size();
+  CFX_Matrix form_matrix = pDict->GetMatrixBy("Matrix");
+  form_matrix.Concat(m_State.m_CTM);
+  m_State.m_CTM = form_matrix;
+  CPDF_Dictionary* pFormResources = pDict->GetDictBy("Resources");
+  CPDF_StreamAcc stream;
+  stream.LoadAllData(pStream, FALSE);
+  ParseContent(stream.GetData(), stream.GetSize(),
+               pFormResources ? pFormResources : pResources, level + 1);
+  m_StateStack.resize(nSavedDepth);
+  m_State = saved;
+}
+
+void CPDF_TextStreamParser::SkipInlineImage(CPDF_StreamParser* pSyntax,
+                                            CPDF_Dictionary* pResources) {
+  // The image data has no delimiter, so its size is worked out from the
+  // dictionary the same way CPDF_StreamContentParser::Handle_BeginImage()
+  // does, then the data is skipped undecoded.
+  FX_DWORD savePos = pSyntax->GetPos();
+  CPDF_Dictionary* pDict = new CPDF_Dictionary;
+  while (1) {
+    CPDF_StreamParser::SyntaxType type = pSyntax->ParseNextElement();
+    if (type == CPDF_StreamParser::Keyword) {
+      if (pSyntax->GetWordSize() != 2 || pSyntax->GetWordBuf()[0] != 'I' ||
+          pSyntax->GetWordBuf()[1] != 'D') {
+        pSyntax->SetPos(savePos);
+        pDict->Release();
+        return;
+      }
+    }
+    if (type != CPDF_StreamParser::Name)
+      break;
+    CFX_ByteString key((const FX_CHAR*)pSyntax->GetWordBuf() + 1,
+                       pSyntax->GetWordSize() - 1);
+    CPDF_Object* pObj = pSyntax->ReadNextObject();
+    if (key.IsEmpty()) {
+      if (pObj)
+        pObj->Release();
+      continue;
+    }
+    pDict->SetAt(key, pObj);
+  }
+  PDF_ReplaceAbbr(pDict);
+  CPDF_Object* pCSObj = pDict->GetElementValue("ColorSpace");
+  if (pCSObj && pCSObj->IsName()) {
+    CFX_ByteString name = pCSObj->GetString();
+    if (name != "DeviceRGB" && name != "DeviceGray" && name != "DeviceCMYK")
+      pCSObj = FindResourceObj(pResources, "ColorSpace", name);
+  }
+  CPDF_Stream* pStream =
+      pSyntax->ReadInlineStream(m_pDocument, pDict, pCSObj, FALSE);
+  while (1) {
+    CPDF_StreamParser::SyntaxType type = pSyntax->ParseNextElement();
+    if (type == CPDF_StreamParser::EndOfData)
+      break;
+    if (type == CPDF_StreamParser::Keyword && pSyntax->GetWordSize() == 2 &&
+        pSyntax->GetWordBuf()[0] == 'E' && pSyntax->GetWordBuf()[1] == 'I') {
+      break;
+    }
+  }
+  if (pStream)
+    pStream->Release();
+  else
+    pDict->Release();
+}
+
+CPDF_Object* CPDF_TextStreamParser::FindResourceObj(
+    CPDF_Dictionary* pResources,
+    const CFX_ByteStringC& type,
+    const CFX_ByteString& name) const {
+  CPDF_Dictionary* pList = pResources ? pResources->GetDictBy(type) : nullptr;
+  if (!pList && m_pPageResources && pResources != m_pPageResources)
+    pList = m_pPageResources->GetDictBy(type);
+  return pList ? pList->GetElementValue(name) : nullptr;
+}
+
+CPDF_Font* CPDF_TextStreamParser::FindFont(CPDF_Dictionary* pResources,
+                                           const CFX_ByteString& name) {
+  CPDF_Dictionary* pFontDict =
+      ToDictionary(FindResourceObj(pResources, "Font", name));
+  if (!pFontDict)
+    return CPDF_Font::GetStockFont(m_pDocument, "Helvetica");
+
+  CPDF_Font* pFont;
+  auto it = m_Fonts.find(pFontDict);
+  if (it != m_Fonts.end()) {
+    pFont = it->second;
+  } else {
+    pFont = m_pDocument->LoadFont(pFontDict);
+    m_Fonts[pFontDict] = pFont;
+  }
+  // Glyph procedures may be run for their widths. Unlike the full parser the
+  // font bounding box is not needed, so CheckType3FontMetrics() is skipped.
+  if (pFont && pFont->GetType3Font())
+    pFont->GetType3Font()->SetPageResources(pResources);
+  return pFont;
+}
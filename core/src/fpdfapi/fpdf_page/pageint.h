@@ -40,9 +40,15 @@ class CPDF_StreamParser {
   }
   FX_DWORD GetPos() const { return m_Pos; }
   void SetPos(FX_DWORD pos) { m_Pos = pos; }
+  // Whether the last element read ran into the end of the data, so may have
+  // been cut short when the data is only part of a stream.
+  FX_BOOL IsEndOfData() const { return m_Pos >= m_Size; }
   CPDF_Object* ReadNextObject(FX_BOOL bAllowNestedArray = FALSE,
                               FX_BOOL bInArray = FALSE);
-  void SkipPathObject();
+  // Skips path construction operators. When |soft_end| is non-zero, stops
+  // after the first complete operator that ends at or past |soft_end|, and
+  // does not skip an operator that runs into the end of the data.
+  void SkipPathObject(FX_DWORD soft_end);
 
  protected:
   friend class fpdf_page_parser_old_ReadHexString_Test;
@@ -128,7 +134,16 @@ class CPDF_StreamContentParser {
   void ConvertUserSpace(FX_FLOAT& x, FX_FLOAT& y);
   void ConvertTextSpace(FX_FLOAT& x, FX_FLOAT& y);
   void OnChangeTextMatrix();
-  FX_DWORD Parse(const uint8_t* pData, FX_DWORD dwSize, FX_DWORD max_cost);
+  // Parses operators in |pData| and returns the number of bytes consumed.
+  // Stops after |max_cost| new page objects or, when |soft_end| is non-zero,
+  // at the first operator boundary at or past |soft_end|. A non-zero
+  // |soft_end| also means more data follows |pData|: an operation that runs
+  // into its end is left unparsed and NeedMoreData() is set.
+  FX_DWORD Parse(const uint8_t* pData,
+                 FX_DWORD dwSize,
+                 FX_DWORD max_cost,
+                 FX_DWORD soft_end = 0);
+  FX_BOOL NeedMoreData() const { return m_bNeedMoreData; }
   void ParsePathObject();
   void AddPathPoint(FX_FLOAT x, FX_FLOAT y, int flag);
   void AddPathRect(FX_FLOAT x, FX_FLOAT y, FX_FLOAT w, FX_FLOAT h);
@@ -245,6 +260,8 @@ class CPDF_StreamContentParser {
   FX_DWORD m_ParamStartPos;
   FX_DWORD m_ParamCount;
   CPDF_StreamParser* m_pSyntax;
+  FX_DWORD m_SoftEndPos;
+  FX_BOOL m_bNeedMoreData;
   std::unique_ptr<CPDF_AllStates> m_pCurStates;
   CPDF_ContentMark m_CurContentMark;
   CFX_ArrayTemplate<CPDF_TextObject*> m_ClipTextList;
@@ -296,6 +313,9 @@ class CPDF_ContentParser {
     STAGE_CHECKCLIP,
   };
 
+  FX_BOOL StartStreaming(const CPDF_Stream* pStream);
+  void FillStreamBuffer(FX_BOOL bNeedMore);
+
   ParseStatus m_Status;
   InternalStage m_InternalStage;
   CPDF_PageObjectList* m_pObjects;
@@ -305,6 +325,10 @@ class CPDF_ContentParser {
   FX_DWORD m_nStreams;
   std::unique_ptr<CPDF_StreamAcc> m_pSingleStream;
   std::vector<std::unique_ptr<CPDF_StreamAcc>> m_StreamArray;
+  // Set when a single large stream is decoded and parsed window by window;
+  // m_pData then holds the current window.
+  std::unique_ptr<CPDF_StreamReader> m_pStreamReader;
+  FX_DWORD m_StreamBufferSize;
   uint8_t* m_pData;
   FX_DWORD m_Size;
   FX_DWORD m_CurrentOffset;
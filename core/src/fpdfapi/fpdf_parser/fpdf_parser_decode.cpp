@@ -292,6 +292,13 @@ ICodec_ScanlineDecoder* FPDFAPI_CreateFlateDecoder(
       src_buf, src_size, width, height, nComps, bpc, predictor, Colors,
       BitsPerComponent, Columns);
 }
+FX_BOOL FPDFAPI_CheckFlateDecodeParams(const CPDF_Dictionary* pParams) {
+  if (!pParams)
+    return TRUE;
+  return CheckFlateDecodeParams(pParams->GetIntegerBy("Colors", 1),
+                                pParams->GetIntegerBy("BitsPerComponent", 8),
+                                pParams->GetIntegerBy("Columns", 1));
+}
 FX_DWORD FPDFAPI_FlateOrLZWDecode(FX_BOOL bLZW,
                                   const uint8_t* src_buf,
                                   FX_DWORD src_size,
@@ -547,6 +554,17 @@ void FlateEncode(const uint8_t* src_buf,
     pEncoders->GetFlateModule()->Encode(src_buf, src_size, dest_buf, dest_size);
   }
 }
+void FlateEncode(const uint8_t* src_buf,
+                 FX_DWORD src_size,
+                 int level,
+                 uint8_t*& dest_buf,
+                 FX_DWORD& dest_size) {
+  CCodec_ModuleMgr* pEncoders = CPDF_ModuleMgr::Get()->GetCodecModule();
+  if (pEncoders) {
+    pEncoders->GetFlateModule()->Encode(src_buf, src_size, level, dest_buf,
+                                        dest_size);
+  }
+}
 void FlateEncode(const uint8_t* src_buf,
                  FX_DWORD src_size,
                  int predictor,
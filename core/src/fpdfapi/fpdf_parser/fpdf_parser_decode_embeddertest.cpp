@@ -5,7 +5,9 @@
 #include <cstring>
 #include <string>
 
+#include "core/include/fpdfapi/fpdf_objects.h"
 #include "core/include/fpdfapi/fpdf_parser.h"
+#include "core/include/fxcodec/fx_codec.h"
 #include "core/include/fxcrt/fx_basic.h"
 #include "testing/embedder_test.h"
 #include "testing/fx_string_testhelpers.h"
@@ -95,6 +97,90 @@ TEST_F(FPDFParserDecodeEmbeddertest, FlateDecode) {
   }
 }
 
+TEST_F(FPDFParserDecodeEmbeddertest, StreamReader) {
+  const unsigned char kEncoded[] =
+      "\x78\x9c\x33\x54\x30\x00\x42\x5d\x43\x05\x23\x4b\x05\x73\x33\x63"
+      "\x85\xe4\x5c\x2e\x90\x80\xa9\xa9\xa9\x82\xb9\xb1\xa9\x42\x51\x2a"
+      "\x57\xb8\x42\x1e\x57\x21\x92\xa0\x89\x9e\xb1\xa5\x09\x92\x84\x9e"
+      "\x85\x81\x81\x25\xd8\x14\x24\x26\xd0\x18\x43\x05\x10\x0c\x72\x57"
+      "\x80\x30\x8a\xd2\xb9\xf4\xdd\x0d\x14\xd2\x8b\xc1\x46\x99\x59\x1a"
+      "\x2b\x58\x1a\x9a\x83\x8c\x49\xe3\x0a\x04\x42\x00\x37\x4c\x1b\x42";
+  const char kDecoded[] =
+      "1 0 0 -1 29 763 cm\n0 0 555 735 re\nW n\nq\n0 0 555 734.394 re\n"
+      "W n\nq\n0.8009 0 0 0.8009 0 0 cm\n1 1 1 RG 1 1 1 rg\n/G0 gs\n"
+      "0 0 693 917 re\nf\nQ\nQ\n";
+
+  {
+    // Unfiltered streams are returned as is.
+    uint8_t* buf = FX_Alloc(uint8_t, sizeof(kDecoded) - 1);
+    FXSYS_memcpy(buf, kDecoded, sizeof(kDecoded) - 1);
+    CPDF_Stream* stream =
+        new CPDF_Stream(buf, sizeof(kDecoded) - 1, new CPDF_Dictionary);
+    CPDF_StreamReader reader;
+    ASSERT_TRUE(reader.Load(stream));
+    uint8_t block[256];
+    EXPECT_EQ(sizeof(kDecoded) - 1, reader.ReadBlock(block, sizeof(block)));
+    EXPECT_TRUE(reader.IsEOF());
+    EXPECT_EQ(std::string(kDecoded), std::string((const char*)block,
+                                                 sizeof(kDecoded) - 1));
+    stream->Release();
+  }
+
+  {
+    // Flate streams are decoded in small blocks.
+    uint8_t* buf = FX_Alloc(uint8_t, sizeof(kEncoded) - 1);
+    FXSYS_memcpy(buf, kEncoded, sizeof(kEncoded) - 1);
+    CPDF_Dictionary* dict = new CPDF_Dictionary;
+    dict->SetAtName("Filter", "FlateDecode");
+    CPDF_Stream* stream = new CPDF_Stream(buf, sizeof(kEncoded) - 1, dict);
+    CPDF_StreamReader reader;
+    ASSERT_TRUE(reader.Load(stream));
+    std::string result;
+    uint8_t block[7];
+    while (!reader.IsEOF()) {
+      FX_DWORD size = reader.ReadBlock(block, sizeof(block));
+      result.append((const char*)block, size);
+    }
+    EXPECT_EQ(std::string(kDecoded), result);
+    EXPECT_EQ(0u, reader.ReadBlock(block, sizeof(block)));
+    stream->Release();
+  }
+
+  {
+    // Filter chains and predictors need CPDF_StreamAcc.
+    CPDF_Dictionary* dict = new CPDF_Dictionary;
+    CPDF_Array* filters = new CPDF_Array;
+    filters->AddName("ASCIIHexDecode");
+    filters->AddName("FlateDecode");
+    dict->SetAt("Filter", filters);
+    CPDF_Stream* stream = new CPDF_Stream(nullptr, 0, dict);
+    CPDF_StreamReader reader;
+    EXPECT_FALSE(reader.Load(stream));
+    stream->Release();
+
+    dict = new CPDF_Dictionary;
+    dict->SetAtName("Filter", "FlateDecode");
+    CPDF_Dictionary* params = new CPDF_Dictionary;
+    params->SetAtInteger("Predictor", 12);
+    dict->SetAt("DecodeParms", params);
+    stream = new CPDF_Stream(nullptr, 0, dict);
+    CPDF_StreamReader reader2;
+    EXPECT_FALSE(reader2.Load(stream));
+    stream->Release();
+
+    // So do invalid parameters, for which the raw data is used.
+    dict = new CPDF_Dictionary;
+    dict->SetAtName("Filter", "FlateDecode");
+    params = new CPDF_Dictionary;
+    params->SetAtInteger("Columns", -1);
+    dict->SetAt("DecodeParms", params);
+    stream = new CPDF_Stream(nullptr, 0, dict);
+    CPDF_StreamReader reader3;
+    EXPECT_FALSE(reader3.Load(stream));
+    stream->Release();
+  }
+}
+
 TEST_F(FPDFParserDecodeEmbeddertest, Bug_552046) {
   // Tests specifying multiple image filters for a stream. Should not cause a
   // crash when rendered.
@@ -116,3 +202,27 @@ TEST_F(FPDFParserDecodeEmbeddertest, Bug_555784) {
 }
 
 #undef TEST_CASE
+
+TEST_F(FPDFParserDecodeEmbeddertest, FlateEncodeLevels) {
+  std::string input;
+  for (int i = 0; i < 2000; ++i)
+    input += "0 0 m " + std::to_string(i % 97) + " 10 l S\n";
+  const uint8_t* src = reinterpret_cast<const uint8_t*>(input.data());
+  FX_DWORD sizes[2];
+  const int levels[2] = {FXCODEC_FLATE_LEVEL_FAST, FXCODEC_FLATE_LEVEL_MAX};
+  for (int i = 0; i < 2; ++i) {
+    uint8_t* encoded = nullptr;
+    FX_DWORD encoded_size = 0;
+    FlateEncode(src, input.size(), levels[i], encoded, encoded_size);
+    ASSERT_TRUE(encoded);
+    sizes[i] = encoded_size;
+
+    uint8_t* decoded = nullptr;
+    FX_DWORD decoded_size = 0;
+    FlateDecode(encoded, encoded_size, decoded, decoded_size);
+    EXPECT_EQ(input, std::string((const char*)decoded, decoded_size));
+    FX_Free(decoded);
+    FX_Free(encoded);
+  }
+  EXPECT_LE(sizes[1], sizes[0]);
+}
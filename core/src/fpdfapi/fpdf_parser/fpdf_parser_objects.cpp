@@ -8,7 +8,9 @@
 
 #include <algorithm>
 
+#include "core/include/fpdfapi/fpdf_module.h"
 #include "core/include/fpdfapi/fpdf_parser.h"
+#include "core/include/fxcodec/fx_codec.h"
 #include "core/include/fxcrt/fx_string.h"
 #include "third_party/base/stl_util.h"
 
@@ -355,13 +357,16 @@ FX_BOOL CPDF_Dictionary::KeyExist(const CFX_ByteStringC& key) const {
 }
 
 void CPDF_Dictionary::SetAt(const CFX_ByteStringC& key, CPDF_Object* pObj) {
+  SetAtSharedKey(key, pObj);
+}
+
+void CPDF_Dictionary::SetAtSharedKey(const CFX_ByteString& key,
+                                     CPDF_Object* pObj) {
   ASSERT(IsDictionary());
-  // Avoid 2 constructions of CFX_ByteString.
-  CFX_ByteString key_bytestring = key;
-  auto it = m_Map.find(key_bytestring);
+  auto it = m_Map.find(key);
   if (it == m_Map.end()) {
     if (pObj) {
-      m_Map.insert(std::make_pair(key_bytestring, pObj));
+      m_Map.insert(std::make_pair(key, pObj));
     }
     return;
   }
@@ -665,6 +670,106 @@ uint8_t* CPDF_StreamAcc::DetachData() {
   return p;
 }
 
+CPDF_StreamReader::CPDF_StreamReader()
+    : m_pStream(nullptr), m_pRawBuf(nullptr), m_RawPos(0), m_bEOF(TRUE) {}
+
+CPDF_StreamReader::~CPDF_StreamReader() {
+  FX_Free(m_pRawBuf);
+}
+
+FX_BOOL CPDF_StreamReader::Load(const CPDF_Stream* pStream) {
+  if (!pStream || m_pStream)
+    return FALSE;
+
+  CPDF_Dictionary* pDict = pStream->GetDict();
+  CPDF_Object* pFilter = pDict ? pDict->GetElementValue("Filter") : nullptr;
+  if (pFilter) {
+    CFX_ByteString decoder;
+    CPDF_Object* pParams = pDict->GetElementValue("DecodeParms");
+    CPDF_Dictionary* pParam = nullptr;
+    if (CPDF_Array* pFilters = pFilter->AsArray()) {
+      if (pFilters->GetCount() != 1)
+        return FALSE;
+      decoder = pFilters->GetStringAt(0);
+      CPDF_Array* pParamsArray = ToArray(pParams);
+      pParam = pParamsArray ? pParamsArray->GetDictAt(0) : nullptr;
+    } else if (pFilter->IsName()) {
+      decoder = pFilter->GetString();
+      pParam = pParams ? pParams->GetDict() : nullptr;
+    } else {
+      return FALSE;
+    }
+    if (decoder != "FlateDecode" && decoder != "Fl")
+      return FALSE;
+
+    // Predictors work on whole rows of the decoded data, see
+    // CCodec_FlateModule::FlateOrLZWDecode().
+    int predictor = pParam ? pParam->GetIntegerBy("Predictor") : 0;
+    if (predictor == 2 || predictor >= 10)
+      return FALSE;
+
+    // CPDF_StreamAcc keeps the raw data of streams it fails to decode.
+    if (!FPDFAPI_CheckFlateDecodeParams(pParam))
+      return FALSE;
+
+    m_pDecoder.reset(
+        CPDF_ModuleMgr::Get()->GetFlateModule()->CreateStreamDecoder());
+    if (!m_pDecoder)
+      return FALSE;
+  }
+  m_pStream = pStream;
+  m_RawPos = 0;
+  m_bEOF = pStream->GetRawSize() == 0;
+  if (!pStream->IsMemoryBased())
+    m_pRawBuf = FX_Alloc(uint8_t, kRawBlockSize);
+  return TRUE;
+}
+
+FX_DWORD CPDF_StreamReader::ReadRawBlock(uint8_t* pBuf, FX_DWORD size) {
+  FX_DWORD dwRead = std::min(size, m_pStream->GetRawSize() - m_RawPos);
+  if (dwRead && !m_pStream->ReadRawData(m_RawPos, pBuf, dwRead))
+    dwRead = 0;
+  m_RawPos = dwRead ? m_RawPos + dwRead : m_pStream->GetRawSize();
+  return dwRead;
+}
+
+FX_BOOL CPDF_StreamReader::FeedDecoder() {
+  if (m_RawPos >= m_pStream->GetRawSize())
+    return FALSE;
+
+  if (m_pStream->IsMemoryBased()) {
+    m_pDecoder->Input(m_pStream->GetRawData(), m_pStream->GetRawSize());
+    m_RawPos = m_pStream->GetRawSize();
+    return TRUE;
+  }
+  FX_DWORD dwRead = ReadRawBlock(m_pRawBuf, kRawBlockSize);
+  if (dwRead == 0)
+    return FALSE;
+
+  m_pDecoder->Input(m_pRawBuf, dwRead);
+  return TRUE;
+}
+
+FX_DWORD CPDF_StreamReader::ReadBlock(uint8_t* pBuf, FX_DWORD size) {
+  FX_DWORD dwTotal = 0;
+  if (!m_pDecoder) {
+    if (!m_bEOF)
+      dwTotal = ReadRawBlock(pBuf, size);
+    m_bEOF = m_RawPos >= m_pStream->GetRawSize();
+    return dwTotal;
+  }
+  while (dwTotal < size && !m_bEOF) {
+    FX_BOOL bHasInput = TRUE;
+    if (m_pDecoder->NeedsInput())
+      bHasInput = FeedDecoder();
+    FX_DWORD dwRead = m_pDecoder->ReadBlock(pBuf + dwTotal, size - dwTotal);
+    dwTotal += dwRead;
+    if (m_pDecoder->IsEOF() || (dwRead == 0 && !bHasInput))
+      m_bEOF = TRUE;
+  }
+  return dwTotal;
+}
+
 CPDF_Object* CPDF_Reference::Clone(FX_BOOL bDirect) const {
   if (bDirect) {
     auto* pDirect = GetDirect();
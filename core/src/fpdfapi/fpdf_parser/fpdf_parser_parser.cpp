@@ -73,6 +73,18 @@ int32_t GetStreamFirst(CPDF_StreamAcc* pObjStream) {
   return pObjStream->GetDict()->GetIntegerBy("First");
 }
 
+// Decodes a name, without its slash, sharing one buffer per distinct name
+// among the objects of |pObjList|.
+CFX_ByteString DecodeName(const CFX_ByteStringC& name,
+                          CPDF_IndirectObjectHolder* pObjList) {
+  if (!pObjList)
+    return PDF_NameDecode(name);
+  CFX_ByteStringPool* pPool = pObjList->GetStringPool();
+  if (!FXSYS_memchr(name.GetPtr(), '#', name.GetLength()))
+    return pPool->Intern(name);
+  return pPool->Intern(PDF_NameDecode(name));
+}
+
 bool CanReadFromBitStream(const CFX_BitStream* hStream,
                           const FX_SAFE_DWORD& num_bits) {
   return (num_bits.IsValid() &&
@@ -1944,22 +1956,25 @@ CPDF_Object* CPDF_SyntaxParser::GetObject(CPDF_IndirectObjectHolder* pObjList,
   }
   FX_FILESIZE SavedPos = m_Pos;
   bool bIsNumber;
-  CFX_ByteString word = GetNextWord(&bIsNumber);
-  if (word.GetLength() == 0) {
+  GetNextWordInternal(&bIsNumber);
+  if (m_WordSize == 0) {
     return nullptr;
   }
+  // Only valid until the next word is read.
+  CFX_ByteStringC word(m_WordBuffer, m_WordSize);
   if (bIsNumber) {
+    CFX_ByteString number(word);
     FX_FILESIZE SavedPos = m_Pos;
     CFX_ByteString nextword = GetNextWord(&bIsNumber);
     if (bIsNumber) {
       CFX_ByteString nextword2 = GetNextWord(nullptr);
       if (nextword2 == "R") {
-        FX_DWORD objnum = FXSYS_atoi(word);
+        FX_DWORD objnum = FXSYS_atoi(number);
         return new CPDF_Reference(pObjList, objnum);
       }
     }
     m_Pos = SavedPos;
-    return new CPDF_Number(word);
+    return new CPDF_Number(number);
   }
   if (word == "true" || word == "false") {
     return new CPDF_Boolean(word == "true");
@@ -1990,7 +2005,8 @@ CPDF_Object* CPDF_SyntaxParser::GetObject(CPDF_IndirectObjectHolder* pObjList,
   }
   if (word[0] == '/') {
     return new CPDF_Name(
-        PDF_NameDecode(CFX_ByteStringC(m_WordBuffer + 1, m_WordSize - 1)));
+        DecodeName(CFX_ByteStringC(m_WordBuffer + 1, m_WordSize - 1),
+                   pObjList));
   }
   if (word == "<<") {
     int32_t nKeys = 0;
@@ -1998,35 +2014,33 @@ CPDF_Object* CPDF_SyntaxParser::GetObject(CPDF_IndirectObjectHolder* pObjList,
     std::unique_ptr<CPDF_Dictionary, ReleaseDeleter<CPDF_Dictionary>> pDict(
         new CPDF_Dictionary);
     while (1) {
-      CFX_ByteString key = GetNextWord(nullptr);
-      if (key.IsEmpty())
+      GetNextWordInternal(nullptr);
+      CFX_ByteStringC token(m_WordBuffer, m_WordSize);
+      if (token.IsEmpty())
         return nullptr;
 
-      FX_FILESIZE SavedPos = m_Pos - key.GetLength();
-      if (key == ">>")
+      FX_FILESIZE SavedPos = m_Pos - token.GetLength();
+      if (token == ">>")
         break;
 
-      if (key == "endobj") {
+      if (token == "endobj") {
         m_Pos = SavedPos;
         break;
       }
-      if (key[0] != '/')
+      if (token[0] != '/')
         continue;
 
       ++nKeys;
-      key = PDF_NameDecode(key);
-      if (key.IsEmpty())
-        continue;
-
-      if (key == "/Contents")
+      CFX_ByteString key = DecodeName(
+          CFX_ByteStringC(m_WordBuffer + 1, m_WordSize - 1), pObjList);
+      if (key == "Contents")
         dwSignValuePos = m_Pos;
 
       CPDF_Object* pObj = GetObject(pObjList, objnum, gennum, true);
       if (!pObj)
         continue;
 
-      CFX_ByteStringC keyNoSlash(key.c_str() + 1, key.GetLength() - 1);
-      pDict->SetAt(keyNoSlash, pObj);
+      pDict->SetAtSharedKey(key, pObj);
     }
 
     // Only when this is a signature dictionary and has contents, we reset the
@@ -2060,21 +2074,24 @@ CPDF_Object* CPDF_SyntaxParser::GetObjectByStrict(
   }
   FX_FILESIZE SavedPos = m_Pos;
   bool bIsNumber;
-  CFX_ByteString word = GetNextWord(&bIsNumber);
-  if (word.GetLength() == 0) {
+  GetNextWordInternal(&bIsNumber);
+  if (m_WordSize == 0) {
     return nullptr;
   }
+  // Only valid until the next word is read.
+  CFX_ByteStringC word(m_WordBuffer, m_WordSize);
   if (bIsNumber) {
+    CFX_ByteString number(word);
     FX_FILESIZE SavedPos = m_Pos;
     CFX_ByteString nextword = GetNextWord(&bIsNumber);
     if (bIsNumber) {
       CFX_ByteString nextword2 = GetNextWord(nullptr);
       if (nextword2 == "R") {
-        return new CPDF_Reference(pObjList, FXSYS_atoi(word));
+        return new CPDF_Reference(pObjList, FXSYS_atoi(number));
       }
     }
     m_Pos = SavedPos;
-    return new CPDF_Number(word);
+    return new CPDF_Number(number);
   }
   if (word == "true" || word == "false") {
     return new CPDF_Boolean(word == "true");
@@ -2104,28 +2121,31 @@ CPDF_Object* CPDF_SyntaxParser::GetObjectByStrict(
   }
   if (word[0] == '/') {
     return new CPDF_Name(
-        PDF_NameDecode(CFX_ByteStringC(m_WordBuffer + 1, m_WordSize - 1)));
+        DecodeName(CFX_ByteStringC(m_WordBuffer + 1, m_WordSize - 1),
+                   pObjList));
   }
   if (word == "<<") {
     std::unique_ptr<CPDF_Dictionary, ReleaseDeleter<CPDF_Dictionary>> pDict(
         new CPDF_Dictionary);
     while (1) {
       FX_FILESIZE SavedPos = m_Pos;
-      CFX_ByteString key = GetNextWord(nullptr);
-      if (key.IsEmpty())
+      GetNextWordInternal(nullptr);
+      CFX_ByteStringC token(m_WordBuffer, m_WordSize);
+      if (token.IsEmpty())
         return nullptr;
 
-      if (key == ">>")
+      if (token == ">>")
         break;
 
-      if (key == "endobj") {
+      if (token == "endobj") {
         m_Pos = SavedPos;
         break;
       }
-      if (key[0] != '/')
+      if (token[0] != '/')
         continue;
 
-      key = PDF_NameDecode(key);
+      CFX_ByteString key = DecodeName(
+          CFX_ByteStringC(m_WordBuffer + 1, m_WordSize - 1), pObjList);
       std::unique_ptr<CPDF_Object, ReleaseDeleter<CPDF_Object>> obj(
           GetObject(pObjList, objnum, gennum, true));
       if (!obj) {
@@ -2134,10 +2154,8 @@ CPDF_Object* CPDF_SyntaxParser::GetObjectByStrict(
         }
         return nullptr;
       }
-      if (key.GetLength() > 1) {
-        pDict->SetAt(CFX_ByteStringC(key.c_str() + 1, key.GetLength() - 1),
-                     obj.release());
-      }
+      if (!key.IsEmpty())
+        pDict->SetAtSharedKey(key, obj.release());
     }
     FX_FILESIZE SavedPos = m_Pos;
     CFX_ByteString nextword = GetNextWord(nullptr);
@@ -6,6 +6,11 @@
 
 #include "render_int.h"
 
+#include <limits.h>
+
+#include <algorithm>
+#include <utility>
+
 #include "core/include/fpdfapi/fpdf_module.h"
 #include "core/include/fpdfapi/fpdf_render.h"
 #include "core/include/fxge/fx_ge.h"
@@ -119,7 +124,8 @@ CPDF_RenderOptions::CPDF_RenderOptions()
       m_AddFlags(0),
       m_pOCContext(NULL),
       m_dwLimitCacheSize(1024 * 1024 * 100),
-      m_HalftoneLimit(-1) {}
+      m_HalftoneLimit(-1),
+      m_dwDisplayListStamp(0) {}
 FX_ARGB CPDF_RenderOptions::TranslateColor(FX_ARGB argb) const {
   if (m_ColorMode == RENDER_COLOR_NORMAL) {
     return argb;
@@ -246,6 +252,25 @@ void CPDF_RenderStatus::RenderObjectList(const CPDF_PageObjectList* pObjs,
   CFX_Matrix device2object;
   device2object.SetReverse(*pObj2Device);
   device2object.TransformRect(clip_rect);
+  const CPDF_DisplayList* pDisplayList =
+      m_pContext->GetDisplayList(pObjs, &m_Options);
+  if (pDisplayList && !m_pStopObj) {
+    std::vector<int> visible;
+    pDisplayList->Query(clip_rect, &visible);
+    for (int i : visible) {
+      CPDF_PageObject* pCurObj = pDisplayList->GetObject(i);
+      if (pCurObj->m_Left > clip_rect.right ||
+          pCurObj->m_Right < clip_rect.left ||
+          pCurObj->m_Bottom > clip_rect.top ||
+          pCurObj->m_Top < clip_rect.bottom) {
+        continue;
+      }
+      RenderSingleObject(pCurObj, pObj2Device);
+      if (m_bStopped)
+        return;
+    }
+    return;
+  }
   int index = 0;
   FX_POSITION pos = pObjs->GetFirstObjectPosition();
   while (pos) {
@@ -812,32 +837,36 @@ FX_BOOL CPDF_RenderStatus::ProcessTransparency(const CPDF_PageObject* pPageObj,
   FX_FLOAT scaleY = FXSYS_fabs(deviceCTM.d);
   int width = FXSYS_round((FX_FLOAT)rect.Width() * scaleX);
   int height = FXSYS_round((FX_FLOAT)rect.Height() * scaleY);
-  CFX_FxgeDevice bitmap_device;
-  std::unique_ptr<CFX_DIBitmap> oriDevice;
+  CPDF_ScratchBitmapPool* pPool = m_pContext->GetScratchBitmapPool();
+  CPDF_ScratchBitmap backdrop;
+  CFX_DIBitmap* oriDevice = NULL;
   if (!isolated && (m_pDevice->GetRenderCaps() & FXRC_GET_BITS)) {
-    oriDevice.reset(new CFX_DIBitmap);
-    if (!m_pDevice->CreateCompatibleBitmap(oriDevice.get(), width, height))
+    oriDevice = backdrop.Create(pPool, width, height,
+                                m_pDevice->GetCompatibleFormat());
+    if (!oriDevice)
       return TRUE;
 
-    m_pDevice->GetDIBits(oriDevice.get(), rect.left, rect.top);
+    m_pDevice->GetDIBits(oriDevice, rect.left, rect.top);
   }
-  if (!bitmap_device.Create(width, height, FXDIB_Argb, 0, oriDevice.get()))
+  CPDF_ScratchBitmap group;
+  CFX_DIBitmap* bitmap = group.Create(pPool, width, height, FXDIB_Argb);
+  if (!bitmap)
     return TRUE;
 
-  CFX_DIBitmap* bitmap = bitmap_device.GetBitmap();
-  bitmap->Clear(0);
+  CFX_FxgeDevice bitmap_device;
+  bitmap_device.Attach(bitmap, 0, FALSE, oriDevice);
   CFX_Matrix new_matrix = *pObj2Device;
   new_matrix.TranslateI(-rect.left, -rect.top);
   new_matrix.Scale(scaleX, scaleY);
-  std::unique_ptr<CFX_DIBitmap> pTextMask;
+  CPDF_ScratchBitmap text_mask;
+  CFX_DIBitmap* pTextMask = NULL;
   if (bTextClip) {
-    pTextMask.reset(new CFX_DIBitmap);
-    if (!pTextMask->Create(width, height, FXDIB_8bppMask))
+    pTextMask = text_mask.Create(pPool, width, height, FXDIB_8bppMask);
+    if (!pTextMask)
       return TRUE;
 
-    pTextMask->Clear(0);
     CFX_FxgeDevice text_device;
-    text_device.Attach(pTextMask.get());
+    text_device.Attach(pTextMask);
     for (FX_DWORD i = 0; i < pPageObj->m_ClipPath.GetTextCount(); i++) {
       CPDF_TextObject* textobj = pPageObj->m_ClipPath.GetText(i);
       if (!textobj) {
@@ -863,15 +892,12 @@ FX_BOOL CPDF_RenderStatus::ProcessTransparency(const CPDF_PageObject* pPageObj,
     FXSYS_memcpy(&smask_matrix, pGeneralState->m_SMaskMatrix,
                  sizeof smask_matrix);
     smask_matrix.Concat(*pObj2Device);
-    std::unique_ptr<CFX_DIBSource> pSMaskSource(
-        LoadSMask(pSMaskDict, &rect, &smask_matrix));
-    if (pSMaskSource)
-      bitmap->MultiplyAlpha(pSMaskSource.get());
-  }
-  if (pTextMask) {
-    bitmap->MultiplyAlpha(pTextMask.get());
-    pTextMask.reset();
+    CFX_DIBitmapRef smask = LoadSMask(pSMaskDict, &rect, &smask_matrix);
+    if (smask.NotNull())
+      bitmap->MultiplyAlpha(smask.GetObject());
   }
+  if (pTextMask)
+    bitmap->MultiplyAlpha(pTextMask);
   if (Transparency & PDFTRANS_GROUP && group_alpha != 1.0f) {
     bitmap->MultiplyAlpha((int32_t)(group_alpha * 255));
   }
@@ -963,14 +989,16 @@ CPDF_RenderContext::CPDF_RenderContext(CPDF_Page* pPage)
     : m_pDocument(pPage->m_pDocument),
       m_pPageResources(pPage->m_pPageResources),
       m_pPageCache(pPage->GetRenderCache()),
-      m_bFirstLayer(TRUE) {}
+      m_bFirstLayer(TRUE),
+      m_pScratchBitmaps(new CPDF_ScratchBitmapPool) {}
 
 CPDF_RenderContext::CPDF_RenderContext(CPDF_Document* pDoc,
                                        CPDF_PageRenderCache* pPageCache)
     : m_pDocument(pDoc),
       m_pPageResources(nullptr),
       m_pPageCache(pPageCache),
-      m_bFirstLayer(TRUE) {}
+      m_bFirstLayer(TRUE),
+      m_pScratchBitmaps(new CPDF_ScratchBitmapPool) {}
 
 CPDF_RenderContext::~CPDF_RenderContext() {}
 
@@ -984,6 +1012,13 @@ void CPDF_RenderContext::AppendLayer(CPDF_PageObjectList* pObjs,
     pLayer->m_Matrix.SetIdentity();
   }
 }
+const CPDF_DisplayList* CPDF_RenderContext::GetDisplayList(
+    const CPDF_PageObjectList* pObjs,
+    const CPDF_RenderOptions* pOptions) {
+  if (!m_pPageCache || !pOptions || !pOptions->m_dwDisplayListStamp)
+    return nullptr;
+  return m_pPageCache->GetDisplayList(pObjs, pOptions->m_dwDisplayListStamp);
+}
 void CPDF_RenderContext::Render(CFX_RenderDevice* pDevice,
                                 const CPDF_RenderOptions* pOptions,
                                 const CFX_Matrix* pLastMatrix) {
@@ -1040,7 +1075,8 @@ CPDF_ProgressiveRenderer::CPDF_ProgressiveRenderer(
       m_LayerIndex(0),
       m_ObjectIndex(0),
       m_ObjectPos(nullptr),
-      m_PrevLastPos(nullptr) {
+      m_PrevLastPos(nullptr),
+      m_VisibleIndex(0) {
 }
 
 CPDF_ProgressiveRenderer::~CPDF_ProgressiveRenderer() {
@@ -1104,6 +1140,19 @@ void CPDF_ProgressiveRenderer::Continue(IFX_Pause* pPause) {
       CFX_Matrix device2object;
       device2object.SetReverse(pLayer->m_Matrix);
       device2object.TransformRect(m_ClipRect);
+      m_VisibleObjects.clear();
+      m_VisibleIndex = 0;
+      const CPDF_DisplayList* pDisplayList =
+          m_pContext->GetDisplayList(pLayer->m_pObjectList, m_pOptions);
+      if (pDisplayList) {
+        std::vector<int> visible;
+        pDisplayList->Query(m_ClipRect, &visible);
+        for (int i : visible) {
+          m_VisibleObjects.push_back(
+              std::make_pair((FX_DWORD)i, pDisplayList->GetPosition(i)));
+        }
+        m_ObjectPos = NextVisibleObject();
+      }
     }
     int objs_to_go = CPDF_ModuleMgr::Get()
                          ->GetRenderModule()
@@ -1133,7 +1182,10 @@ void CPDF_ProgressiveRenderer::Continue(IFX_Pause* pPause) {
         }
       }
       m_ObjectIndex++;
-      pLayer->m_pObjectList->GetNextObject(m_ObjectPos);
+      if (m_VisibleObjects.empty())
+        pLayer->m_pObjectList->GetNextObject(m_ObjectPos);
+      else
+        m_ObjectPos = NextVisibleObject();
       if (objs_to_go == 0) {
         if (pPause && pPause->NeedToPauseNow()) {
           return;
@@ -1158,6 +1210,12 @@ void CPDF_ProgressiveRenderer::Continue(IFX_Pause* pPause) {
   }
   m_Status = Done;
 }
+FX_POSITION CPDF_ProgressiveRenderer::NextVisibleObject() {
+  if (m_VisibleIndex >= m_VisibleObjects.size())
+    return nullptr;
+  m_ObjectIndex = m_VisibleObjects[m_VisibleIndex].first;
+  return m_VisibleObjects[m_VisibleIndex++].second;
+}
 int CPDF_ProgressiveRenderer::EstimateProgress() {
   if (!m_pContext) {
     return 0;
@@ -1389,6 +1447,141 @@ void CPDF_ScaledRenderBuffer::OutputToDevice() {
                              m_Rect.top, m_Rect.Width(), m_Rect.Height());
   }
 }
+
+namespace {
+
+// Pooled buffers are rounded up to this many pixels each way.
+const int kScratchBitmapGranularity = 32;
+
+// Idle buffers beyond this are freed, oldest first.
+const size_t kMaxIdleScratchBytes = 32 * 1024 * 1024;
+
+int RoundUpScratchSize(int size) {
+  return (size + kScratchBitmapGranularity - 1) /
+         kScratchBitmapGranularity * kScratchBitmapGranularity;
+}
+
+size_t GetScratchBytes(const CFX_DIBitmap* pBitmap) {
+  return static_cast<size_t>(pBitmap->GetPitch()) * pBitmap->GetHeight();
+}
+
+}  // namespace
+
+CPDF_ScratchBitmapPool::CPDF_ScratchBitmapPool()
+    : m_nIdleBytes(0), m_nLeases(0), m_nReuses(0) {}
+
+CPDF_ScratchBitmapPool::~CPDF_ScratchBitmapPool() {}
+
+// static
+FX_BOOL CPDF_ScratchBitmapPool::IsPoolable(FXDIB_Format format) {
+  return format == FXDIB_Argb || format == FXDIB_Rgb32 ||
+         format == FXDIB_Rgb || format == FXDIB_8bppMask;
+}
+
+CPDF_ScratchBitmapPool::Buffer* CPDF_ScratchBitmapPool::Take(
+    int width,
+    int height,
+    FXDIB_Format format,
+    FX_BOOL bZeroed) {
+  int bucket_width = RoundUpScratchSize(width);
+  int bucket_height = RoundUpScratchSize(height);
+  // Do not spend a big buffer on a small bitmap.
+  double max_area = 2.0 * bucket_width * bucket_height;
+  size_t best = m_Idle.size();
+  double best_area = 0;
+  for (size_t i = 0; i < m_Idle.size(); i++) {
+    const CFX_DIBitmap* pBitmap = m_Idle[i]->m_pBitmap.get();
+    if (pBitmap->GetFormat() != format || pBitmap->GetWidth() < width ||
+        pBitmap->GetHeight() < height) {
+      continue;
+    }
+    double area = static_cast<double>(pBitmap->GetWidth()) *
+                  pBitmap->GetHeight();
+    if (area <= max_area && (best == m_Idle.size() || area < best_area)) {
+      best = i;
+      best_area = area;
+    }
+  }
+  Buffer* pBuffer;
+  if (best < m_Idle.size()) {
+    pBuffer = m_Idle[best].release();
+    m_Idle.erase(m_Idle.begin() + best);
+    m_nIdleBytes -= GetScratchBytes(pBuffer->m_pBitmap.get());
+    m_nReuses++;
+    if (bZeroed) {
+      CFX_DIBitmap* pBitmap = pBuffer->m_pBitmap.get();
+      int rows = std::min(height, pBuffer->m_DirtyHeight);
+      int row_bytes = std::min(width, pBuffer->m_DirtyWidth) *
+                      pBitmap->GetBPP() / 8;
+      for (int row = 0; row < rows && row_bytes > 0; row++)
+        FXSYS_memset(pBitmap->GetBuffer() + row * pBitmap->GetPitch(), 0,
+                     row_bytes);
+    }
+  } else {
+    std::unique_ptr<CFX_DIBitmap> pBitmap(new CFX_DIBitmap);
+    if (!pBitmap->Create(bucket_width, bucket_height, format))
+      return nullptr;
+    pBuffer = new Buffer;
+    pBuffer->m_pBitmap = std::move(pBitmap);
+    pBuffer->m_DirtyWidth = 0;
+    pBuffer->m_DirtyHeight = 0;
+  }
+  m_nLeases++;
+  // A caller filling the bitmap itself may write whole rows of the buffer,
+  // see CFX_DIBitmap::Clear().
+  pBuffer->m_DirtyWidth =
+      bZeroed ? std::max(width, pBuffer->m_DirtyWidth)
+              : pBuffer->m_pBitmap->GetWidth();
+  pBuffer->m_DirtyHeight = std::max(height, pBuffer->m_DirtyHeight);
+  return pBuffer;
+}
+
+void CPDF_ScratchBitmapPool::Return(Buffer* pBuffer) {
+  std::unique_ptr<Buffer> pOwned(pBuffer);
+  size_t size = GetScratchBytes(pBuffer->m_pBitmap.get());
+  if (size > kMaxIdleScratchBytes)
+    return;
+  size_t nDrop = 0;
+  while (m_nIdleBytes + size > kMaxIdleScratchBytes) {
+    m_nIdleBytes -= GetScratchBytes(m_Idle[nDrop]->m_pBitmap.get());
+    nDrop++;
+  }
+  m_Idle.erase(m_Idle.begin(), m_Idle.begin() + nDrop);
+  m_Idle.push_back(std::move(pOwned));
+  m_nIdleBytes += size;
+}
+
+CPDF_ScratchBitmap::CPDF_ScratchBitmap()
+    : m_pPool(nullptr), m_pBuffer(nullptr) {}
+
+CPDF_ScratchBitmap::~CPDF_ScratchBitmap() {
+  if (m_pBuffer)
+    m_pPool->Return(m_pBuffer);
+}
+
+CFX_DIBitmap* CPDF_ScratchBitmap::Create(CPDF_ScratchBitmapPool* pPool,
+                                         int width,
+                                         int height,
+                                         FXDIB_Format format,
+                                         FX_BOOL bZeroed) {
+  if (width <= 0 || height <= 0)
+    return nullptr;
+  if (!pPool || !CPDF_ScratchBitmapPool::IsPoolable(format) ||
+      width > INT_MAX - kScratchBitmapGranularity ||
+      height > INT_MAX - kScratchBitmapGranularity) {
+    FX_BOOL bRet = bZeroed ? m_View.Create(width, height, format)
+                           : m_View.CreateUninit(width, height, format);
+    return bRet ? &m_View : nullptr;
+  }
+  m_pBuffer = pPool->Take(width, height, format, bZeroed);
+  if (!m_pBuffer)
+    return nullptr;
+  m_pPool = pPool;
+  CFX_DIBitmap* pBitmap = m_pBuffer->m_pBitmap.get();
+  m_View.Create(width, height, format, pBitmap->GetBuffer(),
+                pBitmap->GetPitch());
+  return &m_View;
+}
 FX_BOOL IPDF_OCContext::CheckObjectVisible(const CPDF_PageObject* pObj) {
   const CPDF_ContentMarkData* pData = pObj->m_ContentMark;
   int nItems = pData->CountItems();
@@ -6,6 +6,10 @@
 
 #include "render_int.h"
 
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
 #include "core/include/fpdfapi/fpdf_pageobj.h"
 #include "core/include/fpdfapi/fpdf_render.h"
 #include "core/include/fxge/fx_ge.h"
@@ -14,8 +18,75 @@
 struct CACHEINFO {
   FX_DWORD time;
   CPDF_Stream* pStream;
+  // Set instead of |pStream| for soft masks and pattern cells.
+  const CPDF_PageRenderCache::SMaskKey* pSMaskKey;
+  const CPDF_PageRenderCache::PatternKey* pPatternKey;
 };
 
+namespace {
+
+// Soft masks are keyed by device matrix, so zooming keeps adding them; past
+// this many bytes the oldest are dropped even without a cache limit.
+const FX_DWORD kMaxSMaskCacheSize = 16 * 1024 * 1024;
+// Likewise for pattern cells.
+const FX_DWORD kMaxPatternCacheSize = 16 * 1024 * 1024;
+
+FX_DWORD GetBitmapSize(const CFX_DIBitmap* pBitmap) {
+  return (FX_DWORD)pBitmap->GetHeight() * pBitmap->GetPitch();
+}
+
+// Average number of objects per CPDF_DisplayList cell.
+const int kObjectsPerGridCell = 4;
+const int kMaxGridDimension = 256;
+// Objects spanning more cells than this, like backgrounds, are not bucketed.
+const int kMaxCellsPerObject = 64;
+// Walking shorter lists costs less than keeping a display list for them.
+const FX_DWORD kMinDisplayListObjects = 32;
+
+FX_BOOL IsFiniteRect(const CFX_FloatRect& rect) {
+  return std::isfinite(rect.left) && std::isfinite(rect.right) &&
+         std::isfinite(rect.bottom) && std::isfinite(rect.top);
+}
+
+// The bounds renderers cull by. Inverted ones are left to them as well.
+FX_BOOL GetUsableBounds(const CPDF_PageObject* pObj, CFX_FloatRect* pBounds) {
+  *pBounds = CFX_FloatRect(pObj->m_Left, pObj->m_Bottom, pObj->m_Right,
+                           pObj->m_Top);
+  return IsFiniteRect(*pBounds) && pBounds->left <= pBounds->right &&
+         pBounds->bottom <= pBounds->top;
+}
+
+// Splits |length| into cells of about |cellSize|; returns 1 for degenerate
+// extents, which then need no division.
+int GetGridDimension(FX_FLOAT length, FX_FLOAT cellSize) {
+  if (!(length > 0) || !std::isfinite(length) || !(cellSize > 0))
+    return 1;
+  FX_FLOAT count = length / cellSize;
+  if (!(count >= 1))
+    return 1;
+  return count >= kMaxGridDimension ? kMaxGridDimension : (int)count;
+}
+
+int GetCellIndex(FX_FLOAT pos, FX_FLOAT origin, FX_FLOAT cellSize, int count) {
+  if (count <= 1)
+    return 0;
+  FX_FLOAT index = (pos - origin) / cellSize;
+  if (!(index > 0))
+    return 0;
+  return index >= count ? count - 1 : (int)index;
+}
+
+void ClearCacheEntry(CPDF_PageRenderCache* pCache, const CACHEINFO& info) {
+  if (info.pStream)
+    pCache->ClearImageCacheEntry(info.pStream);
+  else if (info.pSMaskKey)
+    pCache->ClearSMaskCacheEntry(*info.pSMaskKey);
+  else
+    pCache->ClearPatternCacheEntry(*info.pPatternKey);
+}
+
+}  // namespace
+
 extern "C" {
 static int compare(const void* data1, const void* data2) {
   return ((CACHEINFO*)data1)->time - ((CACHEINFO*)data2)->time;
@@ -25,35 +96,58 @@ static int compare(const void* data1, const void* data2) {
 CPDF_PageRenderCache::~CPDF_PageRenderCache() {
   for (const auto& it : m_ImageCache)
     delete it.second;
+  for (const auto& it : m_DisplayLists)
+    delete it.second;
 }
 void CPDF_PageRenderCache::CacheOptimization(int32_t dwLimitCacheSize) {
   if (m_nCacheSize <= (FX_DWORD)dwLimitCacheSize)
     return;
 
-  size_t nCount = m_ImageCache.size();
+  size_t nCount =
+      m_ImageCache.size() + m_SMaskCache.size() + m_PatternCache.size();
   CACHEINFO* pCACHEINFO = FX_Alloc(CACHEINFO, nCount);
   size_t i = 0;
   for (const auto& it : m_ImageCache) {
     pCACHEINFO[i].time = it.second->GetTimeCount();
+    pCACHEINFO[i].pSMaskKey = nullptr;
+    pCACHEINFO[i].pPatternKey = nullptr;
     pCACHEINFO[i++].pStream = it.second->GetStream();
   }
+  for (const auto& it : m_SMaskCache) {
+    pCACHEINFO[i].time = it.second.m_dwTimeCount;
+    pCACHEINFO[i].pSMaskKey = &it.first;
+    pCACHEINFO[i].pPatternKey = nullptr;
+    pCACHEINFO[i++].pStream = nullptr;
+  }
+  for (const auto& it : m_PatternCache) {
+    pCACHEINFO[i].time = it.second.m_dwTimeCount;
+    pCACHEINFO[i].pSMaskKey = nullptr;
+    pCACHEINFO[i].pPatternKey = &it.first;
+    pCACHEINFO[i++].pStream = nullptr;
+  }
   FXSYS_qsort(pCACHEINFO, nCount, sizeof(CACHEINFO), compare);
   FX_DWORD nTimeCount = m_nTimeCount;
 
   // Check if time value is about to roll over and reset all entries.
   // The comparision is legal because FX_DWORD is an unsigned type.
   if (nTimeCount + 1 < nTimeCount) {
-    for (i = 0; i < nCount; i++)
-      m_ImageCache[pCACHEINFO[i].pStream]->m_dwTimeCount = i;
+    for (i = 0; i < nCount; i++) {
+      if (pCACHEINFO[i].pStream)
+        m_ImageCache[pCACHEINFO[i].pStream]->m_dwTimeCount = i;
+      else if (pCACHEINFO[i].pSMaskKey)
+        m_SMaskCache[*pCACHEINFO[i].pSMaskKey].m_dwTimeCount = i;
+      else
+        m_PatternCache[*pCACHEINFO[i].pPatternKey].m_dwTimeCount = i;
+    }
     m_nTimeCount = nCount;
   }
 
   i = 0;
   while (i + 15 < nCount)
-    ClearImageCacheEntry(pCACHEINFO[i++].pStream);
+    ClearCacheEntry(this, pCACHEINFO[i++]);
 
   while (i < nCount && m_nCacheSize > (FX_DWORD)dwLimitCacheSize)
-    ClearImageCacheEntry(pCACHEINFO[i++].pStream);
+    ClearCacheEntry(this, pCACHEINFO[i++]);
 
   FX_Free(pCACHEINFO);
 }
@@ -67,7 +161,7 @@ void CPDF_PageRenderCache::ClearImageCacheEntry(CPDF_Stream* pStream) {
   m_ImageCache.erase(it);
 }
 FX_DWORD CPDF_PageRenderCache::EstimateSize() {
-  FX_DWORD dwSize = 0;
+  FX_DWORD dwSize = m_nSMaskSize + m_nPatternSize;
   for (const auto& it : m_ImageCache)
     dwSize += it.second->EstimateSize();
 
@@ -161,6 +255,231 @@ void CPDF_PageRenderCache::ResetBitmap(CPDF_Stream* pStream,
   pEntry->Reset(pBitmap);
   m_nCacheSize += pEntry->EstimateSize();
 }
+bool CPDF_PageRenderCache::SMaskKey::operator<(const SMaskKey& other) const {
+  const CFX_Matrix& m = m_Matrix;
+  const CFX_Matrix& n = other.m_Matrix;
+  return std::tie(m_pDict, m_pPageResources, m.a, m.b, m.c, m.d, m.e, m.f,
+                  m_Rect.left, m_Rect.top, m_Rect.right, m_Rect.bottom) <
+         std::tie(other.m_pDict, other.m_pPageResources, n.a, n.b, n.c, n.d,
+                  n.e, n.f, other.m_Rect.left, other.m_Rect.top,
+                  other.m_Rect.right, other.m_Rect.bottom);
+}
+CFX_DIBitmapRef CPDF_PageRenderCache::GetCachedSMask(const SMaskKey& key) {
+  auto it = m_SMaskCache.find(key);
+  if (it == m_SMaskCache.end())
+    return CFX_DIBitmapRef();
+  it->second.m_dwTimeCount = ++m_nTimeCount;
+  return it->second.m_Bitmap;
+}
+void CPDF_PageRenderCache::CacheSMask(const SMaskKey& key,
+                                      const CFX_DIBitmapRef& mask) {
+  FX_DWORD size = GetBitmapSize(mask.GetObject());
+  if (size > kMaxSMaskCacheSize)
+    return;
+  ClearSMaskCacheEntry(key);
+  while (m_nSMaskSize + size > kMaxSMaskCacheSize) {
+    auto oldest = m_SMaskCache.begin();
+    for (auto it = m_SMaskCache.begin(); it != m_SMaskCache.end(); ++it) {
+      if (it->second.m_dwTimeCount < oldest->second.m_dwTimeCount)
+        oldest = it;
+    }
+    ClearSMaskCacheEntry(oldest->first);
+  }
+  BitmapEntry& entry = m_SMaskCache[key];
+  entry.m_Bitmap = mask;
+  entry.m_dwTimeCount = ++m_nTimeCount;
+  m_nSMaskSize += size;
+  m_nCacheSize += size;
+}
+void CPDF_PageRenderCache::ClearSMaskCacheEntry(const SMaskKey& key) {
+  auto it = m_SMaskCache.find(key);
+  if (it == m_SMaskCache.end())
+    return;
+
+  FX_DWORD size = GetBitmapSize(it->second.m_Bitmap.GetObject());
+  m_nSMaskSize -= size;
+  m_nCacheSize -= size;
+  m_SMaskCache.erase(it);
+}
+bool CPDF_PageRenderCache::PatternKey::operator<(
+    const PatternKey& other) const {
+  const CFX_Matrix& p = m_ParentMatrix;
+  const CFX_Matrix& q = other.m_ParentMatrix;
+  const CFX_Matrix& m = m_Matrix;
+  const CFX_Matrix& n = other.m_Matrix;
+  return std::tie(m_pPattern, p.a, p.b, p.c, p.d, p.e, p.f, m.a, m.b, m.c,
+                  m.d, m.e, m.f, m_Width, m_Height, m_Flags, m_ColorMode,
+                  m_ForeColor, m_BackColor) <
+         std::tie(other.m_pPattern, q.a, q.b, q.c, q.d, q.e, q.f, n.a, n.b,
+                  n.c, n.d, n.e, n.f, other.m_Width, other.m_Height,
+                  other.m_Flags, other.m_ColorMode, other.m_ForeColor,
+                  other.m_BackColor);
+}
+CFX_DIBitmapRef CPDF_PageRenderCache::GetCachedPatternCell(
+    const PatternKey& key) {
+  auto it = m_PatternCache.find(key);
+  if (it == m_PatternCache.end())
+    return CFX_DIBitmapRef();
+  it->second.m_dwTimeCount = ++m_nTimeCount;
+  return it->second.m_Bitmap;
+}
+void CPDF_PageRenderCache::CachePatternCell(const PatternKey& key,
+                                            const CFX_DIBitmapRef& cell) {
+  FX_DWORD size = GetBitmapSize(cell.GetObject());
+  if (size > kMaxPatternCacheSize)
+    return;
+  ClearPatternCacheEntry(key);
+  while (m_nPatternSize + size > kMaxPatternCacheSize) {
+    auto oldest = m_PatternCache.begin();
+    for (auto it = m_PatternCache.begin(); it != m_PatternCache.end(); ++it) {
+      if (it->second.m_dwTimeCount < oldest->second.m_dwTimeCount)
+        oldest = it;
+    }
+    ClearPatternCacheEntry(oldest->first);
+  }
+  BitmapEntry& entry = m_PatternCache[key];
+  entry.m_Bitmap = cell;
+  entry.m_dwTimeCount = ++m_nTimeCount;
+  m_nPatternSize += size;
+  m_nCacheSize += size;
+}
+void CPDF_PageRenderCache::ClearPatternCacheEntry(const PatternKey& key) {
+  auto it = m_PatternCache.find(key);
+  if (it == m_PatternCache.end())
+    return;
+
+  FX_DWORD size = GetBitmapSize(it->second.m_Bitmap.GetObject());
+  m_nPatternSize -= size;
+  m_nCacheSize -= size;
+  m_PatternCache.erase(it);
+}
+const CPDF_DisplayList* CPDF_PageRenderCache::GetDisplayList(
+    const CPDF_PageObjectList* pObjectList,
+    FX_DWORD dwStamp) {
+  if (!pObjectList->IsParsed() ||
+      pObjectList->CountObjects() < kMinDisplayListObjects) {
+    return nullptr;
+  }
+  if (dwStamp != m_dwDisplayListStamp) {
+    // Also drops the lists of forms that no longer exist.
+    for (const auto& it : m_DisplayLists)
+      delete it.second;
+    m_DisplayLists.clear();
+    m_dwDisplayListStamp = dwStamp;
+  }
+  CPDF_DisplayList*& pDisplayList = m_DisplayLists[pObjectList];
+  if (pDisplayList && pDisplayList->GetVersion() != pObjectList->GetVersion()) {
+    delete pDisplayList;
+    pDisplayList = nullptr;
+  }
+  if (!pDisplayList)
+    pDisplayList = new CPDF_DisplayList(pObjectList);
+  return pDisplayList;
+}
+CPDF_DisplayList::CPDF_DisplayList(const CPDF_PageObjectList* pObjectList)
+    : m_dwVersion(pObjectList->GetVersion()),
+      m_CellWidth(0),
+      m_CellHeight(0),
+      m_nCols(0),
+      m_nRows(0) {
+  m_Objects.reserve(pObjectList->CountObjects());
+  bool bHasBBox = false;
+  FX_POSITION pos = pObjectList->GetFirstObjectPosition();
+  while (pos) {
+    Item item;
+    item.m_Pos = pos;
+    item.m_pObject = pObjectList->GetNextObject(pos);
+    m_Objects.push_back(item);
+    CFX_FloatRect bounds;
+    if (!item.m_pObject || !GetUsableBounds(item.m_pObject, &bounds))
+      continue;
+    if (bHasBBox)
+      m_BBox.Union(bounds);
+    else
+      m_BBox = bounds;
+    bHasBBox = true;
+  }
+  if (!bHasBBox) {
+    for (int i = 0; i < CountObjects(); ++i)
+      m_Unbucketed.push_back(i);
+    return;
+  }
+
+  // Square cells holding about kObjectsPerGridCell objects each.
+  FX_FLOAT width = m_BBox.right - m_BBox.left;
+  FX_FLOAT height = m_BBox.top - m_BBox.bottom;
+  int nCells = std::max(1, CountObjects() / kObjectsPerGridCell);
+  FX_FLOAT cellSize = 0;
+  if (width > 0 && height > 0)
+    cellSize = (FX_FLOAT)sqrt((double)width * height / nCells);
+  else
+    cellSize = std::max(width, height) / nCells;
+  m_nCols = GetGridDimension(width, cellSize);
+  m_nRows = GetGridDimension(height, cellSize);
+  m_CellWidth = width / m_nCols;
+  m_CellHeight = height / m_nRows;
+  m_Cells.resize(m_nCols * m_nRows);
+  for (int i = 0; i < CountObjects(); ++i) {
+    const CPDF_PageObject* pObj = m_Objects[i].m_pObject;
+    if (!pObj)
+      continue;
+    CFX_FloatRect bounds;
+    if (!GetUsableBounds(pObj, &bounds)) {
+      m_Unbucketed.push_back(i);
+      continue;
+    }
+    int left, bottom, right, top;
+    GetCellRange(bounds, &left, &bottom, &right, &top);
+    if ((right - left + 1) * (top - bottom + 1) > kMaxCellsPerObject) {
+      m_Unbucketed.push_back(i);
+      continue;
+    }
+    for (int row = bottom; row <= top; ++row) {
+      for (int col = left; col <= right; ++col)
+        m_Cells[row * m_nCols + col].push_back(i);
+    }
+  }
+}
+
+CPDF_DisplayList::~CPDF_DisplayList() {}
+
+void CPDF_DisplayList::Query(const CFX_FloatRect& rect,
+                             std::vector<int>* pResult) const {
+  pResult->clear();
+  if (!IsFiniteRect(rect) || m_Cells.empty() ||
+      (rect.left <= m_BBox.left && rect.right >= m_BBox.right &&
+       rect.bottom <= m_BBox.bottom && rect.top >= m_BBox.top)) {
+    for (int i = 0; i < CountObjects(); ++i)
+      pResult->push_back(i);
+    return;
+  }
+  if (rect.right >= m_BBox.left && rect.left <= m_BBox.right &&
+      rect.top >= m_BBox.bottom && rect.bottom <= m_BBox.top) {
+    int left, bottom, right, top;
+    GetCellRange(rect, &left, &bottom, &right, &top);
+    for (int row = bottom; row <= top; ++row) {
+      for (int col = left; col <= right; ++col) {
+        const std::vector<int>& cell = m_Cells[row * m_nCols + col];
+        pResult->insert(pResult->end(), cell.begin(), cell.end());
+      }
+    }
+  }
+  pResult->insert(pResult->end(), m_Unbucketed.begin(), m_Unbucketed.end());
+  std::sort(pResult->begin(), pResult->end());
+  pResult->erase(std::unique(pResult->begin(), pResult->end()),
+                 pResult->end());
+}
+
+void CPDF_DisplayList::GetCellRange(const CFX_FloatRect& rect,
+                                    int* pLeft,
+                                    int* pBottom,
+                                    int* pRight,
+                                    int* pTop) const {
+  *pLeft = GetCellIndex(rect.left, m_BBox.left, m_CellWidth, m_nCols);
+  *pRight = GetCellIndex(rect.right, m_BBox.left, m_CellWidth, m_nCols);
+  *pBottom = GetCellIndex(rect.bottom, m_BBox.bottom, m_CellHeight, m_nRows);
+  *pTop = GetCellIndex(rect.top, m_BBox.bottom, m_CellHeight, m_nRows);
+}
 CPDF_ImageCacheEntry::CPDF_ImageCacheEntry(CPDF_Document* pDoc,
                                            CPDF_Stream* pStream)
     : m_dwTimeCount(0),
@@ -124,8 +124,8 @@ void CPDF_RenderStatus::CompositeDIBitmap(CFX_DIBitmap* pDIBitmap,
   }
 
   std::unique_ptr<CFX_DIBitmap> pBackdrop1(new CFX_DIBitmap);
-  pBackdrop1->Create(pBackdrop->GetWidth(), pBackdrop->GetHeight(),
-                     FXDIB_Rgb32);
+  pBackdrop1->CreateUninit(pBackdrop->GetWidth(), pBackdrop->GetHeight(),
+                           FXDIB_Rgb32);
   pBackdrop1->Clear((FX_DWORD)-1);
   pBackdrop1->CompositeBitmap(0, 0, pBackdrop->GetWidth(),
                               pBackdrop->GetHeight(), pBackdrop.get(), 0, 0);
@@ -862,19 +862,44 @@ ICodec_ScanlineDecoder* FPDFAPI_CreateFlateDecoder(
     int nComps,
     int bpc,
     const CPDF_Dictionary* pParams);
-CFX_DIBitmap* CPDF_RenderStatus::LoadSMask(CPDF_Dictionary* pSMaskDict,
-                                           FX_RECT* pClipRect,
-                                           const CFX_Matrix* pMatrix) {
-  if (!pSMaskDict) {
-    return NULL;
-  }
+CFX_DIBitmapRef CPDF_RenderStatus::LoadSMask(CPDF_Dictionary* pSMaskDict,
+                                             FX_RECT* pClipRect,
+                                             const CFX_Matrix* pMatrix) {
+  CFX_DIBitmapRef mask;
+  if (!pSMaskDict)
+    return mask;
+
+  CPDF_PageRenderCache* pCache = m_pContext->GetPageCache();
+  CPDF_PageRenderCache::SMaskKey key;
+  if (pCache) {
+    key.m_pDict = pSMaskDict;
+    key.m_pPageResources = m_pContext->GetPageResources();
+    key.m_Matrix = *pMatrix;
+    key.m_Rect = *pClipRect;
+    mask = pCache->GetCachedSMask(key);
+    if (mask.NotNull())
+      return mask;
+  }
+  if (!RenderSMask(pSMaskDict, pClipRect, pMatrix, mask.New())) {
+    mask.SetNull();
+    return mask;
+  }
+  if (pCache)
+    pCache->CacheSMask(key, mask);
+  return mask;
+}
+
+FX_BOOL CPDF_RenderStatus::RenderSMask(CPDF_Dictionary* pSMaskDict,
+                                       FX_RECT* pClipRect,
+                                       const CFX_Matrix* pMatrix,
+                                       CFX_DIBitmap* pMask) {
   int width = pClipRect->right - pClipRect->left;
   int height = pClipRect->bottom - pClipRect->top;
   FX_BOOL bLuminosity = FALSE;
   bLuminosity = pSMaskDict->GetConstStringBy("S") != "Alpha";
   CPDF_Stream* pGroup = pSMaskDict->GetStreamBy("G");
   if (!pGroup) {
-    return NULL;
+    return FALSE;
   }
   std::unique_ptr<CPDF_Function> pFunc;
   CPDF_Object* pFuncObj = pSMaskDict->GetElementValue("TR");
@@ -886,19 +911,21 @@ CFX_DIBitmap* CPDF_RenderStatus::LoadSMask(CPDF_Dictionary* pSMaskDict,
   CPDF_Form form(m_pContext->GetDocument(), m_pContext->GetPageResources(),
                  pGroup);
   form.ParseContent(NULL, NULL, NULL, NULL);
-  CFX_FxgeDevice bitmap_device;
 #if _FXM_PLATFORM_ == _FXM_PLATFORM_APPLE_
-  if (!bitmap_device.Create(width, height,
-                            bLuminosity ? FXDIB_Rgb32 : FXDIB_8bppMask)) {
-    return NULL;
-  }
+  FXDIB_Format format = bLuminosity ? FXDIB_Rgb32 : FXDIB_8bppMask;
 #else
-  if (!bitmap_device.Create(width, height,
-                            bLuminosity ? FXDIB_Rgb : FXDIB_8bppMask)) {
-    return NULL;
-  }
+  FXDIB_Format format = bLuminosity ? FXDIB_Rgb : FXDIB_8bppMask;
 #endif
-  CFX_DIBitmap& bitmap = *bitmap_device.GetBitmap();
+  // Luminosity masks are cleared to the backdrop color below.
+  CPDF_ScratchBitmap scratch;
+  CFX_DIBitmap* pBitmap = scratch.Create(m_pContext->GetScratchBitmapPool(),
+                                         width, height, format, !bLuminosity);
+  if (!pBitmap)
+    return FALSE;
+
+  CFX_FxgeDevice bitmap_device;
+  bitmap_device.Attach(pBitmap);
+  CFX_DIBitmap& bitmap = *pBitmap;
   CPDF_Object* pCSObj = NULL;
   CPDF_ColorSpace* pCS = NULL;
   if (bLuminosity) {
@@ -922,7 +949,7 @@ CFX_DIBitmap* CPDF_RenderStatus::LoadSMask(CPDF_Dictionary* pSMaskDict,
         FX_SAFE_DWORD num_floats = comps;
         num_floats *= sizeof(FX_FLOAT);
         if (!num_floats.IsValid()) {
-          return NULL;
+          return FALSE;
         }
         FXSYS_memset(pFloats, 0, num_floats.ValueOrDie());
         int count = pBC->GetCount() > 8 ? 8 : pBC->GetCount();
@@ -936,8 +963,6 @@ CFX_DIBitmap* CPDF_RenderStatus::LoadSMask(CPDF_Dictionary* pSMaskDict,
       }
     }
     bitmap.Clear(back_color);
-  } else {
-    bitmap.Clear(0);
   }
   CPDF_Dictionary* pFormResource = NULL;
   if (form.m_pFormDict) {
@@ -950,9 +975,8 @@ CFX_DIBitmap* CPDF_RenderStatus::LoadSMask(CPDF_Dictionary* pSMaskDict,
                     &options, 0, m_bDropObjects, pFormResource, TRUE, NULL, 0,
                     pCS ? pCS->GetFamily() : 0, bLuminosity);
   status.RenderObjectList(&form, &matrix);
-  std::unique_ptr<CFX_DIBitmap> pMask(new CFX_DIBitmap);
   if (!pMask->Create(width, height, FXDIB_8bppMask))
-    return nullptr;
+    return FALSE;
 
   uint8_t* dest_buf = pMask->GetBuffer();
   int dest_pitch = pMask->GetPitch();
@@ -983,12 +1007,17 @@ CFX_DIBitmap* CPDF_RenderStatus::LoadSMask(CPDF_Dictionary* pSMaskDict,
       }
     }
   } else if (pFunc) {
-    int size = dest_pitch * height;
-    for (int i = 0; i < size; i++) {
-      dest_buf[i] = transfers[src_buf[i]];
+    for (int row = 0; row < height; row++) {
+      uint8_t* dest_pos = dest_buf + row * dest_pitch;
+      const uint8_t* src_pos = src_buf + row * src_pitch;
+      for (int col = 0; col < width; col++)
+        dest_pos[col] = transfers[src_pos[col]];
     }
   } else {
-    FXSYS_memcpy(dest_buf, src_buf, dest_pitch * height);
+    for (int row = 0; row < height; row++) {
+      FXSYS_memcpy(dest_buf + row * dest_pitch, src_buf + row * src_pitch,
+                   width);
+    }
   }
-  return pMask.release();
+  return TRUE;
 }
@@ -6,6 +6,8 @@
 
 #include "render_int.h"
 
+#include <algorithm>
+
 #include "core/include/fpdfapi/fpdf_pageobj.h"
 #include "core/include/fpdfapi/fpdf_render.h"
 #include "core/include/fxge/fx_ge.h"
@@ -304,108 +306,147 @@ static void DrawFuncShading(CFX_DIBitmap* pBitmap,
     }
   }
 }
-FX_BOOL _GetScanlineIntersect(int y,
-                              FX_FLOAT x1,
-                              FX_FLOAT y1,
-                              FX_FLOAT x2,
-                              FX_FLOAT y2,
-                              FX_FLOAT& x) {
-  if (y1 == y2) {
-    return FALSE;
-  }
-  if (y1 < y2) {
-    if (y < y1 || y > y2) {
-      return FALSE;
+// One side of a triangle, from its upper vertex to its lower one.
+struct Gouraud_Edge {
+  const CPDF_MeshVertex* top;
+  const CPDF_MeshVertex* bottom;
+  FX_FLOAT dx;
+  void Init(const CPDF_MeshVertex* pTop, const CPDF_MeshVertex* pBottom) {
+    top = pTop;
+    bottom = pBottom;
+    FX_FLOAT height = bottom->y - top->y;
+    dx = height > 0 ? (bottom->x - top->x) / height : 0;
+  }
+  // Widens [min_x, max_x] to where the edge runs between |y0| and |y1|.
+  void Extend(FX_FLOAT y0, FX_FLOAT y1, FX_FLOAT& min_x, FX_FLOAT& max_x) {
+    if (y1 < top->y || y0 > bottom->y)
+      return;
+    FX_FLOAT x0 = y0 > top->y ? top->x + (y0 - top->y) * dx : top->x;
+    FX_FLOAT x1 = y1 < bottom->y ? top->x + (y1 - top->y) * dx : bottom->x;
+    min_x = std::min(min_x, std::min(x0, x1));
+    max_x = std::max(max_x, std::max(x0, x1));
+  }
+};
+// One color component over a triangle, as a plane in device space, in 16.16
+// fixed point levels.
+struct Gouraud_Color {
+  FX_FLOAT origin_x, origin_y;
+  FX_FLOAT value, dx, dy;
+  int min, max;
+  void Init(const CPDF_MeshVertex triangle[3],
+            FX_FLOAT c0,
+            FX_FLOAT c1,
+            FX_FLOAT c2) {
+    const CPDF_MeshVertex& v0 = triangle[0];
+    const CPDF_MeshVertex& v1 = triangle[1];
+    const CPDF_MeshVertex& v2 = triangle[2];
+    origin_x = v0.x;
+    origin_y = v0.y;
+    c0 *= 255 << 16;
+    c1 *= 255 << 16;
+    c2 *= 255 << 16;
+    FX_FLOAT det =
+        (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+    if (FXSYS_fabs(det) < 0.001f) {
+      value = (c0 + c1 + c2) / 3;
+      dx = dy = 0;
+    } else {
+      value = c0;
+      dx = ((c1 - c0) * (v2.y - v0.y) - (c2 - c0) * (v1.y - v0.y)) / det;
+      dy = ((c2 - c0) * (v1.x - v0.x) - (c1 - c0) * (v2.x - v0.x)) / det;
     }
-  } else {
-    if (y < y2 || y > y1) {
-      return FALSE;
+    min = Clamp(std::min(c0, std::min(c1, c2)));
+    max = Clamp(std::max(c0, std::max(c1, c2)));
+  }
+  int Clamp(FX_FLOAT level) const {
+    if (level <= 0)
+      return 0;
+    if (level >= (256 << 16) - 1)
+      return (256 << 16) - 1;
+    return (int)level;
+  }
+  // Gets the level at the center of pixel |x| of row |y| and the step to the
+  // next pixel, so that the |count| pixels stay within the vertices' levels.
+  void GetSpan(int x, int y, int count, int& start, int& unit) const {
+    FX_FLOAT first =
+        value + (x + 0.5f - origin_x) * dx + (y + 0.5f - origin_y) * dy;
+    start = std::min(std::max(Clamp(first), min), max);
+    if (count == 1) {
+      unit = 0;
+      return;
     }
+    int end = std::min(std::max(Clamp(first + (count - 1) * dx), min), max);
+    unit = (end - start) / (count - 1);
   }
-  x = x1 + FXSYS_MulDiv(x2 - x1, y - y1, y2 - y1);
-  return TRUE;
-}
+};
+// Fills every pixel touching |triangle|, walking its edges down one row at a
+// time. Covering the partial pixels along the edges keeps the cracks left
+// between the triangles of a mesh by rounding and subdivision from showing.
+// With RENDER_NOPATHSMOOTH in |fill_mode| only the pixels whose centers are
+// inside |triangle| are filled, as an aliased path fill would.
 static void DrawGouraud(CFX_DIBitmap* pBitmap,
                         int alpha,
-                        CPDF_MeshVertex triangle[3]) {
-  FX_FLOAT min_y = triangle[0].y, max_y = triangle[0].y;
-  for (int i = 1; i < 3; i++) {
-    if (min_y > triangle[i].y) {
-      min_y = triangle[i].y;
-    }
-    if (max_y < triangle[i].y) {
-      max_y = triangle[i].y;
-    }
-  }
-  if (min_y == max_y) {
+                        CPDF_MeshVertex triangle[3],
+                        int fill_mode) {
+  const CPDF_MeshVertex* top = &triangle[0];
+  const CPDF_MeshVertex* middle = &triangle[1];
+  const CPDF_MeshVertex* bottom = &triangle[2];
+  if (top->y > middle->y)
+    std::swap(top, middle);
+  if (middle->y > bottom->y)
+    std::swap(middle, bottom);
+  if (top->y > middle->y)
+    std::swap(top, middle);
+  int width = pBitmap->GetWidth();
+  int height = pBitmap->GetHeight();
+  if (bottom->y < 0 || top->y >= height)
     return;
-  }
-  int min_yi = (int)FXSYS_floor(min_y), max_yi = (int)FXSYS_ceil(max_y);
-  if (min_yi < 0) {
-    min_yi = 0;
-  }
-  if (max_yi >= pBitmap->GetHeight()) {
-    max_yi = pBitmap->GetHeight() - 1;
-  }
-  for (int y = min_yi; y <= max_yi; y++) {
-    int nIntersects = 0;
-    FX_FLOAT inter_x[3], r[3], g[3], b[3];
-    for (int i = 0; i < 3; i++) {
-      CPDF_MeshVertex& vertex1 = triangle[i];
-      CPDF_MeshVertex& vertex2 = triangle[(i + 1) % 3];
-      FX_BOOL bIntersect = _GetScanlineIntersect(
-          y, vertex1.x, vertex1.y, vertex2.x, vertex2.y, inter_x[nIntersects]);
-      if (!bIntersect) {
+  Gouraud_Edge edges[3];
+  edges[0].Init(top, bottom);
+  edges[1].Init(top, middle);
+  edges[2].Init(middle, bottom);
+  Gouraud_Color colors[3];
+  colors[0].Init(triangle, triangle[0].r, triangle[1].r, triangle[2].r);
+  colors[1].Init(triangle, triangle[0].g, triangle[1].g, triangle[2].g);
+  colors[2].Init(triangle, triangle[0].b, triangle[1].b, triangle[2].b);
+  FX_BOOL bNoSmooth = fill_mode & RENDER_NOPATHSMOOTH;
+  int min_y = std::max((int)FXSYS_floor(top->y), 0);
+  int max_y = std::min((int)FXSYS_floor(bottom->y), height - 1);
+  for (int y = min_y; y <= max_y; y++) {
+    FX_FLOAT min_x = (FX_FLOAT)width, max_x = 0;
+    int start_x, end_x;
+    if (bNoSmooth) {
+      FX_FLOAT center_y = y + 0.5f;
+      if (center_y < top->y || center_y >= bottom->y)
+        continue;
+      for (int i = 0; i < 3; i++)
+        edges[i].Extend(center_y, center_y, min_x, max_x);
+      start_x = std::max((int)FXSYS_ceil(min_x - 0.5f), 0);
+      end_x = std::min((int)FXSYS_ceil(max_x - 0.5f), width);
+      if (end_x <= start_x)
         continue;
-      }
-      r[nIntersects] =
-          vertex1.r + FXSYS_MulDiv(vertex2.r - vertex1.r, y - vertex1.y,
-                                   vertex2.y - vertex1.y);
-      g[nIntersects] =
-          vertex1.g + FXSYS_MulDiv(vertex2.g - vertex1.g, y - vertex1.y,
-                                   vertex2.y - vertex1.y);
-      b[nIntersects] =
-          vertex1.b + FXSYS_MulDiv(vertex2.b - vertex1.b, y - vertex1.y,
-                                   vertex2.y - vertex1.y);
-      nIntersects++;
-    }
-    if (nIntersects != 2) {
-      continue;
-    }
-    int min_x, max_x, start_index, end_index;
-    if (inter_x[0] < inter_x[1]) {
-      min_x = (int)FXSYS_floor(inter_x[0]);
-      max_x = (int)FXSYS_ceil(inter_x[1]);
-      start_index = 0;
-      end_index = 1;
     } else {
-      min_x = (int)FXSYS_floor(inter_x[1]);
-      max_x = (int)FXSYS_ceil(inter_x[0]);
-      start_index = 1;
-      end_index = 0;
-    }
-    int start_x = min_x, end_x = max_x;
-    if (start_x < 0) {
-      start_x = 0;
-    }
-    if (end_x > pBitmap->GetWidth()) {
-      end_x = pBitmap->GetWidth();
+      for (int i = 0; i < 3; i++)
+        edges[i].Extend((FX_FLOAT)y, (FX_FLOAT)(y + 1), min_x, max_x);
+      if (max_x <= 0 || min_x >= width)
+        continue;
+      start_x = std::max((int)FXSYS_floor(min_x), 0);
+      end_x = std::min((int)FXSYS_ceil(max_x), width);
+      if (end_x == start_x)
+        end_x++;
     }
+    int count = end_x - start_x;
+    int R, G, B, r_unit, g_unit, b_unit;
+    colors[0].GetSpan(start_x, y, count, R, r_unit);
+    colors[1].GetSpan(start_x, y, count, G, g_unit);
+    colors[2].GetSpan(start_x, y, count, B, b_unit);
     uint8_t* dib_buf =
         pBitmap->GetBuffer() + y * pBitmap->GetPitch() + start_x * 4;
-    FX_FLOAT r_unit = (r[end_index] - r[start_index]) / (max_x - min_x);
-    FX_FLOAT g_unit = (g[end_index] - g[start_index]) / (max_x - min_x);
-    FX_FLOAT b_unit = (b[end_index] - b[start_index]) / (max_x - min_x);
-    FX_FLOAT R = r[start_index] + (start_x - min_x) * r_unit;
-    FX_FLOAT G = g[start_index] + (start_x - min_x) * g_unit;
-    FX_FLOAT B = b[start_index] + (start_x - min_x) * b_unit;
     for (int x = start_x; x < end_x; x++) {
+      FXARGB_SETDIB(dib_buf, FXARGB_MAKE(alpha, R >> 16, G >> 16, B >> 16));
       R += r_unit;
       G += g_unit;
       B += b_unit;
-      FXARGB_SETDIB(dib_buf,
-                    FXARGB_MAKE(alpha, (int32_t)(R * 255), (int32_t)(G * 255),
-                                (int32_t)(B * 255)));
       dib_buf += 4;
     }
   }
@@ -441,7 +482,7 @@ static void DrawFreeGouraudShading(CFX_DIBitmap* pBitmap,
       triangle[1] = triangle[2];
       triangle[2] = vertex;
     }
-    DrawGouraud(pBitmap, alpha, triangle);
+    DrawGouraud(pBitmap, alpha, triangle, 0);
   }
 }
 static void DrawLatticeGouraudShading(CFX_DIBitmap* pBitmap,
@@ -479,9 +520,9 @@ static void DrawLatticeGouraudShading(CFX_DIBitmap* pBitmap,
       triangle[0] = last_row[i];
       triangle[1] = this_row[i - 1];
       triangle[2] = last_row[i - 1];
-      DrawGouraud(pBitmap, alpha, triangle);
+      DrawGouraud(pBitmap, alpha, triangle, 0);
       triangle[2] = this_row[i];
-      DrawGouraud(pBitmap, alpha, triangle);
+      DrawGouraud(pBitmap, alpha, triangle, 0);
     }
     last_index = 1 - last_index;
   }
@@ -511,18 +552,7 @@ struct Coon_BezierCoeff {
     result.d = a / 8 + b / 4 + c / 2 + d;
     return result;
   }
-  void GetPoints(float p[4]) {
-    p[0] = d;
-    p[1] = c / 3 + p[0];
-    p[2] = b / 3 - p[0] + 2 * p[1];
-    p[3] = a + p[0] - 3 * p[1] + 3 * p[2];
-  }
-  void GetPointsReverse(float p[4]) {
-    p[3] = d;
-    p[2] = c / 3 + p[3];
-    p[1] = b / 3 - p[3] + 2 * p[2];
-    p[0] = a + p[3] - 3 * p[2] + 3 * p[1];
-  }
+  float End() { return a + b + c + d; }
   void BezierInterpol(Coon_BezierCoeff& C1,
                       Coon_BezierCoeff& C2,
                       Coon_BezierCoeff& D1,
@@ -537,6 +567,12 @@ struct Coon_BezierCoeff {
     float dis = a + b + c;
     return dis < 0 ? -dis : dis;
   }
+  // Bounds how far the curve strays from its chord walked at constant
+  // speed, by the control points of their difference.
+  float Flatness() {
+    float d1 = FXSYS_fabs(a + b), d2 = FXSYS_fabs(2 * a + b);
+    return (d1 > d2 ? d1 : d2) / 3;
+  }
 };
 struct Coon_Bezier {
   Coon_BezierCoeff x, y;
@@ -570,31 +606,16 @@ struct Coon_Bezier {
     x.BezierInterpol(C1.x, C2.x, D1.x, D2.x);
     y.BezierInterpol(C1.y, C2.y, D1.y, D2.y);
   }
-  void GetPoints(FX_PATHPOINT* pPoints) {
-    float p[4];
-    int i;
-    x.GetPoints(p);
-    for (i = 0; i < 4; i++) {
-      pPoints[i].m_PointX = p[i];
-    }
-    y.GetPoints(p);
-    for (i = 0; i < 4; i++) {
-      pPoints[i].m_PointY = p[i];
-    }
+  void GetStart(CPDF_MeshVertex& vertex) {
+    vertex.x = x.d;
+    vertex.y = y.d;
   }
-  void GetPointsReverse(FX_PATHPOINT* pPoints) {
-    float p[4];
-    int i;
-    x.GetPointsReverse(p);
-    for (i = 0; i < 4; i++) {
-      pPoints[i].m_PointX = p[i];
-    }
-    y.GetPointsReverse(p);
-    for (i = 0; i < 4; i++) {
-      pPoints[i].m_PointY = p[i];
-    }
+  void GetEnd(CPDF_MeshVertex& vertex) {
+    vertex.x = x.End();
+    vertex.y = y.End();
   }
   float Distance() { return x.Distance() + y.Distance(); }
+  float Flatness() { return x.Flatness() + y.Flatness(); }
 };
 static int _BiInterpol(int c0,
                        int c1,
@@ -621,25 +642,31 @@ struct Coon_Color {
           _BiInterpol(colors[0].comp[i], colors[1].comp[i], colors[2].comp[i],
                       colors[3].comp[i], x, y, x_scale, y_scale);
   }
-  int Distance(Coon_Color& o) {
-    int max, diff;
-    max = FXSYS_abs(comp[0] - o.comp[0]);
-    diff = FXSYS_abs(comp[1] - o.comp[1]);
-    if (max < diff) {
-      max = diff;
-    }
-    diff = FXSYS_abs(comp[2] - o.comp[2]);
-    if (max < diff) {
-      max = diff;
+  void GetVertexColor(CPDF_MeshVertex& vertex) {
+    vertex.r = comp[0] / 255.0f;
+    vertex.g = comp[1] / 255.0f;
+    vertex.b = comp[2] / 255.0f;
+  }
+  // How far the bilinear colors at the middle of a patch are from those of
+  // two triangles split along the 0-2 diagonal, times four.
+  static int Twist(Coon_Color colors[4]) {
+    int max = 0;
+    for (int i = 0; i < 3; i++) {
+      int twist = FXSYS_abs(colors[0].comp[i] - colors[1].comp[i] +
+                            colors[2].comp[i] - colors[3].comp[i]);
+      if (max < twist) {
+        max = twist;
+      }
     }
     return max;
   }
 };
+#define COONCOLOR_THRESHOLD 4
+#define COONFLATNESS_THRESHOLD 0.5f
+#define COONMAX_SCALE 1024
 struct CPDF_PatchDrawer {
   Coon_Color patch_colors[4];
-  int max_delta;
-  CFX_PathData path;
-  CFX_RenderDevice* pDevice;
+  CFX_DIBitmap* pBitmap;
   int fill_mode;
   int alpha;
   void Draw(int x_scale,
@@ -653,80 +680,87 @@ struct CPDF_PatchDrawer {
     FX_BOOL bSmall = C1.Distance() < 2 && C2.Distance() < 2 &&
                      D1.Distance() < 2 && D2.Distance() < 2;
     Coon_Color div_colors[4];
-    int d_bottom, d_left, d_top, d_right;
     div_colors[0].BiInterpol(patch_colors, left, bottom, x_scale, y_scale);
+    div_colors[1].BiInterpol(patch_colors, left, bottom + 1, x_scale, y_scale);
+    div_colors[2].BiInterpol(patch_colors, left + 1, bottom + 1, x_scale,
+                             y_scale);
+    div_colors[3].BiInterpol(patch_colors, left + 1, bottom, x_scale, y_scale);
+    // A patch is filled as two Gouraud triangles once its sides are straight
+    // to within COONFLATNESS_THRESHOLD pixels and the triangles are within a
+    // color level of it in the middle. Otherwise it is split across the
+    // curved sides, or both ways for the colors.
+    FX_BOOL bSplitX = FALSE, bSplitY = FALSE;
     if (!bSmall) {
-      div_colors[1].BiInterpol(patch_colors, left, bottom + 1, x_scale,
-                               y_scale);
-      div_colors[2].BiInterpol(patch_colors, left + 1, bottom + 1, x_scale,
-                               y_scale);
-      div_colors[3].BiInterpol(patch_colors, left + 1, bottom, x_scale,
-                               y_scale);
-      d_bottom = div_colors[3].Distance(div_colors[0]);
-      d_left = div_colors[1].Distance(div_colors[0]);
-      d_top = div_colors[1].Distance(div_colors[2]);
-      d_right = div_colors[2].Distance(div_colors[3]);
-    }
-#define COONCOLOR_THRESHOLD 4
-    if (bSmall ||
-        (d_bottom < COONCOLOR_THRESHOLD && d_left < COONCOLOR_THRESHOLD &&
-         d_top < COONCOLOR_THRESHOLD && d_right < COONCOLOR_THRESHOLD)) {
-      FX_PATHPOINT* pPoints = path.GetPoints();
-      C1.GetPoints(pPoints);
-      D2.GetPoints(pPoints + 3);
-      C2.GetPointsReverse(pPoints + 6);
-      D1.GetPointsReverse(pPoints + 9);
-      int fillFlags = FXFILL_WINDING | FXFILL_FULLCOVER;
-      if (fill_mode & RENDER_NOPATHSMOOTH) {
-        fillFlags |= FXFILL_NOPATHSMOOTH;
+      bSplitX = C1.Flatness() > COONFLATNESS_THRESHOLD ||
+                C2.Flatness() > COONFLATNESS_THRESHOLD;
+      bSplitY = D1.Flatness() > COONFLATNESS_THRESHOLD ||
+                D2.Flatness() > COONFLATNESS_THRESHOLD;
+      if (!bSplitX && !bSplitY &&
+          Coon_Color::Twist(div_colors) >= COONCOLOR_THRESHOLD) {
+        bSplitX = bSplitY = TRUE;
       }
-      pDevice->DrawPath(
-          &path, NULL, NULL,
-          FXARGB_MAKE(alpha, div_colors[0].comp[0], div_colors[0].comp[1],
-                      div_colors[0].comp[2]),
-          0, fillFlags);
-    } else {
-      if (d_bottom < COONCOLOR_THRESHOLD && d_top < COONCOLOR_THRESHOLD) {
-        Coon_Bezier m1;
-        m1.BezierInterpol(D1, D2, C1, C2);
-        y_scale *= 2;
-        bottom *= 2;
-        Draw(x_scale, y_scale, left, bottom, C1, m1, D1.first_half(),
-             D2.first_half());
-        Draw(x_scale, y_scale, left, bottom + 1, m1, C2, D1.second_half(),
-             D2.second_half());
-      } else if (d_left < COONCOLOR_THRESHOLD &&
-                 d_right < COONCOLOR_THRESHOLD) {
-        Coon_Bezier m2;
-        m2.BezierInterpol(C1, C2, D1, D2);
-        x_scale *= 2;
-        left *= 2;
-        Draw(x_scale, y_scale, left, bottom, C1.first_half(), C2.first_half(),
-             D1, m2);
-        Draw(x_scale, y_scale, left + 1, bottom, C1.second_half(),
-             C2.second_half(), m2, D2);
-      } else {
-        Coon_Bezier m1, m2;
-        m1.BezierInterpol(D1, D2, C1, C2);
-        m2.BezierInterpol(C1, C2, D1, D2);
-        Coon_Bezier m1f = m1.first_half();
-        Coon_Bezier m1s = m1.second_half();
-        Coon_Bezier m2f = m2.first_half();
-        Coon_Bezier m2s = m2.second_half();
-        x_scale *= 2;
-        y_scale *= 2;
-        left *= 2;
-        bottom *= 2;
-        Draw(x_scale, y_scale, left, bottom, C1.first_half(), m1f,
-             D1.first_half(), m2f);
-        Draw(x_scale, y_scale, left, bottom + 1, m1f, C2.first_half(),
-             D1.second_half(), m2s);
-        Draw(x_scale, y_scale, left + 1, bottom, C1.second_half(), m1s, m2f,
-             D2.first_half());
-        Draw(x_scale, y_scale, left + 1, bottom + 1, m1s, C2.second_half(), m2s,
-             D2.second_half());
+      if (x_scale >= COONMAX_SCALE) {
+        bSplitX = FALSE;
       }
+      if (y_scale >= COONMAX_SCALE) {
+        bSplitY = FALSE;
+      }
+    }
+    if (!bSplitX && !bSplitY) {
+      Fill(C1, C2, div_colors);
+    } else if (!bSplitX) {
+      Coon_Bezier m1;
+      m1.BezierInterpol(D1, D2, C1, C2);
+      y_scale *= 2;
+      bottom *= 2;
+      Draw(x_scale, y_scale, left, bottom, C1, m1, D1.first_half(),
+           D2.first_half());
+      Draw(x_scale, y_scale, left, bottom + 1, m1, C2, D1.second_half(),
+           D2.second_half());
+    } else if (!bSplitY) {
+      Coon_Bezier m2;
+      m2.BezierInterpol(C1, C2, D1, D2);
+      x_scale *= 2;
+      left *= 2;
+      Draw(x_scale, y_scale, left, bottom, C1.first_half(), C2.first_half(),
+           D1, m2);
+      Draw(x_scale, y_scale, left + 1, bottom, C1.second_half(),
+           C2.second_half(), m2, D2);
+    } else {
+      Coon_Bezier m1, m2;
+      m1.BezierInterpol(D1, D2, C1, C2);
+      m2.BezierInterpol(C1, C2, D1, D2);
+      Coon_Bezier m1f = m1.first_half();
+      Coon_Bezier m1s = m1.second_half();
+      Coon_Bezier m2f = m2.first_half();
+      Coon_Bezier m2s = m2.second_half();
+      x_scale *= 2;
+      y_scale *= 2;
+      left *= 2;
+      bottom *= 2;
+      Draw(x_scale, y_scale, left, bottom, C1.first_half(), m1f,
+           D1.first_half(), m2f);
+      Draw(x_scale, y_scale, left, bottom + 1, m1f, C2.first_half(),
+           D1.second_half(), m2s);
+      Draw(x_scale, y_scale, left + 1, bottom, C1.second_half(), m1s, m2f,
+           D2.first_half());
+      Draw(x_scale, y_scale, left + 1, bottom + 1, m1s, C2.second_half(), m2s,
+           D2.second_half());
+    }
+  }
+  void Fill(Coon_Bezier& C1, Coon_Bezier& C2, Coon_Color div_colors[4]) {
+    CPDF_MeshVertex corners[4];
+    C1.GetStart(corners[0]);
+    C2.GetStart(corners[1]);
+    C2.GetEnd(corners[2]);
+    C1.GetEnd(corners[3]);
+    for (int i = 0; i < 4; i++) {
+      div_colors[i].GetVertexColor(corners[i]);
     }
+    CPDF_MeshVertex triangle[3] = {corners[0], corners[1], corners[2]};
+    DrawGouraud(pBitmap, alpha, triangle, fill_mode);
+    triangle[1] = corners[3];
+    DrawGouraud(pBitmap, alpha, triangle, fill_mode);
   }
 };
 
@@ -757,8 +791,6 @@ static void DrawCoonPatchMeshes(FX_BOOL bTensor,
                                 int alpha) {
   ASSERT(pBitmap->GetFormat() == FXDIB_Argb);
 
-  CFX_FxgeDevice device;
-  device.Attach(pBitmap);
   CPDF_MeshStream stream;
   if (!stream.Load(pShadingStream, pFuncs, nFuncs, pCS))
     return;
@@ -767,14 +799,8 @@ static void DrawCoonPatchMeshes(FX_BOOL bTensor,
 
   CPDF_PatchDrawer patch;
   patch.alpha = alpha;
-  patch.pDevice = &device;
+  patch.pBitmap = pBitmap;
   patch.fill_mode = fill_mode;
-  patch.path.SetPointCount(13);
-  FX_PATHPOINT* pPoints = patch.path.GetPoints();
-  pPoints[0].m_Flag = FXPT_MOVETO;
-  for (int i = 1; i < 13; i++) {
-    pPoints[i].m_Flag = FXPT_BEZIERTO;
-  }
   CFX_FloatPoint coords[16];
   for (int i = 0; i < 16; i++) {
     coords[i].Set(0.0f, 0.0f);
@@ -868,7 +894,6 @@ void CPDF_RenderStatus::DrawShading(CPDF_ShadingPattern* pPattern,
     return;
   }
   pBitmap->Clear(background);
-  int fill_mode = m_Options.m_Flags;
   switch (pPattern->m_ShadingType) {
     case kInvalidShading:
     case kMaxShading:
@@ -900,7 +925,7 @@ void CPDF_RenderStatus::DrawShading(CPDF_ShadingPattern* pPattern,
       DrawCoonPatchMeshes(
           pPattern->m_ShadingType == kTensorProductPatchMeshShading, pBitmap,
           &FinalMatrix, ToStream(pPattern->m_pShadingObj), pFuncs, nFuncs,
-          pColorSpace, fill_mode, alpha);
+          pColorSpace, m_Options.m_Flags, alpha);
     } break;
   }
   if (bAlphaMode) {
@@ -958,10 +983,24 @@ FX_BOOL CPDF_RenderStatus::ProcessShading(CPDF_ShadingObject* pShadingObj,
               m_Options.m_ColorMode == RENDER_COLOR_ALPHA);
   return TRUE;
 }
+static CFX_Matrix GetPatternBitmapMatrix(const CPDF_TilingPattern* pPattern,
+                                         const CFX_Matrix* pObject2Device,
+                                         int width,
+                                         int height) {
+  CFX_FloatRect cell_bbox = pPattern->m_BBox;
+  pPattern->m_Pattern2Form.TransformRect(cell_bbox);
+  pObject2Device->TransformRect(cell_bbox);
+  CFX_FloatRect bitmap_rect(0.0f, 0.0f, (FX_FLOAT)width, (FX_FLOAT)height);
+  CFX_Matrix mtAdjust;
+  mtAdjust.MatchRect(bitmap_rect, cell_bbox);
+  CFX_Matrix mtPattern2Bitmap = *pObject2Device;
+  mtPattern2Bitmap.Concat(mtAdjust);
+  return mtPattern2Bitmap;
+}
 static CFX_DIBitmap* DrawPatternBitmap(CPDF_Document* pDoc,
                                        CPDF_PageRenderCache* pCache,
                                        CPDF_TilingPattern* pPattern,
-                                       const CFX_Matrix* pObject2Device,
+                                       const CFX_Matrix* pPattern2Bitmap,
                                        int width,
                                        int height,
                                        int flags) {
@@ -974,14 +1013,6 @@ static CFX_DIBitmap* DrawPatternBitmap(CPDF_Document* pDoc,
   CFX_FxgeDevice bitmap_device;
   bitmap_device.Attach(pBitmap);
   pBitmap->Clear(0);
-  CFX_FloatRect cell_bbox = pPattern->m_BBox;
-  pPattern->m_Pattern2Form.TransformRect(cell_bbox);
-  pObject2Device->TransformRect(cell_bbox);
-  CFX_FloatRect bitmap_rect(0.0f, 0.0f, (FX_FLOAT)width, (FX_FLOAT)height);
-  CFX_Matrix mtAdjust;
-  mtAdjust.MatchRect(bitmap_rect, cell_bbox);
-  CFX_Matrix mtPattern2Bitmap = *pObject2Device;
-  mtPattern2Bitmap.Concat(mtAdjust);
   CPDF_RenderOptions options;
   if (!pPattern->m_bColored) {
     options.m_ColorMode = RENDER_COLOR_ALPHA;
@@ -989,10 +1020,93 @@ static CFX_DIBitmap* DrawPatternBitmap(CPDF_Document* pDoc,
   flags |= RENDER_FORCE_HALFTONE;
   options.m_Flags = flags;
   CPDF_RenderContext context(pDoc, pCache);
-  context.AppendLayer(pPattern->m_pForm, &mtPattern2Bitmap);
+  context.AppendLayer(pPattern->m_pForm, pPattern2Bitmap);
   context.Render(&bitmap_device, &options, nullptr);
   return pBitmap;
 }
+// Returns a |width| x |height| cell of |pPattern| for objects drawn with
+// |pObject2Device|, rendered at most once per page for each scale.
+static CFX_DIBitmapRef LoadPatternCell(CPDF_RenderContext* pContext,
+                                       const CPDF_RenderOptions& options,
+                                       CPDF_TilingPattern* pPattern,
+                                       const CFX_Matrix* pObject2Device,
+                                       int width,
+                                       int height) {
+  // Tiny cells are drawn larger, then scaled down.
+  int draw_width = width * height < 16 ? 8 : width;
+  int draw_height = width * height < 16 ? 8 : height;
+  CFX_Matrix mtPattern2Bitmap =
+      GetPatternBitmapMatrix(pPattern, pObject2Device, draw_width, draw_height);
+  CPDF_PageRenderCache* pCache = pContext->GetPageCache();
+  CPDF_PageRenderCache::PatternKey key;
+  key.m_pPattern = pPattern->m_pPatternObj;
+  key.m_ParentMatrix = pPattern->m_ParentMatrix;
+  key.m_Matrix = mtPattern2Bitmap;
+  key.m_Width = width;
+  key.m_Height = height;
+  key.m_Flags = options.m_Flags;
+  key.m_ColorMode = options.m_ColorMode;
+  key.m_ForeColor = 0;
+  key.m_BackColor = 0;
+  if (options.m_ColorMode == RENDER_COLOR_GRAY) {
+    key.m_ForeColor = options.m_ForeColor;
+    key.m_BackColor = options.m_BackColor;
+  }
+  CFX_DIBitmapRef cell;
+  if (pCache) {
+    cell = pCache->GetCachedPatternCell(key);
+    if (!cell.IsNull())
+      return cell;
+  }
+  CFX_DIBitmap* pBitmap =
+      DrawPatternBitmap(pContext->GetDocument(), pCache, pPattern,
+                        &mtPattern2Bitmap, draw_width, draw_height,
+                        options.m_Flags);
+  if (pBitmap && (draw_width != width || draw_height != height)) {
+    CFX_DIBitmap* pEnlargedBitmap = pBitmap;
+    pBitmap = pEnlargedBitmap->StretchTo(width, height);
+    delete pEnlargedBitmap;
+  }
+  if (!pBitmap)
+    return cell;
+  if (options.m_ColorMode == RENDER_COLOR_GRAY)
+    pBitmap->ConvertColorScale(options.m_ForeColor, options.m_BackColor);
+  cell.New()->TakeOver(pBitmap);
+  delete pBitmap;
+  if (pCache)
+    pCache->CachePatternCell(key, cell);
+  return cell;
+}
+// Puts one |pCell| onto the clear |pScreen| at (|start_x|, |start_y|).
+static void DrawPatternCell(CFX_DIBitmap* pScreen,
+                            int start_x,
+                            int start_y,
+                            const CFX_DIBitmap* pCell,
+                            FX_BOOL bColored,
+                            FX_ARGB fill_argb) {
+  int width = pCell->GetWidth();
+  int height = pCell->GetHeight();
+  if (width == 1 && height == 1) {
+    if (start_x < 0 || start_x >= pScreen->GetWidth() || start_y < 0 ||
+        start_y >= pScreen->GetHeight()) {
+      return;
+    }
+    FX_DWORD* dest_buf =
+        (FX_DWORD*)(pScreen->GetBuffer() + pScreen->GetPitch() * start_y +
+                    start_x * 4);
+    const uint8_t* src_buf = pCell->GetBuffer();
+    if (bColored) {
+      *dest_buf = *(const FX_DWORD*)src_buf;
+    } else {
+      *dest_buf = (*src_buf << 24) | (fill_argb & 0xffffff);
+    }
+  } else if (bColored) {
+    pScreen->CompositeBitmap(start_x, start_y, width, height, pCell, 0, 0);
+  } else {
+    pScreen->CompositeMask(start_x, start_y, width, height, pCell, fill_argb,
+                           0, 0);
+  }
+}
 void CPDF_RenderStatus::DrawTilingPattern(CPDF_TilingPattern* pPattern,
                                           CPDF_PageObject* pPageObj,
                                           const CFX_Matrix* pObj2Device,
@@ -1086,98 +1200,52 @@ void CPDF_RenderStatus::DrawTilingPattern(CPDF_TilingPattern* pPattern,
     delete pStates;
     return;
   }
-  if (bAligned) {
-    int orig_x = FXSYS_round(mtPattern2Device.e);
-    int orig_y = FXSYS_round(mtPattern2Device.f);
-    min_col = (clip_box.left - orig_x) / width;
-    if (clip_box.left < orig_x) {
-      min_col--;
-    }
-    max_col = (clip_box.right - orig_x) / width;
-    if (clip_box.right <= orig_x) {
-      max_col--;
-    }
-    min_row = (clip_box.top - orig_y) / height;
-    if (clip_box.top < orig_y) {
-      min_row--;
-    }
-    max_row = (clip_box.bottom - orig_y) / height;
-    if (clip_box.bottom <= orig_y) {
-      max_row--;
-    }
-  }
   FX_FLOAT left_offset = cell_bbox.left - mtPattern2Device.e;
   FX_FLOAT top_offset = cell_bbox.bottom - mtPattern2Device.f;
-  CFX_DIBitmap* pPatternBitmap = NULL;
-  if (width * height < 16) {
-    CFX_DIBitmap* pEnlargedBitmap =
-        DrawPatternBitmap(m_pContext->GetDocument(), m_pContext->GetPageCache(),
-                          pPattern, pObj2Device, 8, 8, m_Options.m_Flags);
-    pPatternBitmap = pEnlargedBitmap->StretchTo(width, height);
-    delete pEnlargedBitmap;
-  } else {
-    pPatternBitmap = DrawPatternBitmap(
-        m_pContext->GetDocument(), m_pContext->GetPageCache(), pPattern,
-        pObj2Device, width, height, m_Options.m_Flags);
-  }
-  if (!pPatternBitmap) {
+  CFX_DIBitmapRef cell = LoadPatternCell(m_pContext, m_Options, pPattern,
+                                         pObj2Device, width, height);
+  if (cell.IsNull()) {
     m_pDevice->RestoreState();
     return;
   }
-  if (m_Options.m_ColorMode == RENDER_COLOR_GRAY) {
-    pPatternBitmap->ConvertColorScale(m_Options.m_ForeColor,
-                                      m_Options.m_BackColor);
-  }
+  const CFX_DIBitmap* pPatternBitmap = cell.GetObject();
   FX_ARGB fill_argb = GetFillArgb(pPageObj);
   int clip_width = clip_box.right - clip_box.left;
   int clip_height = clip_box.bottom - clip_box.top;
   CFX_DIBitmap screen;
-  if (!screen.Create(clip_width, clip_height, FXDIB_Argb)) {
+  if (!screen.CreateUninit(clip_width, clip_height, FXDIB_Argb)) {
+    m_pDevice->RestoreState();
     return;
   }
-  screen.Clear(0);
-  FX_DWORD* src_buf = (FX_DWORD*)pPatternBitmap->GetBuffer();
-  for (int col = min_col; col <= max_col; col++) {
-    for (int row = min_row; row <= max_row; row++) {
-      int start_x, start_y;
-      if (bAligned) {
-        start_x = FXSYS_round(mtPattern2Device.e) + col * width - clip_box.left;
-        start_y = FXSYS_round(mtPattern2Device.f) + row * height - clip_box.top;
-      } else {
+  if (bAligned) {
+    // Cells lie edge to edge, so the area is one cell drawn on a clear
+    // background repeated.
+    CFX_DIBitmap tile;
+    if (!tile.Create(width, height, FXDIB_Argb)) {
+      m_pDevice->RestoreState();
+      return;
+    }
+    DrawPatternCell(&tile, 0, 0, pPatternBitmap, pPattern->m_bColored,
+                    fill_argb);
+    screen.TileBitmap(&tile, FXSYS_round(mtPattern2Device.e) - clip_box.left,
+                      FXSYS_round(mtPattern2Device.f) - clip_box.top);
+  } else {
+    screen.Clear(0);
+    for (int col = min_col; col <= max_col; col++) {
+      for (int row = min_row; row <= max_row; row++) {
         FX_FLOAT orig_x = col * pPattern->m_XStep;
         FX_FLOAT orig_y = row * pPattern->m_YStep;
         mtPattern2Device.Transform(orig_x, orig_y);
-        start_x = FXSYS_round(orig_x + left_offset) - clip_box.left;
-        start_y = FXSYS_round(orig_y + top_offset) - clip_box.top;
-      }
-      if (width == 1 && height == 1) {
-        if (start_x < 0 || start_x >= clip_box.Width() || start_y < 0 ||
-            start_y >= clip_box.Height()) {
-          continue;
-        }
-        FX_DWORD* dest_buf =
-            (FX_DWORD*)(screen.GetBuffer() + screen.GetPitch() * start_y +
-                        start_x * 4);
-        if (pPattern->m_bColored) {
-          *dest_buf = *src_buf;
-        } else {
-          *dest_buf = (*(uint8_t*)src_buf << 24) | (fill_argb & 0xffffff);
-        }
-      } else {
-        if (pPattern->m_bColored) {
-          screen.CompositeBitmap(start_x, start_y, width, height,
-                                 pPatternBitmap, 0, 0);
-        } else {
-          screen.CompositeMask(start_x, start_y, width, height, pPatternBitmap,
-                               fill_argb, 0, 0);
-        }
+        DrawPatternCell(
+            &screen, FXSYS_round(orig_x + left_offset) - clip_box.left,
+            FXSYS_round(orig_y + top_offset) - clip_box.top, pPatternBitmap,
+            pPattern->m_bColored, fill_argb);
       }
     }
   }
   CompositeDIBitmap(&screen, clip_box.left, clip_box.top, 0, 255,
                     FXDIB_BLEND_NORMAL, FALSE);
   m_pDevice->RestoreState();
-  delete pPatternBitmap;
 }
 void CPDF_RenderStatus::DrawPathWithPattern(CPDF_PathObject* pPathObj,
                                             const CFX_Matrix* pObj2Device,
@@ -2,9 +2,57 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <stdint.h>
+#include <stdlib.h>
+
 #include "testing/embedder_test.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
+namespace {
+
+// Renders |page| at |scale| onto white.
+FPDF_BITMAP RenderPageAtScale(FPDF_PAGE page, int scale) {
+  int width = static_cast<int>(FPDF_GetPageWidth(page)) * scale;
+  int height = static_cast<int>(FPDF_GetPageHeight(page)) * scale;
+  FPDF_BITMAP bitmap = FPDFBitmap_Create(width, height, 0);
+  FPDFBitmap_FillRect(bitmap, 0, 0, width, height, 0xFFFFFFFF);
+  FPDF_RenderPageBitmap(bitmap, page, 0, 0, width, height, 0, 0);
+  return bitmap;
+}
+
+// The color of the pixel at |x|, |y| of a 32bpp |bitmap|, as 0xRRGGBB.
+uint32_t GetPixel(FPDF_BITMAP bitmap, int x, int y) {
+  const uint8_t* pixel =
+      static_cast<const uint8_t*>(FPDFBitmap_GetBuffer(bitmap)) +
+      y * FPDFBitmap_GetStride(bitmap) + x * 4;
+  return pixel[2] << 16 | pixel[1] << 8 | pixel[0];
+}
+
+bool IsNear(uint32_t expected, uint32_t actual, int tolerance) {
+  for (int shift = 0; shift < 24; shift += 8) {
+    int diff = static_cast<int>((expected >> shift) & 0xff) -
+               static_cast<int>((actual >> shift) & 0xff);
+    if (abs(diff) > tolerance)
+      return false;
+  }
+  return true;
+}
+
+// Counts the pixels left white in the square from |min| to |max| in page
+// units, where a mesh covering it is drawn.
+int CountUnpainted(FPDF_BITMAP bitmap, int scale, int min, int max) {
+  int count = 0;
+  for (int y = min * scale; y < max * scale; y++) {
+    for (int x = min * scale; x < max * scale; x++) {
+      if (GetPixel(bitmap, x, y) == 0xFFFFFF)
+        count++;
+    }
+  }
+  return count;
+}
+
+}  // namespace
+
 class FPDFRenderPatternEmbeddertest : public EmbedderTest {};
 
 TEST_F(FPDFRenderPatternEmbeddertest, LoadError_547706) {
@@ -15,3 +63,64 @@ TEST_F(FPDFRenderPatternEmbeddertest, LoadError_547706) {
   FPDFBitmap_Destroy(bitmap);
   UnloadPage(page);
 }
+
+TEST_F(FPDFRenderPatternEmbeddertest, PatchMesh) {
+  // Two Coons patches meeting along a curve, over the square from 20 to 180.
+  EXPECT_TRUE(OpenDocument("mesh_shading.pdf"));
+  FPDF_PAGE page = LoadPage(0);
+  ASSERT_NE(nullptr, page);
+  for (int scale = 1; scale <= 3; scale += 2) {
+    FPDF_BITMAP bitmap = RenderPageAtScale(page, scale);
+    EXPECT_EQ(0, CountUnpainted(bitmap, scale, 21, 179)) << scale;
+    // Near the corners, and in the middle of the left patch, where the
+    // colors of its corners average out.
+    EXPECT_TRUE(IsNear(0x00ff00, GetPixel(bitmap, 21 * scale, 21 * scale), 8));
+    EXPECT_TRUE(IsNear(0xff0000, GetPixel(bitmap, 178 * scale, 21 * scale), 8));
+    EXPECT_TRUE(IsNear(0xff0000, GetPixel(bitmap, 21 * scale, 178 * scale), 8));
+    EXPECT_TRUE(
+        IsNear(0x00ff00, GetPixel(bitmap, 178 * scale, 178 * scale), 8));
+    EXPECT_TRUE(
+        IsNear(0x808040, GetPixel(bitmap, 71 * scale, 100 * scale), 12));
+    FPDFBitmap_Destroy(bitmap);
+  }
+  UnloadPage(page);
+}
+
+TEST_F(FPDFRenderPatternEmbeddertest, PatchMeshNoSmoothPath) {
+  // At 206 pixels the square from 20 to 180 starts and ends 0.6 pixels into
+  // pixels 20 and 185. They are filled unless paths are drawn aliased.
+  EXPECT_TRUE(OpenDocument("mesh_shading.pdf"));
+  FPDF_PAGE page = LoadPage(0);
+  ASSERT_NE(nullptr, page);
+  for (int flags = 0; flags <= FPDF_RENDER_NO_SMOOTHPATH;
+       flags += FPDF_RENDER_NO_SMOOTHPATH) {
+    FPDF_BITMAP bitmap = FPDFBitmap_Create(206, 206, 0);
+    FPDFBitmap_FillRect(bitmap, 0, 0, 206, 206, 0xFFFFFFFF);
+    FPDF_RenderPageBitmap(bitmap, page, 0, 0, 206, 206, 0, flags);
+    uint32_t edge = flags ? 0xFFFFFF : 0xFF0000;
+    EXPECT_TRUE(IsNear(edge, GetPixel(bitmap, 20, 185), 8)) << flags;
+    EXPECT_TRUE(IsNear(edge, GetPixel(bitmap, 185, 20), 8)) << flags;
+    EXPECT_TRUE(IsNear(0xff0000, GetPixel(bitmap, 21, 184), 8)) << flags;
+    EXPECT_TRUE(IsNear(0xff0000, GetPixel(bitmap, 184, 21), 8)) << flags;
+    FPDFBitmap_Destroy(bitmap);
+  }
+  UnloadPage(page);
+}
+
+TEST_F(FPDFRenderPatternEmbeddertest, TriangleMesh) {
+  // Three triangles over the square from 20 to 180, with a vertex in the
+  // middle of its right side.
+  EXPECT_TRUE(OpenDocument("mesh_shading.pdf"));
+  FPDF_PAGE page = LoadPage(1);
+  ASSERT_NE(nullptr, page);
+  for (int scale = 1; scale <= 3; scale += 2) {
+    FPDF_BITMAP bitmap = RenderPageAtScale(page, scale);
+    EXPECT_EQ(0, CountUnpainted(bitmap, scale, 21, 179)) << scale;
+    EXPECT_TRUE(IsNear(0x0000ff, GetPixel(bitmap, 21 * scale, 21 * scale), 8));
+    EXPECT_TRUE(IsNear(0xff0000, GetPixel(bitmap, 21 * scale, 178 * scale), 8));
+    EXPECT_TRUE(
+        IsNear(0x00ff00, GetPixel(bitmap, 179 * scale - 1, 100 * scale), 8));
+    FPDFBitmap_Destroy(bitmap);
+  }
+  UnloadPage(page);
+}
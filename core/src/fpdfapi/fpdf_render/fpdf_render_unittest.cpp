@@ -0,0 +1,214 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/src/fpdfapi/fpdf_render/render_int.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+bool IsZeroed(const CFX_DIBitmap& bitmap) {
+  int row_bytes = bitmap.GetWidth() * bitmap.GetBPP() / 8;
+  for (int row = 0; row < bitmap.GetHeight(); row++) {
+    const uint8_t* scan = bitmap.GetScanline(row);
+    for (int i = 0; i < row_bytes; i++) {
+      if (scan[i])
+        return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+TEST(fpdf_render, ScratchBitmapPool) {
+  CPDF_ScratchBitmapPool pool;
+  const uint8_t* buffer;
+  {
+    CPDF_ScratchBitmap scratch;
+    CFX_DIBitmap* pBitmap = scratch.Create(&pool, 40, 10, FXDIB_Argb);
+    ASSERT_TRUE(pBitmap);
+    EXPECT_EQ(40, pBitmap->GetWidth());
+    EXPECT_EQ(10, pBitmap->GetHeight());
+    EXPECT_TRUE(IsZeroed(*pBitmap));
+    buffer = pBitmap->GetBuffer();
+    pBitmap->Clear(0xff2040c0);
+  }
+  EXPECT_EQ(1u, pool.GetLeaseCount());
+  EXPECT_EQ(0u, pool.GetReuseCount());
+  EXPECT_LT(0u, pool.GetIdleBytes());
+
+  {
+    // A similar size gets the same buffer back, cleared.
+    CPDF_ScratchBitmap scratch;
+    CFX_DIBitmap* pBitmap = scratch.Create(&pool, 60, 30, FXDIB_Argb);
+    ASSERT_TRUE(pBitmap);
+    EXPECT_EQ(buffer, pBitmap->GetBuffer());
+    EXPECT_TRUE(IsZeroed(*pBitmap));
+    EXPECT_EQ(0u, pool.GetIdleBytes());
+
+    // While it is out, nobody else gets it.
+    CPDF_ScratchBitmap other;
+    CFX_DIBitmap* pOther = other.Create(&pool, 60, 30, FXDIB_Argb);
+    ASSERT_TRUE(pOther);
+    EXPECT_NE(buffer, pOther->GetBuffer());
+  }
+  EXPECT_EQ(3u, pool.GetLeaseCount());
+  EXPECT_EQ(1u, pool.GetReuseCount());
+
+  {
+    // Neither another format nor a much bigger size fits.
+    CPDF_ScratchBitmap mask;
+    ASSERT_TRUE(mask.Create(&pool, 10, 10, FXDIB_8bppMask));
+    CPDF_ScratchBitmap big;
+    ASSERT_TRUE(big.Create(&pool, 200, 200, FXDIB_Argb));
+    EXPECT_EQ(1u, pool.GetReuseCount());
+  }
+
+  // Bitmaps with a separate alpha mask are never pooled.
+  CPDF_ScratchBitmap cmyka;
+  EXPECT_TRUE(cmyka.Create(&pool, 10, 10, FXDIB_Cmyka));
+  EXPECT_EQ(5u, pool.GetLeaseCount());
+
+  CPDF_ScratchBitmap empty;
+  EXPECT_FALSE(empty.Create(&pool, 0, 10, FXDIB_Argb));
+}
+
+TEST(fpdf_render, SMaskCache) {
+  CPDF_PageRenderCache cache(nullptr);
+  std::unique_ptr<CPDF_Dictionary, ReleaseDeleter<CPDF_Dictionary>> pDict(
+      new CPDF_Dictionary);
+  CPDF_PageRenderCache::SMaskKey key;
+  key.m_pDict = pDict.get();
+  key.m_pPageResources = nullptr;
+  key.m_Matrix.Set(2, 0, 0, 2, 10, 20);
+  key.m_Rect = FX_RECT(0, 0, 100, 50);
+  EXPECT_TRUE(cache.GetCachedSMask(key).IsNull());
+
+  CFX_DIBitmapRef mask;
+  ASSERT_TRUE(mask.New()->Create(100, 50, FXDIB_8bppMask));
+  cache.CacheSMask(key, mask);
+  EXPECT_EQ(mask, cache.GetCachedSMask(key));
+  EXPECT_EQ(100u * 50u, cache.EstimateSize());
+
+  // Any change of place is another mask.
+  CPDF_PageRenderCache::SMaskKey moved = key;
+  moved.m_Matrix.e += 1;
+  EXPECT_TRUE(cache.GetCachedSMask(moved).IsNull());
+  moved = key;
+  moved.m_Rect.right--;
+  EXPECT_TRUE(cache.GetCachedSMask(moved).IsNull());
+
+  // Masks are dropped with images when the cache is over its limit.
+  cache.CacheOptimization(0);
+  EXPECT_TRUE(cache.GetCachedSMask(key).IsNull());
+  EXPECT_EQ(0u, cache.CountCachedSMasks());
+  EXPECT_EQ(0u, cache.EstimateSize());
+}
+
+TEST(fpdf_render, DisplayList) {
+  // A 20 x 20 grid of small objects, one page-sized background and one
+  // with inverted bounds, which the renderers' tests can still pass.
+  CPDF_PageObjectList objects;
+  for (int i = 0; i < 400; i++) {
+    CPDF_PageObject* pObj = CPDF_PageObject::Create(CPDF_PageObject::PATH);
+    pObj->m_Left = (FX_FLOAT)(i % 20 * 30);
+    pObj->m_Bottom = (FX_FLOAT)(i / 20 * 30);
+    pObj->m_Right = pObj->m_Left + 25;
+    pObj->m_Top = pObj->m_Bottom + 25;
+    objects.AddTail(pObj);
+  }
+  CPDF_PageObject* pBackground = CPDF_PageObject::Create(CPDF_PageObject::PATH);
+  pBackground->m_Left = pBackground->m_Bottom = 0;
+  pBackground->m_Right = pBackground->m_Top = 600;
+  objects.AddTail(pBackground);
+  CPDF_PageObject* pInverted = CPDF_PageObject::Create(CPDF_PageObject::PATH);
+  pInverted->m_Left = pInverted->m_Bottom = 300;
+  pInverted->m_Right = pInverted->m_Top = 200;
+  objects.AddTail(pInverted);
+
+  CPDF_DisplayList list(&objects);
+  EXPECT_EQ(objects.GetVersion(), list.GetVersion());
+  ASSERT_EQ(402, list.CountObjects());
+  EXPECT_EQ(pBackground, list.GetObject(400));
+
+  const CFX_FloatRect kRects[] = {
+      CFX_FloatRect(0, 0, 600, 600),     CFX_FloatRect(100, 100, 140, 140),
+      CFX_FloatRect(26, 26, 29, 29),     CFX_FloatRect(-50, -50, -10, -10),
+      CFX_FloatRect(590, 300, 700, 310), CFX_FloatRect(250, 0, 250, 600),
+  };
+  for (const CFX_FloatRect& rect : kRects) {
+    std::vector<int> result;
+    list.Query(rect, &result);
+    EXPECT_TRUE(std::is_sorted(result.begin(), result.end()));
+    // Every object the renderers would draw is there, in order.
+    std::vector<int> hits;
+    for (int i : result) {
+      const CPDF_PageObject* pObj = list.GetObject(i);
+      if (pObj->m_Left <= rect.right && pObj->m_Right >= rect.left &&
+          pObj->m_Bottom <= rect.top && pObj->m_Top >= rect.bottom) {
+        hits.push_back(i);
+      }
+    }
+    std::vector<int> expected;
+    for (int i = 0; i < list.CountObjects(); i++) {
+      const CPDF_PageObject* pObj = list.GetObject(i);
+      if (pObj->m_Left <= rect.right && pObj->m_Right >= rect.left &&
+          pObj->m_Bottom <= rect.top && pObj->m_Top >= rect.bottom) {
+        expected.push_back(i);
+      }
+    }
+    EXPECT_EQ(expected, hits);
+  }
+
+  // A small query only sees objects near it.
+  std::vector<int> result;
+  list.Query(CFX_FloatRect(100, 100, 140, 140), &result);
+  EXPECT_LT(result.size(), 40u);
+
+  FX_DWORD version = objects.GetVersion();
+  objects.AddTail(CPDF_PageObject::Create(CPDF_PageObject::PATH));
+  EXPECT_NE(version, objects.GetVersion());
+  CPDF_PageObjectList other;
+  EXPECT_NE(objects.GetVersion(), other.GetVersion());
+}
+
+TEST(fpdf_render, PatternCellCache) {
+  CPDF_PageRenderCache cache(nullptr);
+  std::unique_ptr<CPDF_Dictionary, ReleaseDeleter<CPDF_Dictionary>> pDict(
+      new CPDF_Dictionary);
+  CPDF_PageRenderCache::PatternKey key;
+  key.m_pPattern = pDict.get();
+  key.m_Matrix.Set(2, 0, 0, -2, 0, 20);
+  key.m_Width = 20;
+  key.m_Height = 10;
+  key.m_Flags = 0;
+  key.m_ColorMode = RENDER_COLOR_NORMAL;
+  key.m_ForeColor = 0;
+  key.m_BackColor = 0;
+  EXPECT_TRUE(cache.GetCachedPatternCell(key).IsNull());
+
+  CFX_DIBitmapRef cell;
+  ASSERT_TRUE(cell.New()->Create(20, 10, FXDIB_Argb));
+  cache.CachePatternCell(key, cell);
+  EXPECT_EQ(cell, cache.GetCachedPatternCell(key));
+  EXPECT_EQ(20u * 10u * 4u, cache.EstimateSize());
+
+  // Patterns parsed under another matrix, or drawn at another scale, are
+  // other cells.
+  CPDF_PageRenderCache::PatternKey other = key;
+  other.m_ParentMatrix.Set(1, 0, 0, 1, 5, 0);
+  EXPECT_TRUE(cache.GetCachedPatternCell(other).IsNull());
+  other = key;
+  other.m_Matrix.a = 3;
+  EXPECT_TRUE(cache.GetCachedPatternCell(other).IsNull());
+
+  cache.CacheOptimization(0);
+  EXPECT_EQ(0u, cache.CountCachedPatternCells());
+  EXPECT_EQ(0u, cache.EstimateSize());
+}
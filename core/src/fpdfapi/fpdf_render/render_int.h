@@ -9,6 +9,7 @@
 
 #include <map>
 #include <memory>
+#include <vector>
 
 #include "core/include/fpdfapi/fpdf_pageobj.h"
 #include "core/include/fpdfapi/fpdf_render.h"
@@ -215,9 +216,15 @@ class CPDF_RenderStatus {
                             int& left,
                             int& top,
                             FX_BOOL bBackAlphaRequired);
-  CFX_DIBitmap* LoadSMask(CPDF_Dictionary* pSMaskDict,
-                          FX_RECT* pClipRect,
-                          const CFX_Matrix* pMatrix);
+  // Served from the page render cache when the same mask was rendered at
+  // the same place before.
+  CFX_DIBitmapRef LoadSMask(CPDF_Dictionary* pSMaskDict,
+                            FX_RECT* pClipRect,
+                            const CFX_Matrix* pMatrix);
+  FX_BOOL RenderSMask(CPDF_Dictionary* pSMaskDict,
+                      FX_RECT* pClipRect,
+                      const CFX_Matrix* pMatrix,
+                      CFX_DIBitmap* pMask);
   void Init(CPDF_RenderContext* pParent);
   static class CPDF_Type3Cache* GetCachedType3(CPDF_Type3Font* pFont);
   static CPDF_GraphicStates* CloneObjStates(const CPDF_GraphicStates* pPathObj,
@@ -411,6 +418,112 @@ class CPDF_DeviceBuffer {
   CFX_Matrix m_Matrix;
 };
 
+// Offscreen bitmaps for transparency groups, soft masks and text clips,
+// kept for the length of a render so that pages with many small transparent
+// objects do not allocate and clear a page-sized bitmap for each one.
+// Buffers are rounded up in size and handed out as views of their top left
+// corner; on reuse only the part an earlier view may have touched is
+// cleared.
+class CPDF_ScratchBitmapPool {
+ public:
+  CPDF_ScratchBitmapPool();
+  ~CPDF_ScratchBitmapPool();
+
+  // Bitmaps handed out, and how many of them came from the pool.
+  size_t GetLeaseCount() const { return m_nLeases; }
+  size_t GetReuseCount() const { return m_nReuses; }
+  size_t GetIdleBytes() const { return m_nIdleBytes; }
+
+ private:
+  friend class CPDF_ScratchBitmap;
+
+  struct Buffer {
+    std::unique_ptr<CFX_DIBitmap> m_pBitmap;
+    // Pixels outside this corner are still zero.
+    int m_DirtyWidth;
+    int m_DirtyHeight;
+  };
+
+  static FX_BOOL IsPoolable(FXDIB_Format format);
+
+  Buffer* Take(int width, int height, FXDIB_Format format, FX_BOOL bZeroed);
+  void Return(Buffer* pBuffer);
+
+  // Oldest first.
+  std::vector<std::unique_ptr<Buffer>> m_Idle;
+  size_t m_nIdleBytes;
+  size_t m_nLeases;
+  size_t m_nReuses;
+};
+
+// A bitmap borrowed from a CPDF_ScratchBitmapPool, given back when this
+// goes away.
+class CPDF_ScratchBitmap {
+ public:
+  CPDF_ScratchBitmap();
+  ~CPDF_ScratchBitmap();
+
+  // Returns a |width| x |height| bitmap, or NULL on failure. It is zeroed
+  // unless |bZeroed| is FALSE, for callers that fill all of it themselves.
+  // Without a pool, or for formats with a separate alpha mask, the bitmap
+  // is allocated just for this object.
+  CFX_DIBitmap* Create(CPDF_ScratchBitmapPool* pPool,
+                       int width,
+                       int height,
+                       FXDIB_Format format,
+                       FX_BOOL bZeroed = TRUE);
+
+ private:
+  CPDF_ScratchBitmapPool* m_pPool;
+  CPDF_ScratchBitmapPool::Buffer* m_pBuffer;
+  CFX_DIBitmap m_View;
+};
+
+// The objects of a parsed CPDF_PageObjectList in paint order, bucketed in a
+// uniform grid by their bounds, so that renders clipped to a small part of a
+// busy page, such as tiles at high zoom, find the objects they touch without
+// walking the whole list. It holds no device state and serves any matrix.
+// Built from the bounds objects have now; moving them makes it stale.
+class CPDF_DisplayList {
+ public:
+  explicit CPDF_DisplayList(const CPDF_PageObjectList* pObjectList);
+  ~CPDF_DisplayList();
+
+  FX_DWORD GetVersion() const { return m_dwVersion; }
+  int CountObjects() const { return (int)m_Objects.size(); }
+  CPDF_PageObject* GetObject(int index) const {
+    return m_Objects[index].m_pObject;
+  }
+  FX_POSITION GetPosition(int index) const { return m_Objects[index].m_Pos; }
+
+  // Indices of the objects whose bounds may meet |rect|, in paint order.
+  // Callers still test the bounds themselves.
+  void Query(const CFX_FloatRect& rect, std::vector<int>* pResult) const;
+
+ private:
+  struct Item {
+    CPDF_PageObject* m_pObject;
+    FX_POSITION m_Pos;
+  };
+
+  void GetCellRange(const CFX_FloatRect& rect,
+                    int* pLeft,
+                    int* pBottom,
+                    int* pRight,
+                    int* pTop) const;
+
+  const FX_DWORD m_dwVersion;
+  std::vector<Item> m_Objects;
+  CFX_FloatRect m_BBox;
+  FX_FLOAT m_CellWidth;
+  FX_FLOAT m_CellHeight;
+  int m_nCols;
+  int m_nRows;
+  std::vector<std::vector<int>> m_Cells;
+  // Objects with unusable bounds or spanning too many cells.
+  std::vector<int> m_Unbucketed;
+};
+
 class CPDF_ImageCacheEntry {
  public:
   CPDF_ImageCacheEntry(CPDF_Document* pDoc, CPDF_Stream* pStream);
@@ -0,0 +1,221 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/src/fpdftext/text_int.h"
+
+#include <algorithm>
+#include <cwctype>
+
+#include "core/include/fpdfapi/fpdf_page.h"
+#include "core/include/fxcrt/fx_ext.h"
+#include "third_party/base/stl_util.h"
+
+namespace {
+
+FX_BOOL IsSpace(FX_WCHAR wch) {
+  return wch == L' ' || wch == L'\t' || wch == L'\r' || wch == L'\n' ||
+         wch == 0x3000;
+}
+
+FX_WCHAR FoldCase(FX_WCHAR wch) {
+  return (FX_WCHAR)std::towlower(wch);
+}
+
+// Unlike CFX_WideString::MakeLower(), folds non-ASCII letters too.
+CFX_WideString FoldCase(const CFX_WideString& str) {
+  CFX_WideString result = str;
+  for (int i = 0; i < result.GetLength(); ++i)
+    result.SetAt(i, FoldCase(result.GetAt(i)));
+  return result;
+}
+
+// Same notion of a word character as CPDF_TextPageFind::IsMatchWholeWord().
+FX_BOOL IsWordChar(FX_WCHAR wch) {
+  return FXSYS_iswalnum(wch) || (wch > 0xfb00 && wch < 0xfb06);
+}
+
+}  // namespace
+
+IPDF_DocProgressiveSearch* IPDF_DocProgressiveSearch::Create(
+    CPDF_Document* pDoc,
+    int flags) {
+  return pDoc ? new CPDF_DocProgressiveSearch(pDoc, flags) : nullptr;
+}
+
+CPDF_DocProgressiveSearch::CPDF_DocProgressiveSearch(CPDF_Document* pDoc,
+                                                     int flags)
+    : m_pDocument(pDoc), m_Flags(flags), m_nNextPage(0) {}
+
+CPDF_DocProgressiveSearch::~CPDF_DocProgressiveSearch() {}
+
+// static
+void CPDF_DocProgressiveSearch::NormalizeText(
+    const CFX_WideString& str,
+    CFX_WideString* pResult,
+    std::vector<int>* pSourceIndices) {
+  CFX_WideTextBuf buf;
+  if (pSourceIndices)
+    pSourceIndices->clear();
+  bool bPendingSpace = false;
+  for (int i = 0; i < str.GetLength(); ++i) {
+    FX_WCHAR wch = str.GetAt(i);
+    if (IsSpace(wch)) {
+      bPendingSpace = buf.GetLength() > 0;
+      continue;
+    }
+    if (wch == 0)
+      continue;
+    if (bPendingSpace) {
+      // A collapsed run maps to its last whitespace character.
+      buf.AppendChar(L' ');
+      if (pSourceIndices)
+        pSourceIndices->push_back(i - 1);
+      bPendingSpace = false;
+    }
+    FX_WCHAR normalized[16];
+    FX_STRSIZE nCount = FX_Unicode_GetNormalization(wch, normalized);
+    for (FX_STRSIZE j = 0; j < nCount; ++j) {
+      buf.AppendChar(normalized[j]);
+      if (pSourceIndices)
+        pSourceIndices->push_back(i);
+    }
+  }
+  *pResult = buf.GetWideString();
+}
+
+FX_BOOL CPDF_DocProgressiveSearch::Continue(IFX_Pause* pPause) {
+  int nPages = m_pDocument->GetPageCount();
+  while (m_nNextPage < nPages) {
+    IndexPage(m_nNextPage++);
+    if (m_nNextPage < nPages && pPause && pPause->NeedToPauseNow())
+      return FALSE;
+  }
+  return TRUE;
+}
+
+int CPDF_DocProgressiveSearch::CountIndexedPages() const {
+  return pdfium::CollectionSize<int>(m_Pages);
+}
+
+void CPDF_DocProgressiveSearch::IndexPage(int pageIndex) {
+  m_Pages.push_back(PageText());
+  CPDF_Dictionary* pPageDict = m_pDocument->GetPage(pageIndex);
+  if (!pPageDict)
+    return;
+
+  CPDF_Page page;
+  page.Load(m_pDocument, pPageDict, FALSE);
+  CPDF_ParseOptions options;
+  options.m_bTextOnly = TRUE;
+  page.ParseContent(&options);
+  std::unique_ptr<IPDF_TextPage> pTextPage(
+      IPDF_TextPage::CreateTextPage(&page, m_Flags));
+  if (!pTextPage->ParseTextPage())
+    return;
+
+  int nChars = pTextPage->CountChars();
+  CFX_WideTextBuf chars;
+  for (int i = 0; i < nChars; ++i) {
+    FPDF_CHAR_INFO info;
+    pTextPage->GetCharInfo(i, &info);
+    chars.AppendChar(info.m_Unicode);
+  }
+  PageText& pageText = m_Pages.back();
+  NormalizeText(chars.GetWideString(), &pageText.m_Text,
+                &pageText.m_CharIndices);
+
+  const CFX_WideString& text = pageText.m_Text;
+  int wordStart = 0;
+  for (int i = 0; i <= text.GetLength(); ++i) {
+    if (i < text.GetLength() && text.GetAt(i) != L' ')
+      continue;
+    if (i > wordStart) {
+      m_Words[FoldCase(text.Mid(wordStart, i - wordStart))].push_back(
+          {pageIndex, wordStart});
+    }
+    wordStart = i + 1;
+  }
+}
+
+int CPDF_DocProgressiveSearch::Find(const CFX_WideString& findwhat,
+                                    int flags) {
+  m_Results.clear();
+  CFX_WideString query;
+  NormalizeText(findwhat, &query, nullptr);
+  query.TrimRight(L' ');
+  if (query.IsEmpty())
+    return 0;
+
+  // Every match starts inside a word containing the query's first word,
+  // which must end that word when more words follow.
+  FX_STRSIZE firstLength = query.Find(L' ');
+  bool bSingleWord = firstLength < 0;
+  CFX_WideString first =
+      FoldCase(bSingleWord ? query : query.Left(firstLength));
+  for (const auto& it : m_Words) {
+    const CFX_WideString& word = it.first;
+    FX_STRSIZE pos = bSingleWord ? word.Find(first.c_str())
+                                 : word.GetLength() - first.GetLength();
+    while (pos >= 0) {
+      if (bSingleWord || word.Mid(pos) == first) {
+        for (const Posting& posting : it.second) {
+          const PageText& page = m_Pages[posting.m_PageIndex];
+          int offset = posting.m_Offset + pos;
+          if (!IsMatch(page, offset, query, flags))
+            continue;
+          int start = page.m_CharIndices[offset];
+          int end = page.m_CharIndices[offset + query.GetLength() - 1];
+          m_Results.push_back({posting.m_PageIndex, start, end - start + 1});
+        }
+      }
+      pos = bSingleWord ? word.Find(first.c_str(), pos + 1) : -1;
+    }
+  }
+  std::sort(m_Results.begin(), m_Results.end(),
+            [](const Match& a, const Match& b) {
+              return a.m_PageIndex != b.m_PageIndex
+                         ? a.m_PageIndex < b.m_PageIndex
+                         : a.m_Start < b.m_Start;
+            });
+  return pdfium::CollectionSize<int>(m_Results);
+}
+
+FX_BOOL CPDF_DocProgressiveSearch::IsMatch(const PageText& page,
+                                           int offset,
+                                           const CFX_WideString& findwhat,
+                                           int flags) const {
+  const CFX_WideString& text = page.m_Text;
+  int length = findwhat.GetLength();
+  if (offset < 0 || offset + length > text.GetLength())
+    return FALSE;
+  for (int i = 0; i < length; ++i) {
+    FX_WCHAR wch = text.GetAt(offset + i);
+    FX_WCHAR target = findwhat.GetAt(i);
+    if (wch != target &&
+        ((flags & FPDFTEXT_MATCHCASE) || FoldCase(wch) != FoldCase(target))) {
+      return FALSE;
+    }
+  }
+  if (!(flags & FPDFTEXT_MATCHWHOLEWORD))
+    return TRUE;
+  if (offset > 0 && IsWordChar(text.GetAt(offset - 1)) &&
+      IsWordChar(findwhat.GetAt(0))) {
+    return FALSE;
+  }
+  int end = offset + length;
+  return end >= text.GetLength() || !IsWordChar(text.GetAt(end)) ||
+         !IsWordChar(findwhat.GetAt(length - 1));
+}
+
+FX_BOOL CPDF_DocProgressiveSearch::GetResult(int index,
+                                             int& pageIndex,
+                                             int& start,
+                                             int& count) const {
+  if (index < 0 || index >= pdfium::CollectionSize<int>(m_Results))
+    return FALSE;
+  pageIndex = m_Results[index].m_PageIndex;
+  start = m_Results[index].m_Start;
+  count = m_Results[index].m_Count;
+  return TRUE;
+}
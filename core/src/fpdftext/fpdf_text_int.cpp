@@ -8,6 +8,7 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cmath>
 #include <cwctype>
 #include <memory>
 #include <vector>
@@ -82,8 +83,163 @@ FX_FLOAT _CalculateBaseSpace(const CPDF_TextObject* pTextObj,
 
 const FX_FLOAT kDefaultFontSize = 1.0f;
 
+// Average number of characters per CPDF_TextCharGrid cell.
+const int kCharsPerGridCell = 2;
+const int kMaxGridDimension = 1024;
+// Characters spanning more cells than this are not bucketed.
+const int kMaxCellsPerChar = 64;
+
+FX_BOOL IsFiniteRect(const CFX_FloatRect& rect) {
+  return std::isfinite(rect.left) && std::isfinite(rect.right) &&
+         std::isfinite(rect.bottom) && std::isfinite(rect.top);
+}
+
+CFX_FloatRect GetCharBounds(const PAGECHAR_INFO& charinfo) {
+  CFX_FloatRect rect = charinfo.m_CharBox;
+  rect.Normalize();
+  rect.UpdateRect(charinfo.m_OriginX, charinfo.m_OriginY);
+  return rect;
+}
+
+// Splits |length| into cells of about |cellSize|; returns 1 for degenerate
+// extents, which then need no division.
+int GetGridDimension(FX_FLOAT length, FX_FLOAT cellSize) {
+  if (!(length > 0) || !std::isfinite(length) || !(cellSize > 0))
+    return 1;
+  FX_FLOAT count = length / cellSize;
+  if (!(count >= 1))
+    return 1;
+  return count >= kMaxGridDimension ? kMaxGridDimension : (int)count;
+}
+
+int GetCellIndex(FX_FLOAT pos, FX_FLOAT origin, FX_FLOAT cellSize, int count) {
+  if (count <= 1)
+    return 0;
+  FX_FLOAT index = (pos - origin) / cellSize;
+  if (!(index > 0))
+    return 0;
+  return index >= count ? count - 1 : (int)index;
+}
+
+void FillCharInfo(const PAGECHAR_INFO& charinfo, FPDF_CHAR_INFO* info) {
+  info->m_Charcode = charinfo.m_CharCode;
+  info->m_OriginX = charinfo.m_OriginX;
+  info->m_OriginY = charinfo.m_OriginY;
+  info->m_Unicode = charinfo.m_Unicode;
+  info->m_Flag = charinfo.m_Flag;
+  info->m_CharBox = charinfo.m_CharBox;
+  info->m_pTextObj = charinfo.m_pTextObj;
+  if (charinfo.m_pTextObj && charinfo.m_pTextObj->GetFont()) {
+    info->m_FontSize = charinfo.m_pTextObj->GetFontSize();
+  } else {
+    info->m_FontSize = kDefaultFontSize;
+  }
+  info->m_Matrix.Copy(charinfo.m_Matrix);
+}
+
 }  // namespace
 
+CPDF_TextCharGrid::CPDF_TextCharGrid()
+    : m_CellWidth(0), m_CellHeight(0), m_nCols(0), m_nRows(0) {}
+
+CPDF_TextCharGrid::~CPDF_TextCharGrid() {}
+
+void CPDF_TextCharGrid::Build(const std::deque<PAGECHAR_INFO>& charList) {
+  m_Cells.clear();
+  m_Unbucketed.clear();
+  m_nCols = 0;
+  m_nRows = 0;
+
+  std::vector<CFX_FloatRect> bounds;
+  bounds.reserve(charList.size());
+  bool bHasBBox = false;
+  for (const auto& charinfo : charList) {
+    bounds.push_back(GetCharBounds(charinfo));
+    if (!IsFiniteRect(bounds.back()))
+      continue;
+    if (bHasBBox)
+      m_BBox.Union(bounds.back());
+    else
+      m_BBox = bounds.back();
+    bHasBBox = true;
+  }
+  if (!bHasBBox) {
+    for (int i = 0; i < pdfium::CollectionSize<int>(bounds); ++i)
+      m_Unbucketed.push_back(i);
+    return;
+  }
+
+  // Square cells holding about kCharsPerGridCell characters each.
+  FX_FLOAT width = m_BBox.right - m_BBox.left;
+  FX_FLOAT height = m_BBox.top - m_BBox.bottom;
+  int nCells = std::max(1, pdfium::CollectionSize<int>(bounds) /
+                               kCharsPerGridCell);
+  FX_FLOAT cellSize = 0;
+  if (width > 0 && height > 0)
+    cellSize = (FX_FLOAT)sqrt((double)width * height / nCells);
+  else
+    cellSize = std::max(width, height) / nCells;
+  m_nCols = GetGridDimension(width, cellSize);
+  m_nRows = GetGridDimension(height, cellSize);
+  m_CellWidth = width / m_nCols;
+  m_CellHeight = height / m_nRows;
+  m_Cells.resize(m_nCols * m_nRows);
+  for (int i = 0; i < pdfium::CollectionSize<int>(bounds); ++i) {
+    if (!IsFiniteRect(bounds[i])) {
+      m_Unbucketed.push_back(i);
+      continue;
+    }
+    int left, bottom, right, top;
+    GetCellRange(bounds[i], &left, &bottom, &right, &top);
+    if ((right - left + 1) * (top - bottom + 1) > kMaxCellsPerChar) {
+      m_Unbucketed.push_back(i);
+      continue;
+    }
+    for (int row = bottom; row <= top; ++row) {
+      for (int col = left; col <= right; ++col)
+        m_Cells[row * m_nCols + col].push_back(i);
+    }
+  }
+}
+
+void CPDF_TextCharGrid::Query(const CFX_FloatRect& rect,
+                              std::vector<int>* pResult) const {
+  pResult->clear();
+  CFX_FloatRect area = rect;
+  area.Normalize();
+  if (!IsFiniteRect(area)) {
+    // Comparisons against NaN make the callers' tests unpredictable.
+    for (const auto& cell : m_Cells)
+      pResult->insert(pResult->end(), cell.begin(), cell.end());
+  } else if (!m_Cells.empty() && area.right >= m_BBox.left &&
+             area.left <= m_BBox.right && area.top >= m_BBox.bottom &&
+             area.bottom <= m_BBox.top) {
+    int left, bottom, right, top;
+    GetCellRange(area, &left, &bottom, &right, &top);
+    for (int row = bottom; row <= top; ++row) {
+      for (int col = left; col <= right; ++col) {
+        const std::vector<int>& cell = m_Cells[row * m_nCols + col];
+        pResult->insert(pResult->end(), cell.begin(), cell.end());
+      }
+    }
+  }
+  pResult->insert(pResult->end(), m_Unbucketed.begin(), m_Unbucketed.end());
+  std::sort(pResult->begin(), pResult->end());
+  pResult->erase(std::unique(pResult->begin(), pResult->end()),
+                 pResult->end());
+}
+
+void CPDF_TextCharGrid::GetCellRange(const CFX_FloatRect& rect,
+                                     int* pLeft,
+                                     int* pBottom,
+                                     int* pRight,
+                                     int* pTop) const {
+  *pLeft = GetCellIndex(rect.left, m_BBox.left, m_CellWidth, m_nCols);
+  *pRight = GetCellIndex(rect.right, m_BBox.left, m_CellWidth, m_nCols);
+  *pBottom = GetCellIndex(rect.bottom, m_BBox.bottom, m_CellHeight, m_nRows);
+  *pTop = GetCellIndex(rect.top, m_BBox.bottom, m_CellHeight, m_nRows);
+}
+
 IPDF_TextPage* IPDF_TextPage::CreateTextPage(const CPDF_Page* pPage,
                                              int flags) {
   return new CPDF_TextPage(pPage, flags);
@@ -141,6 +297,8 @@ FX_BOOL CPDF_TextPage::ParseTextPage() {
 
   m_TextBuf.Clear();
   m_CharList.clear();
+  m_pCharGrid.reset();
+  m_NonSpaceCounts.clear();
   m_pPreTextObj = NULL;
   ProcessObject();
   m_bIsParsed = true;
@@ -189,6 +347,26 @@ FX_BOOL CPDF_TextPage::ParseTextPage() {
 int CPDF_TextPage::CountChars() const {
   return pdfium::CollectionSize<int>(m_CharList);
 }
+
+const CPDF_TextCharGrid* CPDF_TextPage::GetCharGrid() const {
+  if (!m_pCharGrid) {
+    m_pCharGrid.reset(new CPDF_TextCharGrid);
+    m_pCharGrid->Build(m_CharList);
+    m_NonSpaceCounts.assign(1, 0);
+    for (const auto& charinfo : m_CharList) {
+      m_NonSpaceCounts.push_back(m_NonSpaceCounts.back() +
+                                 (charinfo.m_Unicode != 32 ? 1 : 0));
+    }
+  }
+  return m_pCharGrid.get();
+}
+
+int CPDF_TextPage::CountNonSpaces(int start, int end) const {
+  if (start >= end)
+    return 0;
+  return m_NonSpaceCounts[end] - m_NonSpaceCounts[start];
+}
+
 int CPDF_TextPage::CharIndexFromTextIndex(int TextIndex) const {
   int indexSize = m_CharIndex.GetSize();
   int count = 0;
@@ -307,16 +485,24 @@ int CPDF_TextPage::GetIndexAtPos(CPDF_Point point,
   if (!m_bIsParsed)
     return -3;
 
-  int pos = 0;
+  CFX_FloatRect area(point.x, point.y, point.x, point.y);
+  if (xTolerance > 0 || yTolerance > 0) {
+    area.left -= std::max(xTolerance, 0.0f) / 2;
+    area.right += std::max(xTolerance, 0.0f) / 2;
+    area.bottom -= std::max(yTolerance, 0.0f) / 2;
+    area.top += std::max(yTolerance, 0.0f) / 2;
+  }
+  std::vector<int> candidates;
+  GetCharGrid()->Query(area, &candidates);
+
   int NearPos = -1;
   double xdif = 5000;
   double ydif = 5000;
-  while (pos < pdfium::CollectionSize<int>(m_CharList)) {
-    PAGECHAR_INFO charinfo = m_CharList[pos];
+  for (int pos : candidates) {
+    const PAGECHAR_INFO& charinfo = m_CharList[pos];
     CFX_FloatRect charrect = charinfo.m_CharBox;
-    if (charrect.Contains(point.x, point.y)) {
-      break;
-    }
+    if (charrect.Contains(point.x, point.y))
+      return pos;
     if (xTolerance > 0 || yTolerance > 0) {
       CFX_FloatRect charRectExt;
       charrect.Normalize();
@@ -341,43 +527,59 @@ int CPDF_TextPage::GetIndexAtPos(CPDF_Point point,
         }
       }
     }
-    ++pos;
   }
-  return pos < pdfium::CollectionSize<int>(m_CharList) ? pos : NearPos;
+  return NearPos;
 }
 
 CFX_WideString CPDF_TextPage::GetTextByRect(const CFX_FloatRect& rect) const {
   if (!m_bIsParsed)
     return CFX_WideString();
 
+  std::vector<int> candidates;
+  GetCharGrid()->Query(rect, &candidates);
+  candidates.push_back(pdfium::CollectionSize<int>(m_CharList));
+
   FX_FLOAT posy = 0;
   bool IsContainPreChar = false;
   bool IsAddLineFeed = false;
   CFX_WideString strText;
-  for (const auto& charinfo : m_CharList) {
-    if (IsRectIntersect(rect, charinfo.m_CharBox)) {
-      if (FXSYS_fabs(posy - charinfo.m_OriginY) > 0 && !IsContainPreChar &&
-          IsAddLineFeed) {
-        posy = charinfo.m_OriginY;
-        if (strText.GetLength() > 0) {
-          strText += L"\r\n";
+  int nextPos = 0;
+  for (int pos : candidates) {
+    bool bHit = pos < pdfium::CollectionSize<int>(m_CharList) &&
+                IsRectIntersect(rect, m_CharList[pos].m_CharBox);
+    if (!bHit && pos < pdfium::CollectionSize<int>(m_CharList))
+      continue;
+    if (nextPos < pos) {
+      // Apply the characters outside |rect| since the last hit: a leading
+      // space is kept after a hit, any other character starts a new line.
+      if (m_CharList[nextPos].m_Unicode == 32) {
+        if (IsContainPreChar) {
+          strText += m_CharList[nextPos].m_Unicode;
+          IsAddLineFeed = false;
         }
+      } else {
+        IsAddLineFeed = true;
       }
-      IsContainPreChar = true;
-      IsAddLineFeed = false;
-      if (charinfo.m_Unicode) {
-        strText += charinfo.m_Unicode;
-      }
-    } else if (charinfo.m_Unicode == 32) {
-      if (IsContainPreChar && charinfo.m_Unicode) {
-        strText += charinfo.m_Unicode;
-        IsContainPreChar = false;
-        IsAddLineFeed = false;
-      }
-    } else {
       IsContainPreChar = false;
-      IsAddLineFeed = true;
+      if (CountNonSpaces(nextPos + 1, pos) > 0)
+        IsAddLineFeed = true;
     }
+    if (!bHit)
+      break;
+    const PAGECHAR_INFO& charinfo = m_CharList[pos];
+    if (FXSYS_fabs(posy - charinfo.m_OriginY) > 0 && !IsContainPreChar &&
+        IsAddLineFeed) {
+      posy = charinfo.m_OriginY;
+      if (strText.GetLength() > 0) {
+        strText += L"\r\n";
+      }
+    }
+    IsContainPreChar = true;
+    IsAddLineFeed = false;
+    if (charinfo.m_Unicode) {
+      strText += charinfo.m_Unicode;
+    }
+    nextPos = pos + 1;
   }
   return strText;
 }
@@ -386,10 +588,14 @@ void CPDF_TextPage::GetRectsArrayByRect(const CFX_FloatRect& rect,
   if (!m_bIsParsed)
     return;
 
+  std::vector<int> candidates;
+  GetCharGrid()->Query(rect, &candidates);
+
   CFX_FloatRect curRect;
   bool flagNewRect = true;
   CPDF_TextObject* pCurObj = nullptr;
-  for (auto info_curchar : m_CharList) {
+  for (int pos : candidates) {
+    PAGECHAR_INFO info_curchar = m_CharList[pos];
     if (info_curchar.m_Flag == FPDFTEXT_CHAR_GENERATED) {
       continue;
     }
@@ -433,20 +639,24 @@ void CPDF_TextPage::GetCharInfo(int index, FPDF_CHAR_INFO* info) const {
   if (index < 0 || index >= pdfium::CollectionSize<int>(m_CharList))
     return;
 
-  const PAGECHAR_INFO& charinfo = m_CharList[index];
-  info->m_Charcode = charinfo.m_CharCode;
-  info->m_OriginX = charinfo.m_OriginX;
-  info->m_OriginY = charinfo.m_OriginY;
-  info->m_Unicode = charinfo.m_Unicode;
-  info->m_Flag = charinfo.m_Flag;
-  info->m_CharBox = charinfo.m_CharBox;
-  info->m_pTextObj = charinfo.m_pTextObj;
-  if (charinfo.m_pTextObj && charinfo.m_pTextObj->GetFont()) {
-    info->m_FontSize = charinfo.m_pTextObj->GetFontSize();
-  } else {
-    info->m_FontSize = kDefaultFontSize;
-  }
-  info->m_Matrix.Copy(charinfo.m_Matrix);
+  FillCharInfo(m_CharList[index], info);
+}
+
+int CPDF_TextPage::GetCharInfos(int start,
+                                int count,
+                                FPDF_CHAR_INFO* infos) const {
+  if (!m_bIsParsed || start < 0 || count <= 0)
+    return 0;
+
+  int nChars = pdfium::CollectionSize<int>(m_CharList);
+  if (start >= nChars)
+    return 0;
+
+  count = std::min(count, nChars - start);
+  auto it = m_CharList.begin() + start;
+  for (int i = 0; i < count; ++i, ++it)
+    FillCharInfo(*it, &infos[i]);
+  return count;
 }
 
 void CPDF_TextPage::CheckMarkedContentObject(int32_t& start,
@@ -640,69 +850,61 @@ int CPDF_TextPage::CountBoundedSegments(FX_FLOAT left,
   CFX_FloatRect rect(left, bottom, right, top);
   rect.Normalize();
 
+  std::vector<int> candidates;
+  GetCharGrid()->Query(rect, &candidates);
+  candidates.push_back(pdfium::CollectionSize<int>(m_CharList));
+
   FPDF_SEGMENT segment;
   segment.m_Start = 0;
   segment.m_nCount = 0;
+  bool bInSegment = false;
+  auto AddToSegment = [&segment, &bInSegment](int pos) {
+    if (bInSegment) {
+      segment.m_nCount++;
+      return;
+    }
+    segment.m_Start = pos;
+    segment.m_nCount = 1;
+    bInSegment = true;
+  };
+  auto EndSegment = [this, &segment, &bInSegment]() {
+    if (!bInSegment)
+      return;
+    m_Segments.Add(segment);
+    bInSegment = false;
+  };
 
-  int pos = 0;
-  int segmentStatus = 0;
   FX_BOOL IsContainPreChar = FALSE;
-  for (const auto& charinfo : m_CharList) {
-    if (bContains && rect.Contains(charinfo.m_CharBox)) {
-      if (segmentStatus == 0 || segmentStatus == 2) {
-        segment.m_Start = pos;
-        segment.m_nCount = 1;
-        segmentStatus = 1;
-      } else if (segmentStatus == 1) {
-        segment.m_nCount++;
-      }
-      IsContainPreChar = TRUE;
-    } else if (!bContains &&
-               (IsRectIntersect(rect, charinfo.m_CharBox) ||
-                rect.Contains(charinfo.m_OriginX, charinfo.m_OriginY))) {
-      if (segmentStatus == 0 || segmentStatus == 2) {
-        segment.m_Start = pos;
-        segment.m_nCount = 1;
-        segmentStatus = 1;
-      } else if (segmentStatus == 1) {
-        segment.m_nCount++;
-      }
-      IsContainPreChar = TRUE;
-    } else if (charinfo.m_Unicode == 32) {
-      if (IsContainPreChar == TRUE) {
-        if (segmentStatus == 0 || segmentStatus == 2) {
-          segment.m_Start = pos;
-          segment.m_nCount = 1;
-          segmentStatus = 1;
-        } else if (segmentStatus == 1) {
-          segment.m_nCount++;
-        }
-        IsContainPreChar = FALSE;
-      } else {
-        if (segmentStatus == 1) {
-          segmentStatus = 2;
-          m_Segments.Add(segment);
-          segment.m_Start = 0;
-          segment.m_nCount = 0;
-        }
-      }
-    } else {
-      if (segmentStatus == 1) {
-        segmentStatus = 2;
-        m_Segments.Add(segment);
-        segment.m_Start = 0;
-        segment.m_nCount = 0;
-      }
+  int nextPos = 0;
+  for (int pos : candidates) {
+    bool bHit = false;
+    if (pos < pdfium::CollectionSize<int>(m_CharList)) {
+      const PAGECHAR_INFO& charinfo = m_CharList[pos];
+      bHit = bContains ? !!rect.Contains(charinfo.m_CharBox)
+                       : (IsRectIntersect(rect, charinfo.m_CharBox) ||
+                          rect.Contains(charinfo.m_OriginX,
+                                        charinfo.m_OriginY));
+      if (!bHit)
+        continue;
+    }
+    if (nextPos < pos) {
+      // Characters outside |rect| end the segment, except that one space
+      // right after a hit still belongs to it.
+      bool bKeepSpace =
+          IsContainPreChar && m_CharList[nextPos].m_Unicode == 32;
+      if (bKeepSpace)
+        AddToSegment(nextPos);
+      if (!bKeepSpace || pos - nextPos > 1)
+        EndSegment();
       IsContainPreChar = FALSE;
     }
-    pos++;
-  }
-  if (segmentStatus == 1) {
-    segmentStatus = 2;
-    m_Segments.Add(segment);
-    segment.m_Start = 0;
-    segment.m_nCount = 0;
+    if (!bHit)
+      break;
+    AddToSegment(pos);
+    IsContainPreChar = TRUE;
+    nextPos = pos + 1;
   }
+  EndSegment();
   return m_Segments.GetSize();
 }
 void CPDF_TextPage::GetBoundedSegment(int index, int& start, int& count) const {
@@ -2,6 +2,8 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
+
 #include "testing/gtest/include/gtest/gtest.h"
 
 #include "core/src/fpdftext/text_int.h"
@@ -54,3 +56,42 @@ TEST(fpdf_text_int, CheckMailLink) {
     EXPECT_STREQ(text_str.c_str(), expected_str.c_str());
   }
 }
+
+TEST(fpdf_text_int, TextCharGridQuery) {
+  // A 20x20 table of 10 point characters with one page-sized character.
+  std::deque<PAGECHAR_INFO> chars;
+  for (int row = 0; row < 20; ++row) {
+    for (int col = 0; col < 20; ++col) {
+      PAGECHAR_INFO info = {};
+      info.m_CharBox = CFX_FloatRect(col * 10.0f, row * 10.0f,
+                                     col * 10.0f + 8, row * 10.0f + 8);
+      info.m_OriginX = col * 10.0f;
+      info.m_OriginY = row * 10.0f;
+      chars.push_back(info);
+    }
+  }
+  PAGECHAR_INFO big = {};
+  big.m_CharBox = CFX_FloatRect(0, 0, 200, 200);
+  chars.push_back(big);
+
+  CPDF_TextCharGrid grid;
+  grid.Build(chars);
+  std::vector<int> result;
+  grid.Query(CFX_FloatRect(52, 52, 53, 53), &result);
+  EXPECT_TRUE(std::is_sorted(result.begin(), result.end()));
+  EXPECT_NE(result.end(), std::find(result.begin(), result.end(), 5 * 20 + 5));
+  EXPECT_NE(result.end(), std::find(result.begin(), result.end(), 400));
+  EXPECT_LT(result.size(), 40u);
+
+  // Edges count as touching.
+  grid.Query(CFX_FloatRect(108, 108, 108, 108), &result);
+  EXPECT_NE(result.end(),
+            std::find(result.begin(), result.end(), 10 * 20 + 10));
+
+  grid.Query(CFX_FloatRect(500, 500, 600, 600), &result);
+  ASSERT_EQ(1u, result.size());
+  EXPECT_EQ(400, result[0]);
+
+  grid.Query(CFX_FloatRect(-10, -10, 500, 500), &result);
+  EXPECT_EQ(401u, result.size());
+}
@@ -8,12 +8,14 @@
 #define CORE_SRC_FPDFTEXT_TEXT_INT_H_
 
 #include <deque>
+#include <map>
+#include <memory>
+#include <vector>
 
 #include "core/include/fpdftext/fpdf_text.h"
 #include "core/include/fxcrt/fx_basic.h"
 
 class CFX_BidiChar;
-class CPDF_DocProgressiveSearch;
 class CPDF_FormObject;
 class CPDF_LinkExtract;
 class CPDF_TextPageFind;
@@ -50,6 +52,36 @@ struct PDFTEXT_Obj {
   CFX_Matrix m_formMatrix;
 };
 
+// Uniform grid over character boxes, so position and rectangle queries only
+// test the characters near the query instead of the whole page.
+class CPDF_TextCharGrid {
+ public:
+  CPDF_TextCharGrid();
+  ~CPDF_TextCharGrid();
+
+  void Build(const std::deque<PAGECHAR_INFO>& charList);
+  // Sets |pResult| to the ascending indices of every character whose box or
+  // origin may touch |rect|, edges included. The result is a superset;
+  // callers still apply their exact test.
+  void Query(const CFX_FloatRect& rect, std::vector<int>* pResult) const;
+
+ private:
+  void GetCellRange(const CFX_FloatRect& rect,
+                    int* pLeft,
+                    int* pBottom,
+                    int* pRight,
+                    int* pTop) const;
+
+  CFX_FloatRect m_BBox;
+  FX_FLOAT m_CellWidth;
+  FX_FLOAT m_CellHeight;
+  int m_nCols;
+  int m_nRows;
+  std::vector<std::vector<int>> m_Cells;
+  // Characters too large or malformed to bucket; always returned.
+  std::vector<int> m_Unbucketed;
+};
+
 class CPDF_TextPage : public IPDF_TextPage {
  public:
   CPDF_TextPage(const CPDF_Page* pPage, int flags);
@@ -62,6 +94,9 @@ class CPDF_TextPage : public IPDF_TextPage {
   int TextIndexFromCharIndex(int CharIndex) const override;
   int CountChars() const override;
   void GetCharInfo(int index, FPDF_CHAR_INFO* info) const override;
+  int GetCharInfos(int start,
+                   int count,
+                   FPDF_CHAR_INFO* infos) const override;
   void GetRectArray(int start,
                     int nCount,
                     CFX_RectArray& rectArray) const override;
@@ -129,6 +164,9 @@ class CPDF_TextPage : public IPDF_TextPage {
   FX_BOOL IsRightToLeft(const CPDF_TextObject* pTextObj,
                         const CPDF_Font* pFont,
                         int nItems) const;
+  // Built on first use after each ParseTextPage().
+  const CPDF_TextCharGrid* GetCharGrid() const;
+  int CountNonSpaces(int start, int end) const;
 
   CFX_WordArray m_CharIndex;
   const CPDF_PageObjectList* const m_pPage;
@@ -146,6 +184,9 @@ class CPDF_TextPage : public IPDF_TextPage {
   CFX_ArrayTemplate<PDFTEXT_Obj> m_LineObj;
   int32_t m_TextlineDir;
   CFX_FloatRect m_CurlineRect;
+  mutable std::unique_ptr<CPDF_TextCharGrid> m_pCharGrid;
+  // m_NonSpaceCounts[i] is the number of non-space characters before i.
+  mutable std::vector<int> m_NonSpaceCounts;
 };
 
 class CPDF_TextPageFind : public IPDF_TextPageFind {
@@ -196,6 +237,59 @@ class CPDF_TextPageFind : public IPDF_TextPageFind {
   FX_BOOL m_IsFind;
 };
 
+class CPDF_DocProgressiveSearch : public IPDF_DocProgressiveSearch {
+ public:
+  CPDF_DocProgressiveSearch(CPDF_Document* pDoc, int flags);
+  ~CPDF_DocProgressiveSearch() override;
+
+  // IPDF_DocProgressiveSearch
+  FX_BOOL Continue(IFX_Pause* pPause) override;
+  int CountIndexedPages() const override;
+  int Find(const CFX_WideString& findwhat, int flags) override;
+  FX_BOOL GetResult(int index,
+                    int& pageIndex,
+                    int& start,
+                    int& count) const override;
+
+  // Applies the index's normalization, without case folding: compatibility
+  // decomposition, whitespace runs collapsed to one space. |pSourceIndices|
+  // receives the source position of every output character.
+  static void NormalizeText(const CFX_WideString& str,
+                            CFX_WideString* pResult,
+                            std::vector<int>* pSourceIndices);
+
+ private:
+  struct PageText {
+    // Normalized page text and the text page character index of every
+    // character in it.
+    CFX_WideString m_Text;
+    std::vector<int> m_CharIndices;
+  };
+  struct Posting {
+    int m_PageIndex;
+    int m_Offset;
+  };
+  struct Match {
+    int m_PageIndex;
+    int m_Start;
+    int m_Count;
+  };
+
+  void IndexPage(int pageIndex);
+  FX_BOOL IsMatch(const PageText& page,
+                  int offset,
+                  const CFX_WideString& findwhat,
+                  int flags) const;
+
+  CPDF_Document* const m_pDocument;
+  const int m_Flags;
+  int m_nNextPage;
+  std::vector<PageText> m_Pages;
+  // Case folded words, each with every place it starts.
+  std::map<CFX_WideString, std::vector<Posting>> m_Words;
+  std::vector<Match> m_Results;
+};
+
 class CPDF_LinkExt {
  public:
   CPDF_LinkExt() {}
@@ -135,6 +135,7 @@ class CCodec_FlateModule : public ICodec_FlateModule {
                                                 int Colors,
                                                 int BitsPerComponent,
                                                 int Columns);
+  virtual ICodec_StreamDecoder* CreateStreamDecoder();
   virtual FX_DWORD FlateOrLZWDecode(FX_BOOL bLZW,
                                     const uint8_t* src_buf,
                                     FX_DWORD src_size,
@@ -158,6 +159,11 @@ class CCodec_FlateModule : public ICodec_FlateModule {
                          FX_DWORD src_size,
                          uint8_t*& dest_buf,
                          FX_DWORD& dest_size);
+  virtual FX_BOOL Encode(const uint8_t* src_buf,
+                         FX_DWORD src_size,
+                         int level,
+                         uint8_t*& dest_buf,
+                         FX_DWORD& dest_size);
 };
 
 class CCodec_JpegModule : public ICodec_JpegModule {
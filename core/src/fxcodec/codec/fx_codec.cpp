@@ -47,7 +47,8 @@ bool CCodec_ScanlineDecoder::ImageDataCache::AllocateCache() {
   if (!size.IsValid())
     return false;
 
-  m_Data.reset(FX_TryAlloc(uint8_t, size.ValueOrDie()));
+  // Lines are only handed out once AppendLine() has filled them.
+  m_Data.reset(FX_TryAllocUninit(uint8_t, size.ValueOrDie()));
   return IsValid();
 }
 
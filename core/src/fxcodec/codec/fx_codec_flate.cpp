@@ -30,8 +30,9 @@ static int FPDFAPI_FlateGetTotalIn(void* context) {
 static void FPDFAPI_FlateCompress(unsigned char* dest_buf,
                                   unsigned long* dest_size,
                                   const unsigned char* src_buf,
-                                  unsigned long src_size) {
-  compress(dest_buf, dest_size, src_buf, src_size);
+                                  unsigned long src_size,
+                                  int level) {
+  compress2(dest_buf, dest_size, src_buf, src_size, level);
 }
 void* FPDFAPI_FlateInit(void* (*alloc_func)(void*, unsigned int, unsigned int),
                         void (*free_func)(void*, void*)) {
@@ -704,7 +705,8 @@ void FlateUncompress(const uint8_t* src_buf,
       }
 
       result_tmp_bufs.Add(cur_buf);
-      cur_buf = FX_Alloc(uint8_t, buf_size + 1);
+      // Only the written part of each later buffer is copied out below.
+      cur_buf = FX_AllocUninit(uint8_t, buf_size + 1);
       cur_buf[buf_size] = '\0';
     }
     dest_size = FPDFAPI_FlateGetTotalOut(context);
@@ -712,7 +714,7 @@ void FlateUncompress(const uint8_t* src_buf,
     if (result_tmp_bufs.GetSize() == 1) {
       dest_buf = result_tmp_bufs[0];
     } else {
-      uint8_t* result_buf = FX_Alloc(uint8_t, dest_size);
+      uint8_t* result_buf = FX_AllocUninit(uint8_t, dest_size);
       FX_DWORD result_pos = 0;
       for (int32_t i = 0; i < result_tmp_bufs.GetSize(); i++) {
         uint8_t* tmp_buf = result_tmp_bufs[i];
@@ -896,6 +898,55 @@ FX_DWORD CCodec_FlateScanlineDecoder::GetSrcOffset() {
   return FPDFAPI_FlateGetTotalIn(m_pFlate);
 }
 
+class CCodec_FlateStreamDecoder : public ICodec_StreamDecoder {
+ public:
+  CCodec_FlateStreamDecoder();
+  ~CCodec_FlateStreamDecoder() override;
+
+  // ICodec_StreamDecoder
+  void Input(const uint8_t* src_buf, FX_DWORD src_size) override;
+  FX_BOOL NeedsInput() override;
+  FX_DWORD ReadBlock(uint8_t* dest_buf, FX_DWORD dest_size) override;
+  FX_BOOL IsEOF() override { return m_bEOF; }
+
+ private:
+  void* m_pFlate;
+  FX_BOOL m_bEOF;
+};
+
+CCodec_FlateStreamDecoder::CCodec_FlateStreamDecoder()
+    : m_pFlate(FPDFAPI_FlateInit(my_alloc_func, my_free_func)),
+      m_bEOF(!m_pFlate) {}
+
+CCodec_FlateStreamDecoder::~CCodec_FlateStreamDecoder() {
+  if (m_pFlate)
+    FPDFAPI_FlateEnd(m_pFlate);
+}
+
+void CCodec_FlateStreamDecoder::Input(const uint8_t* src_buf,
+                                      FX_DWORD src_size) {
+  if (m_pFlate)
+    FPDFAPI_FlateInput(m_pFlate, src_buf, src_size);
+}
+
+FX_BOOL CCodec_FlateStreamDecoder::NeedsInput() {
+  return !m_bEOF && FPDFAPI_FlateGetAvailIn(m_pFlate) == 0;
+}
+
+FX_DWORD CCodec_FlateStreamDecoder::ReadBlock(uint8_t* dest_buf,
+                                              FX_DWORD dest_size) {
+  if (m_bEOF || dest_size == 0)
+    return 0;
+
+  FX_DWORD pre_pos = FPDFAPI_FlateGetTotalOut(m_pFlate);
+  int32_t ret = FPDFAPI_FlateOutput(m_pFlate, dest_buf, dest_size);
+  // Z_BUF_ERROR only means more input is needed. Like FlateUncompress(),
+  // treat anything else but Z_OK as the end of the data.
+  if (ret != Z_OK && ret != Z_BUF_ERROR)
+    m_bEOF = TRUE;
+  return FPDFAPI_FlateGetTotalOut(m_pFlate) - pre_pos;
+}
+
 ICodec_ScanlineDecoder* CCodec_FlateModule::CreateDecoder(
     const uint8_t* src_buf,
     FX_DWORD src_size,
@@ -912,6 +963,9 @@ ICodec_ScanlineDecoder* CCodec_FlateModule::CreateDecoder(
                    Colors, BitsPerComponent, Columns);
   return pDecoder;
 }
+ICodec_StreamDecoder* CCodec_FlateModule::CreateStreamDecoder() {
+  return new CCodec_FlateStreamDecoder;
+}
 FX_DWORD CCodec_FlateModule::FlateOrLZWDecode(FX_BOOL bLZW,
                                               const uint8_t* src_buf,
                                               FX_DWORD src_size,
@@ -996,10 +1050,20 @@ FX_BOOL CCodec_FlateModule::Encode(const uint8_t* src_buf,
                                    FX_DWORD src_size,
                                    uint8_t*& dest_buf,
                                    FX_DWORD& dest_size) {
+  return Encode(src_buf, src_size, FXCODEC_FLATE_LEVEL_DEFAULT, dest_buf,
+                dest_size);
+}
+FX_BOOL CCodec_FlateModule::Encode(const uint8_t* src_buf,
+                                   FX_DWORD src_size,
+                                   int level,
+                                   uint8_t*& dest_buf,
+                                   FX_DWORD& dest_size) {
+  if (level != FXCODEC_FLATE_LEVEL_DEFAULT && (level < 1 || level > 9))
+    level = FXCODEC_FLATE_LEVEL_DEFAULT;
   dest_size = src_size + src_size / 1000 + 12;
   dest_buf = FX_Alloc(uint8_t, dest_size);
   unsigned long temp_size = dest_size;
-  FPDFAPI_FlateCompress(dest_buf, &temp_size, src_buf, src_size);
+  FPDFAPI_FlateCompress(dest_buf, &temp_size, src_buf, src_size, level);
   dest_size = (FX_DWORD)temp_size;
   return TRUE;
 }
@@ -543,8 +543,8 @@ void color_apply_icc_profile(opj_image_t* image) {
         (cmsUInt32Number)max * 3 * sizeof(unsigned char);
     in = inbuf = FX_Alloc(unsigned char, nr_samples);
     out = outbuf = FX_Alloc(unsigned char, nr_samples);
-    image->comps = (opj_image_comp_t*)realloc(
-        image->comps, (image->numcomps + 2) * sizeof(opj_image_comp_t));
+    image->comps =
+        FX_Realloc(opj_image_comp_t, image->comps, image->numcomps + 2);
     if (image->numcomps == 2) {
       image->comps[3] = image->comps[1];
     }
@@ -1094,3 +1094,58 @@ CFX_ByteString CFX_ByteString::FormatFloat(FX_FLOAT d, int precision) {
   FX_STRSIZE len = FX_ftoa(d, buf);
   return CFX_ByteString(buf, len);
 }
+
+namespace {
+
+FX_DWORD PoolHash(const CFX_ByteStringC& str) {
+  // FNV-1a.
+  FX_DWORD hash = 2166136261u;
+  for (FX_STRSIZE i = 0; i < str.GetLength(); i++) {
+    hash ^= str.GetAt(i);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+}  // namespace
+
+const FX_STRSIZE CFX_ByteStringPool::kMaxLength;
+
+CFX_ByteStringPool::CFX_ByteStringPool() : m_nCount(0) {}
+
+CFX_ByteStringPool::~CFX_ByteStringPool() {}
+
+CFX_ByteString CFX_ByteStringPool::Intern(const CFX_ByteStringC& str) {
+  if (str.IsEmpty() || str.GetLength() > kMaxLength)
+    return CFX_ByteString(str);
+
+  // Keep the table at most half full.
+  if ((m_nCount + 1) * 2 > m_Slots.size())
+    Grow();
+  size_t mask = m_Slots.size() - 1;
+  for (size_t i = PoolHash(str) & mask;; i = (i + 1) & mask) {
+    CFX_ByteString& slot = m_Slots[i];
+    if (slot.IsEmpty()) {
+      slot = str;
+      m_nCount++;
+      return slot;
+    }
+    if (slot == str)
+      return slot;
+  }
+}
+
+void CFX_ByteStringPool::Grow() {
+  std::vector<CFX_ByteString> old_slots(
+      std::max<size_t>(m_Slots.size() * 2, 64));
+  old_slots.swap(m_Slots);
+  size_t mask = m_Slots.size() - 1;
+  for (CFX_ByteString& str : old_slots) {
+    if (str.IsEmpty())
+      continue;
+    size_t i = PoolHash(str) & mask;
+    while (!m_Slots[i].IsEmpty())
+      i = (i + 1) & mask;
+    m_Slots[i] = str;
+  }
+}
@@ -687,3 +687,33 @@ TEST(fxcrt, EmptyByteString) {
   const FX_CHAR* cstr = empty_str.c_str();
   EXPECT_EQ(0, FXSYS_strlen(cstr));
 }
+
+TEST(fxcrt, ByteStringPool) {
+  CFX_ByteStringPool pool;
+  CFX_ByteString type = pool.Intern("Type");
+  EXPECT_EQ("Type", type);
+  EXPECT_EQ(type.c_str(), pool.Intern("Type").c_str());
+  EXPECT_NE(type.c_str(), pool.Intern("Font").c_str());
+  EXPECT_EQ(2u, pool.GetCount());
+
+  // Empty and long strings are copied, not pooled.
+  EXPECT_TRUE(pool.Intern("").IsEmpty());
+  CFX_ByteString long_str("0123456789abcdef0123456789abcdef0");
+  ASSERT_GT(long_str.GetLength(), CFX_ByteStringPool::kMaxLength);
+  CFX_ByteString long_copy = pool.Intern(long_str);
+  EXPECT_EQ(long_str, long_copy);
+  EXPECT_NE(long_str.c_str(), pool.Intern(long_str).c_str());
+  EXPECT_EQ(2u, pool.GetCount());
+
+  // Growing the table keeps handing out the same buffers.
+  for (int i = 0; i < 1000; i++)
+    pool.Intern(CFX_ByteString::FormatInteger(i));
+  EXPECT_EQ(1002u, pool.GetCount());
+  EXPECT_EQ(type.c_str(), pool.Intern("Type").c_str());
+  EXPECT_EQ("417", pool.Intern("417"));
+
+  // Changing a pooled string leaves the pool alone.
+  type.SetAt(0, 't');
+  EXPECT_EQ("Type", pool.Intern("Type"));
+  EXPECT_EQ(1002u, pool.GetCount());
+}
@@ -70,7 +70,7 @@ void CFX_BinaryBuf::ExpandBuf(FX_STRSIZE add_size) {
   if (pNewBuffer) {
     pNewBuffer = FX_Realloc(uint8_t, m_pBuffer, new_size);
   } else {
-    pNewBuffer = FX_Alloc(uint8_t, new_size);
+    pNewBuffer = FX_AllocUninit(uint8_t, new_size);
   }
   m_pBuffer = pNewBuffer;
   m_AllocSize = new_size;
@@ -210,7 +210,6 @@ CFX_WideStringC CFX_WideTextBuf::GetWideString() const {
                          m_DataSize / sizeof(FX_WCHAR));
 }
 
-#ifdef PDF_ENABLE_XFA
 CFX_ArchiveSaver& CFX_ArchiveSaver::operator<<(uint8_t i) {
   if (m_pStream) {
     m_pStream->WriteBlock(&i, 1);
@@ -335,7 +334,6 @@ FX_BOOL CFX_ArchiveLoader::Read(void* pBuf, FX_DWORD dwSize) {
   m_LoadingPos += dwSize;
   return TRUE;
 }
-#endif  // PDF_ENABLE_XFA
 
 void CFX_BitStream::Init(const uint8_t* pData, FX_DWORD dwSize) {
   m_pData = pData;
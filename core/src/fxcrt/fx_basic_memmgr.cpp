@@ -7,15 +7,201 @@
 #include <stdlib.h>  // For abort().
 
 #include "core/include/fxcrt/fx_memory.h"
+#include "core/include/fxcrt/fx_memorybudget.h"
+
+namespace {
+
+// Precedes every block while accounting.
+struct FX_HeapHeader {
+  CFX_MemoryBudget* m_pBudget;
+  size_t m_Size;
+};
+
+// Rounded up so blocks stay as aligned as the underlying heap returns them.
+const size_t kHeaderSize = 16;
+static_assert(sizeof(FX_HeapHeader) <= kHeaderSize, "header too large");
+
+FXMEM_Allocator g_Allocator;
+bool g_bCustomAllocator = false;
+bool g_bAccounting = false;
+
+thread_local CFX_MemoryBudget* g_pCurrentBudget = nullptr;
+
+void* RawAlloc(size_t size, bool bZeroed) {
+  if (!g_bCustomAllocator)
+    return bZeroed ? calloc(size, 1) : malloc(size);
+  void* result = g_Allocator.Alloc(g_Allocator.user, size);
+  if (result && bZeroed)
+    memset(result, 0, size);
+  return result;
+}
+
+void* RawRealloc(void* ptr, size_t new_size) {
+  if (!g_bCustomAllocator)
+    return realloc(ptr, new_size);
+  return g_Allocator.Realloc(g_Allocator.user, ptr, new_size);
+}
+
+void RawFree(void* ptr) {
+  if (!g_bCustomAllocator) {
+    free(ptr);
+    return;
+  }
+  g_Allocator.Free(g_Allocator.user, ptr);
+}
+
+FX_HeapHeader* HeaderOf(void* ptr) {
+  return reinterpret_cast<FX_HeapHeader*>(static_cast<uint8_t*>(ptr) -
+                                          kHeaderSize);
+}
+
+}  // namespace
+
+void FXMEM_SetAllocator(const FXMEM_Allocator* pAllocator, bool bAccounting) {
+  g_bCustomAllocator = !!pAllocator;
+  if (pAllocator)
+    g_Allocator = *pAllocator;
+  g_bAccounting = bAccounting;
+}
+
+bool FXMEM_IsAccounting() {
+  return g_bAccounting;
+}
+
+void* FX_HeapAlloc(size_t size, int flags) {
+  bool bZeroed = !!(flags & FX_HEAP_ZEROED);
+  if (!g_bAccounting)
+    return RawAlloc(size, bZeroed);
+  if (size > std::numeric_limits<size_t>::max() - kHeaderSize)
+    return nullptr;
+  CFX_MemoryBudget* pBudget = g_pCurrentBudget;
+  if (pBudget && !pBudget->Charge(size, !!(flags & FX_HEAP_MAY_FAIL)))
+    return nullptr;
+  FX_HeapHeader* pHeader =
+      static_cast<FX_HeapHeader*>(RawAlloc(kHeaderSize + size, bZeroed));
+  if (!pHeader) {
+    if (pBudget)
+      pBudget->Credit(size);
+    return nullptr;
+  }
+  pHeader->m_pBudget = pBudget;
+  pHeader->m_Size = size;
+  return reinterpret_cast<uint8_t*>(pHeader) + kHeaderSize;
+}
+
+void* FX_HeapRealloc(void* ptr, size_t new_size, int flags) {
+  if (!ptr)
+    return FX_HeapAlloc(new_size, flags & ~FX_HEAP_ZEROED);
+  if (!g_bAccounting)
+    return RawRealloc(ptr, new_size);
+  if (new_size > std::numeric_limits<size_t>::max() - kHeaderSize)
+    return nullptr;
+  FX_HeapHeader* pHeader = HeaderOf(ptr);
+  CFX_MemoryBudget* pBudget = pHeader->m_pBudget;
+  size_t old_size = pHeader->m_Size;
+  if (pBudget &&
+      !pBudget->Resize(old_size, new_size, !!(flags & FX_HEAP_MAY_FAIL))) {
+    return nullptr;
+  }
+  pHeader = static_cast<FX_HeapHeader*>(
+      RawRealloc(pHeader, kHeaderSize + new_size));
+  if (!pHeader) {
+    if (pBudget)
+      pBudget->Resize(new_size, old_size, false);
+    return nullptr;
+  }
+  pHeader->m_Size = new_size;
+  return reinterpret_cast<uint8_t*>(pHeader) + kHeaderSize;
+}
+
+void FX_HeapFree(void* ptr) {
+  if (!ptr)
+    return;
+  if (!g_bAccounting) {
+    RawFree(ptr);
+    return;
+  }
+  FX_HeapHeader* pHeader = HeaderOf(ptr);
+  CFX_MemoryBudget* pBudget = pHeader->m_pBudget;
+  size_t size = pHeader->m_Size;
+  RawFree(pHeader);
+  if (pBudget)
+    pBudget->Credit(size);
+}
 
 void* FXMEM_DefaultAlloc(size_t byte_size, int flags) {
-  return (void*)malloc(byte_size);
+  return FX_HeapAlloc(byte_size, FX_HEAP_MAY_FAIL);
 }
 void* FXMEM_DefaultRealloc(void* pointer, size_t new_size, int flags) {
-  return realloc(pointer, new_size);
+  return FX_HeapRealloc(pointer, new_size, FX_HEAP_MAY_FAIL);
 }
 void FXMEM_DefaultFree(void* pointer, int flags) {
-  free(pointer);
+  FX_HeapFree(pointer);
+}
+
+CFX_MemoryBudget::Scope::Scope(CFX_MemoryBudget* pBudget)
+    : m_pBudget(pBudget),
+      m_pPrevious(g_pCurrentBudget),
+      m_nRefusedAtStart(pBudget ? pBudget->m_nRefused.load() : 0) {
+  g_pCurrentBudget = pBudget;
+}
+
+CFX_MemoryBudget::Scope::~Scope() {
+  g_pCurrentBudget = m_pPrevious;
+}
+
+bool CFX_MemoryBudget::Scope::HasFailed() const {
+  return m_pBudget && (m_pBudget->m_nRefused != m_nRefusedAtStart ||
+                       m_pBudget->IsExceeded());
+}
+
+// static
+CFX_MemoryBudget* CFX_MemoryBudget::GetCurrent() {
+  return g_pCurrentBudget;
+}
+
+CFX_MemoryBudget::CFX_MemoryBudget(size_t nLimit)
+    : m_nUsage(0), m_nPeakUsage(0), m_nLimit(nLimit), m_nRefused(0),
+      m_nRefs(1) {}
+
+void CFX_MemoryBudget::Release() {
+  Unref();
+}
+
+void CFX_MemoryBudget::Unref() {
+  if (--m_nRefs == 0)
+    delete this;
+}
+
+bool CFX_MemoryBudget::Charge(size_t size, bool bMayFail) {
+  if (!Resize(0, size, bMayFail))
+    return false;
+  ++m_nRefs;
+  return true;
+}
+
+void CFX_MemoryBudget::Credit(size_t size) {
+  m_nUsage -= size;
+  Unref();
+}
+
+bool CFX_MemoryBudget::Resize(size_t old_size, size_t new_size, bool bMayFail) {
+  if (new_size <= old_size) {
+    m_nUsage -= old_size - new_size;
+    return true;
+  }
+  size_t growth = new_size - old_size;
+  size_t nUsage = m_nUsage += growth;
+  size_t nLimit = m_nLimit;
+  if (bMayFail && nLimit && nUsage > nLimit) {
+    m_nUsage -= growth;
+    ++m_nRefused;
+    return false;
+  }
+  size_t nPeak = m_nPeakUsage;
+  while (nUsage > nPeak && !m_nPeakUsage.compare_exchange_weak(nPeak, nUsage)) {
+  }
+  return true;
 }
 
 NEVER_INLINE void FX_OutOfMemoryTerminate() {
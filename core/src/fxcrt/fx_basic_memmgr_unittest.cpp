@@ -5,6 +5,7 @@
 #include <limits>
 
 #include "core/include/fxcrt/fx_memory.h"
+#include "core/include/fxcrt/fx_memorybudget.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace {
@@ -60,6 +61,30 @@ TEST(fxcrt, FX_TryAllocOverflow) {
   FX_Free(ptr);
 }
 
+TEST(fxcrt, FX_AllocUninit) {
+  int* ptr = FX_AllocUninit(int, 16);
+  ASSERT_TRUE(ptr);
+  for (int i = 0; i < 16; ++i)
+    ptr[i] = i;
+  EXPECT_EQ(15, ptr[15]);
+  FX_Free(ptr);
+
+  ptr = FX_AllocUninit2D(int, kWidth, 2);
+  ASSERT_TRUE(ptr);
+  ptr[kWidth * 2 - 1] = 1;
+  FX_Free(ptr);
+}
+
+TEST(fxcrt, FX_AllocUninitOverflow) {
+  EXPECT_DEATH_IF_SUPPORTED((void)FX_AllocUninit(int, kOverflowIntAlloc), "");
+  EXPECT_DEATH_IF_SUPPORTED(
+      (void)FX_AllocUninit2D(int, kWidth, kOverflowIntAlloc2D), "");
+}
+
+TEST(fxcrt, FX_TryAllocUninitOverflow) {
+  EXPECT_FALSE(FX_TryAllocUninit(int, kOverflowIntAlloc));
+}
+
 TEST(fxcrt, DISABLED_FXMEM_DefaultOOM) {
   EXPECT_FALSE(FXMEM_DefaultAlloc(kMaxByteAlloc, 0));
 
@@ -68,3 +93,38 @@ TEST(fxcrt, DISABLED_FXMEM_DefaultOOM) {
   EXPECT_FALSE(FXMEM_DefaultRealloc(ptr, kMaxByteAlloc, 0));
   FXMEM_DefaultFree(ptr, 0);
 }
+
+TEST(fxcrt, MemoryBudget) {
+  FXMEM_SetAllocator(nullptr, true);
+  CFX_MemoryBudget* pBudget = new CFX_MemoryBudget(1000);
+  char* pOutside = FX_Alloc(char, 10);
+  char* pInside;
+  {
+    CFX_MemoryBudget::Scope scope(pBudget);
+    EXPECT_EQ(pBudget, CFX_MemoryBudget::GetCurrent());
+    pInside = FX_Alloc(char, 600);
+    EXPECT_EQ(600u, pBudget->GetUsage());
+    EXPECT_FALSE(scope.HasFailed());
+
+    // Past the limit, requests that may fail are refused...
+    EXPECT_FALSE(FX_TryAlloc(char, 600));
+    EXPECT_FALSE(FXMEM_DefaultAlloc(600, 0));
+    EXPECT_TRUE(scope.HasFailed());
+    EXPECT_FALSE(pBudget->IsExceeded());
+
+    // ...and the rest go through, leaving the budget over its limit.
+    pInside = FX_Realloc(char, pInside, 1200);
+    EXPECT_EQ(1200u, pBudget->GetUsage());
+    EXPECT_TRUE(pBudget->IsExceeded());
+  }
+  EXPECT_EQ(nullptr, CFX_MemoryBudget::GetCurrent());
+  EXPECT_EQ(1200u, pBudget->GetUsage());
+
+  // Blocks are credited whenever they are freed, keeping the budget alive
+  // past its release until then.
+  pBudget->Release();
+  EXPECT_EQ(1200u, pBudget->GetPeakUsage());
+  FX_Free(pInside);
+  FX_Free(pOutside);
+  FXMEM_SetAllocator(nullptr, false);
+}
@@ -11,9 +11,11 @@
 
 #if _FXM_PLATFORM_ != _FXM_PLATFORM_WINDOWS_
 #include <sys/types.h>
+#include <sys/stat.h>
 #include <dirent.h>
 #else
 #include <direct.h>
+#include <sys/stat.h>
 #endif
 
 CFX_PrivateData::~CFX_PrivateData() {
@@ -346,6 +348,36 @@ FX_WCHAR FX_GetFolderSeparator() {
   return '/';
 #endif
 }
+FX_BOOL FX_GetFileStatus(const FX_CHAR* path, int64_t& mtime, int64_t& size) {
+#if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
+  struct _stat64 status;
+  if (_stat64(path, &status) != 0) {
+    return FALSE;
+  }
+#else
+  struct stat status;
+  if (stat(path, &status) != 0) {
+    return FALSE;
+  }
+#endif
+  mtime = status.st_mtime;
+  size = status.st_size;
+  return TRUE;
+}
+FX_BOOL FX_ReplaceFile(const FX_CHAR* src, const FX_CHAR* dest) {
+#if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
+  return MoveFileExA(src, dest, MOVEFILE_REPLACE_EXISTING);
+#else
+  return rename(src, dest) == 0;
+#endif
+}
+FX_DWORD FX_GetCurrentProcessId() {
+#if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
+  return GetCurrentProcessId();
+#else
+  return getpid();
+#endif
+}
 
 CFX_Matrix_3by3 CFX_Matrix_3by3::Inverse() {
   FX_FLOAT det =
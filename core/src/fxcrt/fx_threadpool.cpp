@@ -0,0 +1,64 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/include/fxcrt/fx_threadpool.h"
+
+#include <utility>
+
+namespace {
+
+const int kMaxDefaultThreads = 8;
+
+}  // namespace
+
+// static
+int CFX_ThreadPool::GetDefaultThreadCount() {
+  int nThreads = (int)std::thread::hardware_concurrency();
+  if (nThreads < 1)
+    return 1;
+  return nThreads > kMaxDefaultThreads ? kMaxDefaultThreads : nThreads;
+}
+
+CFX_ThreadPool::CFX_ThreadPool(int nThreads) : m_bQuit(FALSE) {
+  if (nThreads < 1)
+    nThreads = 1;
+  for (int i = 0; i < nThreads; ++i)
+    m_Threads.push_back(std::thread(&CFX_ThreadPool::WorkerMain, this));
+}
+
+CFX_ThreadPool::~CFX_ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_bQuit = TRUE;
+  }
+  m_Cond.notify_all();
+  for (std::thread& thread : m_Threads)
+    thread.join();
+}
+
+std::future<void> CFX_ThreadPool::PostTask(std::function<void()> task) {
+  std::packaged_task<void()> packaged(std::move(task));
+  std::future<void> result = packaged.get_future();
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Tasks.push_back(std::move(packaged));
+  }
+  m_Cond.notify_one();
+  return result;
+}
+
+void CFX_ThreadPool::WorkerMain() {
+  while (true) {
+    std::packaged_task<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      m_Cond.wait(lock, [this] { return m_bQuit || !m_Tasks.empty(); });
+      if (m_Tasks.empty())
+        return;
+      task = std::move(m_Tasks.front());
+      m_Tasks.pop_front();
+    }
+    task();
+  }
+}
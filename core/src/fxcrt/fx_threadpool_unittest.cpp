@@ -0,0 +1,31 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/include/fxcrt/fx_threadpool.h"
+
+#include <atomic>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+TEST(fxcrt, ThreadPoolRunsAllTasks) {
+  std::atomic<int> sum(0);
+  std::vector<std::future<void>> results;
+  {
+    CFX_ThreadPool pool(3);
+    EXPECT_EQ(3, pool.CountThreads());
+    for (int i = 1; i <= 100; ++i)
+      results.push_back(pool.PostTask([&sum, i] { sum += i; }));
+    results[0].wait();
+  }
+  // Destroying the pool drains the queue.
+  EXPECT_EQ(5050, sum.load());
+  for (std::future<void>& result : results)
+    EXPECT_TRUE(result.valid());
+}
+
+TEST(fxcrt, ThreadPoolDefaultThreadCount) {
+  EXPECT_GE(CFX_ThreadPool::GetDefaultThreadCount(), 1);
+  CFX_ThreadPool pool(0);
+  EXPECT_EQ(1, pool.CountThreads());
+}
@@ -6,11 +6,15 @@
 
 #include "fxcrt_posix.h"
 
+#include <limits>
+
 #include "core/include/fxcrt/fx_basic.h"
 
 #if _FXM_PLATFORM_ == _FXM_PLATFORM_LINUX_ || \
     _FXM_PLATFORM_ == _FXM_PLATFORM_APPLE_ || \
     _FXM_PLATFORM_ == _FXM_PLATFORM_ANDROID_
+#include <sys/mman.h>
+
 IFXCRT_FileAccess* FXCRT_FileAccess_Create() {
   return new CFXCRT_FileAccess_Posix;
 }
@@ -127,4 +131,40 @@ FX_BOOL CFXCRT_FileAccess_Posix::Truncate(FX_FILESIZE szFile) {
   }
   return !ftruncate(m_nFD, szFile);
 }
+IFX_MemoryMappedFile* FX_CreateMemoryMappedFile(const FX_CHAR* filename) {
+  int fd = open(filename, O_RDONLY | O_BINARY);
+  if (fd < 0) {
+    return NULL;
+  }
+  struct stat status;
+  if (fstat(fd, &status) != 0 || status.st_size <= 0 ||
+      static_cast<uint64_t>(status.st_size) >
+          std::numeric_limits<size_t>::max()) {
+    close(fd);
+    return NULL;
+  }
+  size_t size = static_cast<size_t>(status.st_size);
+  void* pData = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+  // The mapping keeps the file open by itself.
+  close(fd);
+  if (pData == MAP_FAILED) {
+    return NULL;
+  }
+  return new CFXCRT_MemoryMappedFile_Posix(pData, size);
+}
+CFXCRT_MemoryMappedFile_Posix::CFXCRT_MemoryMappedFile_Posix(void* pData,
+                                                             size_t size)
+    : m_pData(pData), m_Size(size) {}
+CFXCRT_MemoryMappedFile_Posix::~CFXCRT_MemoryMappedFile_Posix() {
+  munmap(m_pData, m_Size);
+}
+void CFXCRT_MemoryMappedFile_Posix::Release() {
+  delete this;
+}
+const uint8_t* CFXCRT_MemoryMappedFile_Posix::GetData() const {
+  return static_cast<const uint8_t*>(m_pData);
+}
+size_t CFXCRT_MemoryMappedFile_Posix::GetSize() const {
+  return m_Size;
+}
 #endif
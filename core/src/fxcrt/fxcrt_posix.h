@@ -37,6 +37,20 @@ class CFXCRT_FileAccess_Posix : public IFXCRT_FileAccess {
  protected:
   int32_t m_nFD;
 };
+class CFXCRT_MemoryMappedFile_Posix : public IFX_MemoryMappedFile {
+ public:
+  CFXCRT_MemoryMappedFile_Posix(void* pData, size_t size);
+  ~CFXCRT_MemoryMappedFile_Posix() override;
+
+  // IFX_MemoryMappedFile
+  void Release() override;
+  const uint8_t* GetData() const override;
+  size_t GetSize() const override;
+
+ protected:
+  void* m_pData;
+  size_t m_Size;
+};
 #endif
 
 #endif  // CORE_SRC_FXCRT_FXCRT_POSIX_H_
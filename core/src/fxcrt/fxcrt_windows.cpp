@@ -6,6 +6,8 @@
 
 #include "fxcrt_windows.h"
 
+#include <limits>
+
 #include "core/include/fxcrt/fx_string.h"
 
 #if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
@@ -169,4 +171,51 @@ FX_BOOL CFXCRT_FileAccess_Win64::Truncate(FX_FILESIZE szFile) {
   }
   return ::SetEndOfFile(m_hFile);
 }
+IFX_MemoryMappedFile* FX_CreateMemoryMappedFile(const FX_CHAR* filename) {
+#ifdef _FX_WINAPI_PARTITION_DESKTOP_
+  HANDLE hFile = ::CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+                               OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (hFile == INVALID_HANDLE_VALUE) {
+    return NULL;
+  }
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(hFile, &size) || size.QuadPart <= 0 ||
+      static_cast<uint64_t>(size.QuadPart) >
+          std::numeric_limits<size_t>::max()) {
+    ::CloseHandle(hFile);
+    return NULL;
+  }
+  HANDLE hMapping =
+      ::CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+  ::CloseHandle(hFile);
+  if (!hMapping) {
+    return NULL;
+  }
+  // The view keeps the mapping and the file open by itself.
+  void* pData = ::MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+  ::CloseHandle(hMapping);
+  if (!pData) {
+    return NULL;
+  }
+  return new CFXCRT_MemoryMappedFile_Win64(pData,
+                                           static_cast<size_t>(size.QuadPart));
+#else
+  return NULL;
+#endif
+}
+CFXCRT_MemoryMappedFile_Win64::CFXCRT_MemoryMappedFile_Win64(void* pData,
+                                                             size_t size)
+    : m_pData(pData), m_Size(size) {}
+CFXCRT_MemoryMappedFile_Win64::~CFXCRT_MemoryMappedFile_Win64() {
+  ::UnmapViewOfFile(m_pData);
+}
+void CFXCRT_MemoryMappedFile_Win64::Release() {
+  delete this;
+}
+const uint8_t* CFXCRT_MemoryMappedFile_Win64::GetData() const {
+  return static_cast<const uint8_t*>(m_pData);
+}
+size_t CFXCRT_MemoryMappedFile_Win64::GetSize() const {
+  return m_Size;
+}
 #endif
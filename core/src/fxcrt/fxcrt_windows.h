@@ -35,6 +35,20 @@ class CFXCRT_FileAccess_Win64 : public IFXCRT_FileAccess {
  protected:
   void* m_hFile;
 };
+class CFXCRT_MemoryMappedFile_Win64 : public IFX_MemoryMappedFile {
+ public:
+  CFXCRT_MemoryMappedFile_Win64(void* pData, size_t size);
+  ~CFXCRT_MemoryMappedFile_Win64() override;
+
+  // IFX_MemoryMappedFile
+  void Release() override;
+  const uint8_t* GetData() const override;
+  size_t GetSize() const override;
+
+ protected:
+  void* m_pData;
+  size_t m_Size;
+};
 #endif
 
 #endif  // CORE_SRC_FXCRT_FXCRT_WINDOWS_H_
@@ -7,6 +7,8 @@
 #ifndef CORE_SRC_FXGE_AGG_INCLUDE_FX_AGG_DRIVER_H_
 #define CORE_SRC_FXGE_AGG_INCLUDE_FX_AGG_DRIVER_H_
 
+#include <functional>
+
 #include "core/include/fxge/fx_ge.h"
 #include "third_party/agg23/agg_clip_liang_barsky.h"
 #include "third_party/agg23/agg_path_storage.h"
@@ -14,6 +16,7 @@
 
 class CFX_Matrix;
 class CFX_PathData;
+class CFX_ThreadPool;
 
 class CAgg_PathData {
  public:
@@ -130,6 +133,18 @@ class CFX_AggDeviceDriver : public IFX_RenderDeviceDriver {
                            int alpha_flag,
                            void* pIccTransform);
 
+  // Renders the outline |add_path| adds to a rasterizer. An outline with
+  // more than m_RasterCellLimit cells is recorded and replayed for each
+  // band of rows in turn, so only one band's cells are held at a time.
+  FX_BOOL RenderPath(
+      const std::function<void(agg::rasterizer_scanline_aa&)>& add_path,
+      agg::filling_rule_e filling_rule,
+      FX_DWORD color,
+      FX_BOOL bFullCover,
+      FX_BOOL bGroupKnockout,
+      int alpha_flag,
+      void* pIccTransform);
+
   void SetClipMask(agg::rasterizer_scanline_aa& rasterizer);
 
   virtual uint8_t* GetBuffer() const { return m_pBitmap->GetBuffer(); }
@@ -145,6 +160,21 @@ class CFX_AggDeviceDriver : public IFX_RenderDeviceDriver {
   FX_BOOL m_bRgbByteOrder;
   CFX_DIBitmap* m_pOriDevice;
   FX_BOOL m_bGroupKnockout;
+  // Set when large paths are rendered in row bands on worker threads.
+  CFX_ThreadPool* m_pRasterPool;
+  unsigned m_RasterCellLimit;
+
+ private:
+  FX_BOOL RenderPathBands(agg::path_storage& outline,
+                          agg::filling_rule_e filling_rule,
+                          int first,
+                          int last,
+                          unsigned dropped,
+                          FX_DWORD color,
+                          FX_BOOL bFullCover,
+                          FX_BOOL bGroupKnockout,
+                          int alpha_flag,
+                          void* pIccTransform);
 };
 
 #endif  // CORE_SRC_FXGE_AGG_INCLUDE_FX_AGG_DRIVER_H_
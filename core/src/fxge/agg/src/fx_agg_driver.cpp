@@ -6,9 +6,12 @@
 
 #include "core/src/fxge/agg/include/fx_agg_driver.h"
 
+#include <limits.h>
+
 #include <algorithm>
 
 #include "core/include/fxcodec/fx_codec.h"
+#include "core/include/fxcrt/fx_threadpool.h"
 #include "core/include/fxge/fx_ge.h"
 #include "core/src/fxge/dib/dib_int.h"
 #include "core/src/fxge/ge/text_int.h"
@@ -23,11 +26,64 @@
 
 namespace {
 
+// About 16 MB of cells, plus their sorted index. Paths needing more are
+// rasterized in bands of rows.
+const unsigned kMaxRasterCells = 1 << 20;
+
 void HardClip(FX_FLOAT& x, FX_FLOAT& y) {
   x = std::max(std::min(x, 50000.0f), -50000.0f);
   y = std::max(std::min(y, 50000.0f), -50000.0f);
 }
 
+// Collects the rasterized path within |clip_rect| as runs of fully covered
+// pixels. Returns false on the first partly covered pixel, since such a
+// path needs an anti-aliased mask instead.
+bool RasterizeClipSpans(agg::rasterizer_scanline_aa& rasterizer,
+                        const FX_RECT& clip_rect,
+                        bool no_smooth,
+                        CFX_ClipRgn::Spans* pSpans) {
+  if (clip_rect.IsEmpty())
+    return true;
+
+  std::vector<int>& row_start = pSpans->m_RowStart;
+  std::vector<int>& runs = pSpans->m_Runs;
+  int height = clip_rect.Height();
+  row_start.reserve(height + 1);
+  if (rasterizer.rewind_scanlines()) {
+    agg::scanline_u8 scanline;
+    scanline.reset(rasterizer.min_x(), rasterizer.max_x());
+    while (rasterizer.sweep_scanline(scanline, no_smooth)) {
+      int row = scanline.y() - clip_rect.top;
+      if (row < 0)
+        continue;
+      if (row >= height)
+        break;
+      while (static_cast<int>(row_start.size()) <= row)
+        row_start.push_back(static_cast<int>(runs.size()));
+      size_t row_begin = runs.size();
+      agg::scanline_u8::const_iterator span = scanline.begin();
+      for (unsigned i = 0; i < scanline.num_spans(); i++, span++) {
+        for (int j = 0; j < span->len; j++) {
+          if (span->covers[j] != 0xff)
+            return false;
+          int x = span->x + j;
+          if (x < clip_rect.left || x >= clip_rect.right)
+            continue;
+          if (runs.size() > row_begin && runs.back() == x) {
+            runs.back() = x + 1;
+          } else {
+            runs.push_back(x);
+            runs.push_back(x + 1);
+          }
+        }
+      }
+    }
+  }
+  while (static_cast<int>(row_start.size()) <= height)
+    row_start.push_back(static_cast<int>(runs.size()));
+  return true;
+}
+
 }  // namespace
 
 void CAgg_PathData::BuildPath(const CFX_PathData* pPathData,
@@ -206,6 +262,8 @@ CFX_AggDeviceDriver::CFX_AggDeviceDriver(CFX_DIBitmap* pBitmap,
   m_pOriDevice = pOriDevice;
   m_bGroupKnockout = bGroupKnockout;
   m_FillFlags = 0;
+  m_pRasterPool = NULL;
+  m_RasterCellLimit = kMaxRasterCells;
   InitPlatform();
 }
 CFX_AggDeviceDriver::~CFX_AggDeviceDriver() {
@@ -293,12 +351,19 @@ void CFX_AggDeviceDriver::SetClipMask(agg::rasterizer_scanline_aa& rasterizer) {
   FX_RECT path_rect(rasterizer.min_x(), rasterizer.min_y(),
                     rasterizer.max_x() + 1, rasterizer.max_y() + 1);
   path_rect.Intersect(m_pClipRgn->GetBox());
+  bool no_smooth = (m_FillFlags & FXFILL_NOPATHSMOOTH) != 0;
+  CFX_ClipRgn::SpansRef spans;
+  if (RasterizeClipSpans(rasterizer, path_rect, no_smooth, spans.New())) {
+    m_pClipRgn->IntersectSpans(path_rect, spans);
+    return;
+  }
   CFX_DIBitmapRef mask;
   CFX_DIBitmap* pThisLayer = mask.New();
   if (!pThisLayer) {
     return;
   }
-  pThisLayer->Create(path_rect.Width(), path_rect.Height(), FXDIB_8bppMask);
+  pThisLayer->CreateUninit(path_rect.Width(), path_rect.Height(),
+                           FXDIB_8bppMask);
   pThisLayer->Clear(0);
   agg::rendering_buffer raw_buf(pThisLayer->GetBuffer(), pThisLayer->GetWidth(),
                                 pThisLayer->GetHeight(),
@@ -309,8 +374,7 @@ void CFX_AggDeviceDriver::SetClipMask(agg::rasterizer_scanline_aa& rasterizer) {
       final_render(base_buf, path_rect.left, path_rect.top);
   final_render.color(agg::gray8(255));
   agg::scanline_u8 scanline;
-  agg::render_scanlines(rasterizer, scanline, final_render,
-                        (m_FillFlags & FXFILL_NOPATHSMOOTH) != 0);
+  agg::render_scanlines(rasterizer, scanline, final_render, no_smooth);
   m_pClipRgn->IntersectMaskF(path_rect.left, path_rect.top, mask);
 }
 FX_BOOL CFX_AggDeviceDriver::SetClip_PathFill(const CFX_PathData* pPathData,
@@ -1184,6 +1248,57 @@ class CFX_Renderer {
     return TRUE;
   }
 };
+namespace {
+
+const int kRasterStripeRows = 16;
+const int64_t kMinParallelRasterArea = 512 * 512;
+
+// Scan converts paths covering at least kMinParallelRasterArea pixels in
+// stripes of rows on |pPool|. Returns FALSE for smaller paths, which are
+// not worth the hand-off.
+FX_BOOL RenderRasterizerInBands(CFX_ThreadPool* pPool,
+                                agg::rasterizer_scanline_aa& rasterizer,
+                                const CFX_Renderer& render,
+                                bool no_smooth) {
+  if (!rasterizer.rewind_scanlines())
+    return FALSE;
+
+  int top = rasterizer.min_y();
+  int bottom = rasterizer.max_y() + 1;
+  int64_t area =
+      (int64_t)(bottom - top) * (rasterizer.max_x() - rasterizer.min_x() + 1);
+  int nStripes = (bottom - top + kRasterStripeRows - 1) / kRasterStripeRows;
+  if (area < kMinParallelRasterArea || nStripes < 2)
+    return FALSE;
+
+  // Stripes are dealt out in turn so that every task gets a share of the
+  // busy parts of the path. Each task writes its own rows only.
+  int nTasks = std::min(pPool->CountThreads() + 1, nStripes);
+  auto render_stripes = [&rasterizer, &render, top, bottom, nTasks,
+                         no_smooth](int first) {
+    CFX_Renderer band_render = render;
+    agg::scanline_u8 scanline;
+    scanline.reset(rasterizer.min_x(), rasterizer.max_x());
+    for (int y0 = top + first * kRasterStripeRows; y0 < bottom;
+         y0 += nTasks * kRasterStripeRows) {
+      int y1 = std::min(y0 + kRasterStripeRows, bottom);
+      for (int y = y0; y < y1; y++) {
+        if (rasterizer.sweep_row(y, scanline, no_smooth))
+          band_render.render(scanline);
+      }
+    }
+  };
+  std::vector<std::future<void>> results;
+  for (int i = 1; i < nTasks; i++)
+    results.push_back(pPool->PostTask(std::bind(render_stripes, i)));
+  render_stripes(0);
+  for (std::future<void>& result : results)
+    result.wait();
+  return TRUE;
+}
+
+}  // namespace
+
 FX_BOOL CFX_AggDeviceDriver::RenderRasterizer(
     agg::rasterizer_scanline_aa& rasterizer,
     FX_DWORD color,
@@ -1197,9 +1312,104 @@ FX_BOOL CFX_AggDeviceDriver::RenderRasterizer(
                    m_bRgbByteOrder, alpha_flag, pIccTransform)) {
     return FALSE;
   }
+  bool no_smooth = (m_FillFlags & FXFILL_NOPATHSMOOTH) != 0;
+  if (m_pRasterPool &&
+      RenderRasterizerInBands(m_pRasterPool, rasterizer, render, no_smooth)) {
+    return TRUE;
+  }
   agg::scanline_u8 scanline;
-  agg::render_scanlines(rasterizer, scanline, render,
-                        (m_FillFlags & FXFILL_NOPATHSMOOTH) != 0);
+  agg::render_scanlines(rasterizer, scanline, render, no_smooth);
+  return TRUE;
+}
+FX_BOOL CFX_AggDeviceDriver::RenderPath(
+    const std::function<void(agg::rasterizer_scanline_aa&)>& add_path,
+    agg::filling_rule_e filling_rule,
+    FX_DWORD color,
+    FX_BOOL bFullCover,
+    FX_BOOL bGroupKnockout,
+    int alpha_flag,
+    void* pIccTransform) {
+  unsigned dropped;
+  int first;
+  int last;
+  {
+    agg::rasterizer_scanline_aa rasterizer;
+    rasterizer.clip_box(0.0f, 0.0f,
+                        (FX_FLOAT)(GetDeviceCaps(FXDC_PIXEL_WIDTH)),
+                        (FX_FLOAT)(GetDeviceCaps(FXDC_PIXEL_HEIGHT)));
+    rasterizer.cell_limit(m_RasterCellLimit);
+    add_path(rasterizer);
+    rasterizer.filling_rule(filling_rule);
+    dropped = rasterizer.dropped_cells();
+    if (!dropped || rasterizer.min_y() >= rasterizer.max_y()) {
+      return RenderRasterizer(rasterizer, color, bFullCover, bGroupKnockout,
+                              alpha_flag, pIccTransform);
+    }
+    first = rasterizer.min_y();
+    last = rasterizer.max_y();
+  }
+  // Keep the vertices the rasterizer is fed, so that strokes and dashes are
+  // generated only once however many bands there are. The empty band keeps
+  // the cells from being made again.
+  agg::path_storage outline;
+  {
+    agg::rasterizer_scanline_aa recorder;
+    recorder.band(1, 0);
+    recorder.record(&outline);
+    add_path(recorder);
+  }
+  return RenderPathBands(outline, filling_rule, first, last, dropped, color,
+                         bFullCover, bGroupKnockout, alpha_flag,
+                         pIccTransform);
+}
+FX_BOOL CFX_AggDeviceDriver::RenderPathBands(agg::path_storage& outline,
+                                             agg::filling_rule_e filling_rule,
+                                             int first,
+                                             int last,
+                                             unsigned dropped,
+                                             FX_DWORD color,
+                                             FX_BOOL bFullCover,
+                                             FX_BOOL bGroupKnockout,
+                                             int alpha_flag,
+                                             void* pIccTransform) {
+  // Size the bands for the cells rows |first| to |last| need, assuming they
+  // are spread evenly. A band that still overflows is split again.
+  int64_t rows = (int64_t)last - first + 1;
+  int64_t nBands = std::min<int64_t>(
+      ((int64_t)m_RasterCellLimit + dropped) / m_RasterCellLimit + 1, rows);
+  for (int64_t i = 0; i < nBands; i++) {
+    int top = (int)(first + rows * i / nBands);
+    int bottom = (int)(first + rows * (i + 1) / nBands - 1);
+    unsigned band_dropped;
+    int band_first;
+    int band_last;
+    {
+      agg::rasterizer_scanline_aa rasterizer;
+      rasterizer.clip_box(0.0f, 0.0f,
+                          (FX_FLOAT)(GetDeviceCaps(FXDC_PIXEL_WIDTH)),
+                          (FX_FLOAT)(GetDeviceCaps(FXDC_PIXEL_HEIGHT)));
+      rasterizer.band(top, bottom);
+      rasterizer.cell_limit(m_RasterCellLimit);
+      rasterizer.add_path(outline);
+      rasterizer.filling_rule(filling_rule);
+      band_dropped = rasterizer.dropped_cells();
+      // A single row is rendered with what fit, as it cannot be split.
+      if (!band_dropped || rasterizer.min_y() >= rasterizer.max_y()) {
+        if (!RenderRasterizer(rasterizer, color, bFullCover, bGroupKnockout,
+                              alpha_flag, pIccTransform)) {
+          return FALSE;
+        }
+        continue;
+      }
+      band_first = rasterizer.min_y();
+      band_last = rasterizer.max_y();
+    }
+    if (!RenderPathBands(outline, filling_rule, band_first, band_last,
+                         band_dropped, color, bFullCover, bGroupKnockout,
+                         alpha_flag, pIccTransform)) {
+      return FALSE;
+    }
+  }
   return TRUE;
 }
 FX_BOOL CFX_AggDeviceDriver::DrawPath(const CFX_PathData* pPathData,
@@ -1221,15 +1431,14 @@ FX_BOOL CFX_AggDeviceDriver::DrawPath(const CFX_PathData* pPathData,
   if ((fill_mode & 3) && fill_color) {
     CAgg_PathData path_data;
     path_data.BuildPath(pPathData, pObject2Device);
-    agg::rasterizer_scanline_aa rasterizer;
-    rasterizer.clip_box(0.0f, 0.0f, (FX_FLOAT)(GetDeviceCaps(FXDC_PIXEL_WIDTH)),
-                        (FX_FLOAT)(GetDeviceCaps(FXDC_PIXEL_HEIGHT)));
-    rasterizer.add_path(path_data.m_PathData);
-    rasterizer.filling_rule((fill_mode & 3) == FXFILL_WINDING
-                                ? agg::fill_non_zero
-                                : agg::fill_even_odd);
-    if (!RenderRasterizer(rasterizer, fill_color, fill_mode & FXFILL_FULLCOVER,
-                          FALSE, alpha_flag, pIccTransform)) {
+    auto add_path = [&path_data](agg::rasterizer_scanline_aa& rasterizer) {
+      rasterizer.add_path(path_data.m_PathData);
+    };
+    if (!RenderPath(add_path, (fill_mode & 3) == FXFILL_WINDING
+                                  ? agg::fill_non_zero
+                                  : agg::fill_even_odd,
+                    fill_color, fill_mode & FXFILL_FULLCOVER, FALSE,
+                    alpha_flag, pIccTransform)) {
       return FALSE;
     }
   }
@@ -1240,17 +1449,17 @@ FX_BOOL CFX_AggDeviceDriver::DrawPath(const CFX_PathData* pPathData,
     if (fill_mode & FX_ZEROAREA_FILL) {
       CAgg_PathData path_data;
       path_data.BuildPath(pPathData, pObject2Device);
-      agg::rasterizer_scanline_aa rasterizer;
-      rasterizer.clip_box(0.0f, 0.0f,
-                          (FX_FLOAT)(GetDeviceCaps(FXDC_PIXEL_WIDTH)),
-                          (FX_FLOAT)(GetDeviceCaps(FXDC_PIXEL_HEIGHT)));
-      RasterizeStroke(rasterizer, path_data.m_PathData, NULL, pGraphState, 1,
-                      FALSE, fill_mode & FX_STROKE_TEXT_MODE);
+      FX_BOOL bTextMode = fill_mode & FX_STROKE_TEXT_MODE;
+      auto add_stroke = [&path_data, pGraphState,
+                         bTextMode](agg::rasterizer_scanline_aa& rasterizer) {
+        RasterizeStroke(rasterizer, path_data.m_PathData, NULL, pGraphState, 1,
+                        FALSE, bTextMode);
+      };
       int fill_flag = FXGETFLAG_COLORTYPE(alpha_flag) << 8 |
                       FXGETFLAG_ALPHA_STROKE(alpha_flag);
-      if (!RenderRasterizer(rasterizer, stroke_color,
-                            fill_mode & FXFILL_FULLCOVER, m_bGroupKnockout,
-                            fill_flag, pIccTransform)) {
+      if (!RenderPath(add_stroke, agg::fill_non_zero, stroke_color,
+                      fill_mode & FXFILL_FULLCOVER, m_bGroupKnockout,
+                      fill_flag, pIccTransform)) {
         return FALSE;
       }
       return TRUE;
@@ -1270,16 +1479,17 @@ FX_BOOL CFX_AggDeviceDriver::DrawPath(const CFX_PathData* pPathData,
     }
     CAgg_PathData path_data;
     path_data.BuildPath(pPathData, &matrix1);
-    agg::rasterizer_scanline_aa rasterizer;
-    rasterizer.clip_box(0.0f, 0.0f, (FX_FLOAT)(GetDeviceCaps(FXDC_PIXEL_WIDTH)),
-                        (FX_FLOAT)(GetDeviceCaps(FXDC_PIXEL_HEIGHT)));
-    RasterizeStroke(rasterizer, path_data.m_PathData, &matrix2, pGraphState,
-                    matrix1.a, FALSE, fill_mode & FX_STROKE_TEXT_MODE);
+    FX_BOOL bTextMode = fill_mode & FX_STROKE_TEXT_MODE;
+    auto add_stroke = [&path_data, &matrix1, &matrix2, pGraphState,
+                       bTextMode](agg::rasterizer_scanline_aa& rasterizer) {
+      RasterizeStroke(rasterizer, path_data.m_PathData, &matrix2, pGraphState,
+                      matrix1.a, FALSE, bTextMode);
+    };
     int fill_flag = FXGETFLAG_COLORTYPE(alpha_flag) << 8 |
                     FXGETFLAG_ALPHA_STROKE(alpha_flag);
-    if (!RenderRasterizer(rasterizer, stroke_color,
-                          fill_mode & FXFILL_FULLCOVER, m_bGroupKnockout,
-                          fill_flag, pIccTransform)) {
+    if (!RenderPath(add_stroke, agg::fill_non_zero, stroke_color,
+                    fill_mode & FXFILL_FULLCOVER, m_bGroupKnockout, fill_flag,
+                    pIccTransform)) {
       return FALSE;
     }
   }
@@ -1771,6 +1981,14 @@ FX_BOOL CFX_FxgeDevice::Attach(CFX_DIBitmap* pBitmap,
   SetDeviceDriver(pDriver);
   return TRUE;
 }
+void CFX_FxgeDevice::SetParallelRaster(FX_BOOL bParallel) {
+  CFX_AggDeviceDriver* pDriver =
+      static_cast<CFX_AggDeviceDriver*>(GetDeviceDriver());
+  if (!pDriver)
+    return;
+  pDriver->m_pRasterPool =
+      bParallel ? CFX_GEModule::Get()->GetRasterThreadPool() : NULL;
+}
 FX_BOOL CFX_FxgeDevice::Create(int width,
                                int height,
                                FXDIB_Format format,
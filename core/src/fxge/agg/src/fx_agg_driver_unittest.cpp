@@ -0,0 +1,85 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/src/fxge/agg/include/fx_agg_driver.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+const int kSize = 200;
+
+// A star of |nPoints| spikes, whose outline crosses itself many times.
+void BuildStar(CFX_PathData* pPath, int nPoints) {
+  pPath->SetPointCount(nPoints + 1);
+  for (int i = 0; i < nPoints; i++) {
+    double angle = 2 * FX_PI * ((i * (nPoints / 2 - 1)) % nPoints) / nPoints;
+    pPath->SetPoint(i, (FX_FLOAT)(kSize / 2 + 95 * cos(angle)),
+                    (FX_FLOAT)(kSize / 2 + 95 * sin(angle)),
+                    i ? FXPT_LINETO : FXPT_MOVETO);
+  }
+  pPath->SetPoint(nPoints, pPath->GetPointX(0), pPath->GetPointY(0),
+                  FXPT_LINETO | FXPT_CLOSEFIGURE);
+}
+
+// Draws |path| on a fresh bitmap, holding at most |cell_limit| cells.
+void DrawWithCellLimit(const CFX_PathData& path,
+                       const CFX_GraphStateData* pGraphState,
+                       int fill_mode,
+                       unsigned cell_limit,
+                       CFX_DIBitmap* pBitmap) {
+  ASSERT_TRUE(pBitmap->Create(kSize, kSize, FXDIB_Argb));
+  pBitmap->Clear(0xffffffff);
+  CFX_AggDeviceDriver driver(pBitmap, 0, FALSE, NULL, FALSE);
+  driver.m_RasterCellLimit = cell_limit;
+  EXPECT_TRUE(driver.DrawPath(&path, NULL, pGraphState,
+                              fill_mode ? 0xff2040c0 : 0, 0xc0e02020,
+                              fill_mode, 0, NULL, FXDIB_BLEND_NORMAL));
+}
+
+bool SameBitmaps(const CFX_DIBitmap& a, const CFX_DIBitmap& b) {
+  for (int row = 0; row < kSize; row++) {
+    if (memcmp(a.GetScanline(row), b.GetScanline(row), kSize * 4) != 0)
+      return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+class AggDriverTest : public testing::Test {
+ public:
+  void SetUp() override { CFX_GEModule::Create(nullptr, nullptr); }
+  void TearDown() override { CFX_GEModule::Destroy(); }
+};
+
+TEST_F(AggDriverTest, BandedRasterizerFill) {
+  CFX_PathData path;
+  BuildStar(&path, 101);
+  for (int fill_mode : {FXFILL_WINDING, FXFILL_ALTERNATE}) {
+    CFX_DIBitmap expected;
+    DrawWithCellLimit(path, NULL, fill_mode, 1 << 20, &expected);
+    for (unsigned cell_limit : {2000u, 700u}) {
+      CFX_DIBitmap banded;
+      DrawWithCellLimit(path, NULL, fill_mode, cell_limit, &banded);
+      EXPECT_TRUE(SameBitmaps(expected, banded)) << cell_limit;
+    }
+  }
+}
+
+TEST_F(AggDriverTest, BandedRasterizerStroke) {
+  CFX_PathData path;
+  BuildStar(&path, 31);
+  CFX_GraphStateData graph_state;
+  graph_state.m_LineWidth = 3.5f;
+  graph_state.m_LineJoin = CFX_GraphStateData::LineJoinRound;
+  CFX_DIBitmap expected;
+  DrawWithCellLimit(path, &graph_state, 0, 1 << 20, &expected);
+  CFX_DIBitmap banded;
+  DrawWithCellLimit(path, &graph_state, 0, 500, &banded);
+  EXPECT_TRUE(SameBitmaps(expected, banded));
+}
@@ -95,16 +95,22 @@ void* CFX_MacFontInfo::MapFont(int weight,
 
   return NULL;
 }
-IFX_SystemFontInfo* IFX_SystemFontInfo::CreateDefault(const char** pUnused) {
+IFX_SystemFontInfo* IFX_SystemFontInfo::CreateDefault(
+    const char** pUnused,
+    const char* pCatalogPath) {
   CFX_MacFontInfo* pInfo = new CFX_MacFontInfo;
   pInfo->AddPath("~/Library/Fonts");
   pInfo->AddPath("/Library/Fonts");
   pInfo->AddPath("/System/Library/Fonts");
+  if (pCatalogPath) {
+    pInfo->SetCatalogPath(pCatalogPath);
+  }
   return pInfo;
 }
 void CFX_GEModule::InitPlatform() {
   m_pPlatformData = new CApplePlatform;
-  m_pFontMgr->SetSystemFontInfo(IFX_SystemFontInfo::CreateDefault(nullptr));
+  m_pFontMgr->SetSystemFontInfo(
+      IFX_SystemFontInfo::CreateDefault(nullptr, GetFontCatalogPath()));
 }
 void CFX_GEModule::DestroyPlatform() {
   delete (CApplePlatform*)m_pPlatformData;
@@ -8,6 +8,8 @@
 
 #include <limits.h>
 
+#include <algorithm>
+
 #include "core/include/fxge/fx_ge.h"
 #include "core/include/fxcodec/fx_codec.h"
 #include "dib_int.h"
@@ -65,6 +67,19 @@ FX_BOOL CFX_DIBitmap::Create(int width,
                              FXDIB_Format format,
                              uint8_t* pBuffer,
                              int pitch) {
+  return CreateBuffer(width, height, format, pBuffer, pitch, TRUE);
+}
+FX_BOOL CFX_DIBitmap::CreateUninit(int width,
+                                   int height,
+                                   FXDIB_Format format) {
+  return CreateBuffer(width, height, format, NULL, 0, FALSE);
+}
+FX_BOOL CFX_DIBitmap::CreateBuffer(int width,
+                                   int height,
+                                   FXDIB_Format format,
+                                   uint8_t* pBuffer,
+                                   int pitch,
+                                   FX_BOOL bZeroed) {
   m_pBuffer = NULL;
   m_bpp = (uint8_t)format;
   m_AlphaFlag = (uint8_t)(format >> 8);
@@ -88,13 +103,18 @@ FX_BOOL CFX_DIBitmap::Create(int width,
     int size = pitch * height + 4;
     int oomlimit = _MAX_OOM_LIMIT_;
     if (oomlimit >= 0 && size >= oomlimit) {
-      m_pBuffer = FX_TryAlloc(uint8_t, size);
+      m_pBuffer = bZeroed ? FX_TryAlloc(uint8_t, size)
+                          : FX_TryAllocUninit(uint8_t, size);
       if (!m_pBuffer) {
         return FALSE;
       }
     } else {
-      m_pBuffer = FX_Alloc(uint8_t, size);
+      m_pBuffer = bZeroed ? FX_Alloc(uint8_t, size)
+                          : FX_AllocUninit(uint8_t, size);
     }
+    // Some scanline readers load a few bytes past the last pixel.
+    if (!bZeroed)
+      FXSYS_memset(m_pBuffer + size - 4, 0, 4);
   }
   m_Width = width;
   m_Height = height;
@@ -117,7 +137,7 @@ FX_BOOL CFX_DIBitmap::Copy(const CFX_DIBSource* pSrc) {
   if (m_pBuffer) {
     return FALSE;
   }
-  if (!Create(pSrc->GetWidth(), pSrc->GetHeight(), pSrc->GetFormat())) {
+  if (!CreateUninit(pSrc->GetWidth(), pSrc->GetHeight(), pSrc->GetFormat())) {
     return FALSE;
   }
   CopyPalette(pSrc->GetPalette());
@@ -430,6 +450,39 @@ FX_BOOL CFX_DIBitmap::TransferBitmap(int dest_left,
   }
   return TRUE;
 }
+FX_BOOL CFX_DIBitmap::TileBitmap(const CFX_DIBitmap* pTile,
+                                 int origin_x,
+                                 int origin_y) {
+  if (!m_pBuffer || !pTile->GetBuffer() || pTile->GetFormat() != GetFormat() ||
+      GetBPP() < 8 || m_pAlphaMask) {
+    return FALSE;
+  }
+  int tile_width = pTile->GetWidth();
+  int tile_height = pTile->GetHeight();
+  int Bpp = GetBPP() / 8;
+  int first_col = (tile_width - origin_x % tile_width) % tile_width;
+  int first_row = (tile_height - origin_y % tile_height) % tile_height;
+  for (int row = 0; row < m_Height; row++) {
+    uint8_t* dest_scan = m_pBuffer + row * m_Pitch;
+    if (row >= tile_height) {
+      // Rows repeat with the tile.
+      FXSYS_memcpy(dest_scan, dest_scan - tile_height * m_Pitch, m_Width * Bpp);
+      continue;
+    }
+    const uint8_t* src_scan =
+        pTile->GetScanline((first_row + row) % tile_height);
+    int col = 0;
+    int src_col = first_col;
+    while (col < m_Width) {
+      int count = std::min(tile_width - src_col, m_Width - col);
+      FXSYS_memcpy(dest_scan + col * Bpp, src_scan + src_col * Bpp,
+                   count * Bpp);
+      col += count;
+      src_col = 0;
+    }
+  }
+  return TRUE;
+}
 FX_BOOL CFX_DIBitmap::TransferMask(int dest_left,
                                    int dest_top,
                                    int width,
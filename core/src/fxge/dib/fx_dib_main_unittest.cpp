@@ -0,0 +1,36 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/include/fxge/fx_dib.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+TEST(fxge, TileBitmap) {
+  CFX_DIBitmap tile;
+  ASSERT_TRUE(tile.Create(3, 2, FXDIB_Argb));
+  for (int y = 0; y < 2; y++) {
+    for (int x = 0; x < 3; x++)
+      tile.SetPixel(x, y, 0xff000000 | (y << 8) | x);
+  }
+
+  // Origins left of, inside and far beyond the bitmap.
+  const int kOrigins[][2] = {{0, 0}, {1, 1}, {-4, -3}, {31, 17}};
+  for (const auto& origin : kOrigins) {
+    CFX_DIBitmap bitmap;
+    ASSERT_TRUE(bitmap.Create(10, 7, FXDIB_Argb));
+    EXPECT_TRUE(bitmap.TileBitmap(&tile, origin[0], origin[1]));
+    for (int y = 0; y < 7; y++) {
+      for (int x = 0; x < 10; x++) {
+        int tile_x = ((x - origin[0]) % 3 + 3) % 3;
+        int tile_y = ((y - origin[1]) % 2 + 2) % 2;
+        EXPECT_EQ(tile.GetPixel(tile_x, tile_y), bitmap.GetPixel(x, y))
+            << x << "," << y;
+      }
+    }
+  }
+
+  CFX_DIBitmap mask;
+  ASSERT_TRUE(mask.Create(10, 7, FXDIB_8bppMask));
+  EXPECT_FALSE(mask.TileBitmap(&tile, 0, 0));
+}
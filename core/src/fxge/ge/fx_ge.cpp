@@ -6,29 +6,37 @@
 
 #include "core/include/fxge/fx_ge.h"
 
+#include "core/include/fxcrt/fx_threadpool.h"
 #include "text_int.h"
 
 static CFX_GEModule* g_pGEModule = NULL;
-CFX_GEModule::CFX_GEModule(const char** pUserFontPaths) {
+CFX_GEModule::CFX_GEModule(const char** pUserFontPaths,
+                           const char* pFontCatalogPath) {
   m_pFontCache = NULL;
   m_pFontMgr = NULL;
   m_FTLibrary = NULL;
   m_pCodecModule = NULL;
+  m_pRasterThreadPool = NULL;
   m_pPlatformData = NULL;
   m_pUserFontPaths = pUserFontPaths;
+  if (pFontCatalogPath)
+    m_FontCatalogPath = pFontCatalogPath;
 }
 CFX_GEModule::~CFX_GEModule() {
   delete m_pFontCache;
   m_pFontCache = NULL;
   delete m_pFontMgr;
   m_pFontMgr = NULL;
+  delete m_pRasterThreadPool;
+  m_pRasterThreadPool = NULL;
   DestroyPlatform();
 }
 CFX_GEModule* CFX_GEModule::Get() {
   return g_pGEModule;
 }
-void CFX_GEModule::Create(const char** userFontPaths) {
-  g_pGEModule = new CFX_GEModule(userFontPaths);
+void CFX_GEModule::Create(const char** userFontPaths,
+                          const char* fontCatalogPath) {
+  g_pGEModule = new CFX_GEModule(userFontPaths, fontCatalogPath);
   g_pGEModule->m_pFontMgr = new CFX_FontMgr;
   g_pGEModule->InitPlatform();
   g_pGEModule->SetTextGamma(2.2f);
@@ -46,6 +54,13 @@ CFX_FontCache* CFX_GEModule::GetFontCache() {
   }
   return m_pFontCache;
 }
+CFX_ThreadPool* CFX_GEModule::GetRasterThreadPool() {
+  if (!m_pRasterThreadPool) {
+    m_pRasterThreadPool =
+        new CFX_ThreadPool(CFX_ThreadPool::GetDefaultThreadCount());
+  }
+  return m_pRasterThreadPool;
+}
 void CFX_GEModule::SetTextGamma(FX_FLOAT gammaValue) {
   gammaValue /= 2.2f;
   int i = 0;
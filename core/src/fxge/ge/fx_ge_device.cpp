@@ -50,26 +50,22 @@ int CFX_RenderDevice::GetDeviceCaps(int caps_id) const {
 CFX_Matrix CFX_RenderDevice::GetCTM() const {
   return m_pDeviceDriver->GetCTM();
 }
-FX_BOOL CFX_RenderDevice::CreateCompatibleBitmap(CFX_DIBitmap* pDIB,
-                                                 int width,
-                                                 int height) const {
-  if (m_RenderCaps & FXRC_CMYK_OUTPUT) {
-    return pDIB->Create(width, height, m_RenderCaps & FXRC_ALPHA_OUTPUT
-                                           ? FXDIB_Cmyka
-                                           : FXDIB_Cmyk);
-  }
-  if (m_RenderCaps & FXRC_BYTEMASK_OUTPUT) {
-    return pDIB->Create(width, height, FXDIB_8bppMask);
-  }
+FXDIB_Format CFX_RenderDevice::GetCompatibleFormat() const {
+  if (m_RenderCaps & FXRC_CMYK_OUTPUT)
+    return m_RenderCaps & FXRC_ALPHA_OUTPUT ? FXDIB_Cmyka : FXDIB_Cmyk;
+  if (m_RenderCaps & FXRC_BYTEMASK_OUTPUT)
+    return FXDIB_8bppMask;
 #if _FXM_PLATFORM_ == _FXM_PLATFORM_APPLE_
-  return pDIB->Create(width, height, m_RenderCaps & FXRC_ALPHA_OUTPUT
-                                         ? FXDIB_Argb
-                                         : FXDIB_Rgb32);
+  return m_RenderCaps & FXRC_ALPHA_OUTPUT ? FXDIB_Argb : FXDIB_Rgb32;
 #else
-  return pDIB->Create(
-      width, height, m_RenderCaps & FXRC_ALPHA_OUTPUT ? FXDIB_Argb : FXDIB_Rgb);
+  return m_RenderCaps & FXRC_ALPHA_OUTPUT ? FXDIB_Argb : FXDIB_Rgb;
 #endif
 }
+FX_BOOL CFX_RenderDevice::CreateCompatibleBitmap(CFX_DIBitmap* pDIB,
+                                                 int width,
+                                                 int height) const {
+  return pDIB->Create(width, height, GetCompatibleFormat());
+}
 FX_BOOL CFX_RenderDevice::SetClip_PathFill(const CFX_PathData* pPathData,
                                            const CFX_Matrix* pObject2Device,
                                            int fill_mode) {
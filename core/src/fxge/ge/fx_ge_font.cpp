@@ -43,10 +43,6 @@ CFX_UnicodeEncodingEx* _FXFM_CreateFontEncoding(CFX_Font* pFont,
 }
 #endif  // PDF_ENABLE_XFA
 
-FXFT_Face FT_LoadFont(const uint8_t* pData, int size) {
-  return CFX_GEModule::Get()->GetFontMgr()->GetFixedFace(pData, size, 0);
-}
-
 }  // namespace
 
 CFX_Font::CFX_Font() {
@@ -55,7 +51,6 @@ CFX_Font::CFX_Font() {
   m_bEmbedded = FALSE;
   m_bVertical = FALSE;
   m_pFontData = NULL;
-  m_pFontDataAllocation = NULL;
   m_dwSize = 0;
   m_pGsubData = NULL;
   m_pPlatformFont = NULL;
@@ -106,7 +101,6 @@ FX_BOOL CFX_Font::LoadClone(const CFX_Font* pFont) {
 
 CFX_Font::~CFX_Font() {
   delete m_pSubstFont;
-  FX_Free(m_pFontDataAllocation);
 #ifdef PDF_ENABLE_XFA
   if (m_bLogic) {
     m_OtfFontData.DetachBuffer();
@@ -134,7 +128,7 @@ CFX_Font::~CFX_Font() {
 #endif
 }
 void CFX_Font::DeleteFace() {
-  FXFT_Done_Face(m_Face);
+  CFX_GEModule::Get()->GetFontMgr()->ReleaseEmbeddedFace(m_Face);
   m_Face = NULL;
 }
 void CFX_Font::LoadSubst(const CFX_ByteString& face_name,
@@ -244,10 +238,8 @@ int CFX_Font::GetGlyphWidth(FX_DWORD glyph_index) {
 }
 
 FX_BOOL CFX_Font::LoadEmbedded(const uint8_t* data, FX_DWORD size) {
-  m_pFontDataAllocation = FX_Alloc(uint8_t, size);
-  FXSYS_memcpy(m_pFontDataAllocation, data, size);
-  m_Face = FT_LoadFont(m_pFontDataAllocation, size);
-  m_pFontData = m_pFontDataAllocation;
+  m_Face = CFX_GEModule::Get()->GetFontMgr()->GetEmbeddedFace(data, size,
+                                                              m_pFontData);
   m_bEmbedded = TRUE;
   m_dwSize = size;
   return m_Face != NULL;
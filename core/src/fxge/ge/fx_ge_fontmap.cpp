@@ -4,9 +4,13 @@
 
 // Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
 
+#include <ctime>
 #include <limits>
+#include <utility>
 #include <vector>
 
+#include "core/include/fxcrt/fx_ext.h"
+#include "core/include/fxcrt/fx_memorybudget.h"
 #include "core/include/fxge/fx_freetype.h"
 #include "core/include/fxge/fx_ge.h"
 #include "core/src/fxge/fontdata/chromefontdata/chromefontdata.h"
@@ -24,6 +28,10 @@
 
 namespace {
 
+// Bytes of embedded font programs that no font uses, kept for the next
+// documents that embed them.
+const size_t kDefaultEmbeddedFontCacheLimit = 16 * 1024 * 1024;
+
 struct BuiltinFont {
   const uint8_t* m_pFontData;
   FX_DWORD m_dwSize;
@@ -433,7 +441,11 @@ CTTFontDesc::~CTTFontDesc() {
         FXFT_Done_Face(m_TTCFace.m_pFaces[i]);
       }
   }
-  FX_Free(m_pFontData);
+  if (m_pFontFile) {
+    m_pFontFile->Release();
+  } else {
+    FX_Free(m_pFontData);
+  }
 }
 int CTTFontDesc::ReleaseFace(FXFT_Face face) {
   if (m_Type == 1) {
@@ -458,13 +470,35 @@ int CTTFontDesc::ReleaseFace(FXFT_Face face) {
   return 0;
 }
 
-CFX_FontMgr::CFX_FontMgr() : m_FTLibrary(nullptr) {
+CFX_EmbeddedFontDesc::CFX_EmbeddedFontDesc(const uint8_t* pData,
+                                           FX_DWORD size)
+    : m_pFontData(FX_Alloc(uint8_t, size)),
+      m_dwSize(size),
+      m_CharmapIndex(-1),
+      m_nFacesInUse(0),
+      m_LastUse(0) {
+  FXSYS_memcpy(m_pFontData, pData, size);
+}
+
+CFX_EmbeddedFontDesc::~CFX_EmbeddedFontDesc() {
+  for (FXFT_Face face : m_IdleFaces)
+    FXFT_Done_Face(face);
+  FX_Free(m_pFontData);
+}
+
+CFX_FontMgr::CFX_FontMgr()
+    : m_IdleEmbeddedFontSize(0),
+      m_EmbeddedFontCacheLimit(kDefaultEmbeddedFontCacheLimit),
+      m_EmbeddedFontUseCount(0),
+      m_FTLibrary(nullptr) {
   m_pBuiltinMapper.reset(new CFX_FontMapper(this));
 }
 
 CFX_FontMgr::~CFX_FontMgr() {
   for (const auto& pair : m_FaceMap)
     delete pair.second;
+  for (const auto& pair : m_EmbeddedFonts)
+    delete pair.second;
 
   // |m_pBuiltinMapper| references |m_FTLibrary|, so it has to be destroyed
   // first.
@@ -512,13 +546,15 @@ FXFT_Face CFX_FontMgr::AddCachedFace(const CFX_ByteString& face_name,
                                      FX_BOOL bItalic,
                                      uint8_t* pData,
                                      FX_DWORD size,
-                                     int face_index) {
+                                     int face_index,
+                                     IFX_MemoryMappedFile* pFontFile) {
   CTTFontDesc* pFontDesc = new CTTFontDesc;
   pFontDesc->m_Type = 1;
   pFontDesc->m_SingleFace.m_pFace = NULL;
   pFontDesc->m_SingleFace.m_bBold = weight;
   pFontDesc->m_SingleFace.m_bItalic = bItalic;
   pFontDesc->m_pFontData = pData;
+  pFontDesc->m_pFontFile = pFontFile;
   pFontDesc->m_RefCount = 1;
 
   InitFTLibrary();
@@ -580,10 +616,12 @@ FXFT_Face CFX_FontMgr::AddCachedTTCFace(int ttc_size,
                                         FX_DWORD checksum,
                                         uint8_t* pData,
                                         FX_DWORD size,
-                                        int font_offset) {
+                                        int font_offset,
+                                        IFX_MemoryMappedFile* pFontFile) {
   CTTFontDesc* pFontDesc = new CTTFontDesc;
   pFontDesc->m_Type = 2;
   pFontDesc->m_pFontData = pData;
+  pFontDesc->m_pFontFile = pFontFile;
   for (int i = 0; i < 16; i++) {
     pFontDesc->m_TTCFace.m_pFaces[i] = NULL;
   }
@@ -635,6 +673,103 @@ void CFX_FontMgr::ReleaseFace(FXFT_Face face) {
     FXFT_Done_Face(face);
 }
 
+FXFT_Face CFX_FontMgr::GetEmbeddedFace(const uint8_t* pData,
+                                       FX_DWORD size,
+                                       uint8_t*& pFontData) {
+  FX_DWORD hash = FX_HashCode_String_GetA((const FX_CHAR*)pData, size);
+  CFX_EmbeddedFontDesc* pDesc = nullptr;
+  auto range = m_EmbeddedFonts.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second->m_dwSize == size &&
+        FXSYS_memcmp(it->second->m_pFontData, pData, size) == 0) {
+      pDesc = it->second;
+      break;
+    }
+  }
+  // The copy and its faces outlive the document asking for them, so are
+  // not charged to its budget.
+  CFX_MemoryBudget::Scope scope(nullptr);
+  if (!pDesc) {
+    pDesc = new CFX_EmbeddedFontDesc(pData, size);
+    m_EmbeddedFonts.insert(std::make_pair(hash, pDesc));
+    m_IdleEmbeddedFontSize += size;
+  }
+  pDesc->m_LastUse = ++m_EmbeddedFontUseCount;
+  FXFT_Face face = nullptr;
+  if (!pDesc->m_IdleFaces.empty()) {
+    face = pDesc->m_IdleFaces.back();
+    pDesc->m_IdleFaces.pop_back();
+  } else {
+    face = GetFixedFace(pDesc->m_pFontData, size, 0);
+    if (!face) {
+      if (pDesc->m_nFacesInUse == 0)
+        DeleteEmbeddedFont(pDesc);
+      return nullptr;
+    }
+    FXFT_CharMap charmap = FXFT_Get_Face_Charmap(face);
+    for (int i = 0; charmap && i < FXFT_Get_Face_CharmapCount(face); i++) {
+      if (FXFT_Get_Face_Charmaps(face)[i] == charmap)
+        pDesc->m_CharmapIndex = i;
+    }
+  }
+  if (pDesc->m_nFacesInUse++ == 0)
+    m_IdleEmbeddedFontSize -= size;
+  m_EmbeddedFaces[face] = pDesc;
+  pFontData = pDesc->m_pFontData;
+  return face;
+}
+
+void CFX_FontMgr::ReleaseEmbeddedFace(FXFT_Face face) {
+  auto it = m_EmbeddedFaces.find(face);
+  if (it == m_EmbeddedFaces.end())
+    return;
+
+  CFX_EmbeddedFontDesc* pDesc = it->second;
+  m_EmbeddedFaces.erase(it);
+  // Undo what fonts change on their faces, so that the next font gets the
+  // face as if it were just opened.
+  FXFT_Get_Face_Charmap(face) =
+      pDesc->m_CharmapIndex < 0
+          ? nullptr
+          : FXFT_Get_Face_Charmaps(face)[pDesc->m_CharmapIndex];
+  FXFT_Set_Pixel_Sizes(face, 64, 64);
+  pDesc->m_IdleFaces.push_back(face);
+  if (--pDesc->m_nFacesInUse == 0) {
+    m_IdleEmbeddedFontSize += pDesc->m_dwSize;
+    TrimEmbeddedFonts();
+  }
+}
+
+void CFX_FontMgr::SetEmbeddedFontCacheLimit(size_t limit) {
+  m_EmbeddedFontCacheLimit = limit;
+  TrimEmbeddedFonts();
+}
+
+void CFX_FontMgr::TrimEmbeddedFonts() {
+  while (m_IdleEmbeddedFontSize > m_EmbeddedFontCacheLimit) {
+    CFX_EmbeddedFontDesc* pOldest = nullptr;
+    for (const auto& pair : m_EmbeddedFonts) {
+      CFX_EmbeddedFontDesc* pDesc = pair.second;
+      if (pDesc->m_nFacesInUse == 0 &&
+          (!pOldest || pDesc->m_LastUse < pOldest->m_LastUse)) {
+        pOldest = pDesc;
+      }
+    }
+    DeleteEmbeddedFont(pOldest);
+  }
+}
+
+void CFX_FontMgr::DeleteEmbeddedFont(CFX_EmbeddedFontDesc* pDesc) {
+  for (auto it = m_EmbeddedFonts.begin(); it != m_EmbeddedFonts.end(); ++it) {
+    if (it->second == pDesc) {
+      m_EmbeddedFonts.erase(it);
+      break;
+    }
+  }
+  m_IdleEmbeddedFontSize -= pDesc->m_dwSize;
+  delete pDesc;
+}
+
 bool CFX_FontMgr::GetBuiltinFont(size_t index,
                                  const uint8_t** pFontData,
                                  FX_DWORD* size) {
@@ -833,6 +968,30 @@ FXFT_Face CFX_FontMapper::UseInternalSubst(CFX_SubstFont* pSubstFont,
   return m_MMFaces[0];
 }
 
+// Gets the |size| bytes GetFontData() gives for |table|, the whole font file.
+// The file is mapped when |pFontInfo| allows, so that every process shares
+// one copy of it; |*ppFontFile| is then the mapping that holds the data.
+// Otherwise it is NULL and the data is read into a heap copy.
+static uint8_t* LoadFontFile(IFX_SystemFontInfo* pFontInfo,
+                             void* hFont,
+                             FX_DWORD table,
+                             FX_DWORD size,
+                             IFX_MemoryMappedFile** ppFontFile) {
+  IFX_MemoryMappedFile* pFontFile = pFontInfo->MapFontFile(hFont);
+  if (pFontFile && pFontFile->GetSize() != size) {
+    pFontFile->Release();
+    pFontFile = NULL;
+  }
+  *ppFontFile = pFontFile;
+  // FreeType never writes to the data of a memory face.
+  if (pFontFile)
+    return const_cast<uint8_t*>(pFontFile->GetData());
+
+  uint8_t* pFontData = FX_Alloc(uint8_t, size);
+  pFontInfo->GetFontData(hFont, table, pFontData, size);
+  return pFontData;
+}
+
 FXFT_Face CFX_FontMapper::FindSubstFont(const CFX_ByteString& name,
                                         FX_BOOL bTrueType,
                                         FX_DWORD flags,
@@ -1167,20 +1326,23 @@ FXFT_Face CFX_FontMapper::FindSubstFont(const CFX_ByteString& name,
     face = m_pFontMgr->GetCachedTTCFace(ttc_size, checksum,
                                         ttc_size - font_size, pFontData);
     if (!face) {
-      pFontData = FX_Alloc(uint8_t, ttc_size);
-      m_pFontInfo->GetFontData(hFont, kTableTTCF, pFontData, ttc_size);
+      IFX_MemoryMappedFile* pFontFile;
+      pFontData = LoadFontFile(m_pFontInfo, hFont, kTableTTCF, ttc_size,
+                               &pFontFile);
       face = m_pFontMgr->AddCachedTTCFace(ttc_size, checksum, pFontData,
-                                          ttc_size, ttc_size - font_size);
+                                          ttc_size, ttc_size - font_size,
+                                          pFontFile);
     }
   } else {
     uint8_t* pFontData;
     face = m_pFontMgr->GetCachedFace(SubstName, weight, bItalic, pFontData);
     if (!face) {
-      pFontData = FX_Alloc(uint8_t, font_size);
-      m_pFontInfo->GetFontData(hFont, 0, pFontData, font_size);
+      IFX_MemoryMappedFile* pFontFile;
+      pFontData = LoadFontFile(m_pFontInfo, hFont, 0, font_size, &pFontFile);
       face = m_pFontMgr->AddCachedFace(SubstName, weight, bItalic, pFontData,
                                        font_size,
-                                       m_pFontInfo->GetFaceIndex(hFont));
+                                       m_pFontInfo->GetFaceIndex(hFont),
+                                       pFontFile);
     }
   }
   if (!face) {
@@ -1259,12 +1421,12 @@ FXFT_Face CFX_FontMapper::FindSubstFontByUnicode(FX_DWORD dwUnicode,
     face = m_pFontMgr->GetCachedTTCFace(ttc_size, checksum,
                                         ttc_size - font_size, pFontData);
     if (face == NULL) {
-      pFontData = FX_Alloc(uint8_t, ttc_size);
-      if (pFontData) {
-        m_pFontInfo->GetFontData(hFont, 0x74746366, pFontData, ttc_size);
-        face = m_pFontMgr->AddCachedTTCFace(ttc_size, checksum, pFontData,
-                                            ttc_size, ttc_size - font_size);
-      }
+      IFX_MemoryMappedFile* pFontFile;
+      pFontData = LoadFontFile(m_pFontInfo, hFont, 0x74746366, ttc_size,
+                               &pFontFile);
+      face = m_pFontMgr->AddCachedTTCFace(ttc_size, checksum, pFontData,
+                                          ttc_size, ttc_size - font_size,
+                                          pFontFile);
     }
   } else {
     CFX_ByteString SubstName;
@@ -1272,15 +1434,12 @@ FXFT_Face CFX_FontMapper::FindSubstFontByUnicode(FX_DWORD dwUnicode,
     uint8_t* pFontData;
     face = m_pFontMgr->GetCachedFace(SubstName, weight, bItalic, pFontData);
     if (face == NULL) {
-      pFontData = FX_Alloc(uint8_t, font_size);
-      if (!pFontData) {
-        m_pFontInfo->DeleteFont(hFont);
-        return NULL;
-      }
-      m_pFontInfo->GetFontData(hFont, 0, pFontData, font_size);
+      IFX_MemoryMappedFile* pFontFile;
+      pFontData = LoadFontFile(m_pFontInfo, hFont, 0, font_size, &pFontFile);
       face = m_pFontMgr->AddCachedFace(SubstName, weight, bItalic, pFontData,
                                        font_size,
-                                       m_pFontInfo->GetFaceIndex(hFont));
+                                       m_pFontInfo->GetFaceIndex(hFont),
+                                       pFontFile);
     }
   }
   m_pFontInfo->DeleteFont(hFont);
@@ -1310,33 +1469,205 @@ unsigned long _FTStreamRead(FXFT_Stream stream,
 void _FTStreamClose(FXFT_Stream stream);
 };
 #if _FX_OS_ == _FX_ANDROID_
-IFX_SystemFontInfo* IFX_SystemFontInfo::CreateDefault(const char** pUnused) {
+IFX_SystemFontInfo* IFX_SystemFontInfo::CreateDefault(
+    const char** pUnused,
+    const char* pUnusedCatalogPath) {
   return NULL;
 }
 #endif
-CFX_FolderFontInfo::CFX_FolderFontInfo() {}
-CFX_FolderFontInfo::~CFX_FolderFontInfo() {
-  for (const auto& pair : m_FontList) {
-    delete pair.second;
+const FX_CHAR kFontCatalogMagic[] = "PDFium font catalog";
+const int kFontCatalogVersion = 1;
+static const struct {
+  FX_DWORD m_CharsetFlag;
+  int m_Charset;
+} g_InstalledCharsets[] = {
+    {CHARSET_FLAG_SHIFTJIS, FXFONT_SHIFTJIS_CHARSET},
+    {CHARSET_FLAG_GB, FXFONT_GB2312_CHARSET},
+    {CHARSET_FLAG_BIG5, FXFONT_CHINESEBIG5_CHARSET},
+    {CHARSET_FLAG_KOREAN, FXFONT_HANGEUL_CHARSET},
+    {CHARSET_FLAG_SYMBOL, FXFONT_SYMBOL_CHARSET},
+    {CHARSET_FLAG_ANSI, FXFONT_ANSI_CHARSET},
+};
+CFX_FontCatalog::CFX_FontCatalog(const CFX_ByteString& path)
+    : m_Path(path),
+      m_LoadedScanTime(0),
+      m_ScanTime(time(nullptr)),
+      m_bChanged(FALSE) {}
+void CFX_FontCatalog::Load() {
+  m_LoadedFolders.clear();
+  m_LoadedFiles.clear();
+  FXSYS_FILE* pFile = FXSYS_fopen(m_Path, "rb");
+  if (!pFile) {
+    m_bChanged = TRUE;
+    return;
+  }
+  FXSYS_fseek(pFile, 0, FXSYS_SEEK_END);
+  long size = FXSYS_ftell(pFile);
+  FXSYS_fseek(pFile, 0, FXSYS_SEEK_SET);
+  std::vector<uint8_t> data(size > 0 ? size : 0);
+  FX_BOOL bRead =
+      !data.empty() && FXSYS_fread(data.data(), data.size(), 1, pFile) == 1;
+  FXSYS_fclose(pFile);
+  if (!bRead || !Parse(data.data(), data.size())) {
+    m_LoadedFolders.clear();
+    m_LoadedFiles.clear();
+    m_bChanged = TRUE;
   }
 }
-void CFX_FolderFontInfo::AddPath(const CFX_ByteStringC& path) {
-  m_PathList.Add(path);
+FX_BOOL CFX_FontCatalog::Parse(const uint8_t* pData, FX_DWORD size) {
+  CFX_ArchiveLoader loader(pData, size);
+  CFX_ByteString magic;
+  int version = 0;
+  loader >> magic >> version;
+  if (magic != kFontCatalogMagic || version != kFontCatalogVersion ||
+      !loader.Read(&m_LoadedScanTime, sizeof(m_LoadedScanTime))) {
+    return FALSE;
+  }
+  // Every record takes more than a byte, which bounds the counts.
+  FX_DWORD nFolders = 0;
+  loader >> nFolders;
+  if (nFolders > size) {
+    return FALSE;
+  }
+  for (FX_DWORD i = 0; i < nFolders; i++) {
+    CFX_ByteString path;
+    Folder folder;
+    FX_DWORD nEntries = 0;
+    loader >> path;
+    if (!loader.Read(&folder.m_ModifiedTime, sizeof(folder.m_ModifiedTime))) {
+      return FALSE;
+    }
+    loader >> nEntries;
+    if (nEntries > size) {
+      return FALSE;
+    }
+    for (FX_DWORD j = 0; j < nEntries; j++) {
+      CFX_ByteString name;
+      uint8_t bFolder = 0;
+      loader >> name >> bFolder;
+      folder.m_Entries.push_back(std::make_pair(name, bFolder != 0));
+    }
+    m_LoadedFolders[path] = folder;
+  }
+  FX_DWORD nFiles = 0;
+  loader >> nFiles;
+  if (nFiles > size) {
+    return FALSE;
+  }
+  for (FX_DWORD i = 0; i < nFiles; i++) {
+    CFX_ByteString path;
+    File file;
+    FX_DWORD nFaces = 0;
+    loader >> path;
+    if (!loader.Read(&file.m_ModifiedTime, sizeof(file.m_ModifiedTime)) ||
+        !loader.Read(&file.m_FileSize, sizeof(file.m_FileSize))) {
+      return FALSE;
+    }
+    loader >> nFaces;
+    if (nFaces > size) {
+      return FALSE;
+    }
+    for (FX_DWORD j = 0; j < nFaces; j++) {
+      CFX_ByteString facename;
+      CFX_ByteString tables;
+      FX_DWORD offset = 0;
+      FX_DWORD styles = 0;
+      FX_DWORD charsets = 0;
+      loader >> facename >> tables >> offset >> styles >> charsets;
+      CFX_FontFaceInfo face(path, facename, tables, offset,
+                            static_cast<FX_DWORD>(file.m_FileSize));
+      face.m_Styles = styles;
+      face.m_Charsets = charsets;
+      file.m_Faces.push_back(face);
+    }
+    m_LoadedFiles.insert(std::make_pair(path, file));
+  }
+  CFX_ByteString end;
+  loader >> end;
+  return end == kFontCatalogMagic && loader.IsEOF();
 }
-void CFX_FolderFontInfo::Release() {
-  delete this;
+FX_BOOL CFX_FontCatalog::Save() {
+  if (!m_bChanged && m_Folders.size() == m_LoadedFolders.size() &&
+      m_Files.size() == m_LoadedFiles.size()) {
+    return TRUE;
+  }
+  CFX_ArchiveSaver saver;
+  saver << CFX_ByteStringC(kFontCatalogMagic) << kFontCatalogVersion;
+  saver.Write(&m_ScanTime, sizeof(m_ScanTime));
+  saver << static_cast<FX_DWORD>(m_Folders.size());
+  for (const auto& it : m_Folders) {
+    saver << it.first;
+    saver.Write(&it.second.m_ModifiedTime, sizeof(it.second.m_ModifiedTime));
+    saver << static_cast<FX_DWORD>(it.second.m_Entries.size());
+    for (const auto& entry : it.second.m_Entries) {
+      saver << entry.first << static_cast<uint8_t>(entry.second ? 1 : 0);
+    }
+  }
+  saver << static_cast<FX_DWORD>(m_Files.size());
+  for (const auto& it : m_Files) {
+    saver << it.first;
+    saver.Write(&it.second.m_ModifiedTime, sizeof(it.second.m_ModifiedTime));
+    saver.Write(&it.second.m_FileSize, sizeof(it.second.m_FileSize));
+    saver << static_cast<FX_DWORD>(it.second.m_Faces.size());
+    for (const CFX_FontFaceInfo& face : it.second.m_Faces) {
+      saver << face.m_FaceName << face.m_FontTables << face.m_FontOffset
+            << face.m_Styles << face.m_Charsets;
+    }
+  }
+  saver << CFX_ByteStringC(kFontCatalogMagic);
+
+  // Readers only ever see a complete catalog, renamed into place. Each
+  // process writes its own temporary file, so concurrent saves do not mix.
+  CFX_ByteString temp_path;
+  temp_path.Format("%s.%u.tmp", m_Path.c_str(), FX_GetCurrentProcessId());
+  FXSYS_FILE* pFile = FXSYS_fopen(temp_path, "wb");
+  if (!pFile) {
+    return FALSE;
+  }
+  FX_BOOL bSaved =
+      FXSYS_fwrite(saver.GetBuffer(), saver.GetLength(), 1, pFile) == 1;
+  bSaved = FXSYS_fclose(pFile) == 0 && bSaved;
+  bSaved = bSaved && FX_ReplaceFile(temp_path, m_Path);
+  if (!bSaved) {
+    remove(temp_path);
+  }
+  return bSaved;
 }
-FX_BOOL CFX_FolderFontInfo::EnumFontList(CFX_FontMapper* pMapper) {
-  m_pMapper = pMapper;
-  for (int i = 0; i < m_PathList.GetSize(); i++) {
-    ScanPath(m_PathList[i]);
+const CFX_FontCatalog::Folder* CFX_FontCatalog::FindFolder(
+    const CFX_ByteString& path,
+    int64_t mtime) {
+  auto it = m_LoadedFolders.find(path);
+  if (it == m_LoadedFolders.end() || it->second.m_ModifiedTime != mtime ||
+      mtime >= m_LoadedScanTime) {
+    m_bChanged = TRUE;
+    return nullptr;
   }
-  return TRUE;
+  return &it->second;
 }
-void CFX_FolderFontInfo::ScanPath(CFX_ByteString& path) {
+const CFX_FontCatalog::File* CFX_FontCatalog::FindFile(
+    const CFX_ByteString& path,
+    int64_t mtime,
+    int64_t size) {
+  auto it = m_LoadedFiles.find(path);
+  if (it == m_LoadedFiles.end() || it->second.m_ModifiedTime != mtime ||
+      it->second.m_FileSize != size || mtime >= m_LoadedScanTime) {
+    m_bChanged = TRUE;
+    return nullptr;
+  }
+  return &it->second;
+}
+void CFX_FontCatalog::AddFolder(const CFX_ByteString& path,
+                                const Folder& folder) {
+  m_Folders[path] = folder;
+}
+void CFX_FontCatalog::AddFile(const CFX_ByteString& path, const File& file) {
+  m_Files.insert(std::make_pair(path, file));
+}
+static FX_BOOL ListFontFolder(const CFX_ByteString& path,
+                              CFX_FontCatalog::Folder* pFolder) {
   void* handle = FX_OpenFolder(path);
   if (!handle) {
-    return;
+    return FALSE;
   }
   CFX_ByteString filename;
   FX_BOOL bFolder;
@@ -1352,25 +1683,73 @@ void CFX_FolderFontInfo::ScanPath(CFX_ByteString& path) {
         continue;
       }
     }
-    CFX_ByteString fullpath = path;
-#if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
-    fullpath += "\\";
-#else
-    fullpath += "/";
-#endif
-    fullpath += filename;
-    if (bFolder) {
-      ScanPath(fullpath);
-    } else {
-      ScanFile(fullpath);
-    }
+    pFolder->m_Entries.push_back(std::make_pair(filename, bFolder));
   }
   FX_CloseFolder(handle);
+  return TRUE;
 }
-void CFX_FolderFontInfo::ScanFile(CFX_ByteString& path) {
+static void LoadFontFace(const CFX_ByteString& path,
+                         FXSYS_FILE* pFile,
+                         FX_DWORD filesize,
+                         FX_DWORD offset,
+                         std::vector<CFX_FontFaceInfo>* pFaces) {
+  FXSYS_fseek(pFile, offset, FXSYS_SEEK_SET);
+  char buffer[16];
+  if (!FXSYS_fread(buffer, 12, 1, pFile)) {
+    return;
+  }
+  FX_DWORD nTables = GET_TT_SHORT(buffer + 4);
+  CFX_ByteString tables = FPDF_ReadStringFromFile(pFile, nTables * 16);
+  if (tables.IsEmpty()) {
+    return;
+  }
+  CFX_ByteString names =
+      FPDF_LoadTableFromTT(pFile, tables, nTables, 0x6e616d65);
+  CFX_ByteString facename = GetNameFromTT(names, 1);
+  CFX_ByteString style = GetNameFromTT(names, 2);
+  if (style != "Regular") {
+    facename += " " + style;
+  }
+  CFX_FontFaceInfo face(path, facename, tables, offset, filesize);
+  CFX_ByteString os2 = FPDF_LoadTableFromTT(pFile, tables, nTables, 0x4f532f32);
+  if (os2.GetLength() >= 86) {
+    const uint8_t* p = (const uint8_t*)os2 + 78;
+    FX_DWORD codepages = GET_TT_LONG(p);
+    if (codepages & (1 << 17)) {
+      face.m_Charsets |= CHARSET_FLAG_SHIFTJIS;
+    }
+    if (codepages & (1 << 18)) {
+      face.m_Charsets |= CHARSET_FLAG_GB;
+    }
+    if (codepages & (1 << 20)) {
+      face.m_Charsets |= CHARSET_FLAG_BIG5;
+    }
+    if ((codepages & (1 << 19)) || (codepages & (1 << 21))) {
+      face.m_Charsets |= CHARSET_FLAG_KOREAN;
+    }
+    if (codepages & (1 << 31)) {
+      face.m_Charsets |= CHARSET_FLAG_SYMBOL;
+    }
+  }
+  face.m_Charsets |= CHARSET_FLAG_ANSI;
+  if (style.Find("Bold") > -1) {
+    face.m_Styles |= FXFONT_BOLD;
+  }
+  if (style.Find("Italic") > -1 || style.Find("Oblique") > -1) {
+    face.m_Styles |= FXFONT_ITALIC;
+  }
+  if (facename.Find("Serif") > -1) {
+    face.m_Styles |= FXFONT_SERIF;
+  }
+  pFaces->push_back(face);
+}
+// Returns FALSE if the file could not be opened; a file which opens but holds
+// no usable faces yields none.
+static FX_BOOL LoadFontFaces(const CFX_ByteString& path,
+                             std::vector<CFX_FontFaceInfo>* pFaces) {
   FXSYS_FILE* pFile = FXSYS_fopen(path, "rb");
   if (!pFile) {
-    return;
+    return FALSE;
   }
   FXSYS_fseek(pFile, 0, FXSYS_SEEK_END);
   FX_DWORD filesize = FXSYS_ftell(pFile);
@@ -1379,14 +1758,14 @@ void CFX_FolderFontInfo::ScanFile(CFX_ByteString& path) {
   size_t readCnt = FXSYS_fread(buffer, 12, 1, pFile);
   if (readCnt != 1) {
     FXSYS_fclose(pFile);
-    return;
+    return TRUE;
   }
 
   if (GET_TT_LONG(buffer) == kTableTTCF) {
     FX_DWORD nFaces = GET_TT_LONG(buffer + 8);
     if (nFaces > std::numeric_limits<FX_DWORD>::max() / 4) {
       FXSYS_fclose(pFile);
-      return;
+      return TRUE;
     }
     FX_DWORD face_bytes = nFaces * 4;
     uint8_t* offsets = FX_Alloc(uint8_t, face_bytes);
@@ -1394,82 +1773,121 @@ void CFX_FolderFontInfo::ScanFile(CFX_ByteString& path) {
     if (readCnt != face_bytes) {
       FX_Free(offsets);
       FXSYS_fclose(pFile);
-      return;
+      return TRUE;
     }
     for (FX_DWORD i = 0; i < nFaces; i++) {
       uint8_t* p = offsets + i * 4;
-      ReportFace(path, pFile, filesize, GET_TT_LONG(p));
+      LoadFontFace(path, pFile, filesize, GET_TT_LONG(p), pFaces);
     }
     FX_Free(offsets);
   } else {
-    ReportFace(path, pFile, filesize, 0);
+    LoadFontFace(path, pFile, filesize, 0, pFaces);
   }
   FXSYS_fclose(pFile);
+  return TRUE;
 }
-void CFX_FolderFontInfo::ReportFace(CFX_ByteString& path,
-                                    FXSYS_FILE* pFile,
-                                    FX_DWORD filesize,
-                                    FX_DWORD offset) {
-  FXSYS_fseek(pFile, offset, FXSYS_SEEK_SET);
-  char buffer[16];
-  if (!FXSYS_fread(buffer, 12, 1, pFile)) {
-    return;
+CFX_FolderFontInfo::CFX_FolderFontInfo()
+    : m_pMapper(nullptr), m_pCatalog(nullptr) {}
+CFX_FolderFontInfo::~CFX_FolderFontInfo() {
+  for (const auto& pair : m_FontList) {
+    delete pair.second;
   }
-  FX_DWORD nTables = GET_TT_SHORT(buffer + 4);
-  CFX_ByteString tables = FPDF_ReadStringFromFile(pFile, nTables * 16);
-  if (tables.IsEmpty()) {
-    return;
+}
+void CFX_FolderFontInfo::AddPath(const CFX_ByteStringC& path) {
+  m_PathList.Add(path);
+}
+void CFX_FolderFontInfo::SetCatalogPath(const CFX_ByteStringC& path) {
+  m_CatalogPath = path;
+}
+void CFX_FolderFontInfo::Release() {
+  delete this;
+}
+FX_BOOL CFX_FolderFontInfo::EnumFontList(CFX_FontMapper* pMapper) {
+  m_pMapper = pMapper;
+  CFX_FontCatalog catalog(m_CatalogPath);
+  if (!m_CatalogPath.IsEmpty()) {
+    catalog.Load();
+    m_pCatalog = &catalog;
   }
-  CFX_ByteString names =
-      FPDF_LoadTableFromTT(pFile, tables, nTables, 0x6e616d65);
-  CFX_ByteString facename = GetNameFromTT(names, 1);
-  CFX_ByteString style = GetNameFromTT(names, 2);
-  if (style != "Regular") {
-    facename += " " + style;
+  for (int i = 0; i < m_PathList.GetSize(); i++) {
+    ScanPath(m_PathList[i]);
   }
-  if (pdfium::ContainsKey(m_FontList, facename))
-    return;
-
-  CFX_FontFaceInfo* pInfo =
-      new CFX_FontFaceInfo(path, facename, tables, offset, filesize);
-  CFX_ByteString os2 = FPDF_LoadTableFromTT(pFile, tables, nTables, 0x4f532f32);
-  if (os2.GetLength() >= 86) {
-    const uint8_t* p = (const uint8_t*)os2 + 78;
-    FX_DWORD codepages = GET_TT_LONG(p);
-    if (codepages & (1 << 17)) {
-      m_pMapper->AddInstalledFont(facename, FXFONT_SHIFTJIS_CHARSET);
-      pInfo->m_Charsets |= CHARSET_FLAG_SHIFTJIS;
-    }
-    if (codepages & (1 << 18)) {
-      m_pMapper->AddInstalledFont(facename, FXFONT_GB2312_CHARSET);
-      pInfo->m_Charsets |= CHARSET_FLAG_GB;
-    }
-    if (codepages & (1 << 20)) {
-      m_pMapper->AddInstalledFont(facename, FXFONT_CHINESEBIG5_CHARSET);
-      pInfo->m_Charsets |= CHARSET_FLAG_BIG5;
-    }
-    if ((codepages & (1 << 19)) || (codepages & (1 << 21))) {
-      m_pMapper->AddInstalledFont(facename, FXFONT_HANGEUL_CHARSET);
-      pInfo->m_Charsets |= CHARSET_FLAG_KOREAN;
+  if (m_pCatalog) {
+    catalog.Save();
+    m_pCatalog = nullptr;
+  }
+  return TRUE;
+}
+void CFX_FolderFontInfo::ScanPath(CFX_ByteString& path) {
+  int64_t mtime = 0;
+  int64_t size = 0;
+  FX_BOOL bCatalog = m_pCatalog && FX_GetFileStatus(path, mtime, size);
+  const CFX_FontCatalog::Folder* pCached =
+      bCatalog ? m_pCatalog->FindFolder(path, mtime) : nullptr;
+  CFX_FontCatalog::Folder folder;
+  if (pCached) {
+    folder = *pCached;
+  } else {
+    folder.m_ModifiedTime = mtime;
+    if (!ListFontFolder(path, &folder)) {
+      return;
     }
-    if (codepages & (1 << 31)) {
-      m_pMapper->AddInstalledFont(facename, FXFONT_SYMBOL_CHARSET);
-      pInfo->m_Charsets |= CHARSET_FLAG_SYMBOL;
+  }
+  if (bCatalog) {
+    m_pCatalog->AddFolder(path, folder);
+  }
+  for (const auto& entry : folder.m_Entries) {
+    CFX_ByteString fullpath = path;
+#if _FXM_PLATFORM_ == _FXM_PLATFORM_WINDOWS_
+    fullpath += "\\";
+#else
+    fullpath += "/";
+#endif
+    fullpath += entry.first;
+    if (entry.second) {
+      ScanPath(fullpath);
+    } else {
+      ScanFile(fullpath);
     }
   }
-  m_pMapper->AddInstalledFont(facename, FXFONT_ANSI_CHARSET);
-  pInfo->m_Charsets |= CHARSET_FLAG_ANSI;
-  pInfo->m_Styles = 0;
-  if (style.Find("Bold") > -1) {
-    pInfo->m_Styles |= FXFONT_BOLD;
+}
+void CFX_FolderFontInfo::ScanFile(CFX_ByteString& path) {
+  int64_t mtime = 0;
+  int64_t size = 0;
+  FX_BOOL bCatalog = m_pCatalog && FX_GetFileStatus(path, mtime, size);
+  const CFX_FontCatalog::File* pCached =
+      bCatalog ? m_pCatalog->FindFile(path, mtime, size) : nullptr;
+  if (pCached) {
+    for (const CFX_FontFaceInfo& face : pCached->m_Faces) {
+      ReportFace(face);
+    }
+    m_pCatalog->AddFile(path, *pCached);
+    return;
   }
-  if (style.Find("Italic") > -1 || style.Find("Oblique") > -1) {
-    pInfo->m_Styles |= FXFONT_ITALIC;
+  CFX_FontCatalog::File file;
+  file.m_ModifiedTime = mtime;
+  file.m_FileSize = size;
+  if (!LoadFontFaces(path, &file.m_Faces)) {
+    return;
   }
-  if (facename.Find("Serif") > -1) {
-    pInfo->m_Styles |= FXFONT_SERIF;
+  for (const CFX_FontFaceInfo& face : file.m_Faces) {
+    ReportFace(face);
+  }
+  if (bCatalog) {
+    m_pCatalog->AddFile(path, file);
+  }
+}
+void CFX_FolderFontInfo::ReportFace(const CFX_FontFaceInfo& face) {
+  if (pdfium::ContainsKey(m_FontList, face.m_FaceName))
+    return;
+
+  for (size_t i = 0; i < FX_ArraySize(g_InstalledCharsets); i++) {
+    if (face.m_Charsets & g_InstalledCharsets[i].m_CharsetFlag) {
+      m_pMapper->AddInstalledFont(face.m_FaceName,
+                                  g_InstalledCharsets[i].m_Charset);
+    }
   }
-  m_FontList[facename] = pInfo;
+  m_FontList[face.m_FaceName] = new CFX_FontFaceInfo(face);
 }
 
 void* CFX_FolderFontInfo::GetSubstFont(const CFX_ByteString& face) {
@@ -1590,6 +2008,13 @@ FX_BOOL CFX_FolderFontInfo::GetFaceName(void* hFont, CFX_ByteString& name) {
 FX_BOOL CFX_FolderFontInfo::GetFontCharset(void* hFont, int& charset) {
   return FALSE;
 }
+IFX_MemoryMappedFile* CFX_FolderFontInfo::MapFontFile(void* hFont) {
+  if (!hFont) {
+    return NULL;
+  }
+  CFX_FontFaceInfo* pFont = (CFX_FontFaceInfo*)hFont;
+  return FX_CreateMemoryMappedFile(pFont->m_FilePath);
+}
 
 int PDF_GetStandardFontName(CFX_ByteString* name) {
   AltFontName* found = static_cast<AltFontName*>(
@@ -0,0 +1,248 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/include/fxge/fx_font.h"
+
+#include <string>
+
+#include "core/include/fxcrt/fx_stream.h"
+#include "core/include/fxge/fx_freetype.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+#if _FXM_PLATFORM_ != _FXM_PLATFORM_WINDOWS_
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+namespace {
+
+// Long before the scans, so the catalog trusts what it records.
+const time_t kOldTime = 1000000000;
+
+void AppendShort(std::string* data, int value) {
+  data->push_back(static_cast<char>((value >> 8) & 0xff));
+  data->push_back(static_cast<char>(value & 0xff));
+}
+
+void AppendLong(std::string* data, FX_DWORD value) {
+  AppendShort(data, value >> 16);
+  AppendShort(data, value & 0xffff);
+}
+
+// A TrueType file holding just the name and OS/2 tables that a folder scan
+// reads, with |family| and |style| in the Macintosh Roman names.
+std::string MakeFont(const std::string& family,
+                     const std::string& style,
+                     FX_DWORD codepages) {
+  std::string names;
+  AppendShort(&names, 0);
+  AppendShort(&names, 2);
+  AppendShort(&names, 6 + 2 * 12);
+  const std::string* strings[] = {&family, &style};
+  int string_offset = 0;
+  for (int i = 0; i < 2; i++) {
+    AppendShort(&names, 1);
+    AppendShort(&names, 0);
+    AppendShort(&names, 0);
+    AppendShort(&names, i + 1);
+    AppendShort(&names, static_cast<int>(strings[i]->size()));
+    AppendShort(&names, string_offset);
+    string_offset += static_cast<int>(strings[i]->size());
+  }
+  names += family + style;
+
+  std::string os2(86, '\0');
+  for (int i = 0; i < 4; i++)
+    os2[78 + i] = static_cast<char>((codepages >> (24 - 8 * i)) & 0xff);
+
+  std::string font;
+  AppendLong(&font, 0x00010000);
+  AppendShort(&font, 2);
+  AppendShort(&font, 0);
+  AppendShort(&font, 0);
+  AppendShort(&font, 0);
+  FX_DWORD offset = 12 + 2 * 16;
+  AppendLong(&font, 0x6e616d65);
+  AppendLong(&font, 0);
+  AppendLong(&font, offset);
+  AppendLong(&font, static_cast<FX_DWORD>(names.size()));
+  AppendLong(&font, 0x4f532f32);
+  AppendLong(&font, 0);
+  AppendLong(&font, offset + static_cast<FX_DWORD>(names.size()));
+  AppendLong(&font, static_cast<FX_DWORD>(os2.size()));
+  return font + names + os2;
+}
+
+void WriteFile(const std::string& path, const std::string& data) {
+  FILE* file = fopen(path.c_str(), "wb");
+  ASSERT_TRUE(file);
+  fwrite(data.data(), 1, data.size(), file);
+  fclose(file);
+}
+
+void SetModifiedTime(const std::string& path, time_t mtime) {
+  struct utimbuf times;
+  times.actime = mtime;
+  times.modtime = mtime;
+  ASSERT_EQ(0, utime(path.c_str(), &times));
+}
+
+// The face names found by scanning |folder| with the catalog in |catalog|.
+std::string Scan(const std::string& folder, const std::string& catalog) {
+  CFX_FolderFontInfo info;
+  info.AddPath(folder.c_str());
+  info.SetCatalogPath(catalog.c_str());
+  CFX_FontMapper mapper(nullptr);
+  info.EnumFontList(&mapper);
+  std::string result;
+  const char* const kFaces[] = {"Catalog Sans Bold", "Catalog Serif",
+                                "Renamed Sans Bold", "Catalog Mono"};
+  for (const char* face : kFaces) {
+    CFX_ByteString name;
+    if (info.GetFaceName(info.GetFont(face), name))
+      result += std::string(name.c_str()) + ";";
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST(fxge, FontCatalog) {
+  char temp[] = "/tmp/pdfium_font_catalog_XXXXXX";
+  ASSERT_TRUE(mkdtemp(temp));
+  const std::string root = temp;
+  const std::string fonts = root + "/fonts";
+  const std::string sub = fonts + "/sub";
+  const std::string catalog = root + "/catalog";
+  ASSERT_EQ(0, mkdir(fonts.c_str(), 0700));
+  ASSERT_EQ(0, mkdir(sub.c_str(), 0700));
+  WriteFile(fonts + "/a.ttf", MakeFont("Catalog Sans", "Bold", 1 << 17));
+  WriteFile(fonts + "/notes.txt", MakeFont("Catalog Mono", "Regular", 0));
+  WriteFile(sub + "/b.TTF", MakeFont("Catalog Serif", "Regular", 0));
+  SetModifiedTime(fonts + "/a.ttf", kOldTime);
+  SetModifiedTime(sub + "/b.TTF", kOldTime);
+  SetModifiedTime(sub, kOldTime);
+  SetModifiedTime(fonts, kOldTime);
+
+  EXPECT_EQ("Catalog Sans Bold;Catalog Serif;", Scan(fonts, catalog));
+  int64_t mtime = 0;
+  int64_t size = 0;
+  EXPECT_TRUE(FX_GetFileStatus(catalog.c_str(), mtime, size));
+
+  // Same size and time: the face comes from the catalog, not the file.
+  WriteFile(fonts + "/a.ttf", MakeFont("Renamed Sans", "Bold", 1 << 17));
+  SetModifiedTime(fonts + "/a.ttf", kOldTime);
+  EXPECT_EQ("Catalog Sans Bold;Catalog Serif;", Scan(fonts, catalog));
+
+  // A new time makes the scan reread the file.
+  SetModifiedTime(fonts + "/a.ttf", kOldTime + 1);
+  EXPECT_EQ("Catalog Serif;Renamed Sans Bold;", Scan(fonts, catalog));
+
+  // A changed folder is listed again.
+  WriteFile(sub + "/c.otf", MakeFont("Catalog Mono", "Regular", 0));
+  EXPECT_EQ("Catalog Serif;Renamed Sans Bold;Catalog Mono;",
+            Scan(fonts, catalog));
+
+  // A damaged catalog is ignored.
+  WriteFile(catalog, "PDFium");
+  EXPECT_EQ("Catalog Serif;Renamed Sans Bold;Catalog Mono;",
+            Scan(fonts, catalog));
+
+  unlink(catalog.c_str());
+  unlink((sub + "/b.TTF").c_str());
+  unlink((sub + "/c.otf").c_str());
+  unlink((fonts + "/a.ttf").c_str());
+  unlink((fonts + "/notes.txt").c_str());
+  rmdir(sub.c_str());
+  rmdir(fonts.c_str());
+  rmdir(root.c_str());
+}
+
+TEST(fxge, MapFontFile) {
+  char temp[] = "/tmp/pdfium_font_mapping_XXXXXX";
+  ASSERT_TRUE(mkdtemp(temp));
+  const std::string folder = temp;
+  const std::string font = MakeFont("Mapped Sans", "Regular", 0);
+  WriteFile(folder + "/mapped.ttf", font);
+
+  CFX_FolderFontInfo info;
+  info.AddPath(folder.c_str());
+  CFX_FontMapper mapper(nullptr);
+  info.EnumFontList(&mapper);
+  void* hFont = info.GetFont("Mapped Sans");
+  ASSERT_TRUE(hFont);
+  IFX_MemoryMappedFile* pFontFile = info.MapFontFile(hFont);
+  ASSERT_TRUE(pFontFile);
+  ASSERT_EQ(font.size(), pFontFile->GetSize());
+  EXPECT_EQ(info.GetFontData(hFont, 0, nullptr, 0), pFontFile->GetSize());
+  EXPECT_EQ(0, memcmp(font.data(), pFontFile->GetData(), font.size()));
+  pFontFile->Release();
+
+  // Empty files cannot be mapped.
+  WriteFile(folder + "/mapped.ttf", "");
+  EXPECT_FALSE(info.MapFontFile(hFont));
+  EXPECT_FALSE(FX_CreateMemoryMappedFile((folder + "/missing.ttf").c_str()));
+
+  unlink((folder + "/mapped.ttf").c_str());
+  rmdir(folder.c_str());
+}
+#endif  // _FXM_PLATFORM_ != _FXM_PLATFORM_WINDOWS_
+
+TEST(fxge, EmbeddedFontCache) {
+  CFX_FontMgr mgr;
+  const uint8_t* pSans = nullptr;
+  const uint8_t* pSerif = nullptr;
+  FX_DWORD sans_size = 0;
+  FX_DWORD serif_size = 0;
+  ASSERT_TRUE(mgr.GetBuiltinFont(4, &pSans, &sans_size));
+  ASSERT_TRUE(mgr.GetBuiltinFont(8, &pSerif, &serif_size));
+
+  // The same bytes from another document share the program, not the face.
+  std::string sans(reinterpret_cast<const char*>(pSans), sans_size);
+  uint8_t* pFontData = nullptr;
+  uint8_t* pOtherFontData = nullptr;
+  FXFT_Face face = mgr.GetEmbeddedFace(pSans, sans_size, pFontData);
+  ASSERT_TRUE(face);
+  FXFT_Face other_face = mgr.GetEmbeddedFace(
+      reinterpret_cast<const uint8_t*>(sans.data()), sans_size,
+      pOtherFontData);
+  ASSERT_TRUE(other_face);
+  EXPECT_NE(face, other_face);
+  EXPECT_EQ(pFontData, pOtherFontData);
+  EXPECT_NE(pSans, pFontData);
+  EXPECT_EQ(0, memcmp(pSans, pFontData, sans_size));
+  EXPECT_EQ(0u, mgr.GetIdleEmbeddedFontSize());
+
+  // A face given back is lent again, with the charmap it was opened with.
+  FXFT_CharMap charmap = FXFT_Get_Face_Charmap(face);
+  FXFT_Get_Face_Charmap(face) = nullptr;
+  mgr.ReleaseEmbeddedFace(face);
+  EXPECT_EQ(0u, mgr.GetIdleEmbeddedFontSize());
+  EXPECT_EQ(face, mgr.GetEmbeddedFace(pSans, sans_size, pFontData));
+  EXPECT_EQ(charmap, FXFT_Get_Face_Charmap(face));
+
+  FXFT_Face serif_face = mgr.GetEmbeddedFace(pSerif, serif_size, pFontData);
+  ASSERT_TRUE(serif_face);
+  EXPECT_NE(pSerif, pFontData);
+
+  // Programs stay once no font uses them, until they pass the limit. The
+  // least recently used goes first.
+  mgr.ReleaseEmbeddedFace(face);
+  mgr.ReleaseEmbeddedFace(other_face);
+  EXPECT_EQ(sans_size, mgr.GetIdleEmbeddedFontSize());
+  mgr.ReleaseEmbeddedFace(serif_face);
+  EXPECT_EQ(sans_size + serif_size, mgr.GetIdleEmbeddedFontSize());
+  mgr.SetEmbeddedFontCacheLimit(serif_size);
+  EXPECT_EQ(serif_size, mgr.GetIdleEmbeddedFontSize());
+  EXPECT_EQ(serif_face, mgr.GetEmbeddedFace(pSerif, serif_size, pFontData));
+  EXPECT_EQ(0u, mgr.GetIdleEmbeddedFontSize());
+  mgr.ReleaseEmbeddedFace(serif_face);
+  mgr.SetEmbeddedFontCacheLimit(0);
+  EXPECT_EQ(0u, mgr.GetIdleEmbeddedFontSize());
+
+  // Bytes FreeType cannot open are not kept.
+  EXPECT_FALSE(mgr.GetEmbeddedFace(pSans, 16, pFontData));
+  EXPECT_EQ(0u, mgr.GetIdleEmbeddedFontSize());
+}
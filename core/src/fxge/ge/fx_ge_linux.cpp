@@ -120,7 +120,9 @@ void* CFX_LinuxFontInfo::MapFont(int weight,
   }
   return FindFont(weight, bItalic, charset, pitch_family, cstr_face, !bCJK);
 }
-IFX_SystemFontInfo* IFX_SystemFontInfo::CreateDefault(const char** pUserPaths) {
+IFX_SystemFontInfo* IFX_SystemFontInfo::CreateDefault(
+    const char** pUserPaths,
+    const char* pCatalogPath) {
   CFX_LinuxFontInfo* pInfo = new CFX_LinuxFontInfo;
   if (!pInfo->ParseFontCfg(pUserPaths)) {
     pInfo->AddPath("/usr/share/fonts");
@@ -128,6 +130,9 @@ IFX_SystemFontInfo* IFX_SystemFontInfo::CreateDefault(const char** pUserPaths) {
     pInfo->AddPath("/usr/share/X11/fonts/TTF");
     pInfo->AddPath("/usr/local/share/fonts");
   }
+  if (pCatalogPath) {
+    pInfo->SetCatalogPath(pCatalogPath);
+  }
   return pInfo;
 }
 FX_BOOL CFX_LinuxFontInfo::ParseFontCfg(const char** pUserPaths) {
@@ -140,8 +145,8 @@ FX_BOOL CFX_LinuxFontInfo::ParseFontCfg(const char** pUserPaths) {
   return TRUE;
 }
 void CFX_GEModule::InitPlatform() {
-  m_pFontMgr->SetSystemFontInfo(
-      IFX_SystemFontInfo::CreateDefault(m_pUserFontPaths));
+  m_pFontMgr->SetSystemFontInfo(IFX_SystemFontInfo::CreateDefault(
+      m_pUserFontPaths, GetFontCatalogPath()));
 }
 void CFX_GEModule::DestroyPlatform() {}
 #endif  // _FXM_PLATFORM_ == _FXM_PLATFORM_LINUX_
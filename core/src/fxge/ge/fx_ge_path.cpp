@@ -4,10 +4,56 @@
 
 // Original code copyright 2014 Foxit Software Inc. http://www.foxitsoftware.com
 
+#include <algorithm>
+
 #include "core/include/fxcrt/fx_system.h"
 #include "core/include/fxge/fx_ge.h"
 #include "third_party/base/numerics/safe_math.h"
 
+namespace {
+
+// Appends the overlap of two ascending lists of runs to |pRuns|.
+void IntersectRuns(const int* a,
+                   const int* a_end,
+                   const int* b,
+                   const int* b_end,
+                   std::vector<int>* pRuns) {
+  while (a < a_end && b < b_end) {
+    int left = std::max(a[0], b[0]);
+    int right = std::min(a[1], b[1]);
+    if (left < right) {
+      pRuns->push_back(left);
+      pRuns->push_back(right);
+    }
+    if (a[1] < b[1])
+      a += 2;
+    else
+      b += 2;
+  }
+}
+
+CFX_DIBitmapRef SpansToMask(const FX_RECT& box,
+                            const CFX_ClipRgn::Spans& spans) {
+  CFX_DIBitmapRef mask;
+  CFX_DIBitmap* pMask = mask.New();
+  if (!pMask ||
+      !pMask->CreateUninit(box.Width(), box.Height(), FXDIB_8bppMask)) {
+    return mask;
+  }
+  pMask->Clear(0);
+  for (int row = 0; row < box.Height(); row++) {
+    uint8_t* scan = pMask->GetBuffer() + row * pMask->GetPitch();
+    for (int i = spans.m_RowStart[row]; i < spans.m_RowStart[row + 1];
+         i += 2) {
+      FXSYS_memset(scan + spans.m_Runs[i] - box.left, 0xff,
+                   spans.m_Runs[i + 1] - spans.m_Runs[i]);
+    }
+  }
+  return mask;
+}
+
+}  // namespace
+
 CFX_ClipRgn::CFX_ClipRgn(int width, int height) {
   m_Type = RectI;
   m_Box.left = m_Box.top = 0;
@@ -22,23 +68,129 @@ CFX_ClipRgn::CFX_ClipRgn(const CFX_ClipRgn& src) {
   m_Type = src.m_Type;
   m_Box = src.m_Box;
   m_Mask = src.m_Mask;
+  m_Spans = src.m_Spans;
 }
 CFX_ClipRgn::~CFX_ClipRgn() {}
 void CFX_ClipRgn::Reset(const FX_RECT& rect) {
   m_Type = RectI;
   m_Box = rect;
   m_Mask.SetNull();
+  m_Spans.SetNull();
+}
+CFX_DIBitmapRef CFX_ClipRgn::GetMask() const {
+  const Spans* pSpans = m_Spans;
+  if (!pSpans)
+    return m_Mask;
+  if (pSpans->m_Mask.IsNull())
+    pSpans->m_Mask = SpansToMask(m_Box, *pSpans);
+  return pSpans->m_Mask;
 }
 void CFX_ClipRgn::IntersectRect(const FX_RECT& rect) {
   if (m_Type == RectI) {
     m_Box.Intersect(rect);
     return;
   }
+  if (m_Spans.NotNull()) {
+    CombineSpans(rect, nullptr);
+    return;
+  }
   if (m_Type == MaskF) {
     IntersectMaskRect(rect, m_Box, m_Mask);
     return;
   }
 }
+void CFX_ClipRgn::IntersectSpans(const FX_RECT& box, SpansRef spans) {
+  if (m_Type == RectI) {
+    FX_RECT rect = m_Box;
+    m_Type = MaskF;
+    m_Box = box;
+    m_Spans = spans;
+    CombineSpans(rect, nullptr);
+    return;
+  }
+  if (m_Spans.NotNull()) {
+    CombineSpans(box, spans);
+    return;
+  }
+  IntersectMaskF(box.left, box.top, SpansToMask(box, *spans.GetObject()));
+}
+void CFX_ClipRgn::CombineSpans(const FX_RECT& box, const Spans* pSpans) {
+  FX_RECT new_box = m_Box;
+  new_box.Intersect(box);
+  std::vector<int> row_start;
+  std::vector<int> runs;
+  if (!new_box.IsEmpty()) {
+    const Spans* pThis = m_Spans;
+    const int rect_run[2] = {box.left, box.right};
+    row_start.reserve(new_box.Height() + 1);
+    for (int row = new_box.top; row < new_box.bottom; row++) {
+      row_start.push_back(static_cast<int>(runs.size()));
+      const int* a = pThis->m_Runs.data();
+      int a_row = row - m_Box.top;
+      const int* b = rect_run;
+      const int* b_end = rect_run + 2;
+      if (pSpans) {
+        int b_row = row - box.top;
+        b = pSpans->m_Runs.data() + pSpans->m_RowStart[b_row];
+        b_end = pSpans->m_Runs.data() + pSpans->m_RowStart[b_row + 1];
+      }
+      IntersectRuns(a + pThis->m_RowStart[a_row],
+                    a + pThis->m_RowStart[a_row + 1], b, b_end, &runs);
+    }
+    row_start.push_back(static_cast<int>(runs.size()));
+  }
+  SetSpans(new_box, row_start, runs);
+}
+void CFX_ClipRgn::SetSpans(const FX_RECT& box,
+                           const std::vector<int>& row_start,
+                           const std::vector<int>& runs) {
+  m_Mask.SetNull();
+  int height = row_start.empty() ? 0 : box.Height();
+  int top = 0;
+  while (top < height && row_start[top] == row_start[top + 1])
+    top++;
+  if (top == height) {
+    m_Type = RectI;
+    m_Box = box;
+    m_Box.bottom = m_Box.top;
+    m_Spans.SetNull();
+    return;
+  }
+  int bottom = height;
+  while (row_start[bottom - 1] == row_start[bottom])
+    bottom--;
+
+  // Shrink the box to the runs, and drop the spans altogether when they
+  // turn out to cover a plain rectangle.
+  int left = runs[row_start[top]];
+  int right = runs[row_start[top] + 1];
+  bool bRect = true;
+  for (int row = top; row < bottom; row++) {
+    int first = row_start[row];
+    int end = row_start[row + 1];
+    if (first == end) {
+      bRect = false;
+      continue;
+    }
+    if (end - first != 2 || runs[first] != left || runs[first + 1] != right)
+      bRect = false;
+    left = std::min(left, runs[first]);
+    right = std::max(right, runs[end - 1]);
+  }
+  m_Box = FX_RECT(left, box.top + top, right, box.top + bottom);
+  if (bRect) {
+    m_Type = RectI;
+    m_Spans.SetNull();
+    return;
+  }
+  m_Type = MaskF;
+  Spans* pNew = m_Spans.New();
+  pNew->m_RowStart.reserve(bottom - top + 1);
+  for (int row = top; row <= bottom; row++)
+    pNew->m_RowStart.push_back(row_start[row] - row_start[top]);
+  pNew->m_Runs.assign(runs.begin() + row_start[top],
+                      runs.begin() + row_start[bottom]);
+}
 void CFX_ClipRgn::IntersectMaskRect(FX_RECT rect,
                                     FX_RECT mask_rect,
                                     CFX_DIBitmapRef Mask) {
@@ -70,6 +222,10 @@ void CFX_ClipRgn::IntersectMaskRect(FX_RECT rect,
   }
 }
 void CFX_ClipRgn::IntersectMaskF(int left, int top, CFX_DIBitmapRef Mask) {
+  if (m_Spans.NotNull()) {
+    m_Mask = GetMask();
+    m_Spans.SetNull();
+  }
   const CFX_DIBitmap* mask_dib = Mask;
   ASSERT(mask_dib->GetFormat() == FXDIB_8bppMask);
   FX_RECT mask_box(left, top, left + mask_dib->GetWidth(),
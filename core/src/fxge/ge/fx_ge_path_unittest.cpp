@@ -0,0 +1,132 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/include/fxge/fx_ge.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+// Builds spans for |box| from one string per row, 'x' marking a pixel
+// inside the clip.
+CFX_ClipRgn::SpansRef MakeSpans(const FX_RECT& box, const char* const* rows) {
+  CFX_ClipRgn::SpansRef spans;
+  CFX_ClipRgn::Spans* pSpans = spans.New();
+  for (int row = 0; row < box.Height(); row++) {
+    pSpans->m_RowStart.push_back(static_cast<int>(pSpans->m_Runs.size()));
+    for (int col = 0; col < box.Width(); col++) {
+      if (rows[row][col] != 'x')
+        continue;
+      int x = box.left + col;
+      if (col > 0 && rows[row][col - 1] == 'x') {
+        pSpans->m_Runs.back() = x + 1;
+      } else {
+        pSpans->m_Runs.push_back(x);
+        pSpans->m_Runs.push_back(x + 1);
+      }
+    }
+  }
+  pSpans->m_RowStart.push_back(static_cast<int>(pSpans->m_Runs.size()));
+  return spans;
+}
+
+bool MaskCovers(const CFX_ClipRgn& clip, int x, int y) {
+  const FX_RECT& box = clip.GetBox();
+  if (!box.Contains(x, y))
+    return false;
+  if (clip.GetType() == CFX_ClipRgn::RectI)
+    return true;
+  const CFX_DIBitmap* pMask = clip.GetMask();
+  return pMask->GetScanline(y - box.top)[x - box.left] == 0xff;
+}
+
+const char* const kLShape[] = {
+    "x...",
+    "x...",
+    "xxxx",
+};
+
+}  // namespace
+
+TEST(fxge, ClipRgnSpans) {
+  FX_RECT box(10, 20, 14, 23);
+  CFX_ClipRgn clip(100, 100);
+  clip.IntersectSpans(box, MakeSpans(box, kLShape));
+  EXPECT_EQ(CFX_ClipRgn::MaskF, clip.GetType());
+  EXPECT_TRUE(clip.HasSpans());
+  EXPECT_EQ(box, clip.GetBox());
+  for (int row = 0; row < 3; row++) {
+    for (int col = 0; col < 4; col++) {
+      EXPECT_EQ(kLShape[row][col] == 'x',
+                MaskCovers(clip, box.left + col, box.top + row));
+    }
+  }
+
+  // Copies share the spans and their mask until one of them changes.
+  CFX_ClipRgn copy(clip);
+  EXPECT_EQ(clip.GetMask().GetObject(), copy.GetMask().GetObject());
+  copy.IntersectRect(FX_RECT(11, 0, 100, 100));
+  EXPECT_EQ(CFX_ClipRgn::RectI, copy.GetType());
+  EXPECT_EQ(FX_RECT(11, 22, 14, 23), copy.GetBox());
+  EXPECT_TRUE(MaskCovers(clip, 10, 20));
+  EXPECT_EQ(box, clip.GetBox());
+}
+
+TEST(fxge, ClipRgnSpansIntersect) {
+  FX_RECT box(0, 0, 4, 3);
+  const char* const kOther[] = {
+      "xxx.",
+      "..x.",
+      ".xxx",
+  };
+  CFX_ClipRgn clip(box);
+  clip.IntersectSpans(box, MakeSpans(box, kLShape));
+  clip.IntersectSpans(box, MakeSpans(box, kOther));
+  EXPECT_TRUE(clip.HasSpans());
+  // The box shrinks to what is left.
+  EXPECT_EQ(FX_RECT(0, 0, 4, 3), clip.GetBox());
+  EXPECT_TRUE(MaskCovers(clip, 0, 0));
+  EXPECT_FALSE(MaskCovers(clip, 0, 1));
+  EXPECT_FALSE(MaskCovers(clip, 0, 2));
+  EXPECT_TRUE(MaskCovers(clip, 1, 2));
+  EXPECT_TRUE(MaskCovers(clip, 3, 2));
+
+  clip.IntersectSpans(box, MakeSpans(box, kOther));
+  clip.IntersectRect(FX_RECT(1, 0, 4, 3));
+  EXPECT_EQ(CFX_ClipRgn::RectI, clip.GetType());
+  EXPECT_EQ(FX_RECT(1, 2, 4, 3), clip.GetBox());
+
+  const char* const kDisjoint[] = {
+      "....",
+      "...x",
+      "....",
+  };
+  clip.IntersectSpans(box, MakeSpans(box, kDisjoint));
+  EXPECT_EQ(CFX_ClipRgn::RectI, clip.GetType());
+  EXPECT_TRUE(clip.GetBox().IsEmpty());
+}
+
+TEST(fxge, ClipRgnSpansWithMask) {
+  FX_RECT box(0, 0, 4, 3);
+  CFX_DIBitmapRef mask;
+  CFX_DIBitmap* pMask = mask.New();
+  ASSERT_TRUE(pMask->Create(4, 3, FXDIB_8bppMask));
+  pMask->Clear(0x80000000);
+  CFX_ClipRgn clip(box);
+  clip.IntersectMaskF(0, 0, mask);
+  clip.IntersectSpans(box, MakeSpans(box, kLShape));
+  EXPECT_FALSE(clip.HasSpans());
+  const CFX_DIBitmap* pResult = clip.GetMask();
+  EXPECT_EQ(0x80, pResult->GetScanline(0)[0]);
+  EXPECT_EQ(0, pResult->GetScanline(0)[1]);
+
+  // And the other way round.
+  CFX_ClipRgn clip2(box);
+  clip2.IntersectSpans(box, MakeSpans(box, kLShape));
+  clip2.IntersectMaskF(0, 0, mask);
+  EXPECT_FALSE(clip2.HasSpans());
+  pResult = clip2.GetMask();
+  EXPECT_EQ(0x80, pResult->GetScanline(2)[3]);
+  EXPECT_EQ(0, pResult->GetScanline(1)[3]);
+}
@@ -8,6 +8,8 @@
 #define CORE_SRC_FXGE_GE_TEXT_INT_H_
 
 #include <map>
+#include <utility>
+#include <vector>
 
 #include "core/include/fxge/fx_font.h"
 #include "core/include/fxge/fx_freetype.h"
@@ -28,6 +30,7 @@ class CTTFontDesc {
   CTTFontDesc() {
     m_Type = 0;
     m_pFontData = NULL;
+    m_pFontFile = NULL;
     m_RefCount = 0;
   }
   ~CTTFontDesc();
@@ -47,9 +50,30 @@ class CTTFontDesc {
     } m_TTCFace;
   };
   uint8_t* m_pFontData;
+  // The mapping |m_pFontData| points into, or NULL if it is from FX_Alloc().
+  IFX_MemoryMappedFile* m_pFontFile;
   int m_RefCount;
 };
 
+// An embedded font program, shared by the fonts of every document that
+// embeds the same bytes, and the faces FreeType opened on it. Each face is
+// lent to one font at a time, since fonts select charmaps on their faces.
+class CFX_EmbeddedFontDesc {
+ public:
+  CFX_EmbeddedFontDesc(const uint8_t* pData, FX_DWORD size);
+  ~CFX_EmbeddedFontDesc();
+
+  uint8_t* m_pFontData;
+  FX_DWORD m_dwSize;
+  // The charmap faces have when opened, as an index into their charmaps, or
+  // -1 for none. Set with the first face.
+  int m_CharmapIndex;
+  int m_nFacesInUse;
+  std::vector<FXFT_Face> m_IdleFaces;
+  // When a face was last lent, to evict the least recently used programs.
+  FX_DWORD m_LastUse;
+};
+
 #define CHARSET_FLAG_ANSI 1
 #define CHARSET_FLAG_SYMBOL 2
 #define CHARSET_FLAG_SHIFTJIS 4
@@ -81,4 +105,53 @@ class CFX_FontFaceInfo {
   FX_DWORD m_Charsets;
 };
 
+// The font folder listings and face records of a CFX_FolderFontInfo scan,
+// kept in a file so that the next scan only opens what has changed since.
+class CFX_FontCatalog {
+ public:
+  struct Folder {
+    int64_t m_ModifiedTime;
+    // Subfolder and font file names, each with whether it is a folder.
+    std::vector<std::pair<CFX_ByteString, FX_BOOL>> m_Entries;
+  };
+  struct File {
+    int64_t m_ModifiedTime;
+    int64_t m_FileSize;
+    std::vector<CFX_FontFaceInfo> m_Faces;
+  };
+
+  explicit CFX_FontCatalog(const CFX_ByteString& path);
+
+  // Reads the previous scan from the file; a missing or damaged file is
+  // treated as empty.
+  void Load();
+  // Writes the folders and files added since Load() if they differ from it.
+  FX_BOOL Save();
+
+  // Returns the record of the previous scan if |path| has not changed since.
+  const Folder* FindFolder(const CFX_ByteString& path, int64_t mtime);
+  const File* FindFile(const CFX_ByteString& path,
+                       int64_t mtime,
+                       int64_t size);
+
+  void AddFolder(const CFX_ByteString& path, const Folder& folder);
+  void AddFile(const CFX_ByteString& path, const File& file);
+
+ private:
+  FX_BOOL Parse(const uint8_t* pData, FX_DWORD size);
+
+  const CFX_ByteString m_Path;
+  // Times at which the previous scan and this one started. Anything modified
+  // during the same second as a scan may have been missed by it, so records
+  // are only trusted when older than the scan that made them.
+  int64_t m_LoadedScanTime;
+  int64_t m_ScanTime;
+  std::map<CFX_ByteString, Folder> m_LoadedFolders;
+  std::map<CFX_ByteString, File> m_LoadedFiles;
+  std::map<CFX_ByteString, Folder> m_Folders;
+  std::map<CFX_ByteString, File> m_Files;
+  // Whether a lookup missed, so the saved catalog is out of date.
+  FX_BOOL m_bChanged;
+};
+
 #endif  // CORE_SRC_FXGE_GE_TEXT_INT_H_
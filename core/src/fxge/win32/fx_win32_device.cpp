@@ -437,7 +437,9 @@ FX_BOOL CFX_Win32FontInfo::GetFontCharset(void* hFont, int& charset) {
   charset = tm.tmCharSet;
   return TRUE;
 }
-IFX_SystemFontInfo* IFX_SystemFontInfo::CreateDefault(const char** pUnused) {
+IFX_SystemFontInfo* IFX_SystemFontInfo::CreateDefault(
+    const char** pUnused,
+    const char* pCatalogPath) {
   HDC hdc = ::GetDC(NULL);
   if (hdc) {
     ::ReleaseDC(NULL, hdc);
@@ -455,6 +457,9 @@ IFX_SystemFontInfo* IFX_SystemFontInfo::CreateDefault(const char** pUnused) {
     fonts_path += "\\Fonts";
     pInfoFallback->AddPath(fonts_path);
   }
+  if (pCatalogPath) {
+    pInfoFallback->SetCatalogPath(pCatalogPath);
+  }
   return pInfoFallback;
 }
 void CFX_GEModule::InitPlatform() {
@@ -465,7 +470,8 @@ void CFX_GEModule::InitPlatform() {
   pPlatformData->m_bHalfTone = ver.dwMajorVersion >= 5;
   pPlatformData->m_GdiplusExt.Load();
   m_pPlatformData = pPlatformData;
-  m_pFontMgr->SetSystemFontInfo(IFX_SystemFontInfo::CreateDefault(nullptr));
+  m_pFontMgr->SetSystemFontInfo(
+      IFX_SystemFontInfo::CreateDefault(nullptr, GetFontCatalogPath()));
 }
 void CFX_GEModule::DestroyPlatform() {
   delete (CWin32Platform*)m_pPlatformData;
@@ -13,6 +13,7 @@
 #include "core/include/fpdfapi/fpdf_render.h"
 #include "core/include/fpdfdoc/fpdf_doc.h"
 #include "core/include/fpdfdoc/fpdf_vt.h"
+#include "core/include/fxcrt/fx_memorybudget.h"
 #include "core/include/fxge/fx_ge.h"
 #include "core/include/fxge/fx_ge_win32.h"
 #include "public/fpdfview.h"
@@ -44,7 +45,6 @@
 
 typedef unsigned int FX_UINT;
 class CRenderContext;
-class IFSDK_PAUSE_Adapter;
 
 class CPDF_CustomAccess final : public IFX_FileRead {
  public:
@@ -119,6 +119,50 @@ FPDF_DOCUMENT FPDFDocumentFromCPDFDocument(CPDF_Document* doc);
 
 CPDF_Page* CPDFPageFromFPDFPage(FPDF_PAGE page);
 
+// Charges the FX heap on this thread to a document's CFX_MemoryBudget while
+// alive. Does nothing unless memory tracking is on.
+class CPDFSDK_MemoryScope {
+ public:
+  // For loading a new document; starts a budget with the default limit.
+  CPDFSDK_MemoryScope();
+  // For work on |pDoc|, charged to the budget it loaded with.
+  explicit CPDFSDK_MemoryScope(CPDF_Document* pDoc);
+  ~CPDFSDK_MemoryScope();
+
+  // The document's budget, or NULL.
+  static CFX_MemoryBudget* GetBudget(CPDF_Document* pDoc);
+
+  // TRUE when the work went over the limit, in which case FPDF_ERR_MEMORY
+  // is also made the last error.
+  FX_BOOL Failed();
+  // Hands a budget started for loading to the loaded |pDoc|.
+  void AttachTo(CPDF_Document* pDoc);
+  CFX_MemoryBudget* GetBudget() const { return m_pBudget; }
+
+ private:
+  CFX_MemoryBudget* m_pBudget;
+  // Set while the scope owns a budget started for loading.
+  FX_BOOL m_bOwnsBudget;
+  CFX_MemoryBudget::Scope m_Scope;
+};
+
+// Pauses rendering once a scope has failed, deferring otherwise to the
+// embedder's pause, if any.
+class CPDFSDK_MemoryPause : public IFX_Pause {
+ public:
+  CPDFSDK_MemoryPause(CPDFSDK_MemoryScope* pScope, IFX_Pause* pPause)
+      : m_pScope(pScope), m_pPause(pPause) {}
+
+  // IFX_Pause:
+  FX_BOOL NeedToPauseNow() override {
+    return m_pScope->Failed() || (m_pPause && m_pPause->NeedToPauseNow());
+  }
+
+ private:
+  CPDFSDK_MemoryScope* const m_pScope;
+  IFX_Pause* const m_pPause;
+};
+
 void DropContext(void* data);
 void FSDK_SetSandBoxPolicy(FPDF_DWORD policy, FPDF_BOOL enable);
 FPDF_BOOL FSDK_IsSandBoxPolicyEnabled(FPDF_DWORD policy);
@@ -131,7 +175,7 @@ void FPDF_RenderPage_Retail(CRenderContext* pContext,
                             int rotate,
                             int flags,
                             FX_BOOL bNeedToRestore,
-                            IFSDK_PAUSE_Adapter* pause);
+                            IFX_Pause* pause);
 
 void CheckUnSupportError(CPDF_Document* pDoc, FX_DWORD err_code);
 void CheckUnSupportAnnot(CPDF_Document* pDoc, const CPDF_Annot* pPDFAnnot);
@@ -533,7 +533,7 @@ class CPDFSDK_Document {
   int GetPageCount() { return m_pDoc->GetPageCount(); }
   FX_BOOL GetPermissions(int nFlag);
   FX_BOOL GetChangeMark() { return m_bChangeMask; }
-  void SetChangeMark() { m_bChangeMask = TRUE; }
+  void SetChangeMark();
   void ClearChangeMark() { m_bChangeMask = FALSE; }
   CFX_WideString GetPath();
   UnderlyingPageType* GetPage(int nIndex);
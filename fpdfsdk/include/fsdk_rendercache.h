@@ -0,0 +1,123 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FPDFSDK_INCLUDE_FSDK_RENDERCACHE_H_
+#define FPDFSDK_INCLUDE_FSDK_RENDERCACHE_H_
+
+#include <list>
+#include <map>
+#include <memory>
+#include <tuple>
+
+#include "core/include/fxcrt/fx_basic.h"
+
+class CFX_DIBitmap;
+class CPDF_Dictionary;
+class CPDF_Document;
+class CPDF_Page;
+
+// Finished FPDF_RenderPageBitmap() results, attached to a document once the
+// embedder gives it a non-zero budget. Rendering composites onto the target,
+// so the key covers the bitmap's contents before rendering as well as the
+// page and every render parameter. The key only holds a hash of those
+// contents; a hit also compares them against a saved copy.
+class CPDFSDK_RenderCache : public CFX_DestructObject {
+ public:
+  // A target's contents before rendering. Holds a single row when every
+  // row is the same, as after a fill.
+  struct Contents {
+    Contents() : m_nSize(0) {}
+
+    std::unique_ptr<uint8_t, FxFreeDeleter> m_pData;
+    size_t m_nSize;
+  };
+
+  struct Key {
+    bool operator<(const Key& other) const {
+      return std::tie(m_pPageDict, m_StartX, m_StartY, m_SizeX, m_SizeY,
+                      m_Rotate, m_Flags, m_Format, m_Width, m_Height,
+                      m_Pitch, m_ContentHash) <
+             std::tie(other.m_pPageDict, other.m_StartX, other.m_StartY,
+                      other.m_SizeX, other.m_SizeY, other.m_Rotate,
+                      other.m_Flags, other.m_Format, other.m_Width,
+                      other.m_Height, other.m_Pitch, other.m_ContentHash);
+    }
+
+    const CPDF_Dictionary* m_pPageDict;
+    int m_StartX;
+    int m_StartY;
+    int m_SizeX;
+    int m_SizeY;
+    int m_Rotate;
+    int m_Flags;
+    int m_Format;
+    int m_Width;
+    int m_Height;
+    FX_DWORD m_Pitch;
+    uint64_t m_ContentHash;
+  };
+
+  // Returns NULL unless a budget was set for |pDoc|.
+  static CPDFSDK_RenderCache* Get(CPDF_Document* pDoc);
+  // A zero budget detaches and frees the cache.
+  static void SetMaxSize(CPDF_Document* pDoc, size_t nMaxBytes);
+  // Drops results for |pPageDict|, or for every page when it is NULL. Safe
+  // to call on documents without a cache.
+  static void Invalidate(CPDF_Document* pDoc, const CPDF_Dictionary* pPageDict);
+  static void InvalidatePage(CPDF_Page* pPage);
+  // Drops results for every document, the next time each cache is used.
+  // For edits made through a page object, which does not know its page.
+  static void InvalidateAll();
+
+  explicit CPDFSDK_RenderCache(size_t nMaxBytes);
+  ~CPDFSDK_RenderCache() override;
+
+  Key MakeKey(CPDF_Page* pPage,
+              const CFX_DIBitmap* pBitmap,
+              int start_x,
+              int start_y,
+              int size_x,
+              int size_y,
+              int rotate,
+              int flags) const;
+  // Copies a stored result into |pBitmap|; returns FALSE on a miss.
+  FX_BOOL Lookup(const Key& key, CFX_DIBitmap* pBitmap);
+  // Call before rendering into |pBitmap|, for Store(). Leaves |pContents|
+  // empty when out of memory.
+  void SaveContents(const CFX_DIBitmap* pBitmap, Contents* pContents) const;
+  // |pContents| is what SaveContents() saved for the same target.
+  void Store(const Key& key, Contents* pContents, const CFX_DIBitmap* pBitmap);
+  void Remove(const CPDF_Dictionary* pPageDict);
+
+  size_t GetMaxSize() const { return m_nMaxBytes; }
+  size_t GetCurrentSize() const { return m_nCurBytes; }
+  int CountEntries() const { return (int)m_Entries.size(); }
+  // For CPDF_RenderOptions::m_dwDisplayListStamp. Every invalidation
+  // changes it, since edits to page objects reach the renderer only that
+  // way.
+  FX_DWORD GetDisplayListStamp() const { return m_dwDisplayListStamp; }
+
+ private:
+  struct Entry {
+    Key m_Key;
+    std::unique_ptr<uint8_t, FxFreeDeleter> m_pData;
+    size_t m_nSize;
+    Contents m_Source;
+  };
+  using EntryList = std::list<Entry>;
+
+  void Shrink(size_t nMaxBytes);
+  void Evict(EntryList::iterator it);
+
+  size_t m_nMaxBytes;
+  size_t m_nCurBytes;
+  FX_DWORD m_dwDisplayListStamp;
+  // The InvalidateAll() count this cache has caught up with.
+  FX_DWORD m_dwInvalidateAllCount;
+  // Most recently used first.
+  EntryList m_Entries;
+  std::map<Key, EntryList::iterator> m_Index;
+};
+
+#endif  // FPDFSDK_INCLUDE_FSDK_RENDERCACHE_H_
@@ -126,15 +126,19 @@ FPDFAvail_GetDocument(FPDF_AVAIL avail, FPDF_BYTESTRING password) {
   if (!pDataAvail)
     return nullptr;
 
+  CPDFSDK_MemoryScope memory;
   CPDF_Parser* pParser = new CPDF_Parser;
   pParser->SetPassword(password);
   CPDF_Parser::Error error =
       pParser->StartAsyncParse(pDataAvail->m_pDataAvail->GetFileRead());
-  if (error != CPDF_Parser::SUCCESS) {
+  FX_BOOL bOverLimit = memory.Failed();
+  if (error != CPDF_Parser::SUCCESS || bOverLimit) {
     delete pParser;
-    ProcessParseError(error);
+    if (!bOverLimit)
+      ProcessParseError(error);
     return nullptr;
   }
+  memory.AttachTo(pParser->GetDocument());
   pDataAvail->m_pDataAvail->SetDocument(pParser->GetDocument());
   CheckUnSupportError(pParser->GetDocument(), FPDF_ERR_SUCCESS);
   return FPDFDocumentFromCPDFDocument(pParser->GetDocument());
@@ -9,6 +9,7 @@
 #include <algorithm>
 
 #include "fpdfsdk/include/fsdk_define.h"
+#include "fpdfsdk/include/fsdk_rendercache.h"
 
 typedef CFX_ArrayTemplate<CPDF_Dictionary*> CPDF_ObjectArray;
 typedef CFX_ArrayTemplate<CPDF_Rect> CPDF_RectArray;
@@ -322,6 +323,7 @@ DLLEXPORT int STDCALL FPDFPage_Flatten(FPDF_PAGE page, int nFlag) {
     return FLATTEN_FAIL;
   }
 
+  CPDFSDK_RenderCache::Invalidate(pDocument, pPageDict);
   CPDF_ObjectArray ObjectArray;
   CPDF_RectArray RectArray;
 
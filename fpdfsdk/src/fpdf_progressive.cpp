@@ -37,6 +37,7 @@ DLLEXPORT int STDCALL FPDF_RenderPageBitmap_Start(FPDF_BITMAP bitmap,
   if (!pPage)
     return FPDF_RENDER_FAILED;
 
+  CPDFSDK_MemoryScope memory(pPage->m_pDocument);
   CRenderContext* pContext = new CRenderContext;
   pPage->SetPrivateData((void*)1, pContext, DropContext);
 #ifdef _SKIA_SUPPORT_
@@ -53,12 +54,17 @@ DLLEXPORT int STDCALL FPDF_RenderPageBitmap_Start(FPDF_BITMAP bitmap,
         ->Attach((CFX_DIBitmap*)bitmap, 0, TRUE);
   else
     ((CFX_FxgeDevice*)pContext->m_pDevice)->Attach((CFX_DIBitmap*)bitmap);
+  if (flags & FPDF_RENDER_PARALLEL)
+    ((CFX_FxgeDevice*)pContext->m_pDevice)->SetParallelRaster(TRUE);
 #endif
   IFSDK_PAUSE_Adapter IPauseAdapter(pause);
+  CPDFSDK_MemoryPause memoryPause(&memory, &IPauseAdapter);
 
   FPDF_RenderPage_Retail(pContext, page, start_x, start_y, size_x, size_y,
-                         rotate, flags, FALSE, &IPauseAdapter);
+                         rotate, flags, FALSE, &memoryPause);
 
+  if (memory.Failed())
+    return FPDF_RENDER_FAILED;
   if (pContext->m_pRenderer) {
     return CPDF_ProgressiveRenderer::ToFPDFStatus(
         pContext->m_pRenderer->GetStatus());
@@ -77,8 +83,12 @@ DLLEXPORT int STDCALL FPDF_RenderPage_Continue(FPDF_PAGE page,
 
   CRenderContext* pContext = (CRenderContext*)pPage->GetPrivateData((void*)1);
   if (pContext && pContext->m_pRenderer) {
+    CPDFSDK_MemoryScope memory(pPage->m_pDocument);
     IFSDK_PAUSE_Adapter IPauseAdapter(pause);
-    pContext->m_pRenderer->Continue(&IPauseAdapter);
+    CPDFSDK_MemoryPause memoryPause(&memory, &IPauseAdapter);
+    pContext->m_pRenderer->Continue(&memoryPause);
+    if (memory.Failed())
+      return FPDF_RENDER_FAILED;
     return CPDF_ProgressiveRenderer::ToFPDFStatus(
         pContext->m_pRenderer->GetStatus());
   }
@@ -169,7 +169,9 @@ static void DefaultDeleteFont(struct _FPDF_SYSFONTINFO* pThis, void* hFont) {
 }
 
 DLLEXPORT FPDF_SYSFONTINFO* STDCALL FPDF_GetDefaultSystemFontInfo() {
-  IFX_SystemFontInfo* pFontInfo = IFX_SystemFontInfo::CreateDefault(nullptr);
+  CFX_GEModule* pModule = CFX_GEModule::Get();
+  IFX_SystemFontInfo* pFontInfo = IFX_SystemFontInfo::CreateDefault(
+      nullptr, pModule ? pModule->GetFontCatalogPath() : nullptr);
   if (!pFontInfo)
     return NULL;
 
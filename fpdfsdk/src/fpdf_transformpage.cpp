@@ -7,6 +7,7 @@
 #include "public/fpdf_transformpage.h"
 
 #include "fpdfsdk/include/fsdk_define.h"
+#include "fpdfsdk/include/fsdk_rendercache.h"
 
 namespace {
 
@@ -55,6 +56,7 @@ DLLEXPORT void STDCALL FPDFPage_SetMediaBox(FPDF_PAGE page,
     return;
 
   SetBoundingBox(pPage, "MediaBox", left, bottom, right, top);
+  CPDFSDK_RenderCache::InvalidatePage(pPage);
 }
 
 DLLEXPORT void STDCALL FPDFPage_SetCropBox(FPDF_PAGE page,
@@ -67,6 +69,7 @@ DLLEXPORT void STDCALL FPDFPage_SetCropBox(FPDF_PAGE page,
     return;
 
   SetBoundingBox(pPage, "CropBox", left, bottom, right, top);
+  CPDFSDK_RenderCache::InvalidatePage(pPage);
 }
 
 DLLEXPORT FPDF_BOOL STDCALL FPDFPage_GetMediaBox(FPDF_PAGE page,
@@ -94,6 +97,7 @@ DLLEXPORT FPDF_BOOL STDCALL FPDFPage_TransFormWithClip(FPDF_PAGE page,
   if (!pPage)
     return FALSE;
 
+  CPDFSDK_RenderCache::InvalidatePage(pPage);
   CFX_ByteTextBuf textBuf;
   textBuf << "q ";
   CFX_FloatRect rect(clipRect->left, clipRect->bottom, clipRect->right,
@@ -203,6 +207,7 @@ FPDFPageObj_TransformClipPath(FPDF_PAGEOBJECT page_object,
   if (pPageObj->m_Type != CPDF_PageObject::SHADING)
     pPageObj->TransformClipPath(matrix);
   pPageObj->TransformGeneralState(matrix);
+  CPDFSDK_RenderCache::InvalidateAll();
 }
 
 DLLEXPORT FPDF_CLIPPATH STDCALL FPDF_CreateClipPath(float left,
@@ -266,6 +271,7 @@ DLLEXPORT void STDCALL FPDFPage_InsertClipPath(FPDF_PAGE page,
   if (!pPage)
     return;
 
+  CPDFSDK_RenderCache::InvalidatePage(pPage);
   CPDF_Dictionary* pPageDic = pPage->m_pFormDict;
   CPDF_Object* pContentObj =
       pPageDic ? pPageDic->GetElement("Contents") : nullptr;
@@ -7,6 +7,7 @@
 #include "public/fpdf_edit.h"
 
 #include "fpdfsdk/include/fsdk_define.h"
+#include "fpdfsdk/include/fsdk_rendercache.h"
 
 DLLEXPORT FPDF_PAGEOBJECT STDCALL
 FPDFPageObj_NewImgeObj(FPDF_DOCUMENT document) {
@@ -35,6 +36,7 @@ FPDFImageObj_LoadJpegFile(FPDF_PAGE* pages,
     if (!pPage)
       continue;
     pImgObj->m_pImage->ResetCache(pPage, NULL);
+    CPDFSDK_RenderCache::InvalidatePage(pPage);
   }
   pImgObj->m_pImage->SetJpegImage(pFile);
 
@@ -58,6 +60,7 @@ DLLEXPORT FPDF_BOOL STDCALL FPDFImageObj_SetMatrix(FPDF_PAGEOBJECT image_object,
   pImgObj->m_Matrix.e = (FX_FLOAT)e;
   pImgObj->m_Matrix.f = (FX_FLOAT)f;
   pImgObj->CalcBoundingBox();
+  CPDFSDK_RenderCache::InvalidateAll();
   return TRUE;
 }
 
@@ -76,6 +79,7 @@ DLLEXPORT FPDF_BOOL STDCALL FPDFImageObj_SetBitmap(FPDF_PAGE* pages,
     if (!pPage)
       continue;
     pImgObj->m_pImage->ResetCache(pPage, NULL);
+    CPDFSDK_RenderCache::InvalidatePage(pPage);
   }
   pImgObj->m_pImage->SetImage(pBmp, FALSE);
   pImgObj->CalcBoundingBox();
@@ -7,6 +7,7 @@
 #include "public/fpdf_edit.h"
 
 #include "fpdfsdk/include/fsdk_define.h"
+#include "fpdfsdk/include/fsdk_rendercache.h"
 #include "public/fpdf_formfill.h"
 
 #ifdef PDF_ENABLE_XFA
@@ -55,6 +56,7 @@ DLLEXPORT void STDCALL FPDFPage_Delete(FPDF_DOCUMENT document, int page_index) {
   if (!pDoc || page_index < 0 || page_index >= pDoc->GetPageCount())
     return;
 
+  CPDFSDK_RenderCache::Invalidate(pDoc, pDoc->GetPage(page_index));
   pDoc->DeletePage(page_index);
 }
 
@@ -135,6 +137,7 @@ DLLEXPORT void STDCALL FPDFPage_InsertObject(FPDF_PAGE page,
   CPDF_PageObject* pPageObj = (CPDF_PageObject*)page_obj;
   if (!pPageObj)
     return;
+  CPDFSDK_RenderCache::InvalidatePage(pPage);
   FX_POSITION LastPersition = pPage->GetLastObjectPosition();
 
   pPage->InsertObject(LastPersition, pPageObj);
@@ -244,6 +247,7 @@ DLLEXPORT FPDF_BOOL STDCALL FPDFPage_GenerateContent(FPDF_PAGE page) {
   }
   CPDF_PageContentGenerator CG(pPage);
   CG.GenerateContent();
+  CPDFSDK_RenderCache::InvalidatePage(pPage);
 
   return TRUE;
 }
@@ -262,6 +266,7 @@ DLLEXPORT void STDCALL FPDFPageObj_Transform(FPDF_PAGEOBJECT page_object,
   CFX_Matrix matrix((FX_FLOAT)a, (FX_FLOAT)b, (FX_FLOAT)c, (FX_FLOAT)d,
                     (FX_FLOAT)e, (FX_FLOAT)f);
   pPageObj->Transform(matrix);
+  CPDFSDK_RenderCache::InvalidateAll();
 }
 DLLEXPORT void STDCALL FPDFPage_TransformAnnots(FPDF_PAGE page,
                                                 double a,
@@ -273,6 +278,7 @@ DLLEXPORT void STDCALL FPDFPage_TransformAnnots(FPDF_PAGE page,
   CPDF_Page* pPage = CPDFPageFromFPDFPage(page);
   if (!pPage)
     return;
+  CPDFSDK_RenderCache::InvalidatePage(pPage);
   CPDF_AnnotList AnnotList(pPage);
   for (size_t i = 0; i < AnnotList.Count(); ++i) {
     CPDF_Annot* pAnnot = AnnotList.GetAt(i);
@@ -309,4 +315,5 @@ DLLEXPORT void STDCALL FPDFPage_SetRotation(FPDF_PAGE page, int rotate) {
   rotate %= 4;
 
   pDict->SetAt("Rotate", new CPDF_Number(rotate * 90));
+  CPDFSDK_RenderCache::InvalidatePage(pPage);
 }
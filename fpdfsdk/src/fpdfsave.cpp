@@ -7,6 +7,7 @@
 #include "public/fpdf_save.h"
 
 #include "core/include/fpdfapi/fpdf_serial.h"
+#include "core/include/fxcodec/fx_codec.h"
 #include "fpdfsdk/include/fsdk_define.h"
 #include "public/fpdf_edit.h"
 
@@ -276,7 +277,8 @@ FPDF_BOOL _FPDF_Doc_Save(FPDF_DOCUMENT document,
                          FPDF_FILEWRITE* pFileWrite,
                          FPDF_DWORD flags,
                          FPDF_BOOL bSetVersion,
-                         int fileVerion) {
+                         int fileVerion,
+                         FPDF_SAVE_STATS* pStats) {
   CPDF_Document* pPDFDoc = CPDFDocumentFromFPDFDocument(document);
   if (!pPDFDoc)
     return 0;
@@ -287,6 +289,21 @@ FPDF_BOOL _FPDF_Doc_Save(FPDF_DOCUMENT document,
   _SendPreSaveToXFADoc(pDoc, fileList);
 #endif  // PDF_ENABLE_XFA
 
+  FX_DWORD dwCreateFlags = 0;
+  if (flags & FPDF_PARALLEL_COMPRESS) {
+    dwCreateFlags |= FPDFCREATE_PARALLEL_COMPRESS;
+    flags &= ~FPDF_PARALLEL_COMPRESS;
+  }
+  if (flags & FPDF_REMOVE_DUPLICATES) {
+    dwCreateFlags |= FPDFCREATE_DEDUPLICATE;
+    flags &= ~FPDF_REMOVE_DUPLICATES;
+  }
+  int level = FXCODEC_FLATE_LEVEL_DEFAULT;
+  if (flags & FPDF_COMPRESSION_FAST)
+    level = FXCODEC_FLATE_LEVEL_FAST;
+  else if (flags & FPDF_COMPRESSION_MAX)
+    level = FXCODEC_FLATE_LEVEL_MAX;
+  flags &= ~(FPDF_COMPRESSION_FAST | FPDF_COMPRESSION_MAX);
   if (flags < FPDF_INCREMENTAL || flags > FPDF_REMOVE_SECURITY) {
     flags = 0;
   }
@@ -294,6 +311,7 @@ FPDF_BOOL _FPDF_Doc_Save(FPDF_DOCUMENT document,
   CPDF_Creator FileMaker(pPDFDoc);
   if (bSetVersion)
     FileMaker.SetFileVersion(fileVerion);
+  FileMaker.SetCompressionLevel(level);
   if (flags == FPDF_REMOVE_SECURITY) {
     flags = 0;
     FileMaker.RemoveSecurity();
@@ -303,7 +321,11 @@ FPDF_BOOL _FPDF_Doc_Save(FPDF_DOCUMENT document,
   FX_BOOL bRet;
   pStreamWrite = new CFX_IFileWrite;
   pStreamWrite->Init(pFileWrite);
-  bRet = FileMaker.Create(pStreamWrite, flags);
+  bRet = FileMaker.Create(pStreamWrite, flags | dwCreateFlags);
+  if (pStats) {
+    pStats->duplicate_objects = FileMaker.GetDuplicateCount();
+    pStats->duplicate_bytes = (unsigned long)FileMaker.GetDuplicateSize();
+  }
 #ifdef PDF_ENABLE_XFA
   _SendPostSaveToXFADoc(pDoc);
   for (int i = 0; i < fileList.GetSize(); i++) {
@@ -319,12 +341,20 @@ FPDF_BOOL _FPDF_Doc_Save(FPDF_DOCUMENT document,
 DLLEXPORT FPDF_BOOL STDCALL FPDF_SaveAsCopy(FPDF_DOCUMENT document,
                                             FPDF_FILEWRITE* pFileWrite,
                                             FPDF_DWORD flags) {
-  return _FPDF_Doc_Save(document, pFileWrite, flags, FALSE, 0);
+  return _FPDF_Doc_Save(document, pFileWrite, flags, FALSE, 0, nullptr);
+}
+
+DLLEXPORT FPDF_BOOL STDCALL FPDF_SaveAsCopyWithStats(FPDF_DOCUMENT document,
+                                                     FPDF_FILEWRITE* pFileWrite,
+                                                     FPDF_DWORD flags,
+                                                     FPDF_SAVE_STATS* stats) {
+  return _FPDF_Doc_Save(document, pFileWrite, flags, FALSE, 0, stats);
 }
 
 DLLEXPORT FPDF_BOOL STDCALL FPDF_SaveWithVersion(FPDF_DOCUMENT document,
                                                  FPDF_FILEWRITE* pFileWrite,
                                                  FPDF_DWORD flags,
                                                  int fileVersion) {
-  return _FPDF_Doc_Save(document, pFileWrite, flags, TRUE, fileVersion);
+  return _FPDF_Doc_Save(document, pFileWrite, flags, TRUE, fileVersion,
+                        nullptr);
 }
@@ -4,7 +4,11 @@
 
 #include <string.h>
 
+#include <string>
+
 #include "core/include/fxcrt/fx_string.h"
+#include "public/fpdf_edit.h"
+#include "public/fpdf_ppo.h"
 #include "public/fpdf_save.h"
 #include "public/fpdfview.h"
 #include "testing/embedder_test.h"
@@ -50,3 +54,111 @@ TEST_F(FPDFSaveEmbedderTest, BUG_342) {
   EXPECT_THAT(GetString(),
               testing::Not(testing::HasSubstr("0000000000 65536 f\r\n")));
 }
+
+TEST_F(FPDFSaveEmbedderTest, SaveParallelCompressMatchesSerial) {
+  EXPECT_TRUE(OpenDocument("hello_world.pdf"));
+  // Loading the page brings its unfiltered content stream into memory, so
+  // the writer deflates it.
+  FPDF_PAGE page = LoadPage(0);
+  EXPECT_NE(nullptr, page);
+  EXPECT_TRUE(FPDF_SaveAsCopy(document(), this, 0));
+  std::string serial = GetString();
+  EXPECT_THAT(serial, testing::HasSubstr("/FlateDecode"));
+
+  ClearString();
+  EXPECT_TRUE(FPDF_SaveAsCopy(document(), this, FPDF_PARALLEL_COMPRESS));
+  EXPECT_EQ(serial, GetString());
+
+  ClearString();
+  EXPECT_TRUE(FPDF_SaveAsCopy(document(), this,
+                              FPDF_NO_INCREMENTAL | FPDF_PARALLEL_COMPRESS));
+  EXPECT_EQ(serial, GetString());
+  UnloadPage(page);
+}
+
+TEST_F(FPDFSaveEmbedderTest, SaveRemoveDuplicates) {
+  EXPECT_TRUE(OpenDocument("hello_world.pdf"));
+  FPDF_DOCUMENT merged = FPDF_CreateNewDocument();
+  ASSERT_NE(nullptr, merged);
+  // Importing the same page twice copies its font and content stream twice.
+  EXPECT_TRUE(FPDF_ImportPages(merged, document(), "1", 0));
+  EXPECT_TRUE(FPDF_ImportPages(merged, document(), "1", 1));
+
+  FPDF_SAVE_STATS stats = {0, 0};
+  EXPECT_TRUE(FPDF_SaveAsCopyWithStats(merged, this, 0, &stats));
+  EXPECT_EQ(0u, stats.duplicate_objects);
+  size_t plain_length = GetString().length();
+
+  ClearString();
+  EXPECT_TRUE(FPDF_SaveAsCopyWithStats(merged, this, FPDF_REMOVE_DUPLICATES,
+                                       &stats));
+  EXPECT_LT(0u, stats.duplicate_objects);
+  EXPECT_LT(0u, stats.duplicate_bytes);
+  EXPECT_LT(GetString().length(), plain_length);
+  FPDF_CloseDocument(merged);
+
+  FPDF_DOCUMENT reloaded = FPDF_LoadMemDocument(
+      GetString().c_str(), (int)GetString().length(), nullptr);
+  ASSERT_NE(nullptr, reloaded);
+  EXPECT_EQ(2, FPDF_GetPageCount(reloaded));
+  FPDF_CloseDocument(reloaded);
+}
+
+TEST_F(FPDFSaveEmbedderTest, SaveRemoveDuplicatesKeepsDocument) {
+  // A page showing a gray image.
+  FPDF_DOCUMENT source = FPDF_CreateNewDocument();
+  ASSERT_NE(nullptr, source);
+  FPDF_PAGE source_page = FPDFPage_New(source, 0, 50, 50);
+  ASSERT_NE(nullptr, source_page);
+  FPDF_PAGEOBJECT source_image = FPDFPageObj_NewImgeObj(source);
+  FPDF_BITMAP gray = FPDFBitmap_Create(4, 4, 0);
+  FPDFBitmap_FillRect(gray, 0, 0, 4, 4, 0xFF808080);
+  EXPECT_TRUE(FPDFImageObj_SetBitmap(&source_page, 1, source_image, gray));
+  FPDFBitmap_Destroy(gray);
+  EXPECT_TRUE(FPDFImageObj_SetMatrix(source_image, 50, 0, 0, 50, 0, 0));
+  FPDFPage_InsertObject(source_page, source_image);
+  EXPECT_TRUE(FPDFPage_GenerateContent(source_page));
+  std::string original = RenderToString(source_page);
+  FPDF_ClosePage(source_page);
+
+  FPDF_DOCUMENT merged = FPDF_CreateNewDocument();
+  ASSERT_NE(nullptr, merged);
+  EXPECT_TRUE(FPDF_ImportPages(merged, source, "1", 0));
+  EXPECT_TRUE(FPDF_ImportPages(merged, source, "1", 1));
+  FPDF_CloseDocument(source);
+  FPDF_SAVE_STATS stats = {0, 0};
+  EXPECT_TRUE(FPDF_SaveAsCopyWithStats(merged, this, FPDF_REMOVE_DUPLICATES,
+                                       &stats));
+  EXPECT_LT(0u, stats.duplicate_objects);
+
+  // The saved file points both pages at one copy of the image.
+  FPDF_DOCUMENT reloaded = FPDF_LoadMemDocument(
+      GetString().c_str(), (int)GetString().length(), nullptr);
+  ASSERT_NE(nullptr, reloaded);
+  for (int i = 0; i < 2; ++i) {
+    FPDF_PAGE page = FPDF_LoadPage(reloaded, i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(original, RenderToString(page));
+    FPDF_ClosePage(page);
+  }
+  FPDF_CloseDocument(reloaded);
+
+  // Only the saved file shares the image; replacing it on the first page
+  // must leave the second page's copy alone.
+  FPDF_PAGE first = FPDF_LoadPage(merged, 0);
+  ASSERT_NE(nullptr, first);
+  ASSERT_EQ(1, FPDFPage_CountObject(first));
+  FPDF_BITMAP black = FPDFBitmap_Create(4, 4, 0);
+  FPDFBitmap_FillRect(black, 0, 0, 4, 4, 0xFF000000);
+  EXPECT_TRUE(
+      FPDFImageObj_SetBitmap(&first, 1, FPDFPage_GetObject(first, 0), black));
+  FPDFBitmap_Destroy(black);
+  EXPECT_NE(original, RenderToString(first));
+  FPDF_ClosePage(first);
+
+  FPDF_PAGE second = FPDF_LoadPage(merged, 1);
+  ASSERT_NE(nullptr, second);
+  EXPECT_EQ(original, RenderToString(second));
+  FPDF_ClosePage(second);
+  FPDF_CloseDocument(merged);
+}
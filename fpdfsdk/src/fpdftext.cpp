@@ -6,9 +6,13 @@
 
 #include "public/fpdf_text.h"
 
+#include <algorithm>
+
+#include "core/include/fpdfapi/fpdf_page.h"
 #include "core/include/fpdfdoc/fpdf_doc.h"
 #include "core/include/fpdftext/fpdf_text.h"
 #include "fpdfsdk/include/fsdk_define.h"
+#include "fpdfsdk/include/fsdk_rendercontext.h"
 
 #ifdef PDF_ENABLE_XFA
 #include "fpdfsdk/include/fpdfxfa/fpdfxfa_doc.h"
@@ -93,6 +97,53 @@ DLLEXPORT void STDCALL FPDFText_GetCharBox(FPDF_TEXTPAGE text_page,
   *top = charinfo.m_CharBox.top;
 }
 
+DLLEXPORT int STDCALL FPDFText_GetCharGeometry(FPDF_TEXTPAGE text_page,
+                                               int start,
+                                               int count,
+                                               unsigned int* unicodes,
+                                               double* boxes,
+                                               double* origins,
+                                               double* font_sizes,
+                                               FPDF_FONT* fonts,
+                                               int* flags) {
+  if (!text_page || start < 0 || count < 0)
+    return -1;
+  IPDF_TextPage* textpage = (IPDF_TextPage*)text_page;
+
+  // Copy through a small batch so no allocation is needed per call.
+  const int kBatchSize = 64;
+  FPDF_CHAR_INFO infos[kBatchSize];
+  int written = 0;
+  while (written < count) {
+    int n = textpage->GetCharInfos(
+        start + written, std::min(count - written, kBatchSize), infos);
+    if (n <= 0)
+      break;
+    for (int i = 0; i < n; ++i, ++written) {
+      const FPDF_CHAR_INFO& info = infos[i];
+      if (unicodes)
+        unicodes[written] = info.m_Unicode;
+      if (boxes) {
+        boxes[written * 4] = info.m_CharBox.left;
+        boxes[written * 4 + 1] = info.m_CharBox.right;
+        boxes[written * 4 + 2] = info.m_CharBox.bottom;
+        boxes[written * 4 + 3] = info.m_CharBox.top;
+      }
+      if (origins) {
+        origins[written * 2] = info.m_OriginX;
+        origins[written * 2 + 1] = info.m_OriginY;
+      }
+      if (font_sizes)
+        font_sizes[written] = info.m_FontSize;
+      if (fonts)
+        fonts[written] = info.m_pTextObj ? info.m_pTextObj->GetFont() : nullptr;
+      if (flags)
+        flags[written] = info.m_Flag;
+    }
+  }
+  return written;
+}
+
 // select
 DLLEXPORT int STDCALL FPDFText_GetCharIndexAtPos(FPDF_TEXTPAGE text_page,
                                                  double x,
@@ -229,6 +280,98 @@ DLLEXPORT void STDCALL FPDFText_FindClose(FPDF_SCHHANDLE handle) {
   handle = NULL;
 }
 
+DLLEXPORT FPDF_DOCSCHHANDLE STDCALL
+FPDFText_DocSearchStart(FPDF_DOCUMENT document) {
+  CPDF_Document* pDoc = CPDFDocumentFromFPDFDocument(document);
+  if (!pDoc)
+    return nullptr;
+  // Same flags as FPDFText_LoadPage() so character indices agree.
+  CPDF_ViewerPreferences viewRef(pDoc);
+  return IPDF_DocProgressiveSearch::Create(pDoc, viewRef.IsDirectionR2L());
+}
+
+DLLEXPORT FPDF_BOOL STDCALL
+FPDFText_DocSearchContinue(FPDF_DOCSCHHANDLE handle, IFSDK_PAUSE* pause) {
+  if (!handle)
+    return FALSE;
+  IPDF_DocProgressiveSearch* pSearch = (IPDF_DocProgressiveSearch*)handle;
+  if (!pause)
+    return pSearch->Continue(nullptr);
+  if (pause->version != 1)
+    return FALSE;
+  IFSDK_PAUSE_Adapter pauseAdapter(pause);
+  return pSearch->Continue(&pauseAdapter);
+}
+
+DLLEXPORT int STDCALL
+FPDFText_DocSearchCountIndexedPages(FPDF_DOCSCHHANDLE handle) {
+  if (!handle)
+    return 0;
+  return ((IPDF_DocProgressiveSearch*)handle)->CountIndexedPages();
+}
+
+DLLEXPORT int STDCALL FPDFText_DocSearchFind(FPDF_DOCSCHHANDLE handle,
+                                             FPDF_WIDESTRING findwhat,
+                                             unsigned long flags) {
+  if (!handle || !findwhat)
+    return 0;
+  FX_STRSIZE len = CFX_WideString::WStringLength(findwhat);
+  return ((IPDF_DocProgressiveSearch*)handle)
+      ->Find(CFX_WideString::FromUTF16LE(findwhat, len), flags);
+}
+
+DLLEXPORT FPDF_BOOL STDCALL
+FPDFText_DocSearchGetResult(FPDF_DOCSCHHANDLE handle,
+                            int index,
+                            int* page_index,
+                            int* start_index,
+                            int* count) {
+  if (!handle || !page_index || !start_index || !count)
+    return FALSE;
+  return ((IPDF_DocProgressiveSearch*)handle)
+      ->GetResult(index, *page_index, *start_index, *count);
+}
+
+DLLEXPORT void STDCALL FPDFText_DocSearchClose(FPDF_DOCSCHHANDLE handle) {
+  delete (IPDF_DocProgressiveSearch*)handle;
+}
+
+namespace {
+
+class CPDF_TextSinkAdapter : public IPDF_TextStreamHandler {
+ public:
+  explicit CPDF_TextSinkAdapter(FPDF_TEXT_SINK* pSink) : m_pSink(pSink) {}
+
+  // IPDF_TextStreamHandler
+  void OnChar(const CPDF_TextStreamChar& ch) override {
+    m_pSink->OnChar(m_pSink, ch.m_Unicode, ch.m_FontSize, ch.m_OriginX,
+                    ch.m_OriginY);
+  }
+
+ private:
+  FPDF_TEXT_SINK* const m_pSink;
+};
+
+}  // namespace
+
+DLLEXPORT FPDF_BOOL STDCALL FPDFText_StreamPageText(FPDF_DOCUMENT document,
+                                                    int page_index,
+                                                    FPDF_TEXT_SINK* sink) {
+  CPDF_Document* pDoc = CPDFDocumentFromFPDFDocument(document);
+  if (!pDoc || !sink || sink->version != 1 || !sink->OnChar)
+    return FALSE;
+  CPDF_Dictionary* pPageDict = pDoc->GetPage(page_index);
+  if (!pPageDict)
+    return FALSE;
+
+  CPDF_Page page;
+  page.Load(pDoc, pPageDict, FALSE);
+  CPDF_TextSinkAdapter adapter(sink);
+  CPDF_TextStreamParser parser(pDoc, &adapter);
+  parser.ParsePage(&page);
+  return TRUE;
+}
+
 // web link
 DLLEXPORT FPDF_PAGELINK STDCALL FPDFLink_LoadWebLinks(FPDF_TEXTPAGE text_page) {
   if (!text_page)
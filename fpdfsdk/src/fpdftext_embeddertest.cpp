@@ -2,6 +2,8 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <vector>
+
 #include "core/include/fxcrt/fx_basic.h"
 #include "public/fpdf_text.h"
 #include "public/fpdfview.h"
@@ -25,6 +27,32 @@ bool check_unsigned_shorts(const char* expected,
   return true;
 }
 
+struct StreamedChar {
+  unsigned int unicode;
+  double font_size;
+  double x;
+  double y;
+};
+
+struct TextCollector : public FPDF_TEXT_SINK {
+  TextCollector() {
+    version = 1;
+    OnChar = OnCharCallback;
+    user = nullptr;
+  }
+
+  static void OnCharCallback(FPDF_TEXT_SINK* pThis,
+                             unsigned int unicode,
+                             double font_size,
+                             double x,
+                             double y) {
+    static_cast<TextCollector*>(pThis)->chars.push_back(
+        {unicode, font_size, x, y});
+  }
+
+  std::vector<StreamedChar> chars;
+};
+
 }  // namespace
 
 class FPDFTextEmbeddertest : public EmbedderTest {};
@@ -247,6 +275,51 @@ TEST_F(FPDFTextEmbeddertest, TextSearch) {
   UnloadPage(page);
 }
 
+TEST_F(FPDFTextEmbeddertest, DocSearch) {
+  EXPECT_TRUE(OpenDocument("hello_world.pdf"));
+  FPDF_DOCSCHHANDLE search = FPDFText_DocSearchStart(document());
+  ASSERT_NE(nullptr, search);
+  EXPECT_EQ(0, FPDFText_DocSearchCountIndexedPages(search));
+  EXPECT_TRUE(FPDFText_DocSearchContinue(search, nullptr));
+  EXPECT_EQ(1, FPDFText_DocSearchCountIndexedPages(search));
+
+  std::unique_ptr<unsigned short, pdfium::FreeDeleter> world =
+      GetFPDFWideString(L"WORLD");
+  std::unique_ptr<unsigned short, pdfium::FreeDeleter> world_substr =
+      GetFPDFWideString(L"orld");
+  std::unique_ptr<unsigned short, pdfium::FreeDeleter> across_lines =
+      GetFPDFWideString(L"world!  goodbye");
+
+  // Same character indices as FPDFText_FindStart() reports.
+  int page_index = -1;
+  int start = -1;
+  int count = -1;
+  ASSERT_EQ(2, FPDFText_DocSearchFind(search, world.get(), 0));
+  EXPECT_TRUE(
+      FPDFText_DocSearchGetResult(search, 0, &page_index, &start, &count));
+  EXPECT_EQ(0, page_index);
+  EXPECT_EQ(7, start);
+  EXPECT_EQ(5, count);
+  EXPECT_TRUE(
+      FPDFText_DocSearchGetResult(search, 1, &page_index, &start, &count));
+  EXPECT_EQ(24, start);
+  EXPECT_FALSE(
+      FPDFText_DocSearchGetResult(search, 2, &page_index, &start, &count));
+
+  EXPECT_EQ(0, FPDFText_DocSearchFind(search, world.get(), FPDF_MATCHCASE));
+  EXPECT_EQ(2, FPDFText_DocSearchFind(search, world_substr.get(), 0));
+  EXPECT_EQ(0, FPDFText_DocSearchFind(search, world_substr.get(),
+                                      FPDF_MATCHWHOLEWORD));
+
+  // Whitespace, including the line break, matches any whitespace.
+  ASSERT_EQ(1, FPDFText_DocSearchFind(search, across_lines.get(), 0));
+  EXPECT_TRUE(
+      FPDFText_DocSearchGetResult(search, 0, &page_index, &start, &count));
+  EXPECT_EQ(7, start);
+  EXPECT_EQ(15, count);
+  FPDFText_DocSearchClose(search);
+}
+
 // Test that the page has characters despite a bad stream length.
 TEST_F(FPDFTextEmbeddertest, StreamLengthPastEndOfFile) {
   EXPECT_TRUE(OpenDocument("bug_57.pdf"));
@@ -261,6 +334,108 @@ TEST_F(FPDFTextEmbeddertest, StreamLengthPastEndOfFile) {
   UnloadPage(page);
 }
 
+TEST_F(FPDFTextEmbeddertest, StreamPageText) {
+  EXPECT_TRUE(OpenDocument("hello_world.pdf"));
+  TextCollector collector;
+  EXPECT_TRUE(FPDFText_StreamPageText(document(), 0, &collector));
+  EXPECT_FALSE(FPDFText_StreamPageText(document(), 1, &collector));
+
+  // The text page adds "\r\n" between the lines; nothing else differs.
+  static const char expected[] = "Hello, world!Goodbye, world!";
+  ASSERT_EQ(strlen(expected), collector.chars.size());
+  FPDF_PAGE page = LoadPage(0);
+  ASSERT_NE(nullptr, page);
+  FPDF_TEXTPAGE textpage = FPDFText_LoadPage(page);
+  ASSERT_NE(nullptr, textpage);
+  for (size_t i = 0; i < collector.chars.size(); ++i) {
+    const StreamedChar& ch = collector.chars[i];
+    EXPECT_EQ(static_cast<unsigned int>(expected[i]), ch.unicode)
+        << " at " << i;
+    int index = i < 13 ? i : i + 2;
+    EXPECT_EQ(FPDFText_GetUnicode(textpage, index), ch.unicode);
+    EXPECT_DOUBLE_EQ(FPDFText_GetFontSize(textpage, index), ch.font_size);
+    double left = 0.0;
+    double right = 0.0;
+    double bottom = 0.0;
+    double top = 0.0;
+    FPDFText_GetCharBox(textpage, index, &left, &right, &bottom, &top);
+    if (ch.unicode == ' ')
+      continue;
+    // The origin sits on the baseline, left of the glyph by its side
+    // bearing.
+    EXPECT_LE(ch.x, left + 0.5) << " at " << i;
+    EXPECT_LE(left - 2.0, ch.x) << " at " << i;
+    EXPECT_LE(ch.y, top) << " at " << i;
+    EXPECT_LE(bottom - 3.0, ch.y) << " at " << i;
+  }
+  FPDFText_ClosePage(textpage);
+  UnloadPage(page);
+}
+
+TEST_F(FPDFTextEmbeddertest, CharGeometry) {
+  EXPECT_TRUE(OpenDocument("hello_world.pdf"));
+  FPDF_PAGE page = LoadPage(0);
+  EXPECT_NE(nullptr, page);
+
+  FPDF_TEXTPAGE textpage = FPDFText_LoadPage(page);
+  EXPECT_NE(nullptr, textpage);
+  int count = FPDFText_CountChars(textpage);
+  ASSERT_EQ(30, count);
+
+  // Ask for more than there is; the range is clipped.
+  std::vector<unsigned int> unicodes(count + 10);
+  std::vector<double> boxes(4 * (count + 10));
+  std::vector<double> origins(2 * (count + 10));
+  std::vector<double> font_sizes(count + 10);
+  std::vector<FPDF_FONT> fonts(count + 10);
+  std::vector<int> flags(count + 10);
+  EXPECT_EQ(count, FPDFText_GetCharGeometry(
+                       textpage, 0, count + 10, unicodes.data(), boxes.data(),
+                       origins.data(), font_sizes.data(), fonts.data(),
+                       flags.data()));
+  for (int i = 0; i < count; ++i) {
+    EXPECT_EQ(FPDFText_GetUnicode(textpage, i), unicodes[i]);
+    EXPECT_DOUBLE_EQ(FPDFText_GetFontSize(textpage, i), font_sizes[i]);
+    double left = 0.0;
+    double right = 0.0;
+    double bottom = 0.0;
+    double top = 0.0;
+    FPDFText_GetCharBox(textpage, i, &left, &right, &bottom, &top);
+    EXPECT_DOUBLE_EQ(left, boxes[i * 4]);
+    EXPECT_DOUBLE_EQ(right, boxes[i * 4 + 1]);
+    EXPECT_DOUBLE_EQ(bottom, boxes[i * 4 + 2]);
+    EXPECT_DOUBLE_EQ(top, boxes[i * 4 + 3]);
+    bool generated = i == 13 || i == 14;
+    EXPECT_EQ(generated ? FPDF_TEXTCHAR_GENERATED : FPDF_TEXTCHAR_NORMAL,
+              flags[i]);
+    EXPECT_EQ(generated, fonts[i] == nullptr);
+  }
+  // Each line uses its own font.
+  EXPECT_EQ(fonts[0], fonts[12]);
+  EXPECT_EQ(fonts[15], fonts[count - 1]);
+  EXPECT_NE(fonts[0], fonts[count - 1]);
+
+  // Partial ranges and absent arrays.
+  unsigned int unicode = 0;
+  EXPECT_EQ(1, FPDFText_GetCharGeometry(textpage, count - 1, 1, &unicode,
+                                        nullptr, nullptr, nullptr, nullptr,
+                                        nullptr));
+  EXPECT_EQ(static_cast<unsigned int>('!'), unicode);
+  EXPECT_EQ(2, FPDFText_GetCharGeometry(textpage, 1, 2, nullptr, nullptr,
+                                        origins.data(), nullptr, nullptr,
+                                        nullptr));
+  EXPECT_LT(origins[0], origins[2]);
+  EXPECT_EQ(0, FPDFText_GetCharGeometry(textpage, count, 5, nullptr, nullptr,
+                                        nullptr, nullptr, nullptr, nullptr));
+  EXPECT_EQ(-1, FPDFText_GetCharGeometry(textpage, -1, 5, nullptr, nullptr,
+                                         nullptr, nullptr, nullptr, nullptr));
+  EXPECT_EQ(-1, FPDFText_GetCharGeometry(nullptr, 0, 5, nullptr, nullptr,
+                                         nullptr, nullptr, nullptr, nullptr));
+
+  FPDFText_ClosePage(textpage);
+  UnloadPage(page);
+}
+
 TEST_F(FPDFTextEmbeddertest, WebLinks) {
   EXPECT_TRUE(OpenDocument("weblinks.pdf"));
   FPDF_PAGE page = LoadPage(0);
@@ -389,3 +564,27 @@ TEST_F(FPDFTextEmbeddertest, GetFontSize) {
   FPDFText_ClosePage(textpage);
   UnloadPage(page);
 }
+
+TEST_F(FPDFTextEmbeddertest, CIDFontWidths) {
+  EXPECT_TRUE(OpenDocument("cid_widths.pdf"));
+  FPDF_PAGE page = LoadPage(0);
+  EXPECT_NE(nullptr, page);
+
+  FPDF_TEXTPAGE textpage = FPDFText_LoadPage(page);
+  EXPECT_NE(nullptr, textpage);
+
+  // CIDs 36, 37 and 39 take their widths from /W, where the first entry
+  // for 39 wins; CID 68 is not listed and takes /DW.
+  const double kExpectedOrigins[] = {20, 25, 31, 38, 41};
+  int count = FPDFText_CountChars(textpage);
+  ASSERT_EQ(FX_ArraySize(kExpectedOrigins), count);
+  std::vector<double> origins(2 * count);
+  EXPECT_EQ(count, FPDFText_GetCharGeometry(textpage, 0, count, nullptr,
+                                            nullptr, origins.data(), nullptr,
+                                            nullptr, nullptr));
+  for (int i = 0; i < count; ++i)
+    EXPECT_NEAR(kExpectedOrigins[i], origins[i * 2], 0.001) << i;
+
+  FPDFText_ClosePage(textpage);
+  UnloadPage(page);
+}
@@ -12,6 +12,7 @@
 #include "core/include/fxcrt/fx_safe_types.h"
 #include "fpdfsdk/include/fsdk_define.h"
 #include "fpdfsdk/include/fsdk_mgr.h"
+#include "fpdfsdk/include/fsdk_rendercache.h"
 #include "fpdfsdk/include/fsdk_rendercontext.h"
 #include "fpdfsdk/include/javascript/IJavaScript.h"
 #include "public/fpdf_ext.h"
@@ -224,15 +225,56 @@ FPDF_BOOL FSDK_IsSandBoxPolicyEnabled(FPDF_DWORD policy) {
 
 CCodec_ModuleMgr* g_pCodecModule = nullptr;
 
+namespace {
+
+// Address used as the document private data key for its memory budget.
+const char kMemoryBudgetKey = 0;
+
+size_t g_DocumentMemoryLimit = 0;
+
+void* AllocTrampoline(void* user, size_t size) {
+  FPDF_ALLOCATOR* pAllocator = static_cast<FPDF_ALLOCATOR*>(user);
+  return pAllocator->Alloc(pAllocator, size);
+}
+
+void* ReallocTrampoline(void* user, void* ptr, size_t new_size) {
+  FPDF_ALLOCATOR* pAllocator = static_cast<FPDF_ALLOCATOR*>(user);
+  return pAllocator->Realloc(pAllocator, ptr, new_size);
+}
+
+void FreeTrampoline(void* user, void* ptr) {
+  FPDF_ALLOCATOR* pAllocator = static_cast<FPDF_ALLOCATOR*>(user);
+  pAllocator->Free(pAllocator, ptr);
+}
+
+void ReleaseMemoryBudget(void* data) {
+  static_cast<CFX_MemoryBudget*>(data)->Release();
+}
+
+}  // namespace
+
 DLLEXPORT void STDCALL FPDF_InitLibrary() {
   FPDF_InitLibraryWithConfig(nullptr);
 }
 
 DLLEXPORT void STDCALL FPDF_InitLibraryWithConfig(
     const FPDF_LIBRARY_CONFIG* cfg) {
+  // The heap goes first, before anything is allocated from it.
+  if (cfg && cfg->version >= 3) {
+    FXMEM_Allocator allocator;
+    allocator.Alloc = AllocTrampoline;
+    allocator.Realloc = ReallocTrampoline;
+    allocator.Free = FreeTrampoline;
+    allocator.user = cfg->m_pAllocator;
+    FXMEM_SetAllocator(cfg->m_pAllocator ? &allocator : nullptr,
+                       !!cfg->m_bTrackDocumentMemory);
+    g_DocumentMemoryLimit = cfg->m_DocumentMemoryLimit;
+  }
   g_pCodecModule = new CCodec_ModuleMgr();
 
-  CFX_GEModule::Create(cfg ? cfg->m_pUserFontPaths : nullptr);
+  CFX_GEModule::Create(
+      cfg ? cfg->m_pUserFontPaths : nullptr,
+      (cfg && cfg->version >= 4) ? cfg->m_pFontCatalogPath : nullptr);
   CFX_GEModule::Get()->SetCodecModule(g_pCodecModule);
 
   CPDF_ModuleMgr::Create();
@@ -264,6 +306,9 @@ DLLEXPORT void STDCALL FPDF_DestroyLibrary() {
 
   delete g_pCodecModule;
   g_pCodecModule = nullptr;
+
+  FXMEM_SetAllocator(nullptr, false);
+  g_DocumentMemoryLimit = 0;
 }
 
 #ifndef _WIN32
@@ -300,6 +345,44 @@ void ProcessParseError(CPDF_Parser::Error err) {
   SetLastError(err_code);
 }
 
+CPDFSDK_MemoryScope::CPDFSDK_MemoryScope()
+    : m_pBudget(FXMEM_IsAccounting()
+                    ? new CFX_MemoryBudget(g_DocumentMemoryLimit)
+                    : nullptr),
+      m_bOwnsBudget(!!m_pBudget),
+      m_Scope(m_pBudget) {}
+
+CPDFSDK_MemoryScope::CPDFSDK_MemoryScope(CPDF_Document* pDoc)
+    : m_pBudget(GetBudget(pDoc)), m_bOwnsBudget(FALSE), m_Scope(m_pBudget) {}
+
+CPDFSDK_MemoryScope::~CPDFSDK_MemoryScope() {
+  if (m_bOwnsBudget)
+    m_pBudget->Release();
+}
+
+// static
+CFX_MemoryBudget* CPDFSDK_MemoryScope::GetBudget(CPDF_Document* pDoc) {
+  if (!pDoc)
+    return nullptr;
+  return static_cast<CFX_MemoryBudget*>(
+      pDoc->GetPrivateData((void*)&kMemoryBudgetKey));
+}
+
+FX_BOOL CPDFSDK_MemoryScope::Failed() {
+  if (!m_Scope.HasFailed())
+    return FALSE;
+  SetLastError(FPDF_ERR_MEMORY);
+  return TRUE;
+}
+
+void CPDFSDK_MemoryScope::AttachTo(CPDF_Document* pDoc) {
+  if (!m_bOwnsBudget || !pDoc)
+    return;
+  pDoc->SetPrivateData((void*)&kMemoryBudgetKey, m_pBudget,
+                       ReleaseMemoryBudget);
+  m_bOwnsBudget = FALSE;
+}
+
 DLLEXPORT void STDCALL FPDF_SetSandBoxPolicy(FPDF_DWORD policy,
                                              FPDF_BOOL enable) {
   return FSDK_SetSandBoxPolicy(policy, enable);
@@ -314,15 +397,19 @@ DLLEXPORT FPDF_DOCUMENT STDCALL FPDF_LoadDocument(FPDF_STRING file_path,
     return nullptr;
   }
 
+  CPDFSDK_MemoryScope memory;
   CPDF_Parser* pParser = new CPDF_Parser;
   pParser->SetPassword(password);
 
   CPDF_Parser::Error error = pParser->StartParse(pFileAccess);
-  if (error != CPDF_Parser::SUCCESS) {
+  FX_BOOL bOverLimit = memory.Failed();
+  if (error != CPDF_Parser::SUCCESS || bOverLimit) {
     delete pParser;
-    ProcessParseError(error);
+    if (!bOverLimit)
+      ProcessParseError(error);
     return NULL;
   }
+  memory.AttachTo(pParser->GetDocument());
 #ifdef PDF_ENABLE_XFA
   CPDF_Document* pPDFDoc = pParser->GetDocument();
   if (!pPDFDoc)
@@ -403,15 +490,19 @@ class CMemFile final : public IFX_FileRead {
 DLLEXPORT FPDF_DOCUMENT STDCALL FPDF_LoadMemDocument(const void* data_buf,
                                                      int size,
                                                      FPDF_BYTESTRING password) {
+  CPDFSDK_MemoryScope memory;
   CPDF_Parser* pParser = new CPDF_Parser;
   pParser->SetPassword(password);
   CMemFile* pMemFile = new CMemFile((uint8_t*)data_buf, size);
   CPDF_Parser::Error error = pParser->StartParse(pMemFile);
-  if (error != CPDF_Parser::SUCCESS) {
+  FX_BOOL bOverLimit = memory.Failed();
+  if (error != CPDF_Parser::SUCCESS || bOverLimit) {
     delete pParser;
-    ProcessParseError(error);
+    if (!bOverLimit)
+      ProcessParseError(error);
     return NULL;
   }
+  memory.AttachTo(pParser->GetDocument());
   CPDF_Document* pDoc = NULL;
   pDoc = pParser ? pParser->GetDocument() : NULL;
   CheckUnSupportError(pDoc, error);
@@ -421,15 +512,19 @@ DLLEXPORT FPDF_DOCUMENT STDCALL FPDF_LoadMemDocument(const void* data_buf,
 DLLEXPORT FPDF_DOCUMENT STDCALL
 FPDF_LoadCustomDocument(FPDF_FILEACCESS* pFileAccess,
                         FPDF_BYTESTRING password) {
+  CPDFSDK_MemoryScope memory;
   CPDF_Parser* pParser = new CPDF_Parser;
   pParser->SetPassword(password);
   CPDF_CustomAccess* pFile = new CPDF_CustomAccess(pFileAccess);
   CPDF_Parser::Error error = pParser->StartParse(pFile);
-  if (error != CPDF_Parser::SUCCESS) {
+  FX_BOOL bOverLimit = memory.Failed();
+  if (error != CPDF_Parser::SUCCESS || bOverLimit) {
     delete pParser;
-    ProcessParseError(error);
+    if (!bOverLimit)
+      ProcessParseError(error);
     return NULL;
   }
+  memory.AttachTo(pParser->GetDocument());
   CPDF_Document* pDoc = NULL;
   pDoc = pParser ? pParser->GetDocument() : NULL;
   CheckUnSupportError(pDoc, error);
@@ -495,12 +590,17 @@ DLLEXPORT FPDF_PAGE STDCALL FPDF_LoadPage(FPDF_DOCUMENT document,
 #ifdef PDF_ENABLE_XFA
   return pDoc->GetPage(page_index);
 #else   // PDF_ENABLE_XFA
+  CPDFSDK_MemoryScope memory(pDoc);
   CPDF_Dictionary* pDict = pDoc->GetPage(page_index);
   if (!pDict)
     return NULL;
   CPDF_Page* pPage = new CPDF_Page;
   pPage->Load(pDoc, pDict);
   pPage->ParseContent(nullptr);
+  if (memory.Failed()) {
+    delete pPage;
+    return NULL;
+  }
   return pPage;
 #endif  // PDF_ENABLE_XFA
 }
@@ -536,6 +636,7 @@ DLLEXPORT void STDCALL FPDF_RenderPage(HDC dc,
   if (!pPage)
     return;
 
+  CPDFSDK_MemoryScope memory(pPage->m_pDocument);
   CRenderContext* pContext = new CRenderContext;
   pPage->SetPrivateData((void*)1, pContext, DropContext);
 
@@ -545,7 +646,7 @@ DLLEXPORT void STDCALL FPDF_RenderPage(HDC dc,
   FX_BOOL bHasImageMask = pPage->HasImageMask();
   if (bBackgroundAlphaNeeded || bHasImageMask) {
     pBitmap = new CFX_DIBitmap;
-    pBitmap->Create(size_x, size_y, FXDIB_Argb);
+    pBitmap->CreateUninit(size_x, size_y, FXDIB_Argb);
     pBitmap->Clear(0x00ffffff);
 #ifdef _SKIA_SUPPORT_
     pContext->m_pDevice = new CFX_SkiaDevice;
@@ -558,8 +659,10 @@ DLLEXPORT void STDCALL FPDF_RenderPage(HDC dc,
     pContext->m_pDevice = new CFX_WindowsDevice(dc);
   }
 
+  CPDFSDK_MemoryPause pause(&memory, nullptr);
   FPDF_RenderPage_Retail(pContext, page, start_x, start_y, size_x, size_y,
-                         rotate, flags, TRUE, NULL);
+                         rotate, flags, TRUE,
+                         memory.GetBudget() ? &pause : nullptr);
 
   if (bBackgroundAlphaNeeded || bHasImageMask) {
     if (pBitmap) {
@@ -698,8 +801,26 @@ DLLEXPORT void STDCALL FPDF_RenderPageBitmap(FPDF_BITMAP bitmap,
   CPDF_Page* pPage = CPDFPageFromFPDFPage(page);
   if (!pPage)
     return;
+  CFX_DIBitmap* pBitmap = (CFX_DIBitmap*)bitmap;
+  CPDFSDK_MemoryScope memory(pPage->m_pDocument);
+  CPDFSDK_RenderCache* pCache = CPDFSDK_RenderCache::Get(pPage->m_pDocument);
+  CPDFSDK_RenderCache::Key key;
+  CPDFSDK_RenderCache::Contents contents;
+  if (pCache) {
+    key = pCache->MakeKey(pPage, pBitmap, start_x, start_y, size_x, size_y,
+                          rotate, flags);
+    if (pCache->Lookup(key, pBitmap))
+      return;
+    pCache->SaveContents(pBitmap, &contents);
+  }
   CRenderContext* pContext = new CRenderContext;
   pPage->SetPrivateData((void*)1, pContext, DropContext);
+  if (pCache) {
+    // Misses, such as other tiles or zoom levels of the page, share the
+    // display lists of earlier renders until the page is invalidated.
+    pContext->m_pOptions = new CPDF_RenderOptions;
+    pContext->m_pOptions->m_dwDisplayListStamp = pCache->GetDisplayListStamp();
+  }
 #ifdef _SKIA_SUPPORT_
   pContext->m_pDevice = new CFX_SkiaDevice;
 
@@ -716,13 +837,52 @@ DLLEXPORT void STDCALL FPDF_RenderPageBitmap(FPDF_BITMAP bitmap,
         ->Attach((CFX_DIBitmap*)bitmap, 0, TRUE);
   else
     ((CFX_FxgeDevice*)pContext->m_pDevice)->Attach((CFX_DIBitmap*)bitmap);
+  if (flags & FPDF_RENDER_PARALLEL)
+    ((CFX_FxgeDevice*)pContext->m_pDevice)->SetParallelRaster(TRUE);
 #endif
 
+  // Over the document's limit, rendering stops at the next object.
+  CPDFSDK_MemoryPause pause(&memory, nullptr);
   FPDF_RenderPage_Retail(pContext, page, start_x, start_y, size_x, size_y,
-                         rotate, flags, TRUE, NULL);
+                         rotate, flags, TRUE,
+                         memory.GetBudget() ? &pause : nullptr);
 
   delete pContext;
   pPage->RemovePrivateData((void*)1);
+  if (pCache && !memory.Failed())
+    pCache->Store(key, &contents, pBitmap);
+}
+
+DLLEXPORT void STDCALL FPDF_SetRenderCacheSize(FPDF_DOCUMENT document,
+                                               unsigned long max_bytes) {
+  CPDFSDK_RenderCache::SetMaxSize(CPDFDocumentFromFPDFDocument(document),
+                                  max_bytes);
+}
+
+DLLEXPORT void STDCALL FPDF_InvalidateRenderCache(FPDF_DOCUMENT document,
+                                                  FPDF_PAGE page) {
+  CPDF_Page* pPage = CPDFPageFromFPDFPage(page);
+  CPDFSDK_RenderCache::Invalidate(CPDFDocumentFromFPDFDocument(document),
+                                  pPage ? pPage->m_pFormDict : nullptr);
+}
+
+DLLEXPORT FPDF_BOOL STDCALL FPDF_SetDocumentMemoryLimit(FPDF_DOCUMENT document,
+                                                        size_t max_bytes) {
+  CFX_MemoryBudget* pBudget =
+      CPDFSDK_MemoryScope::GetBudget(CPDFDocumentFromFPDFDocument(document));
+  if (!pBudget)
+    return FALSE;
+  pBudget->SetLimit(max_bytes);
+  return TRUE;
+}
+
+DLLEXPORT size_t STDCALL FPDF_GetDocumentMemoryUsage(FPDF_DOCUMENT document,
+                                                     size_t* peak) {
+  CFX_MemoryBudget* pBudget =
+      CPDFSDK_MemoryScope::GetBudget(CPDFDocumentFromFPDFDocument(document));
+  if (peak)
+    *peak = pBudget ? pBudget->GetPeakUsage() : 0;
+  return pBudget ? pBudget->GetUsage() : 0;
 }
 
 DLLEXPORT void STDCALL FPDF_ClosePage(FPDF_PAGE page) {
@@ -826,7 +986,8 @@ DLLEXPORT FPDF_BITMAP STDCALL FPDFBitmap_Create(int width,
                                                 int height,
                                                 int alpha) {
   std::unique_ptr<CFX_DIBitmap> pBitmap(new CFX_DIBitmap);
-  if (!pBitmap->Create(width, height, alpha ? FXDIB_Argb : FXDIB_Rgb32)) {
+  if (!pBitmap->CreateUninit(width, height,
+                             alpha ? FXDIB_Argb : FXDIB_Rgb32)) {
     return NULL;
   }
   return pBitmap.release();
@@ -908,7 +1069,7 @@ void FPDF_RenderPage_Retail(CRenderContext* pContext,
                             int rotate,
                             int flags,
                             FX_BOOL bNeedToRestore,
-                            IFSDK_PAUSE_Adapter* pause) {
+                            IFX_Pause* pause) {
   CPDF_Page* pPage = CPDFPageFromFPDFPage(page);
   if (!pPage)
     return;
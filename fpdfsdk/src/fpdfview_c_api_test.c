@@ -147,6 +147,7 @@ int CheckPDFiumCApi() {
 
     // fpdf_save.h
     CHK(FPDF_SaveAsCopy);
+    CHK(FPDF_SaveAsCopyWithStats);
     CHK(FPDF_SaveWithVersion);
 
     // fpdf_searchex.h
@@ -165,6 +166,7 @@ int CheckPDFiumCApi() {
     CHK(FPDFText_GetUnicode);
     CHK(FPDFText_GetFontSize);
     CHK(FPDFText_GetCharBox);
+    CHK(FPDFText_GetCharGeometry);
     CHK(FPDFText_GetCharIndexAtPos);
     CHK(FPDFText_GetText);
     CHK(FPDFText_CountRects);
@@ -176,6 +178,13 @@ int CheckPDFiumCApi() {
     CHK(FPDFText_GetSchResultIndex);
     CHK(FPDFText_GetSchCount);
     CHK(FPDFText_FindClose);
+    CHK(FPDFText_DocSearchStart);
+    CHK(FPDFText_DocSearchContinue);
+    CHK(FPDFText_DocSearchCountIndexedPages);
+    CHK(FPDFText_DocSearchFind);
+    CHK(FPDFText_DocSearchGetResult);
+    CHK(FPDFText_DocSearchClose);
+    CHK(FPDFText_StreamPageText);
     CHK(FPDFLink_LoadWebLinks);
     CHK(FPDFLink_CountWebLinks);
     CHK(FPDFLink_GetURL);
@@ -212,6 +221,10 @@ int CheckPDFiumCApi() {
     CHK(FPDF_GetPageHeight);
     CHK(FPDF_GetPageSizeByIndex);
     CHK(FPDF_RenderPageBitmap);
+    CHK(FPDF_SetRenderCacheSize);
+    CHK(FPDF_InvalidateRenderCache);
+    CHK(FPDF_SetDocumentMemoryLimit);
+    CHK(FPDF_GetDocumentMemoryUsage);
     CHK(FPDF_ClosePage);
     CHK(FPDF_CloseDocument);
     CHK(FPDF_DeviceToPage);
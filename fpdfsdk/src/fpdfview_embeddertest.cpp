@@ -2,13 +2,22 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include <limits>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "fpdfsdk/src/fpdfview_c_api_test.h"
+#include "public/fpdf_edit.h"
 #include "public/fpdfview.h"
 #include "testing/embedder_test.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "testing/test_support.h"
+#include "testing/utils/path_service.h"
 
 TEST(fpdf, CApiTest) {
   EXPECT_TRUE(CheckPDFiumCApi());
@@ -16,6 +25,107 @@ TEST(fpdf, CApiTest) {
 
 class FPDFViewEmbeddertest : public EmbedderTest {};
 
+namespace {
+
+// Renders the |size| pixel square at (|left|, |top|) of the page drawn at
+// |scale|.
+std::string RenderTileToString(FPDF_PAGE page,
+                               int scale,
+                               int left,
+                               int top,
+                               int size) {
+  int width = static_cast<int>(FPDF_GetPageWidth(page)) * scale;
+  int height = static_cast<int>(FPDF_GetPageHeight(page)) * scale;
+  FPDF_BITMAP bitmap = FPDFBitmap_Create(size, size, 0);
+  FPDFBitmap_FillRect(bitmap, 0, 0, size, size, 0xFFFFFFFF);
+  FPDF_RenderPageBitmap(bitmap, page, -left, -top, width, height, 0, 0);
+  std::string result(static_cast<const char*>(FPDFBitmap_GetBuffer(bitmap)),
+                     FPDFBitmap_GetStride(bitmap) * size);
+  FPDFBitmap_Destroy(bitmap);
+  return result;
+}
+
+// A heap that counts the blocks PDFium holds from it.
+struct CountingAllocator : public FPDF_ALLOCATOR {
+  int live_blocks;
+};
+
+void* CountingAlloc(FPDF_ALLOCATOR* pThis, size_t size) {
+  static_cast<CountingAllocator*>(pThis)->live_blocks++;
+  return malloc(size);
+}
+
+void* CountingRealloc(FPDF_ALLOCATOR* pThis, void* ptr, size_t new_size) {
+  return realloc(ptr, new_size);
+}
+
+void CountingFree(FPDF_ALLOCATOR* pThis, void* ptr) {
+  static_cast<CountingAllocator*>(pThis)->live_blocks--;
+  free(ptr);
+}
+
+// Restarts the library on a counting heap with document tracking, and back
+// on the default heap when it goes away, even if a test stops early.
+class CountingLibrary {
+ public:
+  CountingLibrary() {
+    allocator_.version = 1;
+    allocator_.Alloc = CountingAlloc;
+    allocator_.Realloc = CountingRealloc;
+    allocator_.Free = CountingFree;
+    allocator_.live_blocks = 0;
+    memset(&config_, 0, sizeof(config_));
+    config_.version = 3;
+    config_.m_pAllocator = &allocator_;
+    config_.m_bTrackDocumentMemory = 1;
+    FPDF_DestroyLibrary();
+    FPDF_InitLibraryWithConfig(&config_);
+  }
+  ~CountingLibrary() {
+    FPDF_DestroyLibrary();
+    FPDF_InitLibrary();
+  }
+
+  int live_blocks() const { return allocator_.live_blocks; }
+  FPDF_LIBRARY_CONFIG* config() { return &config_; }
+
+ private:
+  CountingAllocator allocator_;
+  FPDF_LIBRARY_CONFIG config_;
+};
+
+// Returns a PDF file with one 100x100 page drawn by |content|.
+std::string MakeSinglePagePdf(const std::string& content) {
+  std::vector<std::string> objects;
+  objects.push_back("<< /Type /Catalog /Pages 2 0 R >>");
+  objects.push_back("<< /Type /Pages /Kids [3 0 R] /Count 1 >>");
+  objects.push_back(
+      "<< /Type /Page /Parent 2 0 R /MediaBox [0 0 100 100] "
+      "/Contents 4 0 R >>");
+  objects.push_back("<< /Length " + std::to_string(content.size()) +
+                    " >>\nstream\n" + content + "\nendstream");
+  std::string pdf = "%PDF-1.4\n";
+  std::vector<size_t> offsets;
+  for (size_t i = 0; i < objects.size(); ++i) {
+    offsets.push_back(pdf.size());
+    pdf += std::to_string(i + 1) + " 0 obj\n" + objects[i] + "\nendobj\n";
+  }
+  size_t xref = pdf.size();
+  pdf += "xref\n0 " + std::to_string(objects.size() + 1) +
+         "\n0000000000 65535 f \n";
+  for (size_t offset : offsets) {
+    char entry[21];
+    snprintf(entry, sizeof(entry), "%010zu 00000 n \n", offset);
+    pdf += entry;
+  }
+  pdf += "trailer\n<< /Size " + std::to_string(objects.size() + 1) +
+         " /Root 1 0 R >>\nstartxref\n" + std::to_string(xref) +
+         "\n%%EOF\n";
+  return pdf;
+}
+
+}  // namespace
+
 TEST_F(FPDFViewEmbeddertest, Document) {
   EXPECT_TRUE(OpenDocument("about_blank.pdf"));
   EXPECT_EQ(1, GetPageCount());
@@ -244,3 +354,199 @@ TEST_F(FPDFViewEmbeddertest, Hang_355) {
 TEST_F(FPDFViewEmbeddertest, Hang_360) {
   EXPECT_FALSE(OpenDocument("bug_360.pdf"));
 }
+
+TEST_F(FPDFViewEmbeddertest, RenderCache) {
+  EXPECT_TRUE(OpenDocument("hello_world.pdf"));
+  FPDF_PAGE page = LoadPage(0);
+  ASSERT_NE(nullptr, page);
+  FPDF_SetRenderCacheSize(document(), 16 * 1024 * 1024);
+  std::string white = RenderToString(page, 0xFFFFFFFF);
+  std::string red = RenderToString(page, 0xFFFF0000);
+  EXPECT_NE(white, red);
+
+  // Editing a page object drops the stale result.
+  FPDF_PAGEOBJECT text = FPDFPage_GetObject(page, 0);
+  ASSERT_NE(nullptr, text);
+  FPDFPageObj_Transform(text, 1, 0, 0, 1, 50, 0);
+  std::string moved = RenderToString(page, 0xFFFFFFFF);
+  EXPECT_NE(white, moved);
+  EXPECT_NE(red, RenderToString(page, 0xFFFF0000));
+
+  // Without a cache every call renders.
+  FPDF_SetRenderCacheSize(document(), 0);
+  FPDFPageObj_Transform(text, 1, 0, 0, 1, -50, 0);
+  EXPECT_EQ(white, RenderToString(page, 0xFFFFFFFF));
+  UnloadPage(page);
+}
+
+TEST_F(FPDFViewEmbeddertest, RenderCacheTiles) {
+  EXPECT_TRUE(OpenDocument("many_objects.pdf"));
+  FPDF_PAGE page = LoadPage(0);
+  ASSERT_NE(nullptr, page);
+  std::vector<std::string> expected;
+  for (int tile = 0; tile < 9; tile++)
+    expected.push_back(RenderTileToString(page, 4, tile % 3 * 800,
+                                          tile / 3 * 800, 100));
+
+  // Tiles miss the result cache, but share the page's display list.
+  FPDF_SetRenderCacheSize(document(), 16 * 1024 * 1024);
+  for (int tile = 0; tile < 9; tile++) {
+    EXPECT_EQ(expected[tile], RenderTileToString(page, 4, tile % 3 * 800,
+                                                 tile / 3 * 800, 100))
+        << tile;
+  }
+
+  // Moved objects are found at their new place.
+  std::string before = RenderTileToString(page, 4, 1600, 1000, 250);
+  FPDF_PAGEOBJECT rect = FPDFPage_GetObject(page, 0);
+  ASSERT_NE(nullptr, rect);
+  FPDFPageObj_Transform(rect, 1, 0, 0, 1, 400, 300);
+  std::string moved = RenderTileToString(page, 4, 1600, 1000, 250);
+  EXPECT_NE(before, moved);
+  FPDF_SetRenderCacheSize(document(), 0);
+  EXPECT_EQ(RenderTileToString(page, 4, 1600, 1000, 250), moved);
+  UnloadPage(page);
+}
+
+TEST_F(FPDFViewEmbeddertest, LargeInlineImage) {
+  // The content stream is parsed as it is decoded, and the image is larger
+  // than the window first used for that.
+  std::string content =
+      "q 100 0 0 100 0 0 cm BI /W 1000 /H 3000 /BPC 8 /CS /G ID\n";
+  content += std::string(1000 * 3000, '\x80');
+  content += "\nEI Q 1 0 0 rg 0 0 10 10 re f";
+  std::string pdf = MakeSinglePagePdf(content);
+  FPDF_DOCUMENT doc = FPDF_LoadMemDocument(
+      pdf.data(), static_cast<int>(pdf.size()), nullptr);
+  ASSERT_TRUE(doc);
+  FPDF_PAGE page = FPDF_LoadPage(doc, 0);
+  ASSERT_TRUE(page);
+  EXPECT_EQ(2, FPDFPage_CountObject(page));
+
+  std::string result = RenderToString(page, 0xFFFFFFFF);
+  int stride = static_cast<int>(result.size()) / 100;
+  // Gray from the image down to its last rows, red from the rectangle drawn
+  // after it in the bottom left corner.
+  const std::string gray("\x80\x80\x80", 3);
+  EXPECT_EQ(gray, result.substr(10 * stride + 50 * 4, 3));
+  EXPECT_EQ(gray, result.substr(99 * stride + 50 * 4, 3));
+  EXPECT_EQ(std::string("\0\0\xff", 3), result.substr(95 * stride + 5 * 4, 3));
+  FPDF_ClosePage(page);
+  FPDF_CloseDocument(doc);
+}
+
+TEST_F(FPDFViewEmbeddertest, ParallelRaster) {
+  EXPECT_TRUE(OpenDocument("large_paths.pdf"));
+  FPDF_PAGE page = LoadPage(0);
+  ASSERT_NE(nullptr, page);
+  for (int flags : {0, FPDF_RENDER_NO_SMOOTHPATH}) {
+    std::string serial = RenderToString(page, 0xFFFFFFFF, 3, flags);
+    EXPECT_EQ(serial, RenderToString(page, 0xFFFFFFFF, 3,
+                                     flags | FPDF_RENDER_PARALLEL));
+  }
+  UnloadPage(page);
+}
+
+TEST_F(FPDFViewEmbeddertest, DocumentMemoryLimit) {
+  std::string file_path;
+  ASSERT_TRUE(PathService::GetTestFilePath("hello_world.pdf", &file_path));
+  size_t file_length = 0;
+  std::unique_ptr<char, pdfium::FreeDeleter> file_contents =
+      GetFileContents(file_path.c_str(), &file_length);
+  ASSERT_TRUE(file_contents);
+
+  CountingLibrary library;
+
+  FPDF_DOCUMENT doc = FPDF_LoadMemDocument(
+      file_contents.get(), static_cast<int>(file_length), nullptr);
+  ASSERT_TRUE(doc);
+  size_t peak = 0;
+  size_t usage = FPDF_GetDocumentMemoryUsage(doc, &peak);
+  EXPECT_GT(usage, 0u);
+  EXPECT_GE(peak, usage);
+  EXPECT_GT(library.live_blocks(), 0);
+
+  FPDF_PAGE page = FPDF_LoadPage(doc, 0);
+  ASSERT_TRUE(page);
+  EXPECT_GT(FPDF_GetDocumentMemoryUsage(doc, nullptr), usage);
+  std::string expected = RenderToString(page, 0xFFFFFFFF);
+  FPDF_ClosePage(page);
+
+  // Past the limit a page fails to load, and says why.
+  EXPECT_TRUE(FPDF_SetDocumentMemoryLimit(
+      doc, FPDF_GetDocumentMemoryUsage(doc, nullptr) + 1));
+  EXPECT_EQ(nullptr, FPDF_LoadPage(doc, 0));
+  EXPECT_EQ(static_cast<unsigned long>(FPDF_ERR_MEMORY), FPDF_GetLastError());
+
+  // Rendering reports it too. This page is too short to reach a point
+  // where rendering stops early, so it still comes out whole.
+  EXPECT_TRUE(FPDF_SetDocumentMemoryLimit(doc, 0));
+  page = FPDF_LoadPage(doc, 0);
+  ASSERT_TRUE(page);
+  EXPECT_TRUE(FPDF_SetDocumentMemoryLimit(
+      doc, FPDF_GetDocumentMemoryUsage(doc, nullptr) + 1));
+  RenderToString(page, 0xFFFFFFFF);
+  EXPECT_EQ(static_cast<unsigned long>(FPDF_ERR_MEMORY), FPDF_GetLastError());
+
+  // The document still works once the request fits.
+  EXPECT_TRUE(FPDF_SetDocumentMemoryLimit(doc, 0));
+  EXPECT_EQ(expected, RenderToString(page, 0xFFFFFFFF));
+  FPDF_ClosePage(page);
+  FPDF_CloseDocument(doc);
+
+  // Every block went back to the embedder's heap.
+  FPDF_DestroyLibrary();
+  EXPECT_EQ(0, library.live_blocks());
+
+  // A default limit applies from the start of loading.
+  library.config()->m_DocumentMemoryLimit = 64;
+  FPDF_InitLibraryWithConfig(library.config());
+  EXPECT_EQ(nullptr,
+            FPDF_LoadMemDocument(file_contents.get(),
+                                 static_cast<int>(file_length), nullptr));
+  EXPECT_EQ(static_cast<unsigned long>(FPDF_ERR_MEMORY), FPDF_GetLastError());
+  FPDF_DestroyLibrary();
+  EXPECT_EQ(0, library.live_blocks());
+
+  // Without tracking there is nothing to report.
+  FPDF_InitLibrary();
+  doc = FPDF_LoadMemDocument(file_contents.get(),
+                             static_cast<int>(file_length), nullptr);
+  ASSERT_TRUE(doc);
+  EXPECT_EQ(0u, FPDF_GetDocumentMemoryUsage(doc, nullptr));
+  EXPECT_FALSE(FPDF_SetDocumentMemoryLimit(doc, 1));
+  FPDF_CloseDocument(doc);
+}
+
+TEST_F(FPDFViewEmbeddertest, DocumentMemoryJpx) {
+  std::string file_path;
+  ASSERT_TRUE(PathService::GetTestFilePath("bug_557223.pdf", &file_path));
+  size_t file_length = 0;
+  std::unique_ptr<char, pdfium::FreeDeleter> file_contents =
+      GetFileContents(file_path.c_str(), &file_length);
+  ASSERT_TRUE(file_contents);
+
+  FPDF_DOCUMENT doc = FPDF_LoadMemDocument(
+      file_contents.get(), static_cast<int>(file_length), nullptr);
+  ASSERT_TRUE(doc);
+  FPDF_PAGE page = FPDF_LoadPage(doc, 0);
+  ASSERT_TRUE(page);
+  std::string expected = RenderToString(page, 0xFFFFFFFF);
+  FPDF_ClosePage(page);
+  FPDF_CloseDocument(doc);
+
+  // OpenJPEG's image buffers change hands with PDFium while decoding, so
+  // they must come from the same tracked heap.
+  CountingLibrary library;
+
+  doc = FPDF_LoadMemDocument(file_contents.get(),
+                             static_cast<int>(file_length), nullptr);
+  ASSERT_TRUE(doc);
+  page = FPDF_LoadPage(doc, 0);
+  ASSERT_TRUE(page);
+  EXPECT_EQ(expected, RenderToString(page, 0xFFFFFFFF));
+  FPDF_ClosePage(page);
+  FPDF_CloseDocument(doc);
+  FPDF_DestroyLibrary();
+  EXPECT_EQ(0, library.live_blocks());
+}
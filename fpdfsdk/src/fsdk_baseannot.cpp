@@ -10,6 +10,7 @@
 #include "fpdfsdk/include/fsdk_baseannot.h"
 #include "fpdfsdk/include/fsdk_define.h"
 #include "fpdfsdk/include/fsdk_mgr.h"
+#include "fpdfsdk/include/fsdk_rendercache.h"
 
 #ifdef PDF_ENABLE_XFA
 #include "fpdfsdk/include/fpdfxfa/fpdfxfa_doc.h"
@@ -887,6 +888,7 @@ void CPDFSDK_BAAnnot::WriteAppearance(const CFX_ByteString& sAPType,
 
   pStream->SetData((uint8_t*)sContents.c_str(), sContents.GetLength(), FALSE,
                    FALSE);
+  CPDFSDK_RenderCache::InvalidatePage(GetPDFPage());
 }
 
 #define BA_ANNOT_MINWIDTH 1
@@ -11,6 +11,7 @@
 
 #include "fpdfsdk/include/formfiller/FFL_FormFiller.h"
 #include "fpdfsdk/include/fsdk_define.h"
+#include "fpdfsdk/include/fsdk_rendercache.h"
 #include "fpdfsdk/include/javascript/IJavaScript.h"
 #include "public/fpdf_ext.h"
 #include "third_party/base/stl_util.h"
@@ -619,6 +620,12 @@ void CPDFSDK_Document::OnCloseDocument() {
   KillFocusAnnot();
 }
 
+void CPDFSDK_Document::SetChangeMark() {
+  m_bChangeMask = TRUE;
+  // Form changes can show, hide or restyle widgets on any page.
+  CPDFSDK_RenderCache::Invalidate(GetPDFDocument(), nullptr);
+}
+
 FX_BOOL CPDFSDK_Document::GetPermissions(int nFlag) {
   return GetPDFDocument()->GetUserPermissions() & nFlag;
 }
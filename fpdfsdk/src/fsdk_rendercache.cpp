@@ -0,0 +1,240 @@
+// Copyright 2016 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "fpdfsdk/include/fsdk_rendercache.h"
+
+#include <iterator>
+#include <utility>
+
+#include "core/include/fpdfapi/fpdf_page.h"
+#include "core/include/fpdfapi/fpdf_parser.h"
+#include "core/include/fxge/fx_dib.h"
+
+namespace {
+
+// Address used as the document private data key.
+const char kRenderCacheKey = 0;
+
+// Bumped by CPDFSDK_RenderCache::InvalidateAll().
+FX_DWORD g_InvalidateAllCount = 0;
+
+// 64-bit FNV-1a over 8-byte words; narrows lookups to one entry, whose saved
+// contents are then compared in full.
+uint64_t HashBuffer(const uint8_t* pData, size_t size) {
+  const uint64_t kPrime = 0x100000001b3ULL;
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    FXSYS_memcpy(&word, pData + i, sizeof(word));
+    hash = (hash ^ word) * kPrime;
+  }
+  for (; i < size; ++i)
+    hash = (hash ^ pData[i]) * kPrime;
+  return hash;
+}
+
+size_t GetBufferSize(const CFX_DIBitmap* pBitmap) {
+  return (size_t)pBitmap->GetPitch() * pBitmap->GetHeight();
+}
+
+// Whether every row of |pBitmap| matches |pRow|, |nRowSize| bytes long.
+bool RowsMatch(const CFX_DIBitmap* pBitmap, const uint8_t* pRow,
+               size_t nRowSize) {
+  for (int row = 0; row < pBitmap->GetHeight(); ++row) {
+    if (FXSYS_memcmp(pBitmap->GetScanline(row), pRow, nRowSize) != 0)
+      return false;
+  }
+  return true;
+}
+
+bool ContentsMatch(const CPDFSDK_RenderCache::Contents& contents,
+                   const CFX_DIBitmap* pBitmap) {
+  if (!contents.m_pData)
+    return false;
+  if (contents.m_nSize == pBitmap->GetPitch())
+    return RowsMatch(pBitmap, contents.m_pData.get(), contents.m_nSize);
+  return contents.m_nSize == GetBufferSize(pBitmap) &&
+         FXSYS_memcmp(pBitmap->GetBuffer(), contents.m_pData.get(),
+                      contents.m_nSize) == 0;
+}
+
+// Unique across caches, so a page never sees one of its old stamps again
+// when a cache is dropped and another attached.
+FX_DWORD NewDisplayListStamp() {
+  static FX_DWORD s_LastStamp = 0;
+  if (++s_LastStamp == 0)
+    ++s_LastStamp;
+  return s_LastStamp;
+}
+
+}  // namespace
+
+// static
+CPDFSDK_RenderCache* CPDFSDK_RenderCache::Get(CPDF_Document* pDoc) {
+  if (!pDoc)
+    return nullptr;
+  CPDFSDK_RenderCache* pCache = static_cast<CPDFSDK_RenderCache*>(
+      pDoc->GetPrivateData((void*)&kRenderCacheKey));
+  if (pCache && pCache->m_dwInvalidateAllCount != g_InvalidateAllCount) {
+    pCache->Remove(nullptr);
+    pCache->m_dwInvalidateAllCount = g_InvalidateAllCount;
+  }
+  return pCache;
+}
+
+// static
+void CPDFSDK_RenderCache::SetMaxSize(CPDF_Document* pDoc, size_t nMaxBytes) {
+  if (!pDoc)
+    return;
+  if (nMaxBytes == 0) {
+    pDoc->RemovePrivateData((void*)&kRenderCacheKey);
+    return;
+  }
+  CPDFSDK_RenderCache* pCache = Get(pDoc);
+  if (pCache) {
+    pCache->Shrink(nMaxBytes);
+    pCache->m_nMaxBytes = nMaxBytes;
+    return;
+  }
+  pDoc->SetPrivateObj((void*)&kRenderCacheKey,
+                      new CPDFSDK_RenderCache(nMaxBytes));
+}
+
+// static
+void CPDFSDK_RenderCache::Invalidate(CPDF_Document* pDoc,
+                                     const CPDF_Dictionary* pPageDict) {
+  CPDFSDK_RenderCache* pCache = Get(pDoc);
+  if (pCache)
+    pCache->Remove(pPageDict);
+}
+
+// static
+void CPDFSDK_RenderCache::InvalidatePage(CPDF_Page* pPage) {
+  if (pPage && pPage->m_pFormDict)
+    Invalidate(pPage->m_pDocument, pPage->m_pFormDict);
+}
+
+// static
+void CPDFSDK_RenderCache::InvalidateAll() {
+  ++g_InvalidateAllCount;
+}
+
+CPDFSDK_RenderCache::CPDFSDK_RenderCache(size_t nMaxBytes)
+    : m_nMaxBytes(nMaxBytes),
+      m_nCurBytes(0),
+      m_dwDisplayListStamp(NewDisplayListStamp()),
+      m_dwInvalidateAllCount(g_InvalidateAllCount) {}
+
+CPDFSDK_RenderCache::~CPDFSDK_RenderCache() {}
+
+CPDFSDK_RenderCache::Key CPDFSDK_RenderCache::MakeKey(
+    CPDF_Page* pPage,
+    const CFX_DIBitmap* pBitmap,
+    int start_x,
+    int start_y,
+    int size_x,
+    int size_y,
+    int rotate,
+    int flags) const {
+  Key key;
+  key.m_pPageDict = pPage->m_pFormDict;
+  key.m_StartX = start_x;
+  key.m_StartY = start_y;
+  key.m_SizeX = size_x;
+  key.m_SizeY = size_y;
+  key.m_Rotate = rotate;
+  key.m_Flags = flags;
+  key.m_Format = pBitmap->GetFormat();
+  key.m_Width = pBitmap->GetWidth();
+  key.m_Height = pBitmap->GetHeight();
+  key.m_Pitch = pBitmap->GetPitch();
+  key.m_ContentHash = pBitmap->GetBuffer()
+                          ? HashBuffer(pBitmap->GetBuffer(),
+                                       GetBufferSize(pBitmap))
+                          : 0;
+  return key;
+}
+
+FX_BOOL CPDFSDK_RenderCache::Lookup(const Key& key, CFX_DIBitmap* pBitmap) {
+  auto it = m_Index.find(key);
+  if (it == m_Index.end() || !pBitmap->GetBuffer())
+    return FALSE;
+  const Entry& entry = *it->second;
+  if (entry.m_nSize != GetBufferSize(pBitmap) ||
+      !ContentsMatch(entry.m_Source, pBitmap)) {
+    return FALSE;
+  }
+  FXSYS_memcpy(pBitmap->GetBuffer(), entry.m_pData.get(), entry.m_nSize);
+  m_Entries.splice(m_Entries.begin(), m_Entries, it->second);
+  return TRUE;
+}
+
+void CPDFSDK_RenderCache::SaveContents(const CFX_DIBitmap* pBitmap,
+                                       Contents* pContents) const {
+  const uint8_t* pBuffer = pBitmap->GetBuffer();
+  if (!pBuffer)
+    return;
+  size_t nSize = RowsMatch(pBitmap, pBuffer, pBitmap->GetPitch())
+                     ? pBitmap->GetPitch()
+                     : GetBufferSize(pBitmap);
+  if (nSize == 0 || nSize > m_nMaxBytes)
+    return;
+  uint8_t* pData = FX_TryAlloc(uint8_t, nSize);
+  if (!pData)
+    return;
+  FXSYS_memcpy(pData, pBuffer, nSize);
+  pContents->m_pData.reset(pData);
+  pContents->m_nSize = nSize;
+}
+
+void CPDFSDK_RenderCache::Store(const Key& key,
+                                Contents* pContents,
+                                const CFX_DIBitmap* pBitmap) {
+  size_t nSize = GetBufferSize(pBitmap);
+  if (!pBitmap->GetBuffer() || nSize == 0 || !pContents->m_pData ||
+      pContents->m_nSize > m_nMaxBytes ||
+      nSize > m_nMaxBytes - pContents->m_nSize) {
+    return;
+  }
+  auto it = m_Index.find(key);
+  if (it != m_Index.end())
+    Evict(it->second);
+  Shrink(m_nMaxBytes - nSize - pContents->m_nSize);
+
+  uint8_t* pData = FX_TryAlloc(uint8_t, nSize);
+  if (!pData)
+    return;
+  FXSYS_memcpy(pData, pBitmap->GetBuffer(), nSize);
+  m_Entries.push_front(Entry());
+  Entry& entry = m_Entries.front();
+  entry.m_Key = key;
+  entry.m_pData.reset(pData);
+  entry.m_nSize = nSize;
+  entry.m_Source = std::move(*pContents);
+  m_Index[key] = m_Entries.begin();
+  m_nCurBytes += nSize + entry.m_Source.m_nSize;
+}
+
+void CPDFSDK_RenderCache::Remove(const CPDF_Dictionary* pPageDict) {
+  m_dwDisplayListStamp = NewDisplayListStamp();
+  auto it = m_Entries.begin();
+  while (it != m_Entries.end()) {
+    auto next = std::next(it);
+    if (!pPageDict || it->m_Key.m_pPageDict == pPageDict)
+      Evict(it);
+    it = next;
+  }
+}
+
+void CPDFSDK_RenderCache::Shrink(size_t nMaxBytes) {
+  while (m_nCurBytes > nMaxBytes && !m_Entries.empty())
+    Evict(std::prev(m_Entries.end()));
+}
+
+void CPDFSDK_RenderCache::Evict(EntryList::iterator it) {
+  m_nCurBytes -= it->m_nSize + it->m_Source.m_nSize;
+  m_Index.erase(it->m_Key);
+  m_Entries.erase(it);
+}
@@ -9,6 +9,7 @@
     'pdf_use_skia%': 0,
     'pdf_enable_v8%': 1,
     'pdf_enable_xfa%': 0, # Set to 1 by standalone.gypi in a standalone build.
+    'pdf_atomic_string_refs%': 0,
     'conditions': [
       ['OS=="linux"', {
         'bundle_freetype%': 0,
@@ -44,6 +45,9 @@
       ['pdf_enable_xfa==1', {
         'defines': ['PDF_ENABLE_XFA'],
       }],
+      ['pdf_atomic_string_refs==1', {
+        'defines': ['PDF_ATOMIC_STRING_REFS'],
+      }],
       ['OS=="linux"', {
         'conditions': [
           ['target_arch=="x64"', {
@@ -114,6 +118,7 @@
         'fpdfsdk/src/fsdk_baseannot.cpp',
         'fpdfsdk/src/fsdk_baseform.cpp',
         'fpdfsdk/src/fsdk_mgr.cpp',
+        'fpdfsdk/src/fsdk_rendercache.cpp',
         'fpdfsdk/src/fsdk_rendercontext.cpp',
         'public/fpdf_dataavail.h',
         'public/fpdf_doc.h',
@@ -289,6 +294,7 @@
         'core/src/fpdfapi/fpdf_edit/editint.h',
         'core/src/fpdfapi/fpdf_edit/fpdf_edit_content.cpp',
         'core/src/fpdfapi/fpdf_edit/fpdf_edit_create.cpp',
+        'core/src/fpdfapi/fpdf_edit/fpdf_edit_dedup.cpp',
         'core/src/fpdfapi/fpdf_edit/fpdf_edit_doc.cpp',
         'core/src/fpdfapi/fpdf_edit/fpdf_edit_image.cpp',
         'core/src/fpdfapi/fpdf_font/font_int.h',
@@ -307,6 +313,7 @@
         'core/src/fpdfapi/fpdf_page/fpdf_page_parser_old.cpp',
         'core/src/fpdfapi/fpdf_page/fpdf_page_path.cpp',
         'core/src/fpdfapi/fpdf_page/fpdf_page_pattern.cpp',
+        'core/src/fpdfapi/fpdf_page/fpdf_page_textstream.cpp',
         'core/src/fpdfapi/fpdf_page/pageint.h',
         'core/src/fpdfapi/fpdf_parser/fpdf_parser_decode.cpp',
         'core/src/fpdfapi/fpdf_parser/fpdf_parser_document.cpp',
@@ -331,6 +338,7 @@
       'sources': [
         'core/include/fpdftext/fpdf_text.h',
         'core/src/fpdftext/fpdf_text.cpp',
+        'core/src/fpdftext/fpdf_text_docsearch.cpp',
         'core/src/fpdftext/fpdf_text_int.cpp',
         'core/src/fpdftext/fpdf_text_search.cpp',
         'core/src/fpdftext/text_int.h',
@@ -442,10 +450,12 @@
         'core/include/fxcrt/fx_coordinates.h',
         'core/include/fxcrt/fx_ext.h',
         'core/include/fxcrt/fx_memory.h',
+        'core/include/fxcrt/fx_memorybudget.h',
         'core/include/fxcrt/fx_safe_types.h',
         'core/include/fxcrt/fx_stream.h',
         'core/include/fxcrt/fx_string.h',
         'core/include/fxcrt/fx_system.h',
+        'core/include/fxcrt/fx_threadpool.h',
         'core/include/fxcrt/fx_ucd.h',
         'core/include/fxcrt/fx_xml.h',
         'core/src/fxcrt/extension.h',
@@ -468,6 +478,7 @@
         'core/src/fxcrt/fx_basic_wstring.cpp',
         'core/src/fxcrt/fx_bidi.cpp',
         'core/src/fxcrt/fx_extension.cpp',
+        'core/src/fxcrt/fx_threadpool.cpp',
         'core/src/fxcrt/fx_ucddata.cpp',
         'core/src/fxcrt/fx_unicode.cpp',
         'core/src/fxcrt/fx_xml_composer.cpp',
@@ -757,6 +768,7 @@
         'core/src/fpdfapi/fpdf_parser/fpdf_parser_decode_unittest.cpp',
         'core/src/fpdfapi/fpdf_parser/fpdf_parser_objects_unittest.cpp',
         'core/src/fpdfapi/fpdf_parser/fpdf_parser_parser_unittest.cpp',
+        'core/src/fpdfapi/fpdf_render/fpdf_render_unittest.cpp',
         'core/src/fpdftext/fpdf_text_int_unittest.cpp',
         'core/src/fxcodec/codec/fx_codec_jpx_unittest.cpp',
         'core/src/fxcrt/fx_basic_bstring_unittest.cpp',
@@ -765,6 +777,11 @@
         'core/src/fxcrt/fx_bidi_unittest.cpp',
         'core/src/fxcrt/fx_extension_unittest.cpp',
         'core/src/fxcrt/fx_system_unittest.cpp',
+        'core/src/fxcrt/fx_threadpool_unittest.cpp',
+        'core/src/fxge/agg/src/fx_agg_driver_unittest.cpp',
+        'core/src/fxge/dib/fx_dib_main_unittest.cpp',
+        'core/src/fxge/ge/fx_ge_fontmap_unittest.cpp',
+        'core/src/fxge/ge/fx_ge_path_unittest.cpp',
         'testing/fx_string_testhelpers.h',
         'testing/fx_string_testhelpers.cpp',
       ],
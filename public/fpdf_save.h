@@ -48,6 +48,27 @@ typedef struct FPDF_FILEWRITE_ {
 #define FPDF_NO_INCREMENTAL 2
 /** @brief Remove security. */
 #define FPDF_REMOVE_SECURITY 3
+/** @brief Compress streams on worker threads. May be OR-ed with one of the
+ *  values above; the saved file is the same as without it. */
+#define FPDF_PARALLEL_COMPRESS 0x100
+/** @brief Write one copy of objects with equal contents, e.g. fonts and
+ *  images repeated by FPDF_ImportPages(). May be OR-ed with one of the values
+ *  above; ignored for incremental saves. */
+#define FPDF_REMOVE_DUPLICATES 0x200
+/** @brief Deflate streams as fast as possible. May be OR-ed with one of the
+ *  first three values. */
+#define FPDF_COMPRESSION_FAST 0x400
+/** @brief Deflate streams as small as possible. May be OR-ed with one of the
+ *  first three values. */
+#define FPDF_COMPRESSION_MAX 0x800
+
+// Statistics reported by FPDF_SaveAsCopyWithStats().
+typedef struct FPDF_SAVE_STATS_ {
+  // Number of indirect objects left out by FPDF_REMOVE_DUPLICATES.
+  unsigned long duplicate_objects;
+  // Approximate number of bytes those objects would have taken.
+  unsigned long duplicate_bytes;
+} FPDF_SAVE_STATS;
 
 // Function: FPDF_SaveAsCopy
 //          Saves the copy of specified document in custom way.
@@ -80,6 +101,22 @@ DLLEXPORT FPDF_BOOL STDCALL FPDF_SaveWithVersion(FPDF_DOCUMENT document,
                                                  FPDF_DWORD flags,
                                                  int fileVersion);
 
+// Function: FPDF_SaveAsCopyWithStats
+//          Same as function ::FPDF_SaveAsCopy, and also reports what the
+//          save did.
+// Parameters:
+//          document        -   Handle to document.
+//          pFileWrite      -   A pointer to a custom file write structure.
+//          flags           -   The creating flags.
+//          stats           -   Receives the save statistics. Can be NULL.
+// Return value:
+//          TRUE if succeed, FALSE if failed.
+//
+DLLEXPORT FPDF_BOOL STDCALL FPDF_SaveAsCopyWithStats(FPDF_DOCUMENT document,
+                                                     FPDF_FILEWRITE* pFileWrite,
+                                                     FPDF_DWORD flags,
+                                                     FPDF_SAVE_STATS* stats);
+
 #ifdef __cplusplus
 }
 #endif
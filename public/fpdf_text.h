@@ -7,6 +7,7 @@
 #ifndef PUBLIC_FPDF_TEXT_H_
 #define PUBLIC_FPDF_TEXT_H_
 
+#include "fpdf_progressive.h"
 #include "fpdfview.h"
 
 // Exported Functions
@@ -112,6 +113,57 @@ DLLEXPORT void STDCALL FPDFText_GetCharBox(FPDF_TEXTPAGE text_page,
                                            double* bottom,
                                            double* top);
 
+// Flags for characters reported by FPDFText_GetCharGeometry.
+#define FPDF_TEXTCHAR_NORMAL 0
+// Generated by the text page, like spaces between words and line breaks.
+#define FPDF_TEXTCHAR_GENERATED 1
+// A glyph without Unicode mapping; its Unicode is the character code.
+#define FPDF_TEXTCHAR_UNUNICODE 2
+#define FPDF_TEXTCHAR_HYPHEN 3
+// One of several characters produced by a single glyph.
+#define FPDF_TEXTCHAR_PIECE 4
+
+// Function: FPDFText_GetCharGeometry
+//          Get the Unicode, geometry and font of a range of characters in one
+//          call.
+// Parameters:
+//          text_page   -   Handle to a text page information structure.
+//          Returned by FPDFText_LoadPage function.
+//          start       -   Zero-based index of the first character.
+//          count       -   Number of characters to get. The range is clipped
+//          to the end of the page.
+//          unicodes    -   Array of |count| entries receiving the Unicode of
+//          each character, as FPDFText_GetUnicode. May be NULL.
+//          boxes       -   Array of 4 * |count| entries receiving left, right,
+//          bottom and top of each character box, as FPDFText_GetCharBox. May
+//          be NULL.
+//          origins     -   Array of 2 * |count| entries receiving the x and y
+//          of each character origin. May be NULL.
+//          font_sizes  -   Array of |count| entries receiving the font size
+//          of each character, as FPDFText_GetFontSize. May be NULL.
+//          fonts       -   Array of |count| entries receiving the font of
+//          each character, or NULL for generated characters. May be NULL.
+//          flags       -   Array of |count| entries receiving one of the
+//          FPDF_TEXTCHAR_* values for each character. May be NULL.
+// Return value:
+//          The number of characters written, or -1 for error.
+// Comments:
+//          All positions are measured in PDF "user space". Font handles are
+//          only useful to tell whether two characters share a font. They
+//          stay valid while the page of |text_page| is loaded; the font is
+//          freed once no loaded page uses it, and may get another handle
+//          when a page is loaded again.
+//
+DLLEXPORT int STDCALL FPDFText_GetCharGeometry(FPDF_TEXTPAGE text_page,
+                                               int start,
+                                               int count,
+                                               unsigned int* unicodes,
+                                               double* boxes,
+                                               double* origins,
+                                               double* font_sizes,
+                                               FPDF_FONT* fonts,
+                                               int* flags);
+
 // Function: FPDFText_GetCharIndexAtPos
 //          Get the index of a character at or nearby a certain position on the
 //          page.
@@ -312,6 +364,147 @@ DLLEXPORT int STDCALL FPDFText_GetSchCount(FPDF_SCHHANDLE handle);
 //
 DLLEXPORT void STDCALL FPDFText_FindClose(FPDF_SCHHANDLE handle);
 
+// Function: FPDFText_DocSearchStart
+//          Create a search context covering every page of a document.
+// Parameters:
+//          document    -   Handle to the document.
+// Return Value:
+//          A handle for the search context, or NULL on failure.
+//          FPDFText_DocSearchClose must be called to release this handle.
+// Comments:
+//          No page is indexed yet; call FPDFText_DocSearchContinue to index
+//          them. Pages are parsed once, for text only, and later searches
+//          use the index instead of loading pages again. Edits made to the
+//          document afterwards are not reflected.
+//
+DLLEXPORT FPDF_DOCSCHHANDLE STDCALL
+FPDFText_DocSearchStart(FPDF_DOCUMENT document);
+
+// Function: FPDFText_DocSearchContinue
+//          Index the pages not indexed yet.
+// Parameters:
+//          handle      -   A handle returned by FPDFText_DocSearchStart.
+//          pause       -   Checked after every page, may be NULL to index
+//                          the whole document in one call.
+// Return Value:
+//          TRUE once every page is indexed, FALSE if paused or on failure.
+//
+DLLEXPORT FPDF_BOOL STDCALL
+FPDFText_DocSearchContinue(FPDF_DOCSCHHANDLE handle, IFSDK_PAUSE* pause);
+
+// Function: FPDFText_DocSearchCountIndexedPages
+//          Get the number of pages indexed so far, always the first pages
+//          of the document.
+// Parameters:
+//          handle      -   A handle returned by FPDFText_DocSearchStart.
+// Return Value:
+//          Number of indexed pages.
+//
+DLLEXPORT int STDCALL
+FPDFText_DocSearchCountIndexedPages(FPDF_DOCSCHHANDLE handle);
+
+// Function: FPDFText_DocSearchFind
+//          Search the indexed pages for a string.
+// Parameters:
+//          handle      -   A handle returned by FPDFText_DocSearchStart.
+//          findwhat    -   A unicode match pattern.
+//          flags       -   FPDF_MATCHCASE and FPDF_MATCHWHOLEWORD.
+// Return Value:
+//          Number of matches, retrieved with FPDFText_DocSearchGetResult.
+// Comments:
+//          Matching ignores differences in whitespace, and compares text
+//          after Unicode compatibility decomposition, so a ligature matches
+//          the letters it is made of.
+//
+DLLEXPORT int STDCALL FPDFText_DocSearchFind(FPDF_DOCSCHHANDLE handle,
+                                             FPDF_WIDESTRING findwhat,
+                                             unsigned long flags);
+
+// Function: FPDFText_DocSearchGetResult
+//          Get a match of the last FPDFText_DocSearchFind call.
+// Parameters:
+//          handle      -   A handle returned by FPDFText_DocSearchStart.
+//          index       -   Zero-based index of the match. Matches are in
+//                          page order, then text order.
+//          page_index  -   Receives the zero-based page index.
+//          start_index -   Receives the index of the first matched
+//                          character, as used by FPDFText_LoadPage.
+//          count       -   Receives the number of matched characters.
+// Return Value:
+//          TRUE on success, FALSE if |index| is out of range.
+//
+DLLEXPORT FPDF_BOOL STDCALL
+FPDFText_DocSearchGetResult(FPDF_DOCSCHHANDLE handle,
+                            int index,
+                            int* page_index,
+                            int* start_index,
+                            int* count);
+
+// Function: FPDFText_DocSearchClose
+//          Release a document search context.
+// Parameters:
+//          handle      -   A handle returned by FPDFText_DocSearchStart.
+// Return Value:
+//          None.
+//
+DLLEXPORT void STDCALL FPDFText_DocSearchClose(FPDF_DOCSCHHANDLE handle);
+
+// Interface for receiving the characters of FPDFText_StreamPageText.
+typedef struct _FPDF_TEXT_SINK {
+  //
+  // Version number of the interface. Currently must be 1.
+  //
+  int version;
+
+  //
+  // Method: OnChar
+  //          Receive one character shown on the page.
+  // Interface Version:
+  //          1
+  // Implementation Required:
+  //          Yes
+  // Parameters:
+  //          pThis       -   Pointer to the structure itself.
+  //          unicode     -   The Unicode character, or the character code
+  //                          when the font has no Unicode mapping.
+  //          font_size   -   The font size, in text space units.
+  //          x           -   Horizontal position of the glyph origin, in
+  //                          page coordinates.
+  //          y           -   Vertical position of the glyph origin, in
+  //                          page coordinates.
+  // Return value:
+  //          None.
+  //
+  void (*OnChar)(struct _FPDF_TEXT_SINK* pThis,
+                 unsigned int unicode,
+                 double font_size,
+                 double x,
+                 double y);
+
+  // A user defined data pointer, used by user's application. Can be NULL.
+  void* user;
+} FPDF_TEXT_SINK;
+
+// Function: FPDFText_StreamPageText
+//          Extract the text of a page without loading it for display.
+// Parameters:
+//          document    -   Handle to the document.
+//          page_index  -   Zero-based index of the page.
+//          sink        -   Receives the characters.
+// Return value:
+//          TRUE on success, FALSE if the page or |sink| is invalid.
+// Comments:
+//          Much cheaper than FPDF_LoadPage and FPDFText_LoadPage, for callers
+//          that only need the text: the page content is read for text
+//          operators only, and no page objects are built. Characters arrive
+//          in content stream order, not reading order, and no spaces or line
+//          breaks are generated between them; use their positions to lay
+//          them out.
+//
+DLLEXPORT FPDF_BOOL STDCALL FPDFText_StreamPageText(FPDF_DOCUMENT document,
+                                                    int page_index,
+                                                    FPDF_TEXT_SINK* sink);
+
 // Function: FPDFLink_LoadWebLinks
 //          Prepare information about weblinks in a page.
 // Parameters:
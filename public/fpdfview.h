@@ -10,6 +10,8 @@
 #ifndef PUBLIC_FPDFVIEW_H_
 #define PUBLIC_FPDFVIEW_H_
 
+#include <stddef.h>  // For size_t.
+
 #if defined(_WIN32) && !defined(__WINDOWS__)
 #include <windows.h>
 #endif
@@ -151,9 +153,24 @@ extern "C" {
 //          backwards comatibility purposes.
 DLLEXPORT void STDCALL FPDF_InitLibrary();
 
+// Heap supplied by the embedder for the memory PDFium allocates itself.
+typedef struct FPDF_ALLOCATOR_ {
+  // Version number of the interface. Currently must be 1.
+  int version;
+
+  // Returns |size| bytes aligned as malloc() would, or NULL on failure.
+  void* (*Alloc)(struct FPDF_ALLOCATOR_* pThis, size_t size);
+
+  // Resizes a block from Alloc or Realloc like realloc(); never passed NULL.
+  void* (*Realloc)(struct FPDF_ALLOCATOR_* pThis, void* ptr, size_t new_size);
+
+  // Frees a block from Alloc or Realloc; never passed NULL.
+  void (*Free)(struct FPDF_ALLOCATOR_* pThis, void* ptr);
+} FPDF_ALLOCATOR;
+
 // Process-wide options for initializing the library.
 typedef struct FPDF_LIBRARY_CONFIG_ {
-  // Version number of the interface. Currently must be 2.
+  // Version number of the interface. Currently must be 2, 3 or 4.
   int version;
 
   // Array of paths to scan in place of the defaults when using built-in
@@ -172,6 +189,30 @@ typedef struct FPDF_LIBRARY_CONFIG_ {
   // v8::Internals::kNumIsolateDataLots (exclusive). Note that 0 is fine
   // for most embedders.
   unsigned int m_v8EmbedderSlot;
+
+  // Version 3.
+
+  // Heap to use in place of the C runtime's, or NULL. Must stay valid until
+  // FPDF_DestroyLibrary() returns.
+  FPDF_ALLOCATOR* m_pAllocator;
+
+  // Non-zero to count the bytes each document allocates; see
+  // FPDF_GetDocumentMemoryUsage(). Adds a small header to every block.
+  FPDF_BOOL m_bTrackDocumentMemory;
+
+  // With tracking, the limit in bytes given to each document as it loads,
+  // or 0 for none; see FPDF_SetDocumentMemoryLimit().
+  size_t m_DocumentMemoryLimit;
+
+  // Version 4.
+
+  // File in which to keep the results of scanning the system font folders,
+  // or NULL. Later processes given the same file only reopen the fonts and
+  // folders that have changed, which shortens their first font lookup. The
+  // file is created when missing and rewritten when out of date. Also used
+  // by FPDF_GetDefaultSystemFontInfo(). May be ignored entirely depending
+  // upon the platform.
+  const char* m_pFontCatalogPath;
 } FPDF_LIBRARY_CONFIG;
 
 // Function: FPDF_InitLibraryWithConfig
@@ -392,6 +433,7 @@ DLLEXPORT FPDF_BOOL STDCALL FPDF_GetFileVersion(FPDF_DOCUMENT doc,
 #define FPDF_ERR_PASSWORD 4   // Password required or incorrect password.
 #define FPDF_ERR_SECURITY 5   // Unsupported security scheme.
 #define FPDF_ERR_PAGE 6       // Page not found or content error.
+#define FPDF_ERR_MEMORY 9     // Document memory limit exceeded.
 #ifdef PDF_ENABLE_XFA
 #define FPDF_ERR_XFALOAD 7    // Load XFA error.
 #define FPDF_ERR_XFALAYOUT 8  // Layout XFA error.
@@ -509,6 +551,9 @@ DLLEXPORT int STDCALL FPDF_GetPageSizeByIndex(FPDF_DOCUMENT document,
 #define FPDF_RENDER_NO_SMOOTHIMAGE 0x2000
 // Set to disable anti-aliasing on paths.
 #define FPDF_RENDER_NO_SMOOTHPATH 0x4000
+// Set to scan convert large paths on several threads. Only used when
+// rendering to a bitmap; the output is the same either way.
+#define FPDF_RENDER_PARALLEL 0x8000
 // Set whether to render in a reverse Byte order, this flag is only used when
 // rendering to a bitmap.
 #define FPDF_REVERSE_BYTE_ORDER 0x10
@@ -576,6 +621,69 @@ DLLEXPORT void STDCALL FPDF_RenderPageBitmap(FPDF_BITMAP bitmap,
                                              int rotate,
                                              int flags);
 
+// Function: FPDF_SetRenderCacheSize
+//          Enable or resize the cache of FPDF_RenderPageBitmap results.
+// Parameters:
+//          document    -   Handle to the document.
+//          max_bytes   -   Memory budget for cached bitmaps, in bytes. 0
+//                          disables the cache and frees its contents.
+// Return value:
+//          None.
+// Comments:
+//          A repeated call with the same page, parameters, flags and
+//          initial bitmap contents copies the stored result instead of
+//          rendering again. Least recently used results are dropped first.
+//          Edits made through FPDFPage_* functions, page flattening and
+//          form filling invalidate the affected page automatically. Edits
+//          to individual page objects, such as FPDFPageObj_Transform, do not
+//          know their page and invalidate every cached result instead.
+//          Renders that miss, such as other tiles or zoom levels, also reuse
+//          the index of where page objects lie built by earlier renders,
+//          which the same invalidation keeps current. Changes made any
+//          other way need FPDF_InvalidateRenderCache.
+DLLEXPORT void STDCALL FPDF_SetRenderCacheSize(FPDF_DOCUMENT document,
+                                               unsigned long max_bytes);
+
+// Function: FPDF_InvalidateRenderCache
+//          Drop cached render results.
+// Parameters:
+//          document    -   Handle to the document.
+//          page        -   Handle to the page whose results are dropped, or
+//                          NULL to drop the results of every page.
+// Return value:
+//          None.
+DLLEXPORT void STDCALL FPDF_InvalidateRenderCache(FPDF_DOCUMENT document,
+                                                  FPDF_PAGE page);
+
+// Function: FPDF_SetDocumentMemoryLimit
+//          Set the most memory a document may use.
+// Parameters:
+//          document    -   Handle to the document.
+//          max_bytes   -   Limit in bytes, or 0 for none.
+// Return value:
+//          TRUE on success. FALSE when memory tracking was not enabled in
+//          FPDF_LIBRARY_CONFIG or |document| is invalid.
+// Comments:
+//          Counts memory PDFium allocates from its heap while working on the
+//          document, such as streams, decoded images and bitmaps; small C++
+//          objects are not counted. Past the limit, loading the document or
+//          a page fails with FPDF_ERR_MEMORY and rendering stops early,
+//          leaving the bitmap partly drawn. The document keeps working for
+//          requests that fit.
+DLLEXPORT FPDF_BOOL STDCALL FPDF_SetDocumentMemoryLimit(FPDF_DOCUMENT document,
+                                                        size_t max_bytes);
+
+// Function: FPDF_GetDocumentMemoryUsage
+//          Get the memory a document uses.
+// Parameters:
+//          document    -   Handle to the document.
+//          peak        -   Receives the highest usage so far. May be NULL.
+// Return value:
+//          The bytes currently charged to the document, or 0 when memory
+//          tracking was not enabled in FPDF_LIBRARY_CONFIG.
+DLLEXPORT size_t STDCALL FPDF_GetDocumentMemoryUsage(FPDF_DOCUMENT document,
+                                                     size_t* peak);
+
 // Function: FPDF_ClosePage
 //          Close a loaded PDF page.
 // Parameters:
@@ -254,6 +254,22 @@ FPDF_BITMAP EmbedderTest::RenderPage(FPDF_PAGE page) {
   return bitmap;
 }
 
+// static
+std::string EmbedderTest::RenderToString(FPDF_PAGE page,
+                                         FPDF_DWORD fill_color,
+                                         int scale,
+                                         int flags) {
+  int width = static_cast<int>(FPDF_GetPageWidth(page)) * scale;
+  int height = static_cast<int>(FPDF_GetPageHeight(page)) * scale;
+  FPDF_BITMAP bitmap = FPDFBitmap_Create(width, height, 0);
+  FPDFBitmap_FillRect(bitmap, 0, 0, width, height, fill_color);
+  FPDF_RenderPageBitmap(bitmap, page, 0, 0, width, height, 0, flags);
+  std::string result(static_cast<const char*>(FPDFBitmap_GetBuffer(bitmap)),
+                     FPDFBitmap_GetStride(bitmap) * height);
+  FPDFBitmap_Destroy(bitmap);
+  return result;
+}
+
 void EmbedderTest::UnloadPage(FPDF_PAGE page) {
   FORM_DoPageAAction(page, form_handle_, FPDFPAGE_AACTION_CLOSE);
   FORM_OnBeforeClosePage(page, form_handle_);
@@ -107,6 +107,13 @@ class EmbedderTest : public ::testing::Test,
   // Convert a loaded page into a bitmap.
   virtual FPDF_BITMAP RenderPage(FPDF_PAGE page);
 
+  // Render |page| at |scale| over |fill_color| with the FPDF_RENDER_* |flags|,
+  // and return the bitmap's bytes, for comparing renderings.
+  static std::string RenderToString(FPDF_PAGE page,
+                                    FPDF_DWORD fill_color = 0xFFFFFFFF,
+                                    int scale = 1,
+                                    int flags = 0);
+
   // Relese the resources obtained from LoadPage(). Further use of |page|
   // is prohibited after this call is made.
   virtual void UnloadPage(FPDF_PAGE page);
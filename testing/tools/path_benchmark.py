@@ -0,0 +1,149 @@
+#!/usr/bin/env python
+# Copyright 2016 The PDFium Authors. All rights reserved.
+# Use of this source code is governed by a BSD-style license that can be
+# found in the LICENSE file.
+
+"""Times pdfium_test on generated pages holding pathologically large paths.
+
+Each page has a single path of about a hundred thousand segments, like the
+contour maps and hatched fills found in GIS and CAD output. For every page
+the wall time and the peak resident memory of rendering it are reported,
+which is where the banded rasterizer should keep memory flat.
+"""
+
+import math
+import optparse
+import os
+import subprocess
+import sys
+import time
+
+import common
+
+PAGE_SIZE = 612
+
+
+def hatching(count):
+  '''|count| thin diagonal strokes across the page, as one path.'''
+  ops = ['0.2 w']
+  step = 2.0 * PAGE_SIZE / count
+  for i in range(count):
+    x = i * step - PAGE_SIZE
+    ops.append('%.2f 0 m %.2f %d l' % (x, x + PAGE_SIZE, PAGE_SIZE))
+  ops.append('S')
+  return ops
+
+
+def contours(rings, segments):
+  '''|rings| wobbly closed curves of |segments| Bezier curves each, filled
+  with the even-odd rule like the bands of a contour map.'''
+  ops = []
+  cx = cy = PAGE_SIZE / 2.0
+  for ring in range(rings):
+    radius = 5 + (PAGE_SIZE / 2.0 - 10) * ring / rings
+    points = []
+    for i in range(segments):
+      angle = 2 * math.pi * i / segments
+      r = radius * (1 + 0.03 * math.sin(angle * 17 + ring))
+      points.append((cx + r * math.cos(angle), cy + r * math.sin(angle)))
+    ops.append('%.2f %.2f m' % points[0])
+    for i in range(segments):
+      x0, y0 = points[i]
+      x3, y3 = points[(i + 1) % segments]
+      ops.append('%.2f %.2f %.2f %.2f %.2f %.2f c' %
+                 (x0 + (x3 - x0) / 3, y0 + (y3 - y0) / 3,
+                  x0 + 2 * (x3 - x0) / 3, y0 + 2 * (y3 - y0) / 3, x3, y3))
+    ops.append('h')
+  ops.append('0.2 0.5 0.3 rg f*')
+  return ops
+
+
+def zigzag(count):
+  '''A filled polygon whose edge zigzags |count| times across the page.'''
+  ops = ['0 0 m']
+  for i in range(count):
+    y = PAGE_SIZE * float(i) / count
+    ops.append('%d %.3f l' % (PAGE_SIZE if i % 2 else 0, y))
+  ops.append('h 0.6 0.2 0.2 rg f')
+  return ops
+
+
+PAGES = [
+    ('hatching', lambda: hatching(20000)),
+    ('contours', lambda: contours(200, 500)),
+    ('zigzag', lambda: zigzag(100000)),
+]
+
+
+def write_pdf(path, ops):
+  content = '\n'.join(ops).encode('latin-1')
+  objects = [
+      b'<< /Type /Catalog /Pages 2 0 R >>',
+      b'<< /Type /Pages /Kids [3 0 R] /Count 1 >>',
+      ('<< /Type /Page /Parent 2 0 R /MediaBox [0 0 %d %d] '
+       '/Contents 4 0 R >>' % (PAGE_SIZE, PAGE_SIZE)).encode('latin-1'),
+      b'<< /Length ' + str(len(content)).encode('latin-1') + b' >>\n' +
+      b'stream\n' + content + b'\nendstream',
+  ]
+  data = b'%PDF-1.7\n'
+  offsets = []
+  for number, body in enumerate(objects, 1):
+    offsets.append(len(data))
+    data += str(number).encode('latin-1') + b' 0 obj\n' + body + b'\nendobj\n'
+  xref = len(data)
+  data += ('xref\n0 %d\n0000000000 65535 f \n' %
+           (len(objects) + 1)).encode('latin-1')
+  for offset in offsets:
+    data += ('%010d 00000 n \n' % offset).encode('latin-1')
+  data += ('trailer\n<< /Size %d /Root 1 0 R >>\nstartxref\n%d\n%%%%EOF\n' %
+           (len(objects) + 1, xref)).encode('latin-1')
+  with open(path, 'wb') as f:
+    f.write(data)
+
+
+def run(pdfium_test_path, pdf_path, scale):
+  '''Returns the wall time in seconds and the peak RSS in KB.'''
+  start = time.time()
+  process = subprocess.Popen([pdfium_test_path, '--scale=%s' % scale,
+                              pdf_path], stderr=open(os.devnull, 'w'))
+  _, status, usage = os.wait4(process.pid, 0)
+  elapsed = time.time() - start
+  if status:
+    raise Exception('pdfium_test failed on %s' % pdf_path)
+  return elapsed, usage.ru_maxrss
+
+
+def main():
+  parser = optparse.OptionParser()
+  parser.add_option('--build-dir', default=os.path.join('out', 'Debug'),
+                    help='relative path from the base source directory')
+  parser.add_option('--scale', default='4',
+                    help='scale at which pages are rendered')
+  parser.add_option('--runs', default=3, type='int',
+                    help='runs per page; the fastest is reported')
+  options, args = parser.parse_args()
+  finder = common.DirectoryFinder(options.build_dir)
+  pdfium_test_path = finder.ExecutablePath('pdfium_test')
+  if not os.path.exists(pdfium_test_path):
+    print("FAILURE: Can't find test executable '%s'" % pdfium_test_path)
+    print("Use --build-dir to specify its location.")
+    return 1
+  working_dir = finder.WorkingDir(os.path.join('testing', 'path_benchmark'))
+  if not os.path.exists(working_dir):
+    os.makedirs(working_dir)
+
+  print('%-10s %10s %12s' % ('page', 'seconds', 'peak RSS KB'))
+  for name, build in PAGES:
+    if args and name not in args:
+      continue
+    pdf_path = os.path.join(working_dir, name + '.pdf')
+    write_pdf(pdf_path, build())
+    results = [run(pdfium_test_path, pdf_path, options.scale)
+               for _ in range(options.runs)]
+    print('%-10s %10.3f %12d' % (name, min(r[0] for r in results),
+                                 max(r[1] for r in results)))
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
@@ -0,0 +1,194 @@
+#!/usr/bin/env python
+# Copyright 2016 The PDFium Authors. All rights reserved.
+# Use of this source code is governed by a BSD-style license that can be
+# found in the LICENSE file.
+
+"""Times pdfium_test on generated pages holding mesh shadings.
+
+The pages mimic the gradient meshes of illustration exports: grids of
+curved Coons and tensor product patches, a single page filling patch with
+a strong color ramp, and free form and lattice form Gouraud triangle
+meshes. For every page the fastest wall time of rendering it is reported.
+"""
+
+import math
+import optparse
+import os
+import struct
+import subprocess
+import sys
+import time
+
+import common
+
+PAGE_SIZE = 612
+DECODE = [0, PAGE_SIZE, 0, PAGE_SIZE, 0, 1, 0, 1, 0, 1]
+
+
+def encode_coord(value):
+  value = min(max(value, 0), PAGE_SIZE)
+  return struct.pack('>H', int(round(value * 65535.0 / PAGE_SIZE)))
+
+
+def encode_color(color):
+  return struct.pack('BBB', *[int(round(c * 255)) for c in color])
+
+
+def warp(x, y, amount):
+  '''Bends straight grid lines into waves, the same way for shared edges.'''
+  return (x + amount * math.sin(y * 0.05), y + amount * math.sin(x * 0.05))
+
+
+def color_at(x, y):
+  return (0.5 + 0.5 * math.sin(x * 0.02), 0.5 + 0.5 * math.cos(y * 0.015),
+          0.5 + 0.5 * math.sin((x + y) * 0.01))
+
+
+def patch_mesh(cells, amount, tensor):
+  '''A |cells| by |cells| grid of patches with wavy edges, as the data of a
+  type 6 or, with |tensor|, type 7 shading.'''
+  size = float(PAGE_SIZE) / cells
+  # Edge parameters of the 12 boundary points, in the order of the spec.
+  boundary = [(0, 0), (0, 1), (0, 2), (0, 3), (1, 3), (2, 3), (3, 3), (3, 2),
+              (3, 1), (3, 0), (2, 0), (1, 0)]
+  interior = [(1, 1), (1, 2), (2, 2), (2, 1)]
+  data = b''
+  for row in range(cells):
+    for column in range(cells):
+      data += b'\0'
+      points = boundary + interior if tensor else boundary
+      for u, v in points:
+        x, y = warp((column + u / 3.0) * size, (row + v / 3.0) * size, amount)
+        data += encode_coord(x) + encode_coord(y)
+      for u, v in [(0, 0), (0, 1), (1, 1), (1, 0)]:
+        data += encode_color(color_at((column + u) * size, (row + v) * size))
+  return data
+
+
+def ramp_patch():
+  '''One patch covering the page, with a color ramp along both directions.'''
+  data = b'\0'
+  for i in range(12):
+    angle = 2 * math.pi * (0.625 - i / 12.0)
+    data += encode_coord(PAGE_SIZE / 2.0 + PAGE_SIZE * 0.48 * math.cos(angle))
+    data += encode_coord(PAGE_SIZE / 2.0 + PAGE_SIZE * 0.48 * math.sin(angle))
+  for color in [(1, 0, 0), (0, 1, 0), (0, 0, 1), (1, 1, 0)]:
+    data += encode_color(color)
+  return data
+
+
+def vertex(x, y, amount):
+  wx, wy = warp(x, y, amount)
+  return encode_coord(wx) + encode_coord(wy) + encode_color(color_at(x, y))
+
+
+def free_triangles(cells, amount):
+  '''Two independent triangles per grid cell, as type 4 data.'''
+  size = float(PAGE_SIZE) / cells
+  data = b''
+  for row in range(cells):
+    for column in range(cells):
+      x, y = column * size, row * size
+      for triangle in [[(x, y), (x + size, y), (x, y + size)],
+                       [(x + size, y), (x + size, y + size), (x, y + size)]]:
+        for px, py in triangle:
+          data += b'\0' + vertex(px, py, amount)
+  return data
+
+
+def lattice(cells, amount):
+  '''A lattice of (|cells| + 1) squared vertices, as type 5 data.'''
+  size = float(PAGE_SIZE) / cells
+  data = b''
+  for row in range(cells + 1):
+    for column in range(cells + 1):
+      data += vertex(column * size, row * size, amount)
+  return data
+
+
+PAGES = [
+    ('coons', 6, lambda: patch_mesh(40, 6, False), ''),
+    ('tensor', 7, lambda: patch_mesh(40, 6, True), ''),
+    ('ramp', 6, ramp_patch, ''),
+    ('gouraud', 4, lambda: free_triangles(150, 3), ''),
+    ('lattice', 5, lambda: lattice(300, 3), '/VerticesPerRow 301'),
+]
+
+
+def write_pdf(path, shading_type, data, extra_keys):
+  shading = ('<< /ShadingType %d /ColorSpace /DeviceRGB '
+             '/BitsPerCoordinate 16 /BitsPerComponent 8 %s /Decode [%s] %s '
+             '/Length %d >>' %
+             (shading_type, '' if shading_type == 5 else '/BitsPerFlag 8',
+              ' '.join(str(d) for d in DECODE), extra_keys, len(data)))
+  content = b'/Sh0 sh'
+  objects = [
+      b'<< /Type /Catalog /Pages 2 0 R >>',
+      b'<< /Type /Pages /Kids [3 0 R] /Count 1 >>',
+      ('<< /Type /Page /Parent 2 0 R /MediaBox [0 0 %d %d] '
+       '/Resources << /Shading << /Sh0 5 0 R >> >> /Contents 4 0 R >>' %
+       (PAGE_SIZE, PAGE_SIZE)).encode('latin-1'),
+      b'<< /Length ' + str(len(content)).encode('latin-1') + b' >>\n' +
+      b'stream\n' + content + b'\nendstream',
+      shading.encode('latin-1') + b'\nstream\n' + data + b'\nendstream',
+  ]
+  out = b'%PDF-1.7\n'
+  offsets = []
+  for number, body in enumerate(objects, 1):
+    offsets.append(len(out))
+    out += str(number).encode('latin-1') + b' 0 obj\n' + body + b'\nendobj\n'
+  xref = len(out)
+  out += ('xref\n0 %d\n0000000000 65535 f \n' %
+          (len(objects) + 1)).encode('latin-1')
+  for offset in offsets:
+    out += ('%010d 00000 n \n' % offset).encode('latin-1')
+  out += ('trailer\n<< /Size %d /Root 1 0 R >>\nstartxref\n%d\n%%%%EOF\n' %
+          (len(objects) + 1, xref)).encode('latin-1')
+  with open(path, 'wb') as f:
+    f.write(out)
+
+
+def run(pdfium_test_path, pdf_path, scale):
+  '''Returns the wall time in seconds.'''
+  start = time.time()
+  status = subprocess.call([pdfium_test_path, '--scale=%s' % scale, pdf_path],
+                           stderr=open(os.devnull, 'w'))
+  elapsed = time.time() - start
+  if status:
+    raise Exception('pdfium_test failed on %s' % pdf_path)
+  return elapsed
+
+
+def main():
+  parser = optparse.OptionParser()
+  parser.add_option('--build-dir', default=os.path.join('out', 'Debug'),
+                    help='relative path from the base source directory')
+  parser.add_option('--scale', default='2',
+                    help='scale at which pages are rendered')
+  parser.add_option('--runs', default=3, type='int',
+                    help='runs per page; the fastest is reported')
+  options, args = parser.parse_args()
+  finder = common.DirectoryFinder(options.build_dir)
+  pdfium_test_path = finder.ExecutablePath('pdfium_test')
+  if not os.path.exists(pdfium_test_path):
+    print("FAILURE: Can't find test executable '%s'" % pdfium_test_path)
+    print("Use --build-dir to specify its location.")
+    return 1
+  working_dir = finder.WorkingDir(os.path.join('testing', 'shading_benchmark'))
+  if not os.path.exists(working_dir):
+    os.makedirs(working_dir)
+
+  print('%-10s %10s' % ('page', 'seconds'))
+  for name, shading_type, build, extra_keys in PAGES:
+    if args and name not in args:
+      continue
+    pdf_path = os.path.join(working_dir, name + '.pdf')
+    write_pdf(pdf_path, shading_type, build(), extra_keys)
+    results = [run(pdfium_test_path, pdf_path, options.scale)
+               for _ in range(options.runs)]
+    print('%-10s %10.3f' % (name, min(results)))
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
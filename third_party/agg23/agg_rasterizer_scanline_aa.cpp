@@ -96,6 +96,10 @@ outline_aa::outline_aa() :
     m_min_y(0x7FFFFFFF),
     m_max_x(-0x7FFFFFFF),
     m_max_y(-0x7FFFFFFF),
+    m_band_min_y(INT_MIN),
+    m_band_max_y(INT_MAX),
+    m_cell_limit(cell_block_limit * cell_block_size),
+    m_dropped_cells(0),
     m_sorted(false)
 {
     m_cur_cell.set(0x7FFF, 0x7FFF, 0, 0);
@@ -110,6 +114,7 @@ void outline_aa::reset()
     m_min_y =  0x7FFFFFFF;
     m_max_x = -0x7FFFFFFF;
     m_max_y = -0x7FFFFFFF;
+    m_dropped_cells = 0;
 }
 void outline_aa::allocate_block()
 {
@@ -130,8 +135,16 @@ void outline_aa::allocate_block()
 AGG_INLINE void outline_aa::add_cur_cell()
 {
     if(m_cur_cell.area | m_cur_cell.cover) {
+        if(m_cur_cell.y < m_band_min_y || m_cur_cell.y > m_band_max_y) {
+            return;
+        }
+        if(m_num_cells >= m_cell_limit) {
+            ++m_dropped_cells;
+            return;
+        }
         if((m_num_cells & cell_block_mask) == 0) {
-            if(m_num_blocks >= cell_block_limit) {
+            if(m_cur_block >= cell_block_limit) {
+                ++m_dropped_cells;
                 return;
             }
             allocate_block();
@@ -145,6 +158,9 @@ AGG_INLINE void outline_aa::set_cur_cell(int x, int y)
     if(m_cur_cell.x != x || m_cur_cell.y != y) {
         add_cur_cell();
         m_cur_cell.set(x, y, 0, 0);
+        if(y < m_band_min_y || y > m_band_max_y) {
+            return;
+        }
         if(x < m_min_x) {
             m_min_x = x;
         }
@@ -221,6 +237,19 @@ AGG_INLINE void outline_aa::render_hline(int ey, int x1, int y1, int x2, int y2)
     delta = y2 - y1;
     m_cur_cell.add_cover(delta, (fx2 + poly_base_size - first) * delta);
 }
+AGG_INLINE int outline_aa::band_skip_target(int ey, int ey2, int incr) const
+{
+    if(ey >= m_band_min_y && ey <= m_band_max_y) {
+        return ey;
+    }
+    if(incr > 0 && ey < m_band_min_y && m_band_min_y < ey2) {
+        return m_band_min_y;
+    }
+    if(incr < 0 && ey > m_band_max_y && m_band_max_y > ey2) {
+        return m_band_max_y;
+    }
+    return ey2;
+}
 void outline_aa::render_line(int x1, int y1, int x2, int y2)
 {
     enum dx_limit_e { dx_limit = 16384 << poly_base_shift };
@@ -260,6 +289,12 @@ void outline_aa::render_line(int x1, int y1, int x2, int y2)
         delta = first + first - poly_base_size;
         area = two_fx * delta;
         while(ey1 != ey2) {
+            int skip_to = band_skip_target(ey1, ey2, incr);
+            if(skip_to != ey1) {
+                ey1 = skip_to;
+                set_cur_cell(ex, ey1);
+                continue;
+            }
             m_cur_cell.set_cover(delta, area);
             ey1 += incr;
             set_cur_cell(ex, ey1);
@@ -296,6 +331,18 @@ void outline_aa::render_line(int x1, int y1, int x2, int y2)
         }
         mod -= dy;
         while(ey1 != ey2) {
+            int skip_to = band_skip_target(ey1, ey2, incr);
+            if(skip_to != ey1) {
+                // Steps over rows outside the band at once, landing exactly
+                // where stepping one row at a time would.
+                int steps = (skip_to - ey1) * incr;
+                long long total = (long long)mod + dy + (long long)rem * steps;
+                x_from += (int)((long long)lift * steps + total / dy);
+                mod = (int)(total % dy) - dy;
+                ey1 = skip_to;
+                set_cur_cell(x_from >> poly_base_shift, ey1);
+                continue;
+            }
             delta = lift;
             mod  += rem;
             if (mod >= 0) {
@@ -322,7 +369,15 @@ void outline_aa::move_to(int x, int y)
 }
 void outline_aa::line_to(int x, int y)
 {
-    render_line(m_cur_x, m_cur_y, x, y);
+    int ey1 = m_cur_y >> poly_base_shift;
+    int ey2 = y >> poly_base_shift;
+    if((ey1 < m_band_min_y && ey2 < m_band_min_y) ||
+       (ey1 > m_band_max_y && ey2 > m_band_max_y)) {
+        // None of the line's cells are kept; only move the current cell.
+        set_cur_cell(x >> poly_base_shift, ey2);
+    } else {
+        render_line(m_cur_x, m_cur_y, x, y);
+    }
     m_cur_x = x;
     m_cur_y = y;
     m_sorted = false;
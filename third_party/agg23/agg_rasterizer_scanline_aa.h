@@ -34,6 +34,7 @@
 #include "agg_basics.h"
 #include "agg_clip_liang_barsky.h"
 #include "agg_math.h"
+#include "agg_path_storage.h"
 #include "agg_render_scanlines.h"
 #include "core/include/fxcrt/fx_coordinates.h"
 #include "core/include/fxcrt/fx_memory.h"
@@ -111,6 +112,19 @@ public:
     {
         return m_sorted;
     }
+    void band(int min_y, int max_y)
+    {
+        m_band_min_y = min_y;
+        m_band_max_y = max_y;
+    }
+    void cell_limit(unsigned limit)
+    {
+        m_cell_limit = limit;
+    }
+    unsigned dropped_cells() const
+    {
+        return m_dropped_cells;
+    }
 private:
     outline_aa(const outline_aa&);
     const outline_aa& operator = (const outline_aa&);
@@ -118,6 +132,7 @@ private:
     void add_cur_cell();
     void render_hline(int ey, int x1, int y1, int x2, int y2);
     void render_line(int x1, int y1, int x2, int y2);
+    int band_skip_target(int ey, int ey2, int incr) const;
     void allocate_block();
 private:
     unsigned  m_num_blocks;
@@ -135,6 +150,10 @@ private:
     int       m_min_y;
     int       m_max_x;
     int       m_max_y;
+    int       m_band_min_y;
+    int       m_band_max_y;
+    unsigned  m_cell_limit;
+    unsigned  m_dropped_cells;
     bool      m_sorted;
 };
 class scanline_hit_test 
@@ -190,7 +209,8 @@ public:
         m_clipped_start_x(0),
         m_clipped_start_y(0),
         m_status(status_initial),
-        m_clipping(false)
+        m_clipping(false),
+        m_record(0)
     {
     }
     ~rasterizer_scanline_aa() {}
@@ -226,8 +246,32 @@ public:
         m_clip_box.normalize();
         m_clipping = true;
     }
+    // Keeps only the cells of pixel rows |min_y| to |max_y|, so a path too
+    // big for its cells to fit at once can be added again for each band.
+    void band(int min_y, int max_y)
+    {
+        m_outline.band(min_y, max_y);
+    }
+    // Cells past |limit| are dropped and counted by dropped_cells().
+    void cell_limit(unsigned limit)
+    {
+        m_outline.cell_limit(limit);
+    }
+    unsigned dropped_cells() const
+    {
+        return m_outline.dropped_cells();
+    }
+    // Copies the vertices added from now on to |storage|, until called
+    // with 0. Replaying them adds exactly the same cells again.
+    void record(path_storage* storage)
+    {
+        m_record = storage;
+    }
     void add_vertex(FX_FLOAT x, FX_FLOAT y, unsigned cmd)
     {
+        if(m_record) {
+            m_record->add_vertex(x, y, cmd);
+        }
         if(is_close(cmd)) {
             close_polygon();
         } else {
@@ -330,47 +374,57 @@ public:
             if(m_cur_y > m_outline.max_y()) {
                 return false;
             }
-            sl.reset_spans();
-            unsigned num_cells = m_outline.scanline_num_cells(m_cur_y);
-            const cell_aa* const* cells = m_outline.scanline_cells(m_cur_y);
-            int cover = 0;
-            while(num_cells) {
-                const cell_aa* cur_cell = *cells;
-                int x    = cur_cell->x;
-                int area = cur_cell->area;
-                unsigned alpha;
-                cover += cur_cell->cover;
-                while(--num_cells) {
-                    cur_cell = *++cells;
-                    if(cur_cell->x != x) {
-                        break;
-                    }
-                    area  += cur_cell->area;
-                    cover += cur_cell->cover;
-                }
-                if(area) {
-                    alpha = calculate_alpha((cover << (poly_base_shift + 1)) - area, no_smooth);
-                    if(alpha) {
-                        sl.add_cell(x, alpha);
-                    }
-                    x++;
-                }
-                if(num_cells && cur_cell->x > x) {
-                    alpha = calculate_alpha(cover << (poly_base_shift + 1), no_smooth);
-                    if(alpha) {
-                        sl.add_span(x, cur_cell->x - x, alpha);
-                    }
-                }
-            }
-            if(sl.num_spans()) {
+            if(sweep_row(m_cur_y, sl, no_smooth)) {
                 break;
             }
             ++m_cur_y;
         }
-        sl.finalize(m_cur_y);
         ++m_cur_y;
         return true;
     }
+    // Fills |sl| with row |y|, which must lie within min_y() and max_y(),
+    // without moving the sweep position. Once rewind_scanlines() has sorted
+    // the cells, disjoint rows may be swept on several threads at once.
+    template<class Scanline> bool sweep_row(int y, Scanline& sl, bool no_smooth) const
+    {
+        sl.reset_spans();
+        unsigned num_cells = m_outline.scanline_num_cells(y);
+        const cell_aa* const* cells = m_outline.scanline_cells(y);
+        int cover = 0;
+        while(num_cells) {
+            const cell_aa* cur_cell = *cells;
+            int x    = cur_cell->x;
+            int area = cur_cell->area;
+            unsigned alpha;
+            cover += cur_cell->cover;
+            while(--num_cells) {
+                cur_cell = *++cells;
+                if(cur_cell->x != x) {
+                    break;
+                }
+                area  += cur_cell->area;
+                cover += cur_cell->cover;
+            }
+            if(area) {
+                alpha = calculate_alpha((cover << (poly_base_shift + 1)) - area, no_smooth);
+                if(alpha) {
+                    sl.add_cell(x, alpha);
+                }
+                x++;
+            }
+            if(num_cells && cur_cell->x > x) {
+                alpha = calculate_alpha(cover << (poly_base_shift + 1), no_smooth);
+                if(alpha) {
+                    sl.add_span(x, cur_cell->x - x, alpha);
+                }
+            }
+        }
+        if(!sl.num_spans()) {
+            return false;
+        }
+        sl.finalize(y);
+        return true;
+    }
     template<class VertexSource>
     void add_path(VertexSource& vs, unsigned path_id = 0)
     {
@@ -469,6 +523,7 @@ private:
     unsigned       m_status;
     rect           m_clip_box;
     bool           m_clipping;
+    path_storage*  m_record;
     int            m_cur_y;
 };
 }
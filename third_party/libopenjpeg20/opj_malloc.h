@@ -172,6 +172,33 @@ void OPJ_CALLCONV opj_free(void * m);
 #define opj_free(m) free(m)
 #endif
 
+/* PDFium: take the blocks above from the FX heap, as the other bundled
+   libraries do, so that image data can pass between OpenJPEG and PDFium and
+   is charged to the document's memory budget. The aligned variants keep
+   their own heap; they are always released with opj_aligned_free(). */
+extern void* FXMEM_DefaultAlloc(size_t byte_size, int flags);
+extern void* FXMEM_DefaultRealloc(void* pointer, size_t new_size, int flags);
+extern void FXMEM_DefaultFree(void* pointer, int flags);
+
+static INLINE void* opj_fx_calloc(size_t num, size_t size) {
+	void* mem;
+	if (size && num > (size_t)-1 / size)
+		return NULL;
+	mem = FXMEM_DefaultAlloc(num * size, 0);
+	if (mem)
+		memset(mem, 0, num * size);
+	return mem;
+}
+
+#undef opj_malloc
+#define opj_malloc(size) FXMEM_DefaultAlloc(size, 0)
+#undef opj_calloc
+#define opj_calloc(num, size) opj_fx_calloc(num, size)
+#undef opj_realloc
+#define opj_realloc(m, s) FXMEM_DefaultRealloc(m, s, 0)
+#undef opj_free
+#define opj_free(m) FXMEM_DefaultFree(m, 0)
+
 #ifdef __GNUC__
 #pragma GCC poison malloc calloc realloc free
 #endif